@@ -20,7 +20,7 @@
 #include <stddef.h>
 #include <unistd.h>
 
-#define LTO_API_VERSION 4
+#define LTO_API_VERSION 6
 
 typedef enum {
     LTO_SYMBOL_ALIGNMENT_MASK              = 0x0000001F, /* log2 of alignment */
@@ -265,6 +265,41 @@ extern const void*
 lto_codegen_compile(lto_code_gen_t cg, size_t* length);
 
 
+/**
+ * Generates code for all added modules into up to the given number of
+ * native object files at once, one thread per object file.  The functions
+ * are split between the object files along the call graph, and local
+ * symbols used from more than one of them become hidden globals.
+ * On success returns the number of object files, which are read with
+ * lto_codegen_get_partition().
+ * On failure, returns zero (check lto_get_error_message() for details).
+ */
+extern unsigned
+lto_codegen_compile_partitions(lto_code_gen_t cg, unsigned partitions);
+
+
+/**
+ * Sets the directory in which lto_codegen_compile_partitions() keeps the
+ * object files it generates.  A partition whose code, declarations and
+ * code generation options did not change since an earlier link is read
+ * back from there instead of being generated again.  The functions are
+ * then put in the same partition from one link to the next.
+ */
+extern void
+lto_codegen_set_cache_dir(lto_code_gen_t cg, const char* path);
+
+
+/**
+ * Returns the object file of the given partition after
+ * lto_codegen_compile_partitions(), and sets length to its size.  The
+ * buffer is owned by the lto_code_gen_t and will be freed when
+ * lto_codegen_dispose() is called, or lto_codegen_compile_partitions()
+ * is called again.  Returns NULL if there is no such partition.
+ */
+extern const void*
+lto_codegen_get_partition(lto_code_gen_t cg, unsigned index, size_t* length);
+
+
 /**
  * Sets options to help debug codegen bugs.
  */
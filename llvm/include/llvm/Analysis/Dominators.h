@@ -735,6 +735,10 @@ public:
 
   virtual bool runOnFunction(Function &F);
 
+  virtual FunctionPass *createParallelClone() const {
+    return new DominatorTree();
+  }
+
   virtual void verifyAnalysis() const;
 
   virtual void getAnalysisUsage(AnalysisUsage &AU) const {
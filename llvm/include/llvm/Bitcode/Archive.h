@@ -345,10 +345,11 @@ class Archive {
     /// offset in the symbol table to obtain the real file offset. Note that
     /// there is purposefully no interface provided by Archive to look up
     /// members by their offset. Use the findModulesDefiningSymbols and
-    /// findModuleDefiningSymbol methods instead.
+    /// findModuleDefiningSymbol methods instead. If the archive has a hashed
+    /// symbol index, the table is built from it on the first call.
     /// @returns the Archive's symbol table.
     /// @brief Get the archive's symbol table
-    const SymTabType& getSymbolTable() { return symTab; }
+    const SymTabType& getSymbolTable();
 
     /// This method returns the offset in the archive file to the first "real"
     /// file member. Archive files, on disk, have a signature and might have a
@@ -458,6 +459,19 @@ class Archive {
     /// @brief Parse the symbol table at \p data.
     bool parseSymbolTable(const void* data,unsigned len,std::string* error);
 
+    /// The hashed symbol index is not copied: lookups read it straight from
+    /// the mapped archive file.
+    /// @param data The symbol index data to be checked
+    /// @param len  The length of the symbol index data
+    /// @param error Set to address of a std::string to get error messages
+    /// @returns false on error
+    /// @brief Check the hashed symbol index at \p data and remember it.
+    bool parseSymbolIndex(const void* data,unsigned len,std::string* error);
+
+    /// @returns true and sets \p offset if \p symbol is in the symbol index.
+    /// @brief Look up one symbol in the hashed symbol index.
+    bool lookupSymbolIndex(const std::string& symbol, unsigned& offset) const;
+
     /// @returns A fully populated ArchiveMember or 0 if an error occurred.
     /// @brief Parse the header of a member starting at \p At
     ArchiveMember* parseMemberHeader(
@@ -525,6 +539,7 @@ class Archive {
     MemoryBuffer *mapfile;    ///< Raw Archive contents mapped into memory
     const char* base;         ///< Base of the memory mapped file data
     SymTabType symTab;        ///< The symbol table
+    const char* symIndex;     ///< The hashed symbol index in the mapped file
     std::string strtab;       ///< The string table for long file names
     unsigned symTabSize;      ///< Size in bytes of symbol table
     unsigned firstFileOffset; ///< Offset to first normal file.
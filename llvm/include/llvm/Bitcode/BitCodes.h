@@ -19,6 +19,7 @@
 #define LLVM_BITCODE_BITCODES_H
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Atomic.h"
 #include "llvm/Support/DataTypes.h"
 #include <cassert>
 
@@ -161,13 +162,15 @@ public:
 /// specialized format instead of the fully-general, fully-vbr, format.
 class BitCodeAbbrev {
   SmallVector<BitCodeAbbrevOp, 8> OperandList;
-  unsigned char RefCount; // Number of things using this.
+  // Number of things using this.  Abbreviations from the block info block are
+  // shared by every cursor on the stream, which can be on different threads.
+  volatile sys::cas_flag RefCount;
   ~BitCodeAbbrev() {}
 public:
   BitCodeAbbrev() : RefCount(1) {}
 
-  void addRef() { ++RefCount; }
-  void dropRef() { if (--RefCount == 0) delete this; }
+  void addRef() { sys::AtomicIncrement(&RefCount); }
+  void dropRef() { if (sys::AtomicDecrement(&RefCount) == 0) delete this; }
 
   unsigned getNumOperandInfos() const {
     return static_cast<unsigned>(OperandList.size());
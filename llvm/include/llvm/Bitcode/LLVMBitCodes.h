@@ -35,7 +35,8 @@ namespace bitc {
     TYPE_SYMTAB_BLOCK_ID,
     VALUE_SYMTAB_BLOCK_ID,
     METADATA_BLOCK_ID,
-    METADATA_ATTACHMENT_ID
+    METADATA_ATTACHMENT_ID,
+    SUMMARY_BLOCK_ID
   };
 
 
@@ -127,6 +128,15 @@ namespace bitc {
     METADATA_NAMED_NODE2   = 10,  // NAMED_NODE2:   [n x mdnodes]
     METADATA_ATTACHMENT2   = 11   // [m x [value, [n x [id, mdnode]]]
   };
+
+  /// SUMMARY blocks describe the function bodies of the module, so that the
+  /// references between globals are known without reading the bodies.
+  enum SummaryCodes {
+    // FUNCTION: [valueid, numblocks, numinsts, numcalls, callee valueid x N,
+    //            ref valueid x N]
+    SUMMARY_CODE_FUNCTION = 1
+  };
+
   // The constants block (CONSTANTS_BLOCK_ID) describes emission for each
   // constant and maintains an implicit current type value.
   enum ConstantsCodes {
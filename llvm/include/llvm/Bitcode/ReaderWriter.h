@@ -14,9 +14,13 @@
 #ifndef LLVM_BITCODE_H
 #define LLVM_BITCODE_H
 
+#include <map>
 #include <string>
+#include <vector>
 
 namespace llvm {
+  class Function;
+  class GlobalValue;
   class Module;
   class MemoryBuffer;
   class ModulePass;
@@ -33,6 +37,31 @@ namespace llvm {
                                LLVMContext& Context,
                                std::string *ErrMsg = 0);
 
+  /// BitcodeFunctionSummary - What the summary block of a bitcode file records
+  /// about the body of a function.
+  struct BitcodeFunctionSummary {
+    /// NumBlocks, NumInstructions - The size of the body.
+    unsigned NumBlocks, NumInstructions;
+    /// Calls - The functions and aliases the body calls directly.
+    std::vector<GlobalValue*> Calls;
+    /// Refs - The other globals the body uses.
+    std::vector<GlobalValue*> Refs;
+  };
+
+  /// BitcodeModuleSummary - The summaries of the function bodies of a module.
+  typedef std::map<const Function*, BitcodeFunctionSummary>
+    BitcodeModuleSummary;
+
+  /// getLazyBitcodeModule - Like the above, and also fill in Summary from the
+  /// summary block of the file, so that what the function bodies refer to is
+  /// known without reading them.  Summary is left empty for files written
+  /// before there was a summary block.  It describes the bodies as they are
+  /// in the file, which is no longer accurate once they are read and changed.
+  Module *getLazyBitcodeModule(MemoryBuffer *Buffer,
+                               LLVMContext& Context,
+                               BitcodeModuleSummary &Summary,
+                               std::string *ErrMsg = 0);
+
   /// getBitcodeTargetTriple - Read the header of the specified bitcode
   /// buffer and extract just the triple information. If successful,
   /// this returns a string and *does not* take ownership
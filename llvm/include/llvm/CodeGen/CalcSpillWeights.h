@@ -69,6 +69,10 @@ namespace llvm {
       initializeCalculateSpillWeightsPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new CalculateSpillWeights();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &au) const;
 
     virtual bool runOnMachineFunction(MachineFunction &fn);
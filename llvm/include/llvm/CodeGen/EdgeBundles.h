@@ -33,6 +33,10 @@ public:
   static char ID;
   EdgeBundles() : MachineFunctionPass(ID) {}
 
+  virtual FunctionPass *createParallelClone() const {
+    return new EdgeBundles();
+  }
+
   /// getBundle - Return the ingoing (Out = false) or outgoing (Out = true)
   /// bundle number for basic block #N
   unsigned getBundle(unsigned N, bool Out) const { return EC[2 * N + Out]; }
@@ -287,6 +287,11 @@ protected:
                                       unsigned Op0, bool Op0IsKill,
                                       uint32_t Idx);
 
+  /// FastEmitInst_copytoregclass - Emit a copy of a register into a new
+  /// virtual register of the specified class.
+  unsigned FastEmitInst_copytoregclass(const TargetRegisterClass *RC,
+                                       unsigned Op0, bool Op0IsKill);
+
   /// FastEmitZExtFromI1 - Emit MachineInstrs to compute the value of Op
   /// with all but the least significant bit set to zero.
   unsigned FastEmitZExtFromI1(MVT VT,
@@ -231,6 +231,18 @@ namespace ISD {
     // Same for multiplication
     SMULO, UMULO,
 
+    // RESULT = SADDSAT(LHS, RHS) - Signed addition that clamps the result to
+    // the range of the type instead of wrapping around. SSUBSAT is the same
+    // for subtraction. These nodes are generated from the llvm.sadd.sat and
+    // llvm.ssub.sat intrinsics.
+    SADDSAT, SSUBSAT,
+
+    // RESULT = SMULFIXSAT(LHS, RHS, SCALE) - Signed fixed-point multiplication
+    // of two values with SCALE fraction bits, clamped to the range of the
+    // type. SCALE is a target constant smaller than the bit width. This node
+    // is generated from the llvm.smul.fix.sat intrinsic.
+    SMULFIXSAT,
+
     // Simple binary floating point operators.
     FADD, FSUB, FMUL, FDIV, FREM,
 
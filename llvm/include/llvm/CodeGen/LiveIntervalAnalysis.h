@@ -72,6 +72,10 @@ namespace llvm {
       initializeLiveIntervalsPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new LiveIntervals();
+    }
+
     // Calculate the spill weight to assign to a single instruction.
     static float getSpillWeight(bool isDef, bool isUse, unsigned loopDepth);
 
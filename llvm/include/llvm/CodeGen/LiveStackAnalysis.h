@@ -43,6 +43,10 @@ namespace llvm {
       initializeLiveStacksPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new LiveStacks();
+    }
+
     typedef SS2IntervalMap::iterator iterator;
     typedef SS2IntervalMap::const_iterator const_iterator;
     const_iterator begin() const { return S2IMap.begin(); }
@@ -52,6 +52,10 @@ public:
     initializeLiveVariablesPass(*PassRegistry::getPassRegistry());
   }
 
+  virtual FunctionPass *createParallelClone() const {
+    return new LiveVariables();
+  }
+
   /// VarInfo - This represents the regions where a virtual register is live in
   /// the program.  We represent this with three different pieces of
   /// information: the set of blocks in which the instruction is live
@@ -43,6 +43,10 @@ public:
   DominatorTreeBase<MachineBasicBlock>* DT;
   
   MachineDominatorTree();
+
+  virtual FunctionPass *createParallelClone() const {
+    return new MachineDominatorTree();
+  }
   
   ~MachineDominatorTree();
   
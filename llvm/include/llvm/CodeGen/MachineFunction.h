@@ -22,6 +22,7 @@
 #include "llvm/ADT/ilist.h"
 #include "llvm/Support/DebugLoc.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/ArrayRecycler.h"
 #include "llvm/Support/Recycler.h"
 
 namespace llvm {
@@ -108,6 +109,9 @@ class MachineFunction {
   // Allocation management for basic blocks in function.
   Recycler<MachineBasicBlock> BasicBlockRecycler;
 
+  // Allocation management for instruction operand arrays in function.
+  ArrayRecycler<MachineOperand> OperandRecycler;
+
   // List of machine basic blocks in function
   typedef ilist<MachineBasicBlock> BasicBlockListType;
   BasicBlockListType BasicBlocks;
@@ -361,6 +365,20 @@ public:
   ///
   void DeleteMachineInstr(MachineInstr *MI);
 
+  /// allocateOperandArray - Allocate an array to hold the operands of a
+  /// MachineInstr.  Arrays are recycled by capacity class, so an instruction
+  /// growing its operand list reuses the arrays of deleted instructions.
+  MachineOperand *allocateOperandArray(MachineInstr::OperandCapacity Cap) {
+    return OperandRecycler.allocate(Cap, Allocator);
+  }
+
+  /// deallocateOperandArray - Return an operand array allocated by
+  /// allocateOperandArray with the same capacity to the recycler.
+  void deallocateOperandArray(MachineInstr::OperandCapacity Cap,
+                              MachineOperand *Array) {
+    OperandRecycler.deallocate(Cap, Array);
+  }
+
   /// CreateMachineBasicBlock - Allocate a new MachineBasicBlock. Use this
   /// instead of `new MachineBasicBlock'.
   ///
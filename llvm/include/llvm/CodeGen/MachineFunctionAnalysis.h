@@ -15,6 +15,7 @@
 #define LLVM_CODEGEN_MACHINE_FUNCTION_ANALYSIS_H
 
 #include "llvm/Pass.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Target/TargetMachine.h"
 
 namespace llvm {
@@ -23,16 +24,37 @@ class MachineFunction;
 
 /// MachineFunctionAnalysis - This class is a Pass that manages a
 /// MachineFunction object.
+///
+/// With Threads set, it asks for the machine passes after it to run on that
+/// many threads for the functions that can be built independently.  Its
+/// parallel clones then keep the MachineFunctions they built in the
+/// MachineModuleInfo, and this pass takes them over for the passes that run
+/// on one thread, such as the AsmPrinter.
 struct MachineFunctionAnalysis : public FunctionPass {
 private:
   const TargetMachine &TM;
   CodeGenOpt::Level OptLevel;
   MachineFunction *MF;
   unsigned NextFnNum;
+  unsigned Threads;
+
+  /// ParallelThreads - What getParallelThreads returns for the current
+  /// module.
+  unsigned ParallelThreads;
+
+  /// IsClone - True for a parallel clone, which keeps its MachineFunctions
+  /// rather than deleting them.
+  bool IsClone;
+
+  /// FunctionNumbers - The number of each function of the module as this
+  /// pass would give it running on one function after the other, for a
+  /// clone.
+  DenseMap<const Function *, unsigned> FunctionNumbers;
 public:
   static char ID;
   explicit MachineFunctionAnalysis(const TargetMachine &tm,
-                                   CodeGenOpt::Level OL = CodeGenOpt::Default);
+                                   CodeGenOpt::Level OL = CodeGenOpt::Default,
+                                   unsigned Threads = 0);
   ~MachineFunctionAnalysis();
 
   MachineFunction &getMF() const { return *MF; }
@@ -42,6 +64,11 @@ public:
     return "Machine Function Analysis";
   }
 
+  virtual FunctionPass *createParallelClone() const;
+  virtual unsigned getParallelThreads() const { return ParallelThreads; }
+  virtual bool keepsParallelResults() const { return true; }
+  virtual bool canRunInParallelOn(Function &F);
+
 private:
   virtual bool doInitialization(Module &M);
   virtual bool runOnFunction(Function &F);
@@ -23,6 +23,7 @@
 #include "llvm/ADT/ilist_node.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/ArrayRecycler.h"
 #include "llvm/Support/DebugLoc.h"
 #include <vector>
 
@@ -43,6 +44,10 @@ class MachineInstr : public ilist_node<MachineInstr> {
 public:
   typedef MachineMemOperand **mmo_iterator;
 
+  /// OperandCapacity - The capacity class of an operand array.  Operand
+  /// arrays are allocated by the MachineFunction and recycled by capacity.
+  typedef ArrayRecycler<MachineOperand>::Capacity OperandCapacity;
+
   /// Flags to specify different kinds of comments to output in
   /// assembly code.  These flags carry semantic information not
   /// otherwise easily derivable from the IR text.
@@ -53,8 +58,10 @@ public:
 
   enum MIFlag {
     NoFlags    = 0,
-    FrameSetup = 1 << 0                 // Instruction is used as a part of
+    FrameSetup   = 1 << 0,              // Instruction is used as a part of
                                         // function frame setup code.
+    InsideBundle = 1 << 1               // Instruction issues in the same
+                                        // cycle as the preceding one.
   };
 private:
   const TargetInstrDesc *TID;           // Instruction descriptor.
@@ -72,7 +79,10 @@ private:
                                         // anything other than to convey comment
                                         // information to AsmPrinter.
 
-  std::vector<MachineOperand> Operands; // the operands
+  MachineOperand *Operands;             // Pointer to the first operand.
+  unsigned NumOperands;                 // Number of operands on instruction.
+  OperandCapacity CapOperands;          // Capacity of the Operands array.
+  MachineFunction *ParentMF;            // Function the operands come from.
   mmo_iterator MemRefs;                 // information on memory references
   mmo_iterator MemRefsEnd;
   MachineBasicBlock *Parent;            // Pointer to the owning basic block.
@@ -104,7 +114,8 @@ private:
   /// MachineInstr ctor - This constructor creates a MachineInstr and adds the
   /// implicit operands.  It reserves space for the number of operands specified
   /// by the TargetInstrDesc.  The version with a DebugLoc should be preferred.
-  explicit MachineInstr(const TargetInstrDesc &TID, bool NoImp = false);
+  MachineInstr(MachineFunction &MF, const TargetInstrDesc &TID,
+               bool NoImp = false);
 
   /// MachineInstr ctor - Work exactly the same as the ctor above, except that
   /// the MachineInstr is created and added to the end of the specified basic
@@ -114,8 +125,8 @@ private:
   /// MachineInstr ctor - This constructor create a MachineInstr and add the
   /// implicit operands.  It reserves space for number of operands specified by
   /// TargetInstrDesc.  An explicit DebugLoc is supplied.
-  explicit MachineInstr(const TargetInstrDesc &TID, const DebugLoc dl, 
-                        bool NoImp = false);
+  MachineInstr(MachineFunction &MF, const TargetInstrDesc &TID,
+               const DebugLoc dl, bool NoImp = false);
 
   /// MachineInstr ctor - Work exactly the same as the ctor above, except that
   /// the MachineInstr is created and added to the end of the specified basic
@@ -170,6 +181,17 @@ public:
   void setFlags(unsigned flags) {
     Flags = flags;
   }
+
+  /// clearFlag - Clear a MI flag.
+  void clearFlag(MIFlag Flag) {
+    Flags &= ~((uint8_t)Flag);
+  }
+
+  /// isInsideBundle - Return true if MI is packed into the same issue bundle
+  /// as the instruction before it. Only VLIW packetizers set this.
+  bool isInsideBundle() const {
+    return getFlag(InsideBundle);
+  }
   
   /// clearAsmPrinterFlag - clear specific AsmPrinter flags
   ///
@@ -191,7 +213,7 @@ public:
 
   /// Access to explicit operands of the instruction.
   ///
-  unsigned getNumOperands() const { return (unsigned)Operands.size(); }
+  unsigned getNumOperands() const { return NumOperands; }
 
   const MachineOperand& getOperand(unsigned i) const {
     assert(i < getNumOperands() && "getOperand() out of range!");
@@ -207,14 +229,14 @@ public:
   unsigned getNumExplicitOperands() const;
 
   /// iterator/begin/end - Iterate over all operands of a machine instruction.
-  typedef std::vector<MachineOperand>::iterator mop_iterator;
-  typedef std::vector<MachineOperand>::const_iterator const_mop_iterator;
+  typedef MachineOperand *mop_iterator;
+  typedef const MachineOperand *const_mop_iterator;
 
-  mop_iterator operands_begin() { return Operands.begin(); }
-  mop_iterator operands_end() { return Operands.end(); }
+  mop_iterator operands_begin() { return Operands; }
+  mop_iterator operands_end() { return Operands + NumOperands; }
 
-  const_mop_iterator operands_begin() const { return Operands.begin(); }
-  const_mop_iterator operands_end() const { return Operands.end(); }
+  const_mop_iterator operands_begin() const { return Operands; }
+  const_mop_iterator operands_end() const { return Operands + NumOperands; }
 
   /// Access to memory operands of the instruction
   mmo_iterator memoperands_begin() const { return MemRefs; }
@@ -71,6 +71,10 @@ public:
     initializeMachineLoopInfoPass(*PassRegistry::getPassRegistry());
   }
 
+  virtual FunctionPass *createParallelClone() const {
+    return new MachineLoopInfo();
+  }
+
   LoopInfoBase<MachineBasicBlock, MachineLoop>& getBase() { return LI; }
 
   /// iterator/begin/end - The interface to the top-level loops in the current
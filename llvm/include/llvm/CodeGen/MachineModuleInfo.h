@@ -38,6 +38,7 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/DebugLoc.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/ADT/DenseMap.h"
@@ -50,6 +51,7 @@ namespace llvm {
 //===----------------------------------------------------------------------===//
 // Forward declarations.
 class Constant;
+class Function;
 class GlobalVariable;
 class MDNode;
 class MachineBasicBlock;
@@ -161,6 +163,11 @@ class MachineModuleInfo : public ImmutablePass {
   /// This is used to emit an undefined reference to fltused on Windows targets.
   bool CallsExternalVAFunctionWithFloatingPointArguments;
 
+  /// KeptFunctions - The MachineFunctions built on other threads, waiting for
+  /// the MachineFunctionAnalysis that takes them over, and their lock.
+  DenseMap<const Function *, MachineFunction *> KeptFunctions;
+  sys::SmartMutex<true> KeptFunctionsLock;
+
 public:
   static char ID; // Pass identification, replacement for typeid
 
@@ -225,6 +232,14 @@ public:
     CallsExternalVAFunctionWithFloatingPointArguments = b;
   }
 
+  /// keepMachineFunction - Keep MF, built on another thread, for
+  /// takeMachineFunction to hand out.
+  void keepMachineFunction(MachineFunction *MF);
+
+  /// takeMachineFunction - Return the MachineFunction kept for F and give up
+  /// ownership of it, or null if there is none.
+  MachineFunction *takeMachineFunction(const Function *F);
+
   /// getFrameMoves - Returns a reference to a list of moves done in the current
   /// function's prologue.  Used to construct frame maps for debug and exception
   /// handling comsumers.
@@ -199,6 +199,10 @@ namespace llvm {
   /// instructions.
   FunctionPass *createMachineSinkingPass();
 
+  /// createModuloSchedulingPass - This pass software pipelines single block
+  /// innermost loops, using the target's itineraries to overlap iterations.
+  FunctionPass *createModuloSchedulingPass();
+
   /// createPeepholeOptimizerPass - This pass performs peephole optimizations -
   /// like extension and comparison eliminations.
   FunctionPass *createPeepholeOptimizerPass();
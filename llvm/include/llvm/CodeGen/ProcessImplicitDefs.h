@@ -35,6 +35,10 @@ namespace llvm {
       initializeProcessImplicitDefsPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new ProcessImplicitDefs();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &au) const;
 
     virtual bool runOnMachineFunction(MachineFunction &fn);
@@ -158,8 +158,17 @@ class SelectionDAG {
   FoldingSet<SDNode> CSEMap;
 
   /// OperandAllocator - Pool allocation for machine-opcode SDNode operands.
+  /// It is recycled rather than reset between blocks, so once it has grown to
+  /// the size of the largest DAG it keeps its slabs for the rest of the
+  /// module.
   BumpPtrAllocator OperandAllocator;
 
+  /// NumBlockNodes, BlockOperandBytes - The number of nodes created and the
+  /// number of operand bytes in use when the DAG was last cleared, for
+  /// statistics.
+  unsigned NumBlockNodes;
+  size_t BlockOperandBytes;
+
   /// Allocator - Pool allocation for misc. objects that are created once per
   /// SelectionDAG.
   BumpPtrAllocator Allocator;
@@ -1008,6 +1017,14 @@ public:
   unsigned InferPtrAlignment(SDValue Ptr) const;
 
 private:
+  /// InsertNode - Add a newly allocated node to the list of all nodes.
+  void InsertNode(SDNode *N);
+
+  /// FindNodeOrInsertPos - Look up a node with the given profile in the CSE
+  /// map.  If there is none, return null and set InsertPos to the place to
+  /// insert the new node at.
+  SDNode *FindNodeOrInsertPos(const FoldingSetNodeID &ID, void *&InsertPos);
+
   bool RemoveNodeFromCSEMaps(SDNode *N);
   void AddModifiedNodeToCSEMaps(SDNode *N, DAGUpdateListener *UpdateListener);
   SDNode *FindModifiedNodeSlot(SDNode *N, SDValue Op, void *&InsertPos);
@@ -17,6 +17,7 @@
 
 #include "llvm/BasicBlock.h"
 #include "llvm/Pass.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 
@@ -62,6 +63,10 @@ public:
 
   virtual bool runOnMachineFunction(MachineFunction &MF);
 
+  /// doFinalization - Print the FastISel miss histogram collected under
+  /// -fast-isel-verbose.
+  virtual bool doFinalization(Module &M);
+
   virtual void EmitFunctionEntryCode() {}
 
   /// PreprocessISelDAG - This hook allows targets to hack on the graph before
@@ -166,6 +171,11 @@ public:
 
 
 protected:
+  /// canRunInParallel - Return true if the target's createParallelClone may
+  /// return a copy of the selector.  The -fast-isel-verbose histogram is kept
+  /// per selector and printed when the module is done, so it needs one.
+  static bool canRunInParallel();
+
   /// DAGSize - Size of DAG being instruction selected.
   ///
   unsigned DAGSize;
@@ -301,6 +311,21 @@ private:
   /// state machines that start with a OPC_SwitchOpcode node.
   std::vector<unsigned> OpcodeOffset;
 
+  /// FastISelMiss - How often FastISel failed on one kind of instruction,
+  /// and how many instructions were selected with SelectionDAG as a result.
+  struct FastISelMiss {
+    unsigned Count;
+    unsigned DAGInsts;
+    FastISelMiss() : Count(0), DAGInsts(0) {}
+  };
+
+  /// FastISelMisses - The FastISel misses of the module under
+  /// -fast-isel-verbose, keyed by opcode and type, or by callee for calls
+  /// to intrinsics.
+  StringMap<FastISelMiss> FastISelMisses;
+
+  void RecordFastISelMiss(const Instruction *I, unsigned DAGInsts);
+
   void UpdateChainsAndGlue(SDNode *NodeToMatch, SDValue InputChain,
                            const SmallVectorImpl<SDNode*> &ChainNodesMatched,
                            SDValue InputGlue, const SmallVectorImpl<SDNode*> &F,
@@ -437,6 +437,10 @@ namespace llvm {
       initializeSlotIndexesPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new SlotIndexes();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &au) const;
     virtual void releaseMemory(); 
 
@@ -0,0 +1,94 @@
+//=- llvm/CodeGen/VLIWPacketizer.h - Issue bundle formation ------*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the VLIWPacketizerList class, which reorders the
+// instructions of a basic block after register allocation and groups the
+// ones that can issue in the same cycle into bundles, for targets whose
+// instruction encoding spells out instruction level parallelism.
+//
+// Bundles are recorded with the MachineInstr::InsideBundle flag: a flagged
+// instruction issues in the same cycle as the instruction before it. The
+// target's asm printer and code emitter translate this into bundle syntax or
+// parallel bits. Instructions that emit no code are ignored when forming
+// bundles.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_VLIWPACKETIZER_H
+#define LLVM_CODEGEN_VLIWPACKETIZER_H
+
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+
+class AliasAnalysis;
+class InstrItineraryData;
+class MachineDominatorTree;
+class MachineFunction;
+class MachineInstr;
+class MachineLoopInfo;
+class TargetInstrInfo;
+class TargetRegisterInfo;
+class VLIWScheduler;
+
+class VLIWPacketizerList {
+  /// Scheduler - The list scheduler that assigns an issue cycle to every
+  /// instruction of a scheduling region.
+  VLIWScheduler *Scheduler;
+
+  /// PacketOf - Bundle number of every scheduled instruction in the block
+  /// being packetized. Scheduling boundaries have no entry.
+  DenseMap<MachineInstr*, unsigned> PacketOf;
+
+  /// NextPacket - First unused bundle number in the current block.
+  unsigned NextPacket;
+
+  void scheduleRegion(MachineBasicBlock *MBB,
+                      MachineBasicBlock::iterator Begin,
+                      MachineBasicBlock::iterator End, unsigned EndCount);
+  unsigned formBundles(MachineBasicBlock *MBB);
+  bool canJoinBundle(const SmallVectorImpl<MachineInstr*> &Bundle,
+                     MachineInstr *MI) const;
+
+protected:
+  MachineFunction &MF;
+  const TargetInstrInfo *TII;
+  const TargetRegisterInfo *TRI;
+  const InstrItineraryData *InstrItins;
+
+public:
+  VLIWPacketizerList(MachineFunction &MF, MachineLoopInfo &MLI,
+                     MachineDominatorTree &MDT, AliasAnalysis *AA);
+  virtual ~VLIWPacketizerList();
+
+  /// PacketizeBlock - Schedule every region of MBB and mark the resulting
+  /// bundles. Return the number of instructions placed in the same bundle as
+  /// their predecessor. Does nothing if the target has no itineraries or no
+  /// issue width.
+  unsigned PacketizeBlock(MachineBasicBlock *MBB);
+
+  /// isSoloInstruction - Return true if MI must be the only instruction in
+  /// its bundle. By default this holds for inline asm and instructions with
+  /// unmodeled side effects.
+  virtual bool isSoloInstruction(const MachineInstr *MI) const;
+
+  /// endsPacket - Return true if no instruction may follow MI in its bundle.
+  /// By default this holds for calls, branches and returns.
+  virtual bool endsPacket(const MachineInstr *MI) const;
+
+  /// emitsCode - Return true if MI takes an issue slot. Labels, KILLs and
+  /// other markers do not, and are skipped when forming bundles.
+  static bool emitsCode(const MachineInstr *MI);
+};
+
+} // end namespace llvm
+
+#endif
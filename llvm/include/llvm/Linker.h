@@ -254,9 +254,11 @@ class Linker {
     /// case it is not usable by the caller after this method is invoked. Only
     /// the \p Dest module will remain. The \p Src module is linked into the
     /// Linker's composite module such that types, global variables, functions,
-    /// and etc. are matched and resolved.  If an error occurs, this function
-    /// returns true and ErrorMsg is set to a descriptive message about the
-    /// error.
+    /// and etc. are matched and resolved.  The \p Src module may be read
+    /// lazily: function bodies are then read from its file as they are moved
+    /// into \p Dest, and local functions nothing refers to are not read at
+    /// all.  If an error occurs, this function returns true and ErrorMsg is
+    /// set to a descriptive message about the error.
     /// @returns True if an error occurs, false otherwise.
     /// @brief Generically link two modules together.
     static bool LinkModules(Module* Dest, Module* Src, std::string* ErrorMsg);
@@ -274,6 +276,7 @@ class Linker {
   private:
     /// Read in and parse the bitcode file named by FN and return the
     /// Module it contains (wrapped in an auto_ptr), or 0 if an error occurs.
+    /// The function bodies are left in the file until the module is linked.
     std::auto_ptr<Module> LoadObject(const sys::Path& FN);
 
     bool warning(StringRef message);
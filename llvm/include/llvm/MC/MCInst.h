@@ -128,14 +128,20 @@ public:
 /// instruction.
 class MCInst {
   unsigned Opcode;
+  unsigned Flags;
   SmallVector<MCOperand, 8> Operands;
 public:
-  MCInst() : Opcode(0) {}
+  MCInst() : Opcode(0), Flags(0) {}
 
   void setOpcode(unsigned Op) { Opcode = Op; }
 
   unsigned getOpcode() const { return Opcode; }
 
+  /// setFlags/getFlags - Target-defined bits that do not fit in an operand,
+  /// e.g. whether the instruction issues in parallel with its predecessor.
+  void setFlags(unsigned F) { Flags = F; }
+  unsigned getFlags() const { return Flags; }
+
   const MCOperand &getOperand(unsigned i) const { return Operands[i]; }
   MCOperand &getOperand(unsigned i) { return Operands[i]; }
   unsigned getNumOperands() const { return Operands.size(); }
@@ -302,6 +302,35 @@ public:
 
   ///  Return what kind of Pass Manager can manage this pass.
   virtual PassManagerType getPotentialPassManagerType() const;
+
+  /// createParallelClone - Return a new instance of this pass, set up the same
+  /// way, for the pass manager to run on other functions at the same time as
+  /// this one, or null if the pass cannot run on several functions at once.
+  /// Passes that return a copy may only change the function they run on, and
+  /// anything they share with other functions only through the LLVMContext.
+  /// The copies get doInitialization and runOnFunction calls; only the
+  /// original gets doFinalization.
+  virtual FunctionPass *createParallelClone() const { return 0; }
+
+  /// getParallelThreads - Return the number of threads this pass asks its pass
+  /// manager to run it on, for the module it was last initialized for.  Zero
+  /// leaves the choice to the pass manager, and one keeps the passes of the
+  /// manager on one function after the other for that module.  When not every
+  /// pass of the manager has a parallel clone, the passes with clones around
+  /// this one run on the threads, and the others after them on one thread.
+  virtual unsigned getParallelThreads() const { return 0; }
+
+  /// keepsParallelResults - Return true if the parallel clones of this pass
+  /// leave what they computed for a function where this pass picks it up when
+  /// it runs on the same function, so that the passes after the clones can
+  /// use it.
+  virtual bool keepsParallelResults() const { return false; }
+
+  /// canRunInParallelOn - Return false if the parallel clones of this pass
+  /// must not run on F.  The pass manager asks once the body of F has been
+  /// read and the passes before the clones ran on it, and then runs F through
+  /// the original passes on its own thread, in order with the other functions.
+  virtual bool canRunInParallelOn(Function &F) { return true; }
 };
 
 
@@ -58,6 +58,13 @@ public:
   /// whether any of the passes modifies the module, and if so, return true.
   bool run(Module &M);
 
+  /// setMaterializeForModulePasses - If Materialize is true, read all the
+  /// function bodies of a lazily loaded module in before a module pass runs
+  /// on it.  Otherwise module passes see the functions that are not read yet
+  /// as declarations.  Function passes read each body as they get to it
+  /// either way.
+  void setMaterializeForModulePasses(bool Materialize);
+
 private:
   /// addImpl - Add a pass to the queue of passes to run, without
   /// checking whether to add a printer pass.
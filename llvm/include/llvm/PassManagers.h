@@ -91,6 +91,8 @@
 #include "llvm/Support/PrettyStackTrace.h"
 
 namespace llvm {
+  class BasicBlock;
+  class Function;
   class Module;
   class Pass;
   class StringRef;
@@ -128,6 +130,25 @@ public:
   /// print - Emit information about this stack frame to OS.
   virtual void print(raw_ostream &OS) const;
 };
+
+struct PassProfileRun;
+
+/// PassProfileRegion - This records the time, memory and instruction count
+/// changes of one run of a pass for -profile-passes and -profile-passes-trace.
+/// It does nothing unless one of those options is given.
+class PassProfileRegion {
+  PassProfileRun *Run;
+  PassProfileRegion(const PassProfileRegion &); // do not implement
+  void operator=(const PassProfileRegion &);    // do not implement
+public:
+  PassProfileRegion(Pass *P, Module &M);      // When P is run on M
+  PassProfileRegion(Pass *P, Function &F);    // When P is run on F
+  PassProfileRegion(Pass *P, BasicBlock &BB); // When P is run on BB
+  /// When P is run on something else, named Name.  No instructions are
+  /// counted for these runs.
+  PassProfileRegion(Pass *P, StringRef Name);
+  ~PassProfileRegion();
+};
   
   
 //===----------------------------------------------------------------------===//
@@ -190,6 +211,11 @@ public:
   /// Collect passes whose last user is P
   void collectLastUses(SmallVectorImpl<Pass *> &LastUses, Pass *P);
 
+  /// Make each pass in Clones the last user of the clones of the passes
+  /// whose last user is the pass at the same position in Originals.
+  void cloneLastUses(const SmallVectorImpl<Pass *> &Originals,
+                     const SmallVectorImpl<Pass *> &Clones);
+
   /// Find the pass that implements Analysis AID. Search immutable
   /// passes and all pass managers. If desired pass is not found
   /// then return NULL.
@@ -409,12 +435,28 @@ class FPPassManager : public ModulePass, public PMDataManager {
 public:
   static char ID;
   explicit FPPassManager(int Depth) 
-  : ModulePass(ID), PMDataManager(Depth) { }
+  : ModulePass(ID), PMDataManager(Depth), CanRunInParallel(true),
+    PipelineChecked(false), PipelineBegin(0), PipelineEnd(0) { }
+
+  ~FPPassManager();
   
   /// run - Execute all of the passes scheduled for execution.  Keep track of
   /// whether any of the passes modifies the module, and if so, return true.
   bool runOnFunction(Function &F);
   bool runOnModule(Module &M);
+
+  /// runPassesOn - Run all of the passes on F, without collecting the
+  /// analysis of the managers above this one first.
+  bool runPassesOn(Function &F) {
+    return runPassesOn(F, 0, getNumContainedPasses());
+  }
+
+  /// runPassesOn - Run the passes [Begin, End) on F.
+  bool runPassesOn(Function &F, unsigned Begin, unsigned End);
+
+  /// freeUnreleasedPasses - Free the passes that no pass of this manager is
+  /// the last user of in a parallel run, once they are done with F.
+  void freeUnreleasedPasses(Function &F);
   
   /// cleanup - After running all passes, clean up pass manager cache.
   void cleanup();
@@ -451,6 +493,61 @@ public:
   virtual PassManagerType getPassManagerType() const { 
     return PMT_FunctionPassManager; 
   }
+
+private:
+  /// getNumShards - Return the number of threads to run the passes on M
+  /// with, or zero to run them on one function after the other.
+  unsigned getNumShards(Module &M);
+
+  /// addShard - Add a manager with a copy of each of the passes [Begin, End)
+  /// to Shards, or return false if some pass cannot be copied.
+  bool addShard(unsigned Begin, unsigned End);
+
+  /// findPipeline - Find the passes with parallel clones from the pass
+  /// Requester on that can run on all functions of a batch before the passes
+  /// after them run on the first one, and set PipelineBegin, PipelineEnd and
+  /// PipelineReruns.  Return false if there are none.
+  bool findPipeline(unsigned Requester);
+
+  /// canRunInParallelOn - Return true if each of the passes [Begin, End) lets
+  /// its parallel clones run on F.
+  bool canRunInParallelOn(Function &F, unsigned Begin, unsigned End);
+
+  /// runInParallel - Run the passes on the functions of M with the first
+  /// NumShards managers in Shards, and those some pass keeps off the shards
+  /// on this manager.
+  void runInParallel(Module &M, unsigned NumShards);
+
+  /// runPipelined - Run the passes on the functions of M batch by batch: the
+  /// passes before the pipeline on this manager, the pipeline on the first
+  /// NumShards managers in Shards, then the rest on this manager again.
+  /// Functions some pass of the pipeline keeps off the shards run through all
+  /// of it on this manager.
+  void runPipelined(Module &M, unsigned NumShards);
+
+  /// Shards - Managers running copies of the passes of this one, one for
+  /// each thread the passes run on.
+  SmallVector<FPPassManager *, 8> Shards;
+
+  /// CanRunInParallel - False once some pass turned out to be unable to run
+  /// on several functions at once.
+  bool CanRunInParallel;
+
+  /// PipelineChecked - True once findPipeline ran.
+  bool PipelineChecked;
+
+  /// PipelineBegin, PipelineEnd - The passes the shards run when not all
+  /// passes can run on several functions at once, or an empty range.
+  unsigned PipelineBegin, PipelineEnd;
+
+  /// PipelineReruns - The passes of the pipeline whose analysis the passes
+  /// after it use.  They run again on this manager, where they pick up what
+  /// their clones kept.
+  SmallVector<unsigned, 4> PipelineReruns;
+
+  /// Unreleased - The passes that no pass of this manager is the last user of
+  /// in a parallel run, because their last user runs elsewhere.
+  SmallVector<Pass *, 4> Unreleased;
 };
 
 Timer *getPassTimer(Pass *);
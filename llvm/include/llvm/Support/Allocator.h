@@ -81,6 +81,11 @@ public:
   virtual ~MallocSlabAllocator();
   virtual MemSlab *Allocate(size_t Size);
   virtual void Deallocate(MemSlab *Slab);
+
+  /// getTotalSlabBytes - Return the number of bytes all MallocSlabAllocators
+  /// have handed out as slabs so far.  The count wraps around at the width of
+  /// sys::cas_flag, so only differences between two calls are meaningful.
+  static size_t getTotalSlabBytes();
 };
 
 /// BumpPtrAllocator - This allocator is useful for containers that need
@@ -116,6 +121,10 @@ class BumpPtrAllocator {
   ///
   char *End;
 
+  /// FreeSlabs - Slabs kept by Recycle for later allocations to reuse before
+  /// asking the slab allocator for new ones.
+  MemSlab *FreeSlabs;
+
   /// BytesAllocated - This field tracks how many bytes we've allocated, so
   /// that we can compute how much space was wasted.
   size_t BytesAllocated;
@@ -133,6 +142,10 @@ class BumpPtrAllocator {
   /// one.
   void DeallocateSlabs(MemSlab *Slab);
 
+  /// TakeFreeSlab - Remove a slab of at least MinSize bytes from FreeSlabs and
+  /// return it, or return null if there is none.
+  MemSlab *TakeFreeSlab(size_t MinSize);
+
   static MallocSlabAllocator DefaultSlabAllocator;
 
   template<typename T> friend class SpecificBumpPtrAllocator;
@@ -145,6 +158,14 @@ public:
   /// to the beginning of it, freeing all memory allocated so far.
   void Reset();
 
+  /// Recycle - Like Reset, but keep every slab for the allocations that
+  /// follow instead of returning them to the slab allocator.  This suits an
+  /// allocator that is emptied and refilled over and over: once it has grown
+  /// to the size it needs, it stops allocating slabs.  Slabs smaller than the
+  /// current slab size are released when they come up for reuse, so the
+  /// slabs that are kept follow the slab size as it grows.
+  void Recycle();
+
   /// Allocate - Allocate space at the specified alignment.
   ///
   void *Allocate(size_t Size, size_t Alignment);
@@ -176,6 +197,10 @@ public:
 
   unsigned GetNumSlabs() const;
 
+  /// getBytesAllocated - Return the number of bytes allocated so far, not
+  /// counting alignment padding.  This is never reset.
+  size_t getBytesAllocated() const { return BytesAllocated; }
+
   void PrintStats() const;
 };
 
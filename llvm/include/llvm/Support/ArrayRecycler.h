@@ -0,0 +1,130 @@
+//==- llvm/Support/ArrayRecycler.h - Recycling of Arrays ---------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ArrayRecycler class template which can recycle small
+// arrays allocated from one of the allocators in Allocator.h
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_ARRAYRECYCLER_H
+#define LLVM_SUPPORT_ARRAYRECYCLER_H
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/AlignOf.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+
+namespace llvm {
+
+/// ArrayRecycler - Recycle arrays of T.  The arrays are grouped into capacity
+/// classes of power-of-two sizes, and each class keeps its own free list, so
+/// an array that is freed is handed out again to the next request of the same
+/// class instead of growing the allocator.
+///
+/// The recycler does not know the capacity of the arrays it hands out; the
+/// caller keeps the Capacity that an array was allocated with and passes it
+/// back when the array is freed.
+///
+template<class T, size_t Align = AlignOf<T>::Alignment>
+class ArrayRecycler {
+  /// FreeList - The free'd arrays of a capacity class are linked through
+  /// their first word.
+  struct FreeList {
+    FreeList *Next;
+  };
+
+  /// Bucket - The free list of each capacity class, indexed by the class.
+  SmallVector<FreeList*, 8> Bucket;
+
+  /// pop - Remove an entry from the free list in Bucket[Idx] and return it.
+  /// Return NULL if no entries are available.
+  T *pop(unsigned Idx) {
+    if (Idx >= Bucket.size())
+      return 0;
+    FreeList *Entry = Bucket[Idx];
+    if (!Entry)
+      return 0;
+    Bucket[Idx] = Entry->Next;
+    return reinterpret_cast<T*>(Entry);
+  }
+
+  /// push - Add an entry to the free list at Bucket[Idx].
+  void push(unsigned Idx, T *Ptr) {
+    assert(Ptr && "Cannot recycle NULL pointer");
+    FreeList *Entry = reinterpret_cast<FreeList*>(Ptr);
+    if (Idx >= Bucket.size())
+      Bucket.resize(size_t(Idx) + 1);
+    Entry->Next = Bucket[Idx];
+    Bucket[Idx] = Entry;
+  }
+
+public:
+  /// Capacity - The capacity class of an array: one of 1, 2, 4, 8, ...
+  /// elements.  It fits in a byte so it is cheap to keep next to the array.
+  class Capacity {
+    uint8_t Index;
+    explicit Capacity(uint8_t idx) : Index(idx) {}
+
+  public:
+    Capacity() : Index(0) {}
+
+    /// get - Return the smallest capacity class that holds N elements.
+    static Capacity get(size_t N) {
+      return Capacity(N ? Log2_64_Ceil(N) : 0);
+    }
+
+    /// getSize - Return the number of elements in an array of this class.
+    size_t getSize() const { return size_t(1u) << Index; }
+
+    /// getBucket - Return the index of the free list for this class.
+    unsigned getBucket() const { return Index; }
+
+    /// getNext - Return the next larger capacity class, twice this size.
+    Capacity getNext() const { return Capacity(Index + 1); }
+  };
+
+  ~ArrayRecycler() {
+    // The free lists point into memory owned by the allocator, so the
+    // recycler must have been cleared before it is destroyed.
+    assert(Bucket.empty() && "Non-empty ArrayRecycler deleted!");
+  }
+
+  /// clear - Release all the tracked allocations to the allocator.  The
+  /// recycler must be free of any tracked allocations before being
+  /// deleted.
+  template<class AllocatorType>
+  void clear(AllocatorType &Allocator) {
+    for (; !Bucket.empty(); Bucket.pop_back())
+      while (T *Ptr = pop(Bucket.size() - 1))
+        Allocator.Deallocate(Ptr);
+  }
+
+  /// allocate - Return an array of Cap.getSize() uninitialized elements,
+  /// reusing a free'd array of the same class if there is one.
+  template<class AllocatorType>
+  T *allocate(Capacity Cap, AllocatorType &Allocator) {
+    // Free'd arrays hold the free list link, so T must be large enough.
+    assert(sizeof(T) >= sizeof(FreeList) && "Objects too small to recycle");
+    assert(Align >= AlignOf<FreeList>::Alignment && "Object underaligned");
+    if (T *Ptr = pop(Cap.getBucket()))
+      return Ptr;
+    return static_cast<T*>(Allocator.Allocate(sizeof(T)*Cap.getSize(), Align));
+  }
+
+  /// deallocate - Recycle an array allocated with the same capacity class.
+  /// The elements are not destroyed.
+  void deallocate(Capacity Cap, T *Ptr) {
+    push(Cap.getBucket(), Ptr);
+  }
+};
+
+} // end llvm namespace
+
+#endif
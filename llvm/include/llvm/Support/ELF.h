@@ -141,6 +141,7 @@ enum {
   EM_ALPHA = 41,    // DEC Alpha
   EM_SPARCV9 = 43,  // SPARC V9
   EM_X86_64 = 62,   // AMD64
+  EM_MDSP = 19780,  // MDSP VLIW DSP
   EM_MBLAZE = 47787 // Xilinx MicroBlaze
 };
 
@@ -290,6 +291,17 @@ enum {
   R_MICROBLAZE_COPY           = 21
 };
 
+// MDSP relocations.
+enum {
+  R_MDSP_NONE                 = 0,
+  R_MDSP_32                   = 1,
+  R_MDSP_PC32                 = 2,
+  R_MDSP_PC16                 = 3,  // Conditional branch, in words
+  R_MDSP_PC26                 = 4,  // br, call and endloop, in words
+  R_MDSP_HI16                 = 5,  // Upper half of an address, for movhi
+  R_MDSP_LO16                 = 6   // Lower half of an address, for ori
+};
+
 
 // ARM Specific e_flags
 enum { EF_ARM_EABIMASK = 0xFF000000U };
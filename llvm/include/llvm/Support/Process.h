@@ -47,6 +47,12 @@ namespace sys {
       /// that memory.
       static size_t GetTotalMemoryUsage();
 
+      /// This static function will return the largest resident set size the
+      /// process has had so far, in bytes. If the operating system does not
+      /// support collection of this metric, zero is returned.
+      /// @brief Return the peak resident set size of the process.
+      static size_t GetPeakResidentSetSize();
+
       /// This static function will set \p user_time to the amount of CPU time
       /// spent in user (non-kernel) mode and \p sys_time to the amount of CPU
       /// time spent in system (kernel) mode.  If the operating system does not
@@ -54,6 +54,24 @@ namespace llvm {
   /// the thread stack.
   void llvm_execute_on_thread(void (*UserFn)(void*), void *UserData,
                               unsigned RequestedStackSize = 0);
+
+  /// llvm_execute_in_parallel - Call the given \arg UserFn once for each
+  /// element of \arg UserData, on \arg NumThreads threads at once, and wait
+  /// for all of the calls to return.  The calling thread makes the first call
+  /// itself.
+  ///
+  /// Where threads are not available, or cannot be created, the calls run one
+  /// after the other on the calling thread, so callers that share work between
+  /// the calls must not wait for each other.
+  ///
+  /// \param UserFn - The callback to execute.
+  /// \param UserData - The arguments, one per call.
+  /// \param NumThreads - The number of calls, and of elements in UserData.
+  /// \param RequestedStackSize - If non-zero, a requested size (in bytes) for
+  /// the stacks of the new threads.
+  void llvm_execute_in_parallel(void (*UserFn)(void*), void **UserData,
+                                unsigned NumThreads,
+                                unsigned RequestedStackSize = 0);
 }
 
 #endif
@@ -67,7 +67,7 @@ public:
   ValueHandleBase(HandleBaseKind Kind, const ValueHandleBase &RHS)
     : PrevPair(0, Kind), Next(0), VP(RHS.VP) {
     if (isValid(VP))
-      AddToExistingUseList(RHS.getPrevPtr());
+      AddToUseListBefore(RHS);
   }
   ~ValueHandleBase() {
     if (isValid(VP))
@@ -86,7 +86,7 @@ public:
     if (VP == RHS.VP) return RHS.VP;
     if (isValid(VP)) RemoveFromUseList();
     VP = RHS.VP;
-    if (isValid(VP)) AddToExistingUseList(RHS.getPrevPtr());
+    if (isValid(VP)) AddToUseListBefore(RHS);
     return VP;
   }
 
@@ -122,6 +122,9 @@ private:
 
   /// AddToUseList - Add this ValueHandle to the use list for VP.
   void AddToUseList();
+  /// AddToUseListBefore - Add this ValueHandle to the use list for VP, right
+  /// before RHS, which is already on it.
+  void AddToUseListBefore(const ValueHandleBase &RHS);
   /// RemoveFromUseList - Remove this ValueHandle from its current use list.
   void RemoveFromUseList();
 };
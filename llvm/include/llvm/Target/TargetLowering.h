@@ -1512,13 +1512,20 @@ public:
   /// If HasBaseReg is false, there is no base register.
   /// If Scale is zero, there is no ScaleReg.  Scale of 1 indicates a reg with
   /// no scale.
+  /// If IsCircular is true, ScaleReg indexes a circular buffer whose length
+  /// is held in a second register, and the address is
+  ///    BaseGV + BaseOffs + BaseReg + Scale*(ScaleReg mod Length)
+  /// ScaleReg is known to be less than twice the length, so the target only
+  /// has to wrap it once.  Targets without circular addressing reject these.
   ///
   struct AddrMode {
     GlobalValue *BaseGV;
     int64_t      BaseOffs;
     bool         HasBaseReg;
     int64_t      Scale;
-    AddrMode() : BaseGV(0), BaseOffs(0), HasBaseReg(false), Scale(0) {}
+    bool         IsCircular;
+    AddrMode() : BaseGV(0), BaseOffs(0), HasBaseReg(false), Scale(0),
+                 IsCircular(false) {}
   };
 
   /// isLegalAddressingMode - Return true if the addressing mode represented by
@@ -32,18 +32,21 @@ class User;
 class raw_ostream;
 
 /// ExtAddrMode - This is an extended version of TargetLowering::AddrMode
-/// which holds actual Value*'s for register values.
+/// which holds actual Value*'s for register values.  CircLength is the length
+/// of the circular buffer, in units of ScaledReg, if IsCircular is set.
 struct ExtAddrMode : public TargetLowering::AddrMode {
   Value *BaseReg;
   Value *ScaledReg;
-  ExtAddrMode() : BaseReg(0), ScaledReg(0) {}
+  Value *CircLength;
+  ExtAddrMode() : BaseReg(0), ScaledReg(0), CircLength(0) {}
   void print(raw_ostream &OS) const;
   void dump() const;
   
   bool operator==(const ExtAddrMode& O) const {
     return (BaseReg == O.BaseReg) && (ScaledReg == O.ScaledReg) &&
            (BaseGV == O.BaseGV) && (BaseOffs == O.BaseOffs) &&
-           (HasBaseReg == O.HasBaseReg) && (Scale == O.Scale);
+           (HasBaseReg == O.HasBaseReg) && (Scale == O.Scale) &&
+           (IsCircular == O.IsCircular) && (CircLength == O.CircLength);
   }
 };
 
@@ -95,6 +98,7 @@ public:
   }
 private:
   bool MatchScaledValue(Value *ScaleReg, int64_t Scale, unsigned Depth);
+  bool MatchCircularIndex(Value *ScaleReg, int64_t Scale);
   bool MatchAddr(Value *V, unsigned Depth);
   bool MatchOperationAddr(User *Operation, unsigned Opcode, unsigned Depth);
   bool IsProfitableToFoldIntoAddressingMode(Instruction *I,
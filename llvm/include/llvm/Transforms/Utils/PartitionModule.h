@@ -0,0 +1,47 @@
+//===- PartitionModule.h - Split a module for parallel codegen --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares PartitionModule, which spreads the definitions of a
+// module over several copies of it, so that the code for each copy can be
+// generated on its own and the object files linked together.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_UTILS_PARTITIONMODULE_H
+#define LLVM_TRANSFORMS_UTILS_PARTITIONMODULE_H
+
+#include <vector>
+
+namespace llvm {
+
+class Module;
+
+/// PartitionModule - Split the definitions of M into up to NumPartitions
+/// groups of about the same weight, and append to Partitions a copy of M for
+/// each group in which the definitions of the other groups are declarations.
+///
+/// An alias is defined with its aliasee, and a function whose blockaddress is
+/// taken with the users of the blockaddress.  The local functions and
+/// variables a definition uses are kept in its group, unless the group would
+/// get too heavy; locals still used from more than one partition become
+/// hidden globals with a new name ending in ".lto_part".  Appending variables
+/// such as llvm.global_ctors and the module asm only go to the first
+/// partition.
+///
+/// Groups are normally given to the lightest partition, heaviest first.  If
+/// Stable is true, the partition of a group only depends on the names of its
+/// definitions instead, so that it does not change when other code does.
+///
+/// M itself is left as it is; the caller owns the new modules.
+void PartitionModule(Module *M, unsigned NumPartitions, bool Stable,
+                     std::vector<Module*> &Partitions);
+
+} // End llvm namespace
+
+#endif
@@ -11,6 +11,7 @@
 #define LLVM_TYPE_H
 
 #include "llvm/AbstractTypeUser.h"
+#include "llvm/Support/Atomic.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/ADT/GraphTraits.h"
 #include <string>
@@ -100,9 +101,10 @@ private:
   /// RefCount - This counts the number of PATypeHolders that are pointing to
   /// this type.  When this number falls to zero, if the type is abstract and
   /// has no AbstractTypeUsers, the type is deleted.  This is only sensical for
-  /// derived types.
+  /// derived types.  It is changed atomically, since values of the type can be
+  /// created on several threads at once.
   ///
-  mutable unsigned RefCount;
+  mutable sys::cas_flag RefCount;
 
   /// Context - This refers to the LLVMContext in which this type was uniqued.
   LLVMContext &Context;
@@ -435,7 +437,7 @@ public:
 
   void addRef() const {
     assert(isAbstract() && "Cannot add a reference to a non-abstract type!");
-    ++RefCount;
+    sys::AtomicIncrement(&RefCount);
   }
 
   void dropRef() const {
@@ -444,7 +446,7 @@ public:
 
     // If this is the last PATypeHolder using this object, and there are no
     // PATypeHandles using it, the type is dead, delete it now.
-    if (--RefCount == 0 && AbstractTypeUsers.empty())
+    if (sys::AtomicDecrement(&RefCount) == 0 && AbstractTypeUsers.empty())
       this->destroy();
   }
   
@@ -65,9 +65,7 @@ private:
   Use(const Use &U);
 
   /// Destructor - Only for zap()
-  ~Use() {
-    if (Val) removeFromList();
-  }
+  ~Use();
 
   enum PrevPtrTag { zeroDigitTag
                   , oneDigitTag
@@ -115,6 +113,12 @@ public:
 private:
   const Use* getImpliedUser() const;
   static Use *initTags(Use *Start, Use *Stop);
+
+  /// setShared - Implement set() for a use of a value that can be used from
+  /// more than one function.  Those use lists are only changed under the lock
+  /// of the context, so that function passes can run on several functions at
+  /// once.
+  void setShared(Value *Val);
   
   Value *Val;
   Use *Next;
@@ -197,6 +197,13 @@ public:
   ///
   void addUse(Use &U) { U.addToList(&UseList); }
 
+  /// hasSharedUseList - Return true if this value can be used from more than
+  /// one function, like constants and globals can.  Instructions, arguments
+  /// and basic blocks are only used within their own function.
+  bool hasSharedUseList() const {
+    return SubclassID > BasicBlockVal && SubclassID < InstructionVal;
+  }
+
   /// An enumeration for keeping track of the concrete subclass of Value that
   /// is actually instantiated. Values of this enumeration are kept in the 
   /// Value classes SubclassID field. They are used for concrete type
@@ -321,6 +328,8 @@ inline raw_ostream &operator<<(raw_ostream &OS, const Value &V) {
 }
   
 void Use::set(Value *V) {
+  if ((Val && Val->hasSharedUseList()) || (V && V->hasSharedUseList()))
+    return setShared(V);
   if (Val) removeFromList();
   Val = V;
   if (V) V->addUse(*this);
@@ -462,13 +462,11 @@ namespace {
 
     virtual AliasResult alias(const Location &LocA,
                               const Location &LocB) {
-      assert(Visited.empty() && "Visited must be cleared after use!");
       assert(notDifferentParent(LocA.Ptr, LocB.Ptr) &&
              "BasicAliasAnalysis doesn't support interprocedural queries.");
-      AliasResult Alias = aliasCheck(LocA.Ptr, LocA.Size, LocA.TBAATag,
-                                     LocB.Ptr, LocB.Size, LocB.TBAATag);
-      Visited.clear();
-      return Alias;
+      VisitedSet Visited;
+      return aliasCheck(LocA.Ptr, LocA.Size, LocA.TBAATag,
+                        LocB.Ptr, LocB.Size, LocB.TBAATag, Visited);
     }
 
     virtual ModRefResult getModRefInfo(ImmutableCallSite CS,
@@ -503,33 +501,36 @@ namespace {
     }
     
   private:
-    // Visited - Track instructions visited by a aliasPHI, aliasSelect(), and aliasGEP().
-    SmallPtrSet<const Value*, 16> Visited;
+    // VisitedSet - Track instructions visited by a aliasPHI, aliasSelect(),
+    // and aliasGEP().  Each query has its own, so that queries from several
+    // threads at once share no state.
+    typedef SmallPtrSet<const Value*, 16> VisitedSet;
 
     // aliasGEP - Provide a bunch of ad-hoc rules to disambiguate a GEP
     // instruction against another.
     AliasResult aliasGEP(const GEPOperator *V1, uint64_t V1Size,
                          const Value *V2, uint64_t V2Size,
                          const MDNode *V2TBAAInfo,
-                         const Value *UnderlyingV1, const Value *UnderlyingV2);
+                         const Value *UnderlyingV1, const Value *UnderlyingV2,
+                         VisitedSet &Visited);
 
     // aliasPHI - Provide a bunch of ad-hoc rules to disambiguate a PHI
     // instruction against another.
     AliasResult aliasPHI(const PHINode *PN, uint64_t PNSize,
                          const MDNode *PNTBAAInfo,
                          const Value *V2, uint64_t V2Size,
-                         const MDNode *V2TBAAInfo);
+                         const MDNode *V2TBAAInfo, VisitedSet &Visited);
 
     /// aliasSelect - Disambiguate a Select instruction against another value.
     AliasResult aliasSelect(const SelectInst *SI, uint64_t SISize,
                             const MDNode *SITBAAInfo,
                             const Value *V2, uint64_t V2Size,
-                            const MDNode *V2TBAAInfo);
+                            const MDNode *V2TBAAInfo, VisitedSet &Visited);
 
     AliasResult aliasCheck(const Value *V1, uint64_t V1Size,
                            const MDNode *V1TBAATag,
                            const Value *V2, uint64_t V2Size,
-                           const MDNode *V2TBAATag);
+                           const MDNode *V2TBAATag, VisitedSet &Visited);
   };
 }  // End of anonymous namespace
 
@@ -548,17 +549,14 @@ ImmutablePass *llvm::createBasicAliasAnalysisPass() {
 /// considered local to all functions.
 bool
 BasicAliasAnalysis::pointsToConstantMemory(const Location &Loc, bool OrLocal) {
-  assert(Visited.empty() && "Visited must be cleared after use!");
-
+  SmallPtrSet<const Value *, 16> Visited;
   unsigned MaxLookup = 8;
   SmallVector<const Value *, 16> Worklist;
   Worklist.push_back(Loc.Ptr);
   do {
     const Value *V = GetUnderlyingObject(Worklist.pop_back_val(), TD);
-    if (!Visited.insert(V)) {
-      Visited.clear();
+    if (!Visited.insert(V))
       return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
-    }
 
     // An alloca instruction defines local memory.
     if (OrLocal && isa<AllocaInst>(V))
@@ -569,10 +567,8 @@ BasicAliasAnalysis::pointsToConstantMemory(const Location &Loc, bool OrLocal) {
       // Note: this doesn't require GV to be "ODR" because it isn't legal for a
       // global to be marked constant in some modules and non-constant in
       // others.  GV may even be a declaration, not a definition.
-      if (!GV->isConstant()) {
-        Visited.clear();
+      if (!GV->isConstant())
         return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
-      }
       continue;
     }
 
@@ -587,22 +583,18 @@ BasicAliasAnalysis::pointsToConstantMemory(const Location &Loc, bool OrLocal) {
     // the phi.
     if (const PHINode *PN = dyn_cast<PHINode>(V)) {
       // Don't bother inspecting phi nodes with many operands.
-      if (PN->getNumIncomingValues() > MaxLookup) {
-        Visited.clear();
+      if (PN->getNumIncomingValues() > MaxLookup)
         return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
-      }
       for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
         Worklist.push_back(PN->getIncomingValue(i));
       continue;
     }
 
     // Otherwise be conservative.
-    Visited.clear();
     return AliasAnalysis::pointsToConstantMemory(Loc, OrLocal);
 
   } while (!Worklist.empty() && --MaxLookup);
 
-  Visited.clear();
   return Worklist.empty();
 }
 
@@ -795,7 +787,8 @@ BasicAliasAnalysis::aliasGEP(const GEPOperator *GEP1, uint64_t V1Size,
                              const Value *V2, uint64_t V2Size,
                              const MDNode *V2TBAAInfo,
                              const Value *UnderlyingV1,
-                             const Value *UnderlyingV2) {
+                             const Value *UnderlyingV2,
+                             VisitedSet &Visited) {
   // If this GEP has been visited before, we're on a use-def cycle.
   // Such cycles are only valid when PHI nodes are involved or in unreachable
   // code. The visitPHI function catches cycles containing PHIs, but there
@@ -811,7 +804,7 @@ BasicAliasAnalysis::aliasGEP(const GEPOperator *GEP1, uint64_t V1Size,
   if (const GEPOperator *GEP2 = dyn_cast<GEPOperator>(V2)) {
     // Do the base pointers alias?
     AliasResult BaseAlias = aliasCheck(UnderlyingV1, UnknownSize, 0,
-                                       UnderlyingV2, UnknownSize, 0);
+                                       UnderlyingV2, UnknownSize, 0, Visited);
     
     // If we get a No or May, then return it immediately, no amount of analysis
     // will improve this situation.
@@ -852,7 +845,7 @@ BasicAliasAnalysis::aliasGEP(const GEPOperator *GEP1, uint64_t V1Size,
       return MayAlias;
 
     AliasResult R = aliasCheck(UnderlyingV1, UnknownSize, 0,
-                               V2, V2Size, V2TBAAInfo);
+                               V2, V2Size, V2TBAAInfo, Visited);
     if (R != MustAlias)
       // If V2 may alias GEP base pointer, conservatively returns MayAlias.
       // If V2 is known not to alias GEP base pointer, then the two values
@@ -929,7 +922,8 @@ AliasAnalysis::AliasResult
 BasicAliasAnalysis::aliasSelect(const SelectInst *SI, uint64_t SISize,
                                 const MDNode *SITBAAInfo,
                                 const Value *V2, uint64_t V2Size,
-                                const MDNode *V2TBAAInfo) {
+                                const MDNode *V2TBAAInfo,
+                                VisitedSet &Visited) {
   // If this select has been visited before, we're on a use-def cycle.
   // Such cycles are only valid when PHI nodes are involved or in unreachable
   // code. The visitPHI function catches cycles containing PHIs, but there
@@ -943,12 +937,12 @@ BasicAliasAnalysis::aliasSelect(const SelectInst *SI, uint64_t SISize,
     if (SI->getCondition() == SI2->getCondition()) {
       AliasResult Alias =
         aliasCheck(SI->getTrueValue(), SISize, SITBAAInfo,
-                   SI2->getTrueValue(), V2Size, V2TBAAInfo);
+                   SI2->getTrueValue(), V2Size, V2TBAAInfo, Visited);
       if (Alias == MayAlias)
         return MayAlias;
       AliasResult ThisAlias =
         aliasCheck(SI->getFalseValue(), SISize, SITBAAInfo,
-                   SI2->getFalseValue(), V2Size, V2TBAAInfo);
+                   SI2->getFalseValue(), V2Size, V2TBAAInfo, Visited);
       if (ThisAlias != Alias)
         return MayAlias;
       return Alias;
@@ -957,7 +951,8 @@ BasicAliasAnalysis::aliasSelect(const SelectInst *SI, uint64_t SISize,
   // If both arms of the Select node NoAlias or MustAlias V2, then returns
   // NoAlias / MustAlias. Otherwise, returns MayAlias.
   AliasResult Alias =
-    aliasCheck(V2, V2Size, V2TBAAInfo, SI->getTrueValue(), SISize, SITBAAInfo);
+    aliasCheck(V2, V2Size, V2TBAAInfo, SI->getTrueValue(), SISize, SITBAAInfo,
+               Visited);
   if (Alias == MayAlias)
     return MayAlias;
 
@@ -967,7 +962,8 @@ BasicAliasAnalysis::aliasSelect(const SelectInst *SI, uint64_t SISize,
   Visited.erase(V2);
 
   AliasResult ThisAlias =
-    aliasCheck(V2, V2Size, V2TBAAInfo, SI->getFalseValue(), SISize, SITBAAInfo);
+    aliasCheck(V2, V2Size, V2TBAAInfo, SI->getFalseValue(), SISize, SITBAAInfo,
+               Visited);
   if (ThisAlias != Alias)
     return MayAlias;
   return Alias;
@@ -979,7 +975,8 @@ AliasAnalysis::AliasResult
 BasicAliasAnalysis::aliasPHI(const PHINode *PN, uint64_t PNSize,
                              const MDNode *PNTBAAInfo,
                              const Value *V2, uint64_t V2Size,
-                             const MDNode *V2TBAAInfo) {
+                             const MDNode *V2TBAAInfo,
+                             VisitedSet &Visited) {
   // The PHI node has already been visited, avoid recursion any further.
   if (!Visited.insert(PN))
     return MayAlias;
@@ -992,14 +989,14 @@ BasicAliasAnalysis::aliasPHI(const PHINode *PN, uint64_t PNSize,
       AliasResult Alias =
         aliasCheck(PN->getIncomingValue(0), PNSize, PNTBAAInfo,
                    PN2->getIncomingValueForBlock(PN->getIncomingBlock(0)),
-                   V2Size, V2TBAAInfo);
+                   V2Size, V2TBAAInfo, Visited);
       if (Alias == MayAlias)
         return MayAlias;
       for (unsigned i = 1, e = PN->getNumIncomingValues(); i != e; ++i) {
         AliasResult ThisAlias =
           aliasCheck(PN->getIncomingValue(i), PNSize, PNTBAAInfo,
                      PN2->getIncomingValueForBlock(PN->getIncomingBlock(i)),
-                     V2Size, V2TBAAInfo);
+                     V2Size, V2TBAAInfo, Visited);
         if (ThisAlias != Alias)
           return MayAlias;
       }
@@ -1021,7 +1018,7 @@ BasicAliasAnalysis::aliasPHI(const PHINode *PN, uint64_t PNSize,
   }
 
   AliasResult Alias = aliasCheck(V2, V2Size, V2TBAAInfo,
-                                 V1Srcs[0], PNSize, PNTBAAInfo);
+                                 V1Srcs[0], PNSize, PNTBAAInfo, Visited);
   // Early exit if the check of the first PHI source against V2 is MayAlias.
   // Other results are not possible.
   if (Alias == MayAlias)
@@ -1038,7 +1035,7 @@ BasicAliasAnalysis::aliasPHI(const PHINode *PN, uint64_t PNSize,
     Visited.erase(V2);
 
     AliasResult ThisAlias = aliasCheck(V2, V2Size, V2TBAAInfo,
-                                       V, PNSize, PNTBAAInfo);
+                                       V, PNSize, PNTBAAInfo, Visited);
     if (ThisAlias != Alias || ThisAlias == MayAlias)
       return MayAlias;
   }
@@ -1053,7 +1050,8 @@ AliasAnalysis::AliasResult
 BasicAliasAnalysis::aliasCheck(const Value *V1, uint64_t V1Size,
                                const MDNode *V1TBAAInfo,
                                const Value *V2, uint64_t V2Size,
-                               const MDNode *V2TBAAInfo) {
+                               const MDNode *V2TBAAInfo,
+                               VisitedSet &Visited) {
   // If either of the memory references is empty, it doesn't matter what the
   // pointer values are.
   if (V1Size == 0 || V2Size == 0)
@@ -1133,7 +1131,8 @@ BasicAliasAnalysis::aliasCheck(const Value *V1, uint64_t V1Size,
     std::swap(O1, O2);
   }
   if (const GEPOperator *GV1 = dyn_cast<GEPOperator>(V1)) {
-    AliasResult Result = aliasGEP(GV1, V1Size, V2, V2Size, V2TBAAInfo, O1, O2);
+    AliasResult Result = aliasGEP(GV1, V1Size, V2, V2Size, V2TBAAInfo, O1, O2,
+                                  Visited);
     if (Result != MayAlias) return Result;
   }
 
@@ -1143,7 +1142,7 @@ BasicAliasAnalysis::aliasCheck(const Value *V1, uint64_t V1Size,
   }
   if (const PHINode *PN = dyn_cast<PHINode>(V1)) {
     AliasResult Result = aliasPHI(PN, V1Size, V1TBAAInfo,
-                                  V2, V2Size, V2TBAAInfo);
+                                  V2, V2Size, V2TBAAInfo, Visited);
     if (Result != MayAlias) return Result;
   }
 
@@ -1153,7 +1152,7 @@ BasicAliasAnalysis::aliasCheck(const Value *V1, uint64_t V1Size,
   }
   if (const SelectInst *S1 = dyn_cast<SelectInst>(V1)) {
     AliasResult Result = aliasSelect(S1, V1Size, V1TBAAInfo,
-                                     V2, V2Size, V2TBAAInfo);
+                                     V2, V2Size, V2TBAAInfo, Visited);
     if (Result != MayAlias) return Result;
   }
 
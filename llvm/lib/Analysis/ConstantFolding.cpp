@@ -1053,6 +1053,9 @@ llvm::canConstantFoldCallTo(const Function *F) {
   case Intrinsic::sadd_with_overflow:
   case Intrinsic::ssub_with_overflow:
   case Intrinsic::smul_with_overflow:
+  case Intrinsic::sadd_sat:
+  case Intrinsic::ssub_sat:
+  case Intrinsic::smul_fix_sat:
   case Intrinsic::convert_from_fp16:
   case Intrinsic::convert_to_fp16:
   case Intrinsic::x86_sse_cvtss2si:
@@ -1389,6 +1392,23 @@ llvm::ConstantFoldCall(Function *F,
           };
           return ConstantStruct::get(F->getContext(), Ops, 2, false);
         }
+        case Intrinsic::sadd_sat:
+        case Intrinsic::ssub_sat: {
+          // Both operands of an overflowing add have the sign of the first
+          // one, as does the first operand of an overflowing subtract, so
+          // it picks the bound to clamp to.
+          bool Overflow;
+          APInt Res = F->getIntrinsicID() == Intrinsic::sadd_sat ?
+            Op1->getValue().sadd_ov(Op2->getValue(), Overflow) :
+            Op1->getValue().ssub_ov(Op2->getValue(), Overflow);
+          if (Overflow) {
+            unsigned BitWidth = Res.getBitWidth();
+            Res = Op1->getValue().isNegative() ?
+                    APInt::getSignedMinValue(BitWidth) :
+                    APInt::getSignedMaxValue(BitWidth);
+          }
+          return ConstantInt::get(F->getContext(), Res);
+        }
         }
       }
       
@@ -1396,5 +1416,29 @@ llvm::ConstantFoldCall(Function *F,
     }
     return 0;
   }
+
+  if (NumOperands == 3) {
+    if (F->getIntrinsicID() != Intrinsic::smul_fix_sat)
+      return 0;
+    ConstantInt *Op1 = dyn_cast<ConstantInt>(Operands[0]);
+    ConstantInt *Op2 = dyn_cast<ConstantInt>(Operands[1]);
+    ConstantInt *Op3 = dyn_cast<ConstantInt>(Operands[2]);
+    if (!Op1 || !Op2 || !Op3)
+      return 0;
+    unsigned BitWidth = Op1->getBitWidth();
+    if (Op3->getValue().uge(BitWidth))
+      return 0;
+
+    // The full product of two N-bit values fits in 2N bits.
+    APInt Res = Op1->getValue().sext(2 * BitWidth) *
+                Op2->getValue().sext(2 * BitWidth);
+    Res = Res.ashr(Op3->getZExtValue());
+    if (Res.isSignedIntN(BitWidth))
+      Res = Res.trunc(BitWidth);
+    else
+      Res = Res.isNegative() ? APInt::getSignedMinValue(BitWidth) :
+                               APInt::getSignedMaxValue(BitWidth);
+    return ConstantInt::get(F->getContext(), Res);
+  }
   return 0;
 }
@@ -117,7 +117,11 @@ bool CGPassManager::RunPassOnSCC(Pass *P, CallGraphSCC &CurSCC,
     }
 
     {
+      // The SCC is named after its first function for -profile-passes.
+      Function *F = (*CurSCC.begin())->getFunction();
       TimeRegion PassTimer(getPassTimer(CGSP));
+      PassProfileRegion PassProfile(CGSP, F ? F->getName()
+                                            : StringRef("<external node>"));
       Changed = CGSP->runOnSCC(CurSCC);
     }
     
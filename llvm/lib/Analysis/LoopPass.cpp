@@ -264,6 +264,8 @@ bool LPPassManager::runOnFunction(Function &F) {
       {
         PassManagerPrettyStackEntry X(P, *CurrentLoop->getHeader());
         TimeRegion PassTimer(getPassTimer(P));
+        PassProfileRegion PassProfile(P,
+                                      *CurrentLoop->getHeader()->getParent());
 
         Changed |= P->runOnLoop(CurrentLoop, *this);
       }
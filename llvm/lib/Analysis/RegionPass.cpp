@@ -93,6 +93,8 @@ bool RGPassManager::runOnFunction(Function &F) {
         PassManagerPrettyStackEntry X(P, *CurrentRegion->getEntry());
 
         TimeRegion PassTimer(getPassTimer(P));
+        PassProfileRegion PassProfile(P,
+                                      *CurrentRegion->getEntry()->getParent());
         Changed |= P->runOnRegion(CurrentRegion, *this);
       }
 
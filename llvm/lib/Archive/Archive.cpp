@@ -90,7 +90,8 @@ bool ArchiveMember::replaceWith(const sys::Path& newFile, std::string* ErrMsg) {
     flags &= ~BSD4SymbolTableFlag;
 
   // LLVM symbol tables have a very specific name
-  if (path.str() == ARFILE_LLVM_SYMTAB_NAME)
+  if (path.str() == ARFILE_LLVM_SYMTAB_NAME ||
+      path.str() == ARFILE_LLVM_SYMIDX_NAME)
     flags |= LLVMSymbolTableFlag;
   else
     flags &= ~LLVMSymbolTableFlag;
@@ -143,8 +144,9 @@ bool ArchiveMember::replaceWith(const sys::Path& newFile, std::string* ErrMsg) {
 // Archive class. Everything else (default,copy) is deprecated. This just
 // initializes and maps the file into memory, if requested.
 Archive::Archive(const sys::Path& filename, LLVMContext& C)
-  : archPath(filename), members(), mapfile(0), base(0), symTab(), strtab(),
-    symTabSize(0), firstFileOffset(0), modules(), foreignST(0), Context(C) {
+  : archPath(filename), members(), mapfile(0), base(0), symTab(),
+    symIndex(0), strtab(), symTabSize(0), firstFileOffset(0), modules(),
+    foreignST(0), Context(C) {
 }
 
 bool
@@ -168,6 +170,7 @@ void Archive::cleanUpMemory() {
 
   // Forget the entire symbol table
   symTab.clear();
+  symIndex = 0;
   symTabSize = 0;
 
   firstFileOffset = 0;
@@ -200,9 +203,10 @@ static void getSymbols(Module*M, std::vector<std::string>& symbols) {
       if (!GI->getName().empty())
         symbols.push_back(GI->getName());
 
-  // Loop over functions
+  // Loop over functions, the ones whose bodies are not read yet are defined
   for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI)
-    if (!FI->isDeclaration() && !FI->hasLocalLinkage())
+    if ((!FI->isDeclaration() || FI->isMaterializable()) &&
+        !FI->hasLocalLinkage())
       if (!FI->getName().empty())
         symbols.push_back(FI->getName());
 
@@ -226,9 +230,11 @@ bool llvm::GetBitcodeSymbols(const sys::Path& fName,
     return true;
   }
 
-  Module *M = ParseBitcodeFile(Buffer.get(), Context, ErrMsg);
+  // The symbols are all in the header of the module.
+  Module *M = getLazyBitcodeModule(Buffer.get(), Context, ErrMsg);
   if (!M)
     return true;
+  Buffer.take();
 
   // Get the symbols
   getSymbols(M, symbols);
@@ -248,9 +254,12 @@ llvm::GetBitcodeSymbols(const char *BufPtr, unsigned Length,
   OwningPtr<MemoryBuffer> Buffer(
     MemoryBuffer::getMemBufferCopy(StringRef(BufPtr, Length),ModuleID.c_str()));
 
-  Module *M = ParseBitcodeFile(Buffer.get(), Context, ErrMsg);
+  // The symbols are all in the header of the module, the function bodies are
+  // read when the module is linked in.
+  Module *M = getLazyBitcodeModule(Buffer.get(), Context, ErrMsg);
   if (!M)
     return 0;
+  Buffer.take();
 
   // Get the symbols
   getSymbols(M, symbols);
@@ -24,6 +24,7 @@
 #define ARFILE_MAGIC_LEN (sizeof(ARFILE_MAGIC)-1)  ///< length of magic string
 #define ARFILE_SVR4_SYMTAB_NAME "/               " ///< SVR4 symtab entry name
 #define ARFILE_LLVM_SYMTAB_NAME "#_LLVM_SYM_TAB_#" ///< LLVM symtab entry name
+#define ARFILE_LLVM_SYMIDX_NAME "#_LLVM_SYM_IDX_#" ///< LLVM hashed symtab name
 #define ARFILE_BSD4_SYMTAB_NAME "__.SYMDEF SORTED" ///< BSD4 symtab entry name
 #define ARFILE_STRTAB_NAME      "//              " ///< Name of string table
 #define ARFILE_PAD "\n"                            ///< inter-file align padding
@@ -71,6 +72,35 @@ namespace llvm {
     }
   };
   
+  /// The hashed LLVM symbol index is made of little endian 32-bit words so
+  /// that it can be searched in place in the mapped archive file:
+  ///
+  ///   NumBuckets, NumSymbols, StringsSize
+  ///   NumBuckets buckets: index of a symbol plus one, or 0 if empty
+  ///   NumSymbols symbols: hash, name offset, name length, member offset
+  ///   StringsSize bytes of symbol names
+  ///
+  /// NumBuckets is a power of two larger than NumSymbols. A symbol goes in
+  /// the first empty bucket at or after its hash modulo NumBuckets. The
+  /// member offsets are relative to the first file after the symbol tables,
+  /// like those of the older "#_LLVM_SYM_TAB_#" table.
+  enum {
+    SymIndexHeaderSize = 12,
+    SymIndexBucketSize = 4,
+    SymIndexEntrySize = 16
+  };
+
+  /// Hash a symbol name for the hashed symbol index. This is the 32-bit FNV-1a
+  /// hash, it is part of the file format and must not change.
+  inline unsigned HashArchiveSymbol(const char *Name, unsigned Length) {
+    unsigned Hash = 2166136261U;
+    for (unsigned i = 0; i != Length; ++i) {
+      Hash ^= (unsigned char)Name[i];
+      Hash *= 16777619U;
+    }
+    return Hash;
+  }
+
   // Get just the externally visible defined symbols from the bitcode
   bool GetBitcodeSymbols(const sys::Path& fName,
                           LLVMContext& Context,
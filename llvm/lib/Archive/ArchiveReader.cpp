@@ -13,6 +13,7 @@
 
 #include "ArchiveInternals.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Module.h"
 #include <cstdlib>
@@ -64,6 +65,101 @@ Archive::parseSymbolTable(const void* data, unsigned size, std::string* error) {
   return true;
 }
 
+/// Read a little endian 32-bit word of the hashed symbol index
+static inline unsigned readWord(const char* At) {
+  const unsigned char* P = (const unsigned char*) At;
+  return P[0] | (P[1] << 8) | (P[2] << 16) | ((unsigned)P[3] << 24);
+}
+
+// Check the layout of the hashed symbol index and remember where it is. The
+// symbols themselves are only looked at by lookupSymbolIndex.
+bool
+Archive::parseSymbolIndex(const void* data, unsigned size, std::string* error) {
+  const char* At = (const char*) data;
+  if (size < SymIndexHeaderSize) {
+    if (error)
+      *error = "Symbol index is too small for its header";
+    return false;
+  }
+  unsigned NumBuckets = readWord(At);
+  unsigned NumSymbols = readWord(At + 4);
+  unsigned StringsSize = readWord(At + 8);
+  if (!isPowerOf2_32(NumBuckets) || NumSymbols >= NumBuckets) {
+    if (error)
+      *error = "Malformed symbol index: invalid number of buckets";
+    return false;
+  }
+  uint64_t Expected = SymIndexHeaderSize +
+    uint64_t(NumBuckets) * SymIndexBucketSize +
+    uint64_t(NumSymbols) * SymIndexEntrySize + StringsSize;
+  if (Expected != size) {
+    if (error)
+      *error = "Malformed symbol index: sizes not consistent with length";
+    return false;
+  }
+  // An empty index is as good as no index at all.
+  symIndex = NumSymbols ? At : 0;
+  symTabSize = size;
+  return true;
+}
+
+// Look the symbol up in the hashed symbol index, reading it in place.
+bool
+Archive::lookupSymbolIndex(const std::string& symbol, unsigned& offset) const {
+  unsigned NumBuckets = readWord(symIndex);
+  unsigned NumSymbols = readWord(symIndex + 4);
+  unsigned StringsSize = readWord(symIndex + 8);
+  const char* Buckets = symIndex + SymIndexHeaderSize;
+  const char* Entries = Buckets + NumBuckets * SymIndexBucketSize;
+  const char* Strings = Entries + NumSymbols * SymIndexEntrySize;
+
+  unsigned Hash = HashArchiveSymbol(symbol.data(), symbol.length());
+  unsigned Bucket = Hash & (NumBuckets - 1);
+  for (unsigned Probes = 0; Probes != NumBuckets; ++Probes) {
+    unsigned Index = readWord(Buckets + Bucket * SymIndexBucketSize);
+    if (Index == 0 || Index > NumSymbols)
+      return false;
+    const char* Entry = Entries + (Index - 1) * SymIndexEntrySize;
+    if (readWord(Entry) == Hash) {
+      unsigned NameOffset = readWord(Entry + 4);
+      unsigned NameLength = readWord(Entry + 8);
+      if (NameOffset <= StringsSize && NameLength <= StringsSize - NameOffset &&
+          NameLength == symbol.length() &&
+          0 == memcmp(Strings + NameOffset, symbol.data(), NameLength)) {
+        offset = readWord(Entry + 12);
+        return true;
+      }
+    }
+    Bucket = (Bucket + 1) & (NumBuckets - 1);
+  }
+  return false;
+}
+
+// Get the symbol table, building the map from the hashed index if that is
+// what the archive has.
+const Archive::SymTabType&
+Archive::getSymbolTable() {
+  if (symIndex && symTab.empty()) {
+    unsigned NumBuckets = readWord(symIndex);
+    unsigned NumSymbols = readWord(symIndex + 4);
+    unsigned StringsSize = readWord(symIndex + 8);
+    const char* Entries =
+      symIndex + SymIndexHeaderSize + NumBuckets * SymIndexBucketSize;
+    const char* Strings = Entries + NumSymbols * SymIndexEntrySize;
+    for (unsigned i = 0; i != NumSymbols; ++i) {
+      const char* Entry = Entries + i * SymIndexEntrySize;
+      unsigned NameOffset = readWord(Entry + 4);
+      unsigned NameLength = readWord(Entry + 8);
+      if (NameOffset > StringsSize || NameLength > StringsSize - NameOffset)
+        continue;
+      symTab.insert(std::make_pair(std::string(Strings + NameOffset,
+                                               NameLength),
+                                   readWord(Entry + 12)));
+    }
+  }
+  return symTab;
+}
+
 // This member parses an ArchiveMemberHeader that is presumed to be pointed to
 // by At. The At pointer is updated to the byte just after the header, which
 // can be variable in size.
@@ -130,6 +226,10 @@ Archive::parseMemberHeader(const char*& At, const char* End, std::string* error)
             *error = "invalid long filename";
           return 0;
         }
+      } else if (Hdr->name[1] == '_' &&
+                 (0 == memcmp(Hdr->name, ARFILE_LLVM_SYMIDX_NAME, 16))) {
+        pathname.assign(ARFILE_LLVM_SYMIDX_NAME);
+        flags |= ArchiveMember::LLVMSymbolTableFlag;
       } else if (Hdr->name[1] == '_' &&
                  (0 == memcmp(Hdr->name, ARFILE_LLVM_SYMTAB_NAME, 16))) {
         // The member is using a long file name (>15 chars) format.
@@ -255,6 +355,7 @@ Archive::loadArchive(std::string* error) {
   // Set up parsing
   members.clear();
   symTab.clear();
+  symIndex = 0;
   const char *At = base;
   const char *End = mapfile->getBufferEnd();
 
@@ -303,7 +404,10 @@ Archive::loadArchive(std::string* error) {
           *error = "invalid archive: multiple symbol tables";
         return false;
       }
-      if (!parseSymbolTable(mbr->getData(), mbr->getSize(), error))
+      if (mbr->getPath().str() == ARFILE_LLVM_SYMIDX_NAME) {
+        if (!parseSymbolIndex(mbr->getData(), mbr->getSize(), error))
+          return false;
+      } else if (!parseSymbolTable(mbr->getData(), mbr->getSize(), error))
         return false;
       seenSymbolTable = true;
       At += mbr->getSize();
@@ -369,6 +473,7 @@ Archive::loadSymbolTable(std::string* ErrorMsg) {
   // Set up parsing
   members.clear();
   symTab.clear();
+  symIndex = 0;
   const char *At = base;
   const char *End = mapfile->getBufferEnd();
 
@@ -418,7 +523,10 @@ Archive::loadSymbolTable(std::string* ErrorMsg) {
 
   // See if its the symbol table
   if (mbr->isLLVMSymbolTable()) {
-    if (!parseSymbolTable(mbr->getData(), mbr->getSize(), ErrorMsg)) {
+    bool Parsed = mbr->getPath().str() == ARFILE_LLVM_SYMIDX_NAME ?
+      parseSymbolIndex(mbr->getData(), mbr->getSize(), ErrorMsg) :
+      parseSymbolTable(mbr->getData(), mbr->getSize(), ErrorMsg);
+    if (!Parsed) {
       delete mbr;
       return false;
     }
@@ -458,9 +566,16 @@ Archive* Archive::OpenAndLoadSymbols(const sys::Path& file,
 Module*
 Archive::findModuleDefiningSymbol(const std::string& symbol, 
                                   std::string* ErrMsg) {
-  SymTabType::iterator SI = symTab.find(symbol);
-  if (SI == symTab.end())
-    return 0;
+  unsigned symOffset;
+  if (symIndex) {
+    if (!lookupSymbolIndex(symbol, symOffset))
+      return 0;
+  } else {
+    SymTabType::iterator SI = symTab.find(symbol);
+    if (SI == symTab.end())
+      return 0;
+    symOffset = SI->second;
+  }
 
   // The symbol table was previously constructed assuming that the members were
   // written without the symbol table header. Because VBR encoding is used, the
@@ -469,7 +584,7 @@ Archive::findModuleDefiningSymbol(const std::string& symbol,
   // We now have to account for this by adjusting the offset by the size of the
   // symbol table and its header.
   unsigned fileOffset =
-    SI->second +                // offset in symbol-table-less file
+    symOffset +                 // offset in symbol-table-less file
     firstFileOffset;            // add offset to first "real" file in archive
 
   // See if the module is already loaded
@@ -512,7 +627,7 @@ Archive::findModulesDefiningSymbols(std::set<std::string>& symbols,
     return false;
   }
 
-  if (symTab.empty()) {
+  if (!symIndex && symTab.empty()) {
     // We don't have a symbol table, so we must build it now but lets also
     // make sure that we populate the modules table as we do this to ensure
     // that we don't load them twice when findModuleDefiningSymbol is called
@@ -591,13 +706,13 @@ Archive::findModulesDefiningSymbols(std::set<std::string>& symbols,
 bool Archive::isBitcodeArchive() {
   // Make sure the symTab has been loaded. In most cases this should have been
   // done when the archive was constructed, but still,  this is just in case.
-  if (symTab.empty())
+  if (!symIndex && symTab.empty())
     if (!loadSymbolTable(0))
       return false;
 
   // Now that we know it's been loaded, return true
   // if it has a size
-  if (symTab.size()) return true;
+  if (symIndex || symTab.size()) return true;
 
   // We still can't be sure it isn't a bitcode archive
   if (!loadArchive(0))
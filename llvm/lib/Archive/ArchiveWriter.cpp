@@ -16,6 +16,7 @@
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
@@ -25,44 +26,12 @@
 #include <iomanip>
 using namespace llvm;
 
-// Write an integer using variable bit rate encoding. This saves a few bytes
-// per entry in the symbol table.
-static inline void writeInteger(unsigned num, std::ofstream& ARFile) {
-  while (1) {
-    if (num < 0x80) { // done?
-      ARFile << (unsigned char)num;
-      return;
-    }
-
-    // Nope, we are bigger than a character, output the next 7 bits and set the
-    // high bit to say that there is more coming...
-    ARFile << (unsigned char)(0x80 | ((unsigned char)num & 0x7F));
-    num >>= 7;  // Shift out 7 bits now...
-  }
-}
-
-// Compute how many bytes are taken by a given VBR encoded value. This is needed
-// to pre-compute the size of the symbol table.
-static inline unsigned numVbrBytes(unsigned num) {
-
-  // Note that the following nested ifs are somewhat equivalent to a binary
-  // search. We split it in half by comparing against 2^14 first. This allows
-  // most reasonable values to be done in 2 comparisons instead of 1 for
-  // small ones and four for large ones. We expect this to access file offsets
-  // in the 2^10 to 2^24 range and symbol lengths in the 2^0 to 2^8 range,
-  // so this approach is reasonable.
-  if (num < 1<<14) {
-    if (num < 1<<7)
-      return 1;
-    else
-      return 2;
-  }
-  if (num < 1<<21)
-    return 3;
-
-  if (num < 1<<28)
-    return 4;
-  return 5; // anything >= 2^28 takes 5 bytes
+// Append a little endian 32-bit word to the symbol index being built.
+static inline void writeWord(unsigned num, std::string& Out) {
+  Out += (char)(num & 0xFF);
+  Out += (char)((num >> 8) & 0xFF);
+  Out += (char)((num >> 16) & 0xFF);
+  Out += (char)((num >> 24) & 0xFF);
 }
 
 // Create an empty archive.
@@ -242,14 +211,7 @@ Archive::writeMember(
       for (std::vector<std::string>::iterator SI = symbols.begin(),
            SE = symbols.end(); SI != SE; ++SI) {
 
-        std::pair<SymTabType::iterator,bool> Res =
-          symTab.insert(std::make_pair(*SI,filepos));
-
-        if (Res.second) {
-          symTabSize += SI->length() +
-                        numVbrBytes(SI->length()) +
-                        numVbrBytes(filepos);
-        }
+        symTab.insert(std::make_pair(*SI,filepos));
       }
       // We don't need this module any more.
       delete M;
@@ -289,14 +251,48 @@ Archive::writeMember(
   return false;
 }
 
-// Write out the LLVM symbol table as an archive member to the file.
+// Write out the LLVM symbol table as an archive member to the file. The
+// table is written as a hashed index (see ArchiveInternals.h) so that readers
+// can look symbols up in the mapped file without building a map first.
 void
 Archive::writeSymbolTable(std::ofstream& ARFile) {
 
+  unsigned NumSymbols = symTab.size();
+  unsigned NumBuckets = (unsigned)NextPowerOf2(NumSymbols + NumSymbols / 3);
+
+  // Lay out the symbols, their names and the buckets that point at them.
+  std::vector<unsigned> Buckets(NumBuckets, 0);
+  std::string Entries, Strings;
+  unsigned Index = 0;
+  for (Archive::SymTabType::iterator I = symTab.begin(), E = symTab.end();
+       I != E; ++I, ++Index) {
+    unsigned Hash = HashArchiveSymbol(I->first.data(), I->first.length());
+    unsigned Bucket = Hash & (NumBuckets - 1);
+    while (Buckets[Bucket])
+      Bucket = (Bucket + 1) & (NumBuckets - 1);
+    Buckets[Bucket] = Index + 1;
+
+    writeWord(Hash, Entries);
+    writeWord(Strings.size(), Entries);
+    writeWord(I->first.length(), Entries);
+    writeWord(I->second, Entries);
+    Strings += I->first;
+  }
+
+  std::string Table;
+  writeWord(NumBuckets, Table);
+  writeWord(NumSymbols, Table);
+  writeWord(Strings.size(), Table);
+  for (unsigned i = 0; i != NumBuckets; ++i)
+    writeWord(Buckets[i], Table);
+  Table += Entries;
+  Table += Strings;
+  symTabSize = Table.size();
+
   // Construct the symbol table's header
   ArchiveMemberHeader Hdr;
   Hdr.init();
-  memcpy(Hdr.name,ARFILE_LLVM_SYMTAB_NAME,16);
+  memcpy(Hdr.name,ARFILE_LLVM_SYMIDX_NAME,16);
   uint64_t secondsSinceEpoch = sys::TimeValue::now().toEpochTime();
   char buffer[32];
   sprintf(buffer, "%-8o", 0644);
@@ -310,34 +306,9 @@ Archive::writeSymbolTable(std::ofstream& ARFile) {
   sprintf(buffer,"%-10u",symTabSize);
   memcpy(Hdr.size,buffer,10);
 
-  // Write the header
+  // Write the header and the table
   ARFile.write((char*)&Hdr, sizeof(Hdr));
-
-#ifndef NDEBUG
-  // Save the starting position of the symbol tables data content.
-  unsigned startpos = ARFile.tellp();
-#endif
-
-  // Write out the symbols sequentially
-  for ( Archive::SymTabType::iterator I = symTab.begin(), E = symTab.end();
-        I != E; ++I)
-  {
-    // Write out the file index
-    writeInteger(I->second, ARFile);
-    // Write out the length of the symbol
-    writeInteger(I->first.length(), ARFile);
-    // Write out the symbol
-    ARFile.write(I->first.data(), I->first.length());
-  }
-
-#ifndef NDEBUG
-  // Now that we're done with the symbol table, get the ending file position
-  unsigned endpos = ARFile.tellp();
-#endif
-
-  // Make sure that the amount we wrote is what we pre-computed. This is
-  // critical for file integrity purposes.
-  assert(endpos - startpos == symTabSize && "Invalid symTabSize computation");
+  ARFile.write(Table.data(), Table.size());
 
   // Make sure the symbol table is even sized
   if (symTabSize % 2 != 0 )
@@ -22,11 +22,35 @@
 #include "llvm/AutoUpgrade.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/OperandTraits.h"
+#include <algorithm>
 using namespace llvm;
 
+static cl::opt<unsigned>
+ReaderThreads("bitcode-reader-threads",
+              cl::desc("Number of threads to read function bodies on when "
+                       "a whole module is read"),
+              cl::init(0));
+
+BitcodeReader::BitcodeReader(BitcodeReader &P)
+  : Context(P.Context), Parent(&P), TheModule(P.TheModule), Buffer(P.Buffer),
+    BufferOwned(false), ErrorString(0), TypeList(P.TypeList),
+    ValueList(P.Context), MDValueList(P.Context), MAttributes(P.MAttributes),
+    MDKindMap(P.MDKindMap), HasReversedFunctionsWithBodies(true), Summary(0),
+    LLVM2_7MetadataDetected(P.LLVM2_7MetadataDetected) {
+  // Read from the stream of the parent, the abbreviations in its block info
+  // block apply to the function blocks too.
+  Stream.init(P.StreamFile);
+  for (unsigned i = 0, e = P.ValueList.size(); i != e; ++i)
+    ValueList.push_back(P.ValueList[i]);
+  for (unsigned i = 0, e = P.MDValueList.size(); i != e; ++i)
+    MDValueList.push_back(P.MDValueList[i]);
+}
+
 void BitcodeReader::FreeState() {
   if (BufferOwned)
     delete Buffer;
@@ -1228,12 +1252,28 @@ bool BitcodeReader::ParseConstants() {
       Function *Fn =
         dyn_cast_or_null<Function>(ValueList.getConstantFwdRef(Record[1],FnTy));
       if (Fn == 0) return Error("Invalid CE_BLOCKADDRESS record");
-      
+
+      // If the body of the function was already read, take the address of
+      // the block right away.  A worker cannot tell, the body may be read on
+      // another thread just now.
+      if (!Parent && !Fn->isDeclaration()) {
+        Function::iterator BB = Fn->begin(), BBE = Fn->end();
+        for (uint64_t BlockIdx = Record[2]; BlockIdx && BB != BBE; --BlockIdx)
+          ++BB;
+        if (BB == BBE)
+          return Error("Invalid blockaddress block #");
+        V = BlockAddress::get(Fn, BB);
+        break;
+      }
+
+      // Workers add to the forward references of the reader they work for.
+      BitcodeReader &Owner = Parent ? *Parent : *this;
+      sys::SmartScopedLock<true> Guard(Owner.FwdRefLock);
       GlobalVariable *FwdRef = new GlobalVariable(*Fn->getParent(),
                                                   Type::getInt8Ty(Context),
                                             false, GlobalValue::InternalLinkage,
                                                   0, "");
-      BlockAddrFwdRefs[Fn].push_back(std::make_pair(Record[2], FwdRef));
+      Owner.BlockAddrFwdRefs[Fn].push_back(std::make_pair(Record[2], FwdRef));
       V = FwdRef;
       break;
     }  
@@ -1255,6 +1295,76 @@ bool BitcodeReader::ParseConstants() {
   return false;
 }
 
+/// ParseSummary - Read what the summary block says about the function bodies
+/// into Summary.
+bool BitcodeReader::ParseSummary() {
+  if (Stream.EnterSubBlock(bitc::SUMMARY_BLOCK_ID))
+    return Error("Malformed block record");
+
+  SmallVector<uint64_t, 64> Record;
+
+  // Read all the records.
+  while (1) {
+    unsigned Code = Stream.ReadCode();
+    if (Code == bitc::END_BLOCK) {
+      if (Stream.ReadBlockEnd())
+        return Error("Error at end of SUMMARY block");
+      return false;
+    }
+
+    if (Code == bitc::ENTER_SUBBLOCK) {
+      // No known subblocks, always skip them.
+      Stream.ReadSubBlockID();
+      if (Stream.SkipBlock())
+        return Error("Malformed block record");
+      continue;
+    }
+
+    if (Code == bitc::DEFINE_ABBREV) {
+      Stream.ReadAbbrevRecord();
+      continue;
+    }
+
+    // Read a record.
+    Record.clear();
+    switch (Stream.ReadRecord(Code, Record)) {
+    default:  // Default behavior: ignore.
+      break;
+    case bitc::SUMMARY_CODE_FUNCTION: {
+      // FUNCTION: [valueid, numblocks, numinsts, numcalls, callee valueid x N,
+      //            ref valueid x N]
+      if (Record.size() < 4 || Record.size() - 4 < Record[3])
+        return Error("Invalid FUNCTION summary record");
+
+      // The summary only refers to globals, which are all known by now.
+      Function *F = 0;
+      if (Record[0] < ValueList.size())
+        F = dyn_cast_or_null<Function>(ValueList[Record[0]]);
+      if (F == 0)
+        return Error("Invalid FUNCTION summary record");
+
+      BitcodeFunctionSummary &FS = (*Summary)[F];
+      FS.NumBlocks = Record[1];
+      FS.NumInstructions = Record[2];
+      FS.Calls.clear();
+      FS.Refs.clear();
+      for (unsigned i = 4, e = Record.size(); i != e; ++i) {
+        GlobalValue *GV = 0;
+        if (Record[i] < ValueList.size())
+          GV = dyn_cast_or_null<GlobalValue>(ValueList[Record[i]]);
+        if (GV == 0)
+          return Error("Invalid FUNCTION summary record");
+        if (i < 4 + Record[3])
+          FS.Calls.push_back(GV);
+        else
+          FS.Refs.push_back(GV);
+      }
+      break;
+    }
+    }
+  }
+}
+
 /// RememberAndSkipFunctionBody - When we see the block for a function body,
 /// remember where it is and then skip it.  This lets us lazily deserialize the
 /// functions.
@@ -1354,6 +1464,13 @@ bool BitcodeReader::ParseModule() {
         if (ParseMetadata())
           return true;
         break;
+      case bitc::SUMMARY_BLOCK_ID:
+        if (!Summary) {
+          if (Stream.SkipBlock())
+            return Error("Malformed block record");
+        } else if (ParseSummary())
+          return true;
+        break;
       case bitc::FUNCTION_BLOCK_ID:
         // If this is the first function body we've seen, reverse the
         // FunctionsWithBodies list.
@@ -1617,7 +1734,9 @@ bool BitcodeReader::ParseBitcodeInto(Module *M) {
     }
   }
 
-  return false;
+  // Blockaddresses in the initializers of globals point into bodies that are
+  // still in the file; read those bodies right away.
+  return MaterializeBlockAddrTargets(0);
 }
 
 bool BitcodeReader::ParseModuleTriple(std::string &Triple) {
@@ -2490,24 +2609,11 @@ bool BitcodeReader::ParseFunctionBody(Function *F) {
   // and clean up leaks.
 
   // See if anything took the address of blocks in this function.  If so,
-  // resolve them now.
-  DenseMap<Function*, std::vector<BlockAddrRefTy> >::iterator BAFRI =
-    BlockAddrFwdRefs.find(F);
-  if (BAFRI != BlockAddrFwdRefs.end()) {
-    std::vector<BlockAddrRefTy> &RefList = BAFRI->second;
-    for (unsigned i = 0, e = RefList.size(); i != e; ++i) {
-      unsigned BlockIdx = RefList[i].first;
-      if (BlockIdx >= FunctionBBs.size())
-        return Error("Invalid blockaddress block #");
-    
-      GlobalVariable *FwdRef = RefList[i].second;
-      FwdRef->replaceAllUsesWith(BlockAddress::get(F, FunctionBBs[BlockIdx]));
-      FwdRef->eraseFromParent();
-    }
-    
-    BlockAddrFwdRefs.erase(BAFRI);
-  }
-  
+  // resolve them now.  A worker leaves this to the reader it works for, as a
+  // function read on another thread can still refer to the blocks.
+  if (!Parent && ResolveBlockAddrFwdRefs(F, FunctionBBs))
+    return true;
+
   // FIXME: Remove this in LLVM 3.0.
   unsigned NewMDValueListSize = MDValueList.size();
 
@@ -2528,6 +2634,159 @@ bool BitcodeReader::ParseFunctionBody(Function *F) {
   return false;
 }
 
+/// ResolveBlockAddrFwdRefs - Replace the forward references to the addresses
+/// of blocks in F, whose blocks are BBs in the order of the bitcode file.
+bool BitcodeReader::ResolveBlockAddrFwdRefs(Function *F,
+                                      const std::vector<BasicBlock*> &BBs) {
+  DenseMap<Function*, std::vector<BlockAddrRefTy> >::iterator BAFRI =
+    BlockAddrFwdRefs.find(F);
+  if (BAFRI == BlockAddrFwdRefs.end())
+    return false;
+
+  std::vector<BlockAddrRefTy> &RefList = BAFRI->second;
+  for (unsigned i = 0, e = RefList.size(); i != e; ++i) {
+    unsigned BlockIdx = RefList[i].first;
+    if (BlockIdx >= BBs.size())
+      return Error("Invalid blockaddress block #");
+
+    GlobalVariable *FwdRef = RefList[i].second;
+    FwdRef->replaceAllUsesWith(BlockAddress::get(F, BBs[BlockIdx]));
+    FwdRef->eraseFromParent();
+  }
+
+  BlockAddrFwdRefs.erase(BAFRI);
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// Parallel function body reading
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// ParallelRead - The function bodies the workers of a reader share out
+/// between them.
+struct ParallelRead {
+  std::vector<std::pair<Function*, uint64_t> > Bodies;
+  volatile sys::cas_flag NextBody;
+  volatile sys::cas_flag Failed;
+};
+
+/// WorkerRead - What one worker reads with.
+struct WorkerRead {
+  BitcodeReader *Worker;
+  ParallelRead *Read;
+};
+
+}
+
+/// ReadFunctionBodies - Read the function bodies no other worker took yet,
+/// until they are all read, one of them turns out to be malformed or the file
+/// turns out to be from LLVM 2.7.
+void BitcodeReader::ReadFunctionBodies(void *Arg) {
+  WorkerRead *WR = static_cast<WorkerRead *>(Arg);
+  BitcodeReader *Worker = WR->Worker;
+  ParallelRead *Read = WR->Read;
+  while (!Read->Failed) {
+    unsigned Index = sys::AtomicIncrement(&Read->NextBody) - 1;
+    if (Index >= Read->Bodies.size())
+      break;
+
+    Worker->Stream.JumpToBit(Read->Bodies[Index].second);
+    if (Worker->ParseFunctionBody(Read->Bodies[Index].first) ||
+        Worker->LLVM2_7MetadataDetected) {
+      Read->Failed = 1;
+      break;
+    }
+  }
+}
+
+/// MaterializeInParallel - Read all the function bodies that are still in the
+/// file with -bitcode-reader-threads workers, each on a thread of its own and
+/// with its own copy of the value tables.  Functions are handed out one at a
+/// time, so the workers stay busy when the functions differ in size.  Return
+/// true on error, and false without doing anything when only one thread is
+/// to be used.
+bool BitcodeReader::MaterializeInParallel(std::string *ErrInfo) {
+  if (ReaderThreads < 2 || Parent)
+    return false;
+
+  // Function-local metadata of LLVM 2.7 is numbered across the functions, in
+  // the order they are read.  Files that only show their age in a function
+  // body are found out by the workers.
+  if (LLVM2_7MetadataDetected)
+    return false;
+
+  ParallelRead Read;
+  Read.NextBody = 0;
+  Read.Failed = 0;
+  for (Module::iterator F = TheModule->begin(), E = TheModule->end();
+       F != E; ++F)
+    if (F->isMaterializable())
+      Read.Bodies.push_back(std::make_pair(&*F, DeferredFunctionInfo[F]));
+
+  unsigned NumWorkers = std::min<unsigned>(ReaderThreads, Read.Bodies.size());
+  if (NumWorkers < 2)
+    return false;
+
+  // Without this the locks of the context do nothing.
+  if (!llvm_is_multithreaded() && !llvm_start_multithreaded())
+    return false;
+
+  std::vector<BitcodeReader *> Workers(NumWorkers);
+  std::vector<WorkerRead> WorkerReads(NumWorkers);
+  std::vector<void *> Args(NumWorkers);
+  for (unsigned i = 0; i != NumWorkers; ++i) {
+    Workers[i] = new BitcodeReader(*this);
+    WorkerReads[i].Worker = Workers[i];
+    WorkerReads[i].Read = &Read;
+    Args[i] = &WorkerReads[i];
+  }
+
+  llvm_execute_in_parallel(ReadFunctionBodies, &Args[0], NumWorkers);
+
+  for (unsigned i = 0; i != NumWorkers; ++i) {
+    if (Workers[i]->ErrorString && !ErrorString)
+      ErrorString = Workers[i]->ErrorString;
+    LLVM2_7MetadataDetected |= Workers[i]->LLVM2_7MetadataDetected;
+    delete Workers[i];
+  }
+  if (ErrorString) {
+    if (ErrInfo) *ErrInfo = ErrorString;
+    return true;
+  }
+
+  // Throw away what the workers read of an LLVM 2.7 file, it is read again one
+  // function after the other.  This keeps the linkage, unlike deleteBody.
+  if (LLVM2_7MetadataDetected) {
+    for (unsigned i = 0, e = Read.Bodies.size(); i != e; ++i)
+      Read.Bodies[i].first->dropAllReferences();
+    return false;
+  }
+
+  // Now that all the bodies are there, take the addresses of the blocks the
+  // workers left forward references to, including blocks of bodies that were
+  // read before the workers started.
+  std::vector<Function*> Targets;
+  for (DenseMap<Function*, std::vector<BlockAddrRefTy> >::iterator
+       I = BlockAddrFwdRefs.begin(), E = BlockAddrFwdRefs.end(); I != E; ++I)
+    if (!I->first->isDeclaration())
+      Targets.push_back(I->first);
+
+  std::vector<BasicBlock*> BBs;
+  for (unsigned i = 0, e = Targets.size(); i != e; ++i) {
+    Function *F = Targets[i];
+    BBs.clear();
+    for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      BBs.push_back(BB);
+    if (ResolveBlockAddrFwdRefs(F, BBs)) {
+      if (ErrInfo) *ErrInfo = ErrorString;
+      return true;
+    }
+  }
+  return false;
+}
+
 //===----------------------------------------------------------------------===//
 // GVMaterializer implementation
 //===----------------------------------------------------------------------===//
@@ -2569,6 +2828,26 @@ bool BitcodeReader::Materialize(GlobalValue *GV, std::string *ErrInfo) {
     }
   }
 
+  // Read the bodies this one takes the addresses of blocks in, too.
+  return MaterializeBlockAddrTargets(ErrInfo);
+}
+
+/// MaterializeBlockAddrTargets - Read the bodies, in the order of the file,
+/// that forward references to the addresses of their blocks wait for.  The
+/// forward references are globals of their own, which clients of a module
+/// that is read lazily should never see.
+bool BitcodeReader::MaterializeBlockAddrTargets(std::string *ErrInfo) {
+  std::vector<std::pair<uint64_t, Function*> > Targets;
+  for (DenseMap<Function*, std::vector<BlockAddrRefTy> >::iterator
+       I = BlockAddrFwdRefs.begin(), E = BlockAddrFwdRefs.end(); I != E; ++I)
+    if (I->first->isMaterializable())
+      Targets.push_back(std::make_pair(DeferredFunctionInfo[I->first],
+                                       I->first));
+  std::sort(Targets.begin(), Targets.end());
+
+  for (unsigned i = 0, e = Targets.size(); i != e; ++i)
+    if (Materialize(Targets[i].second, ErrInfo))
+      return true;
   return false;
 }
 
@@ -2587,14 +2866,21 @@ void BitcodeReader::Dematerialize(GlobalValue *GV) {
 
   assert(DeferredFunctionInfo.count(F) && "No info to read function later?");
 
-  // Just forget the function body, we can remat it later.
+  // Just forget the function body, we can remat it later.  Keep the linkage,
+  // which deleteBody resets: the function is still defined in this module.
+  GlobalValue::LinkageTypes Linkage = F->getLinkage();
   F->deleteBody();
+  F->setLinkage(Linkage);
 }
 
 
 bool BitcodeReader::MaterializeModule(Module *M, std::string *ErrInfo) {
   assert(M == TheModule &&
          "Can only Materialize the Module this BitcodeReader is attached to.");
+  // Read the function bodies on several threads if asked to.
+  if (MaterializeInParallel(ErrInfo))
+    return true;
+
   // Iterate over the module, deserializing any functions that are still on
   // disk.
   for (Module::iterator F = TheModule->begin(), E = TheModule->end();
@@ -2633,26 +2919,46 @@ bool BitcodeReader::MaterializeModule(Module *M, std::string *ErrInfo) {
 // External interface
 //===----------------------------------------------------------------------===//
 
-/// getLazyBitcodeModule - lazy function-at-a-time loading from a file.
-///
-Module *llvm::getLazyBitcodeModule(MemoryBuffer *Buffer,
-                                   LLVMContext& Context,
-                                   std::string *ErrMsg) {
+/// ReadLazyBitcodeModule - Implement getLazyBitcodeModule, reading the summary
+/// block of the file into Summary unless it is null.
+static Module *ReadLazyBitcodeModule(MemoryBuffer *Buffer,
+                                     LLVMContext& Context,
+                                     BitcodeModuleSummary *Summary,
+                                     std::string *ErrMsg) {
   Module *M = new Module(Buffer->getBufferIdentifier(), Context);
   BitcodeReader *R = new BitcodeReader(Buffer, Context);
+  R->setSummary(Summary);
   M->setMaterializer(R);
   if (R->ParseBitcodeInto(M)) {
     if (ErrMsg)
       *ErrMsg = R->getErrorString();
+    if (Summary)
+      Summary->clear();
 
     delete M;  // Also deletes R.
     return 0;
   }
+  R->setSummary(0);
   // Have the BitcodeReader dtor delete 'Buffer'.
   R->setBufferOwned(true);
   return M;
 }
 
+/// getLazyBitcodeModule - lazy function-at-a-time loading from a file.
+///
+Module *llvm::getLazyBitcodeModule(MemoryBuffer *Buffer,
+                                   LLVMContext& Context,
+                                   std::string *ErrMsg) {
+  return ReadLazyBitcodeModule(Buffer, Context, 0, ErrMsg);
+}
+
+Module *llvm::getLazyBitcodeModule(MemoryBuffer *Buffer,
+                                   LLVMContext& Context,
+                                   BitcodeModuleSummary &Summary,
+                                   std::string *ErrMsg) {
+  return ReadLazyBitcodeModule(Buffer, Context, &Summary, ErrMsg);
+}
+
 /// ParseBitcodeFile - Read the specified bitcode file, returning the module.
 /// If an error occurs, return null and fill in *ErrMsg if non-null.
 Module *llvm::ParseBitcodeFile(MemoryBuffer *Buffer, LLVMContext& Context,
@@ -16,10 +16,12 @@
 
 #include "llvm/GVMaterializer.h"
 #include "llvm/Attributes.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Type.h"
 #include "llvm/OperandTraits.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Bitcode/LLVMBitCodes.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/ADT/DenseMap.h"
 #include <vector>
@@ -123,6 +125,9 @@ public:
 
 class BitcodeReader : public GVMaterializer {
   LLVMContext &Context;
+  /// Parent - When this reader is a worker that reads function bodies on a
+  /// thread of its own, this is the reader of the module it works for.
+  BitcodeReader *Parent;
   Module *TheModule;
   MemoryBuffer *Buffer;
   bool BufferOwned;
@@ -174,6 +179,14 @@ class BitcodeReader : public GVMaterializer {
   typedef std::pair<unsigned, GlobalVariable*> BlockAddrRefTy;
   DenseMap<Function*, std::vector<BlockAddrRefTy> > BlockAddrFwdRefs;
 
+  /// Summary - Where to put the function summaries of the summary block, or
+  /// null to skip the block.
+  BitcodeModuleSummary *Summary;
+
+  /// FwdRefLock - Guards BlockAddrFwdRefs and the module's list of globals
+  /// while workers read function bodies.
+  sys::SmartMutex<true> FwdRefLock;
+
   /// LLVM2_7MetadataDetected - True if metadata produced by LLVM 2.7 or
   /// earlier was detected, in which case we behave slightly differently,
   /// for compatibility.
@@ -182,8 +195,8 @@ class BitcodeReader : public GVMaterializer {
   
 public:
   explicit BitcodeReader(MemoryBuffer *buffer, LLVMContext &C)
-    : Context(C), TheModule(0), Buffer(buffer), BufferOwned(false),
-      ErrorString(0), ValueList(C), MDValueList(C),
+    : Context(C), Parent(0), TheModule(0), Buffer(buffer), BufferOwned(false),
+      ErrorString(0), ValueList(C), MDValueList(C), Summary(0),
       LLVM2_7MetadataDetected(false) {
     HasReversedFunctionsWithBodies = false;
   }
@@ -196,6 +209,10 @@ public:
   /// setBufferOwned - If this is true, the reader will destroy the MemoryBuffer
   /// when the reader is destroyed.
   void setBufferOwned(bool Owned) { BufferOwned = Owned; }
+
+  /// setSummary - Fill in S with the function summaries of the file when the
+  /// module is read.
+  void setSummary(BitcodeModuleSummary *S) { Summary = S; }
   
   virtual bool isMaterializable(const GlobalValue *GV) const;
   virtual bool isDematerializable(const GlobalValue *GV) const;
@@ -217,6 +234,10 @@ public:
   /// @returns true if an error occurred.
   bool ParseTriple(std::string &Triple);
 private:
+  /// BitcodeReader - Create a worker that reads function bodies of the module
+  /// Parent has read the header of.
+  explicit BitcodeReader(BitcodeReader &Parent);
+
   const Type *getTypeByID(unsigned ID, bool isTypeTable = false);
   Value *getFnValueByID(unsigned ID, const Type *Ty) {
     if (Ty == Type::getMetadataTy(Context))
@@ -271,9 +292,15 @@ private:
   bool ParseConstants();
   bool RememberAndSkipFunctionBody();
   bool ParseFunctionBody(Function *F);
+  bool ResolveBlockAddrFwdRefs(Function *F,
+                               const std::vector<BasicBlock*> &BBs);
+  bool MaterializeBlockAddrTargets(std::string *ErrInfo);
+  bool MaterializeInParallel(std::string *ErrInfo);
+  static void ReadFunctionBodies(void *Arg);
   bool ResolveGlobalAndAliasInits();
   bool ParseMetadata();
   bool ParseMetadataAttachment();
+  bool ParseSummary();
   bool ParseModuleTriple(std::string &Triple);
 };
   
@@ -23,6 +23,7 @@
 #include "llvm/Operator.h"
 #include "llvm/TypeSymbolTable.h"
 #include "llvm/ValueSymbolTable.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
@@ -1278,6 +1279,84 @@ static void WriteFunction(const Function &F, ValueEnumerator &VE,
   Stream.ExitBlock();
 }
 
+/// CollectGlobalRefs - Add the globals C refers to, that are not in Visited
+/// yet, to Refs.
+static void CollectGlobalRefs(const Constant *C,
+                              SmallPtrSet<const Value*, 32> &Visited,
+                              SmallVectorImpl<const GlobalValue*> &Refs) {
+  if (!Visited.insert(C))
+    return;
+  if (const GlobalValue *GV = dyn_cast<GlobalValue>(C)) {
+    Refs.push_back(GV);
+    return;
+  }
+  // The basic block of a blockaddress is not a constant.
+  for (unsigned i = 0, e = C->getNumOperands(); i != e; ++i)
+    if (const Constant *Op = dyn_cast<Constant>(C->getOperand(i)))
+      CollectGlobalRefs(Op, Visited, Refs);
+}
+
+/// WriteModuleSummary - Emit the size of each function body and the globals
+/// it calls and refers to otherwise, so that readers can tell what a module
+/// references without reading the bodies.
+static void WriteModuleSummary(const Module *M, const ValueEnumerator &VE,
+                               BitstreamWriter &Stream) {
+  SmallVector<uint64_t, 64> Vals;
+  SmallVector<const GlobalValue*, 16> Calls, Refs;
+  SmallPtrSet<const Value*, 32> Visited;
+  bool Started = false;
+
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    if (!Started) {
+      Stream.EnterSubblock(bitc::SUMMARY_BLOCK_ID, 3);
+      Started = true;
+    }
+
+    unsigned NumInsts = 0;
+    Calls.clear();
+    Refs.clear();
+    Visited.clear();
+    for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE;
+         ++BB)
+      for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end();
+           I != IE; ++I) {
+        ++NumInsts;
+
+        // A direct call, possibly through a cast, is a call edge.  Any other
+        // use of a global is a reference.
+        const Value *Callee = 0;
+        if (const CallInst *CI = dyn_cast<CallInst>(I))
+          Callee = CI->getCalledValue()->stripPointerCasts();
+        else if (const InvokeInst *II = dyn_cast<InvokeInst>(I))
+          Callee = II->getCalledValue()->stripPointerCasts();
+        if (const GlobalValue *GV = dyn_cast_or_null<GlobalValue>(Callee))
+          if (Visited.insert(GV))
+            Calls.push_back(GV);
+
+        for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+             OI != OE; ++OI)
+          if (const Constant *C = dyn_cast<Constant>(*OI))
+            CollectGlobalRefs(C, Visited, Refs);
+      }
+
+    Vals.push_back(VE.getValueID(F));
+    Vals.push_back(F->size());
+    Vals.push_back(NumInsts);
+    Vals.push_back(Calls.size());
+    for (unsigned i = 0, e = Calls.size(); i != e; ++i)
+      Vals.push_back(VE.getValueID(Calls[i]));
+    for (unsigned i = 0, e = Refs.size(); i != e; ++i)
+      Vals.push_back(VE.getValueID(Refs[i]));
+    Stream.EmitRecord(bitc::SUMMARY_CODE_FUNCTION, Vals);
+    Vals.clear();
+  }
+
+  if (Started)
+    Stream.ExitBlock();
+}
+
 /// WriteTypeSymbolTable - Emit a block for the specified type symtab.
 static void WriteTypeSymbolTable(const TypeSymbolTable &TST,
                                  const ValueEnumerator &VE,
@@ -1518,6 +1597,9 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
     if (!I->isDeclaration())
       WriteFunction(*I, VE, Stream);
 
+  // Emit what the function bodies refer to.
+  WriteModuleSummary(M, VE, Stream);
+
   // Emit metadata.
   WriteModuleMetadataStore(M, Stream);
 
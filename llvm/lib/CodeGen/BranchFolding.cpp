@@ -62,10 +62,16 @@ namespace {
   /// BranchFolderPass - Wrap branch folder in a machine function pass.
   class BranchFolderPass : public MachineFunctionPass,
                            public BranchFolder {
+    bool DefaultEnableTailMerge;
   public:
     static char ID;
     explicit BranchFolderPass(bool defaultEnableTailMerge)
-      : MachineFunctionPass(ID), BranchFolder(defaultEnableTailMerge) {}
+      : MachineFunctionPass(ID), BranchFolder(defaultEnableTailMerge),
+        DefaultEnableTailMerge(defaultEnableTailMerge) {}
+
+    virtual FunctionPass *createParallelClone() const {
+      return new BranchFolderPass(DefaultEnableTailMerge);
+    }
 
     virtual bool runOnMachineFunction(MachineFunction &MF);
     virtual const char *getPassName() const { return "Control Flow Optimizer"; }
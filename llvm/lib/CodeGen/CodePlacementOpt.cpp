@@ -38,6 +38,10 @@ namespace {
     static char ID;
     CodePlacementOpt() : MachineFunctionPass(ID) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      return new CodePlacementOpt();
+    }
+
     virtual bool runOnMachineFunction(MachineFunction &MF);
     virtual const char *getPassName() const {
       return "Code Placement Optimizer";
@@ -40,6 +40,10 @@ namespace {
      initializeDeadMachineInstructionElimPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new DeadMachineInstructionElim();
+    }
+
   private:
     bool isDead(const MachineInstr *MI) const;
   };
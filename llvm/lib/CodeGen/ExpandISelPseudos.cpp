@@ -29,6 +29,10 @@ namespace {
     static char ID; // Pass identification, replacement for typeid
     ExpandISelPseudos() : MachineFunctionPass(ID) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      return new ExpandISelPseudos();
+    }
+
   private:
     virtual bool runOnMachineFunction(MachineFunction &MF);
 
@@ -82,6 +82,11 @@ namespace {
     static char ID;
     
     MachineCodeAnalysis();
+
+    virtual FunctionPass *createParallelClone() const {
+      return new MachineCodeAnalysis();
+    }
+
     const char *getPassName() const;
     void getAnalysisUsage(AnalysisUsage &AU) const;
     
@@ -35,6 +35,10 @@ public:
   LiveDebugVariables();
   ~LiveDebugVariables();
 
+  virtual FunctionPass *createParallelClone() const {
+    return new LiveDebugVariables();
+  }
+
   /// renameRegister - Move any user variables in OldReg to NewReg:SubIdx.
   /// @param OldReg Old virtual register that is going away.
   /// @param NewReg New register holding the user variables.
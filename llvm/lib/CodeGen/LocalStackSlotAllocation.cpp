@@ -65,6 +65,10 @@ namespace {
   public:
     static char ID; // Pass identification, replacement for typeid
     explicit LocalStackSlotPass() : MachineFunctionPass(ID) { }
+
+    virtual FunctionPass *createParallelClone() const {
+      return new LocalStackSlotPass();
+    }
     bool runOnMachineFunction(MachineFunction &MF);
 
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
@@ -38,6 +38,10 @@ namespace {
     static char ID; // Pass identification, replacement for typeid
     LowerSubregsInstructionPass() : MachineFunctionPass(ID) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      return new LowerSubregsInstructionPass();
+    }
+
     const char *getPassName() const {
       return "Subregister lowering instruction pass";
     }
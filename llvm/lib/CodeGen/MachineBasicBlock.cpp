@@ -487,6 +487,26 @@ MachineBasicBlock::SplitCriticalEdge(MachineBasicBlock *Succ, Pass *P) {
         << " -- BB#" << NMBB->getNumber()
         << " -- BB#" << Succ->getNumber() << '\n');
 
+  // updateTerminator may rewrite the branches, so collect the virtual
+  // registers they kill and restore the kills afterwards. This matters for
+  // targets whose conditional branches read general purpose registers.
+  LiveVariables *LV = P->getAnalysisIfAvailable<LiveVariables>();
+  SmallVector<unsigned, 4> KilledRegs;
+  if (LV)
+    for (iterator I = getFirstTerminator(), E = end(); I != E; ++I) {
+      MachineInstr *MI = I;
+      for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+        MachineOperand &MO = MI->getOperand(i);
+        if (!MO.isReg() || !MO.isUse() || !MO.isKill() || MO.isUndef() ||
+            !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+          continue;
+        if (LV->getVarInfo(MO.getReg()).removeKill(MI)) {
+          KilledRegs.push_back(MO.getReg());
+          MO.setIsKill(false);
+        }
+      }
+    }
+
   ReplaceUsesOfBlockWith(Succ, NMBB);
   updateTerminator();
 
@@ -504,9 +524,19 @@ MachineBasicBlock::SplitCriticalEdge(MachineBasicBlock *Succ, Pass *P) {
       if (i->getOperand(ni+1).getMBB() == this)
         i->getOperand(ni+1).setMBB(NMBB);
 
-  if (LiveVariables *LV =
-        P->getAnalysisIfAvailable<LiveVariables>())
+  if (LV) {
+    // Restore the kills of the registers the old terminators killed.
+    while (!KilledRegs.empty()) {
+      unsigned Reg = KilledRegs.pop_back_val();
+      for (iterator I = end(), E = begin(); I != E;) {
+        if (!(--I)->addRegisterKilled(Reg, NULL, false))
+          continue;
+        LV->getVarInfo(Reg).Kills.push_back(I);
+        break;
+      }
+    }
     LV->addNewBlock(NMBB, this, Succ);
+  }
 
   if (MachineDominatorTree *MDT =
       P->getAnalysisIfAvailable<MachineDominatorTree>()) {
@@ -74,6 +74,7 @@ MachineFunction::~MachineFunction() {
   BasicBlocks.clear();
   InstructionRecycler.clear(Allocator);
   BasicBlockRecycler.clear(Allocator);
+  OperandRecycler.clear(Allocator);
   if (RegInfo) {
     RegInfo->~MachineRegisterInfo();
     Allocator.Deallocate(RegInfo);
@@ -151,7 +152,7 @@ MachineInstr *
 MachineFunction::CreateMachineInstr(const TargetInstrDesc &TID,
                                     DebugLoc DL, bool NoImp) {
   return new (InstructionRecycler.Allocate<MachineInstr>(Allocator))
-    MachineInstr(TID, DL, NoImp);
+    MachineInstr(*this, TID, DL, NoImp);
 }
 
 /// CloneMachineInstr - Create a new MachineInstr which is a copy of the
@@ -168,7 +169,12 @@ MachineFunction::CloneMachineInstr(const MachineInstr *Orig) {
 ///
 void
 MachineFunction::DeleteMachineInstr(MachineInstr *MI) {
+  // The operand array is recycled on its own, by its capacity class.
+  MachineOperand *Operands = MI->Operands;
+  MachineInstr::OperandCapacity CapOperands = MI->CapOperands;
   MI->~MachineInstr();
+  if (Operands)
+    deallocateOperandArray(CapOperands, Operands);
   InstructionRecycler.Deallocate(Allocator, MI);
 }
 
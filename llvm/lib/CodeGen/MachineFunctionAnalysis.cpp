@@ -15,13 +15,19 @@
 #include "llvm/CodeGen/GCMetadata.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/Instructions.h"
+#include "llvm/Module.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetOptions.h"
 using namespace llvm;
 
 char MachineFunctionAnalysis::ID = 0;
 
 MachineFunctionAnalysis::MachineFunctionAnalysis(const TargetMachine &tm,
-                                                 CodeGenOpt::Level OL) :
-  FunctionPass(ID), TM(tm), OptLevel(OL), MF(0) {
+                                                 CodeGenOpt::Level OL,
+                                                 unsigned threads) :
+  FunctionPass(ID), TM(tm), OptLevel(OL), MF(0), Threads(threads),
+  ParallelThreads(0), IsClone(false) {
   initializeMachineModuleInfoPass(*PassRegistry::getPassRegistry());
 }
 
@@ -35,24 +41,99 @@ void MachineFunctionAnalysis::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<MachineModuleInfo>();
 }
 
+FunctionPass *MachineFunctionAnalysis::createParallelClone() const {
+  MachineFunctionAnalysis *Clone =
+    new MachineFunctionAnalysis(TM, OptLevel, Threads);
+  Clone->IsClone = true;
+  return Clone;
+}
+
+/// canBuildInParallel - Return true if the MachineFunctions of M may be built
+/// on several threads with the same result as one after the other, as far as
+/// can be told without reading the function bodies.
+static bool canBuildInParallel(Module &M) {
+#ifndef NDEBUG
+  // The -debug output is not kept per thread.
+  if (DebugFlag)
+    return false;
+#endif
+
+  if (UnwindTablesMandatory)
+    return false;
+
+  for (Module::named_metadata_iterator I = M.named_metadata_begin(),
+         E = M.named_metadata_end(); I != E; ++I)
+    if (I->getName().startswith("llvm.dbg."))
+      return false;
+  return true;
+}
+
+/// canRunInParallelOn - Exception handling, debug info, garbage collection and
+/// blocks whose address is taken keep per-function state or create symbols in
+/// the MachineModuleInfo while the machine code is built, so functions using
+/// them are built on the thread of the pass manager, in order.
+bool MachineFunctionAnalysis::canRunInParallelOn(Function &F) {
+  if (F.hasGC() || !F.doesNotThrow())
+    return false;
+
+  for (Function::iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB) {
+    if (BB->hasAddressTaken())
+      return false;
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+      if (isa<InvokeInst>(I) || isa<UnwindInst>(I))
+        return false;
+      if (const CallInst *CI = dyn_cast<CallInst>(I))
+        if (const Function *Callee = CI->getCalledFunction())
+          if (Callee->getName().startswith("llvm.eh.") ||
+              Callee->getName().startswith("llvm.dbg."))
+            return false;
+    }
+  }
+  return true;
+}
+
 bool MachineFunctionAnalysis::doInitialization(Module &M) {
   MachineModuleInfo *MMI = getAnalysisIfAvailable<MachineModuleInfo>();
   assert(MMI && "MMI not around yet??");
   MMI->setModule(&M);
   NextFnNum = 0;
+
+  if (IsClone) {
+    // The clones see the functions in any order, number them as the original
+    // would.  The bodies of a lazily loaded module may not be read yet.
+    FunctionNumbers.clear();
+    for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
+      if (!I->isDeclaration() || I->isMaterializable())
+        FunctionNumbers[I] = NextFnNum++;
+  } else if (Threads >= 2)
+    ParallelThreads = canBuildInParallel(M) ? Threads : 1;
+  else
+    ParallelThreads = 0;
   return false;
 }
 
 
 bool MachineFunctionAnalysis::runOnFunction(Function &F) {
   assert(!MF && "MachineFunctionAnalysis already initialized!");
-  MF = new MachineFunction(&F, TM, NextFnNum++,
-                           getAnalysis<MachineModuleInfo>(),
+  MachineModuleInfo &MMI = getAnalysis<MachineModuleInfo>();
+  unsigned FnNum = NextFnNum++;
+
+  // Pick up what a parallel clone built for F.
+  if (!IsClone && (MF = MMI.takeMachineFunction(&F)))
+    return false;
+
+  if (IsClone)
+    FnNum = FunctionNumbers.lookup(&F);
+  MF = new MachineFunction(&F, TM, FnNum, MMI,
                            getAnalysisIfAvailable<GCModuleInfo>());
   return false;
 }
 
 void MachineFunctionAnalysis::releaseMemory() {
-  delete MF;
+  // A clone hands MF over to the original.
+  if (IsClone && MF)
+    MF->getMMI().keepMachineFunction(MF);
+  else
+    delete MF;
   MF = 0;
 }
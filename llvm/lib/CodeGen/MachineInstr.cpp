@@ -37,6 +37,8 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/FoldingSet.h"
+#include <algorithm>
+#include <memory>
 using namespace llvm;
 
 //===----------------------------------------------------------------------===//
@@ -452,7 +454,7 @@ raw_ostream &llvm::operator<<(raw_ostream &OS, const MachineMemOperand &MMO) {
 /// TID NULL and no operands.
 MachineInstr::MachineInstr()
   : TID(0), NumImplicitOps(0), Flags(0), AsmPrinterFlags(0),
-    MemRefs(0), MemRefsEnd(0),
+    Operands(0), NumOperands(0), ParentMF(0), MemRefs(0), MemRefsEnd(0),
     Parent(0) {
   // Make sure that we get added to a machine basicblock
   LeakDetector::addGarbageObject(this);
@@ -470,12 +472,14 @@ void MachineInstr::addImplicitDefUseOperands() {
 /// MachineInstr ctor - This constructor creates a MachineInstr and adds the
 /// implicit operands. It reserves space for the number of operands specified by
 /// the TargetInstrDesc.
-MachineInstr::MachineInstr(const TargetInstrDesc &tid, bool NoImp)
+MachineInstr::MachineInstr(MachineFunction &MF, const TargetInstrDesc &tid,
+                           bool NoImp)
   : TID(&tid), NumImplicitOps(0), Flags(0), AsmPrinterFlags(0),
-    MemRefs(0), MemRefsEnd(0), Parent(0) {
+    NumOperands(0), ParentMF(&MF), MemRefs(0), MemRefsEnd(0), Parent(0) {
   if (!NoImp)
     NumImplicitOps = TID->getNumImplicitDefs() + TID->getNumImplicitUses();
-  Operands.reserve(NumImplicitOps + TID->getNumOperands());
+  CapOperands = OperandCapacity::get(NumImplicitOps + TID->getNumOperands());
+  Operands = ParentMF->allocateOperandArray(CapOperands);
   if (!NoImp)
     addImplicitDefUseOperands();
   // Make sure that we get added to a machine basicblock
@@ -483,13 +487,15 @@ MachineInstr::MachineInstr(const TargetInstrDesc &tid, bool NoImp)
 }
 
 /// MachineInstr ctor - As above, but with a DebugLoc.
-MachineInstr::MachineInstr(const TargetInstrDesc &tid, const DebugLoc dl,
-                           bool NoImp)
+MachineInstr::MachineInstr(MachineFunction &MF, const TargetInstrDesc &tid,
+                           const DebugLoc dl, bool NoImp)
   : TID(&tid), NumImplicitOps(0), Flags(0), AsmPrinterFlags(0),
-    MemRefs(0), MemRefsEnd(0), Parent(0), debugLoc(dl) {
+    NumOperands(0), ParentMF(&MF), MemRefs(0), MemRefsEnd(0), Parent(0),
+    debugLoc(dl) {
   if (!NoImp)
     NumImplicitOps = TID->getNumImplicitDefs() + TID->getNumImplicitUses();
-  Operands.reserve(NumImplicitOps + TID->getNumOperands());
+  CapOperands = OperandCapacity::get(NumImplicitOps + TID->getNumOperands());
+  Operands = ParentMF->allocateOperandArray(CapOperands);
   if (!NoImp)
     addImplicitDefUseOperands();
   // Make sure that we get added to a machine basicblock
@@ -501,10 +507,12 @@ MachineInstr::MachineInstr(const TargetInstrDesc &tid, const DebugLoc dl,
 /// basic block.
 MachineInstr::MachineInstr(MachineBasicBlock *MBB, const TargetInstrDesc &tid)
   : TID(&tid), NumImplicitOps(0), Flags(0), AsmPrinterFlags(0),
-    MemRefs(0), MemRefsEnd(0), Parent(0) {
+    NumOperands(0), ParentMF(MBB->getParent()), MemRefs(0), MemRefsEnd(0),
+    Parent(0) {
   assert(MBB && "Cannot use inserting ctor with null basic block!");
   NumImplicitOps = TID->getNumImplicitDefs() + TID->getNumImplicitUses();
-  Operands.reserve(NumImplicitOps + TID->getNumOperands());
+  CapOperands = OperandCapacity::get(NumImplicitOps + TID->getNumOperands());
+  Operands = ParentMF->allocateOperandArray(CapOperands);
   addImplicitDefUseOperands();
   // Make sure that we get added to a machine basicblock
   LeakDetector::addGarbageObject(this);
@@ -516,10 +524,12 @@ MachineInstr::MachineInstr(MachineBasicBlock *MBB, const TargetInstrDesc &tid)
 MachineInstr::MachineInstr(MachineBasicBlock *MBB, const DebugLoc dl,
                            const TargetInstrDesc &tid)
   : TID(&tid), NumImplicitOps(0), Flags(0), AsmPrinterFlags(0),
-    MemRefs(0), MemRefsEnd(0), Parent(0), debugLoc(dl) {
+    NumOperands(0), ParentMF(MBB->getParent()), MemRefs(0), MemRefsEnd(0),
+    Parent(0), debugLoc(dl) {
   assert(MBB && "Cannot use inserting ctor with null basic block!");
   NumImplicitOps = TID->getNumImplicitDefs() + TID->getNumImplicitUses();
-  Operands.reserve(NumImplicitOps + TID->getNumOperands());
+  CapOperands = OperandCapacity::get(NumImplicitOps + TID->getNumOperands());
+  Operands = ParentMF->allocateOperandArray(CapOperands);
   addImplicitDefUseOperands();
   // Make sure that we get added to a machine basicblock
   LeakDetector::addGarbageObject(this);
@@ -530,9 +540,10 @@ MachineInstr::MachineInstr(MachineBasicBlock *MBB, const DebugLoc dl,
 ///
 MachineInstr::MachineInstr(MachineFunction &MF, const MachineInstr &MI)
   : TID(&MI.getDesc()), NumImplicitOps(0), Flags(0), AsmPrinterFlags(0),
-    MemRefs(MI.MemRefs), MemRefsEnd(MI.MemRefsEnd),
+    NumOperands(0), CapOperands(OperandCapacity::get(MI.getNumOperands())),
+    ParentMF(&MF), MemRefs(MI.MemRefs), MemRefsEnd(MI.MemRefsEnd),
     Parent(0), debugLoc(MI.getDebugLoc()) {
-  Operands.reserve(MI.getNumOperands());
+  Operands = MF.allocateOperandArray(CapOperands);
 
   // Add operands
   for (unsigned i = 0; i != MI.getNumOperands(); ++i)
@@ -551,7 +562,7 @@ MachineInstr::MachineInstr(MachineFunction &MF, const MachineInstr &MI)
 MachineInstr::~MachineInstr() {
   LeakDetector::removeGarbageObject(this);
 #ifndef NDEBUG
-  for (unsigned i = 0, e = Operands.size(); i != e; ++i) {
+  for (unsigned i = 0, e = NumOperands; i != e; ++i) {
     assert(Operands[i].ParentMI == this && "ParentMI mismatch!");
     assert((!Operands[i].isReg() || !Operands[i].isOnRegUseList()) &&
            "Reg operand def/use list corrupted");
@@ -572,7 +583,7 @@ MachineRegisterInfo *MachineInstr::getRegInfo() {
 /// this instruction from their respective use lists.  This requires that the
 /// operands already be on their use lists.
 void MachineInstr::RemoveRegOperandsFromUseLists() {
-  for (unsigned i = 0, e = Operands.size(); i != e; ++i) {
+  for (unsigned i = 0, e = NumOperands; i != e; ++i) {
     if (Operands[i].isReg())
       Operands[i].RemoveRegOperandFromRegInfo();
   }
@@ -582,7 +593,7 @@ void MachineInstr::RemoveRegOperandsFromUseLists() {
 /// this instruction from their respective use lists.  This requires that the
 /// operands not be on their use lists yet.
 void MachineInstr::AddRegOperandsToUseLists(MachineRegisterInfo &RegInfo) {
-  for (unsigned i = 0, e = Operands.size(); i != e; ++i) {
+  for (unsigned i = 0, e = NumOperands; i != e; ++i) {
     if (Operands[i].isReg())
       Operands[i].AddRegOperandToRegInfo(&RegInfo);
   }
@@ -600,110 +611,76 @@ void MachineInstr::addOperand(const MachineOperand &Op) {
 
   MachineRegisterInfo *RegInfo = getRegInfo();
 
-  // If we are adding the operand to the end of the list, our job is simpler.
-  // This is true most of the time, so this is a reasonable optimization.
-  if (isImpReg || NumImplicitOps == 0) {
-    // We can only do this optimization if we know that the operand list won't
-    // reallocate.
-    if (Operands.empty() || Operands.size()+1 <= Operands.capacity()) {
-      Operands.push_back(Op);
-    
-      // Set the parent of the operand.
-      Operands.back().ParentMI = this;
-  
-      // If the operand is a register, update the operand's use list.
-      if (Op.isReg()) {
-        Operands.back().AddRegOperandToRegInfo(RegInfo);
-        // If the register operand is flagged as early, mark the operand as such
-        unsigned OpNo = Operands.size() - 1;
-        if (TID->getOperandConstraint(OpNo, TOI::EARLY_CLOBBER) != -1)
-          Operands[OpNo].setIsEarlyClobber(true);
-      }
-      return;
-    }
-  }
-  
-  // Otherwise, we have to insert a real operand before any implicit ones.
-  unsigned OpNo = Operands.size()-NumImplicitOps;
-
-  // If this instruction isn't embedded into a function, then we don't need to
-  // update any operand lists.
-  if (RegInfo == 0) {
-    // Simple insertion, no reginfo update needed for other register operands.
-    Operands.insert(Operands.begin()+OpNo, Op);
-    Operands[OpNo].ParentMI = this;
-
-    // Do explicitly set the reginfo for this operand though, to ensure the
-    // next/prev fields are properly nulled out.
-    if (Operands[OpNo].isReg()) {
-      Operands[OpNo].AddRegOperandToRegInfo(0);
-      // If the register operand is flagged as early, mark the operand as such
-      if (TID->getOperandConstraint(OpNo, TOI::EARLY_CLOBBER) != -1)
-        Operands[OpNo].setIsEarlyClobber(true);
-    }
-
-  } else if (Operands.size()+1 <= Operands.capacity()) {
-    // Otherwise, we have to remove register operands from their register use
-    // list, add the operand, then add the register operands back to their use
-    // list.  This also must handle the case when the operand list reallocates
-    // to somewhere else.
-  
-    // If insertion of this operand won't cause reallocation of the operand
-    // list, just remove the implicit operands, add the operand, then re-add all
-    // the rest of the operands.
-    for (unsigned i = OpNo, e = Operands.size(); i != e; ++i) {
-      assert(Operands[i].isReg() && "Should only be an implicit reg!");
-      Operands[i].RemoveRegOperandFromRegInfo();
-    }
-    
-    // Add the operand.  If it is a register, add it to the reg list.
-    Operands.insert(Operands.begin()+OpNo, Op);
-    Operands[OpNo].ParentMI = this;
-
-    if (Operands[OpNo].isReg()) {
-      Operands[OpNo].AddRegOperandToRegInfo(RegInfo);
-      // If the register operand is flagged as early, mark the operand as such
-      if (TID->getOperandConstraint(OpNo, TOI::EARLY_CLOBBER) != -1)
-        Operands[OpNo].setIsEarlyClobber(true);
-    }
-    
-    // Re-add all the implicit ops.
-    for (unsigned i = OpNo+1, e = Operands.size(); i != e; ++i) {
-      assert(Operands[i].isReg() && "Should only be an implicit reg!");
-      Operands[i].AddRegOperandToRegInfo(RegInfo);
-    }
-  } else {
-    // Otherwise, we will be reallocating the operand list.  Remove all reg
-    // operands from their list, then readd them after the operand list is
-    // reallocated.
-    RemoveRegOperandsFromUseLists();
-    
-    Operands.insert(Operands.begin()+OpNo, Op);
-    Operands[OpNo].ParentMI = this;
-  
-    // Re-add all the operands.
-    AddRegOperandsToUseLists(*RegInfo);
+  // Implicit register operands, and every operand of an instruction without
+  // implicit operands, go at the end of the list.  This is true most of the
+  // time.  Otherwise, we have to insert a real operand before any implicit
+  // ones.
+  unsigned OpNo = NumOperands;
+  if (!isImpReg && NumImplicitOps != 0)
+    OpNo -= NumImplicitOps;
+
+  // If the operand array is full, the operands move to an array of the next
+  // capacity class; otherwise only the operands after OpNo shift up by one.
+  bool Reallocate = NumOperands == CapOperands.getSize();
+  unsigned FirstMoved = Reallocate ? 0 : OpNo;
+
+  // Register operands are linked into their use lists by address, so remove
+  // the ones that move from their lists and add them back afterwards.
+  if (RegInfo)
+    for (unsigned i = FirstMoved; i != NumOperands; ++i)
+      if (Operands[i].isReg())
+        Operands[i].RemoveRegOperandFromRegInfo();
 
-      // If the register operand is flagged as early, mark the operand as such
-    if (Operands[OpNo].isReg()
-        && TID->getOperandConstraint(OpNo, TOI::EARLY_CLOBBER) != -1)
-      Operands[OpNo].setIsEarlyClobber(true);
+  if (Reallocate) {
+    OperandCapacity NewCap = CapOperands.getNext();
+    MachineOperand *NewOperands = ParentMF->allocateOperandArray(NewCap);
+    std::uninitialized_copy(Operands, Operands+OpNo, NewOperands);
+    std::uninitialized_copy(Operands+OpNo, Operands+NumOperands,
+                            NewOperands+OpNo+1);
+    ParentMF->deallocateOperandArray(CapOperands, Operands);
+    Operands = NewOperands;
+    CapOperands = NewCap;
+  } else if (OpNo != NumOperands) {
+    new (Operands+NumOperands) MachineOperand(Operands[NumOperands-1]);
+    std::copy_backward(Operands+OpNo, Operands+NumOperands-1,
+                       Operands+NumOperands);
   }
+  ++NumOperands;
+
+  // Add the operand and set its parent.
+  MachineOperand *NewMO = new (Operands+OpNo) MachineOperand(Op);
+  NewMO->ParentMI = this;
+
+  // If the operand is a register, update the operand's use list.  Without
+  // reginfo, this explicitly nulls out the next/prev fields instead.
+  if (NewMO->isReg()) {
+    NewMO->AddRegOperandToRegInfo(RegInfo);
+    // If the register operand is flagged as early, mark the operand as such
+    if (TID->getOperandConstraint(OpNo, TOI::EARLY_CLOBBER) != -1)
+      NewMO->setIsEarlyClobber(true);
+  }
+
+  // Re-add the operands that moved.
+  if (RegInfo)
+    for (unsigned i = FirstMoved; i != NumOperands; ++i)
+      if (i != OpNo && Operands[i].isReg())
+        Operands[i].AddRegOperandToRegInfo(RegInfo);
 }
 
 /// RemoveOperand - Erase an operand  from an instruction, leaving it with one
 /// fewer operand than it started with.
 ///
 void MachineInstr::RemoveOperand(unsigned OpNo) {
-  assert(OpNo < Operands.size() && "Invalid operand number");
+  assert(OpNo < NumOperands && "Invalid operand number");
   
   // Special case removing the last one.
-  if (OpNo == Operands.size()-1) {
+  if (OpNo == NumOperands-1) {
     // If needed, remove from the reg def/use list.
-    if (Operands.back().isReg() && Operands.back().isOnRegUseList())
-      Operands.back().RemoveRegOperandFromRegInfo();
+    MachineOperand &Last = Operands[OpNo];
+    if (Last.isReg() && Last.isOnRegUseList())
+      Last.RemoveRegOperandFromRegInfo();
     
-    Operands.pop_back();
+    --NumOperands;
     return;
   }
 
@@ -712,16 +689,17 @@ void MachineInstr::RemoveOperand(unsigned OpNo) {
   // move everything down, then re-add them.
   MachineRegisterInfo *RegInfo = getRegInfo();
   if (RegInfo) {
-    for (unsigned i = OpNo, e = Operands.size(); i != e; ++i) {
+    for (unsigned i = OpNo, e = NumOperands; i != e; ++i) {
       if (Operands[i].isReg())
         Operands[i].RemoveRegOperandFromRegInfo();
     }
   }
   
-  Operands.erase(Operands.begin()+OpNo);
+  std::copy(Operands+OpNo+1, Operands+NumOperands, Operands+OpNo);
+  --NumOperands;
 
   if (RegInfo) {
-    for (unsigned i = OpNo, e = Operands.size(); i != e; ++i) {
+    for (unsigned i = OpNo, e = NumOperands; i != e; ++i) {
       if (Operands[i].isReg())
         Operands[i].AddRegOperandToRegInfo(RegInfo);
     }
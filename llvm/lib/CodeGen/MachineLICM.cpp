@@ -104,6 +104,10 @@ namespace {
         initializeMachineLICMPass(*PassRegistry::getPassRegistry());
       }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new MachineLICM(PreRegAlloc);
+    }
+
     virtual bool runOnMachineFunction(MachineFunction &MF);
 
     const char *getPassName() const { return "Machine Instruction LICM"; }
@@ -276,6 +276,10 @@ MachineModuleInfo::MachineModuleInfo()
 MachineModuleInfo::~MachineModuleInfo() {
   delete ObjFileMMI;
 
+  for (DenseMap<const Function *, MachineFunction *>::iterator
+         I = KeptFunctions.begin(), E = KeptFunctions.end(); I != E; ++I)
+    delete I->second;
+
   // FIXME: Why isn't doFinalization being called??
   //assert(AddrLabelSymbols == 0 && "doFinalization not called");
   delete AddrLabelSymbols;
@@ -297,6 +301,24 @@ bool MachineModuleInfo::doFinalization() {
   return false;
 }
 
+void MachineModuleInfo::keepMachineFunction(MachineFunction *MF) {
+  sys::SmartScopedLock<true> Guard(KeptFunctionsLock);
+  MachineFunction *&Entry = KeptFunctions[MF->getFunction()];
+  assert(!Entry && "MachineFunction kept twice!");
+  Entry = MF;
+}
+
+MachineFunction *MachineModuleInfo::takeMachineFunction(const Function *F) {
+  sys::SmartScopedLock<true> Guard(KeptFunctionsLock);
+  DenseMap<const Function *, MachineFunction *>::iterator I =
+    KeptFunctions.find(F);
+  if (I == KeptFunctions.end())
+    return 0;
+  MachineFunction *MF = I->second;
+  KeptFunctions.erase(I);
+  return MF;
+}
+
 /// EndFunction - Discard function meta information.
 ///
 void MachineModuleInfo::EndFunction() {
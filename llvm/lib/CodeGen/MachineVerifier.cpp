@@ -207,6 +207,10 @@ namespace {
         initializeMachineVerifierPassPass(*PassRegistry::getPassRegistry());
       }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new MachineVerifierPass(Banner);
+    }
+
     void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesAll();
       MachineFunctionPass::getAnalysisUsage(AU);
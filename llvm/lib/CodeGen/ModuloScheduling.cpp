@@ -0,0 +1,1141 @@
+//===-- ModuloScheduling.cpp - Software pipelining of innermost loops -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass software pipelines single block innermost loops while the machine
+// code is still in SSA form. Successive iterations of the loop are overlapped
+// so that a new iteration is started every II (initiation interval) cycles,
+// which hides the latency of loads and multiplies on in-order targets.
+//
+// II starts at the larger of the resource bound, computed from the target's
+// itineraries, and the recurrence bound, computed from the latencies and
+// iteration distances of the loop carried dependences. The loop body is then
+// placed in a modulo reservation table by a list scheduler that may evict
+// already placed instructions, as in Rau's iterative modulo scheduling; if
+// that does not converge, II is increased and scheduling restarts. Loops are
+// only pipelined if II is shorter than a non-overlapped iteration.
+//
+// A schedule with S stages is emitted as:
+//
+//   - S-1 prologue blocks, the p-th of which starts iteration p.
+//   - A kernel block which executes stage s of iteration k+S-1-s in its k-th
+//     trip, and loops as long as the original loop would have started
+//     another iteration.
+//   - S epilogue blocks. Every prologue block and the kernel test whether
+//     the next iteration exists and, if not, branch to their own epilogue,
+//     which finishes the iterations still in flight.
+//
+// Values that live into a later stage are carried through PHIs in the
+// kernel, so the result is still in SSA form. There is no modulo variable
+// expansion: each value must be dead before it is computed again by the next
+// iteration, otherwise the register allocator would have to insert copies.
+// The instructions computing the loop exit condition are kept in the first
+// stage, which lets the prologue leave early for short trip counts.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "modulo-sched"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/Instructions.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/MachineSSAUpdater.h"
+#include "llvm/CodeGen/PseudoSourceValue.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetInstrItineraries.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+using namespace llvm;
+
+static cl::opt<bool>
+DisableModuloSched("disable-modulo-sched", cl::Hidden,
+                   cl::desc("Disable software pipelining of loops"));
+
+static cl::opt<unsigned>
+MaxLoopSize("modulo-sched-max-instrs", cl::Hidden, cl::init(64),
+            cl::desc("Do not pipeline loops with more instructions"));
+
+static cl::opt<unsigned>
+MaxStages("modulo-sched-max-stages", cl::Hidden, cl::init(4),
+          cl::desc("Maximum number of overlapped iterations"));
+
+STATISTIC(NumPipelined, "Number of loops software pipelined");
+STATISTIC(NumStages,    "Number of stages in pipelined loops");
+
+namespace {
+  /// SDep-like edge of the loop dependence graph. Distance is the number of
+  /// iterations the dependence crosses.
+  struct LoopDep {
+    unsigned Node;
+    int Latency;
+    unsigned Distance;
+    LoopDep(unsigned N, int L, unsigned D) : Node(N), Latency(L), Distance(D) {}
+  };
+
+  struct LoopNode {
+    MachineInstr *MI;
+    std::vector<LoopDep> Preds, Succs;
+    int ASAP, Height, Cycle;
+    /// Order - Position in a topological order of the dependences within an
+    /// iteration; instructions issued in the same cycle are emitted in it.
+    unsigned Order;
+    bool FeedsBranch;
+    explicit LoopNode(MachineInstr *mi)
+      : MI(mi), ASAP(0), Height(0), Cycle(-1), Order(0), FeedsBranch(false) {}
+  };
+
+  typedef DenseMap<std::pair<unsigned, int>, unsigned> ValueMapTy;
+
+  class ModuloScheduler : public MachineFunctionPass {
+    const TargetInstrInfo *TII;
+    const TargetRegisterInfo *TRI;
+    const InstrItineraryData *InstrItins;
+    MachineRegisterInfo *MRI;
+    MachineFunction *MF;
+
+    // State for the loop being pipelined.
+    MachineBasicBlock *LoopBB, *Preheader, *ExitBB;
+    MachineBasicBlock *TBB, *FBB;
+    SmallVector<MachineOperand, 4> Cond;
+    std::vector<LoopNode> Nodes;
+    DenseMap<MachineInstr*, unsigned> NodeOf;
+    BitVector ReservedRegs;
+    unsigned II, NumStagesInLoop;
+
+    /// MRT - Modulo reservation table, one word of busy units per row.
+    std::vector<unsigned> MRT, IssuedInRow;
+
+    // Generated code.
+    MachineBasicBlock *KernelBB, *LastPrologue;
+    std::vector<ValueMapTy> PrologueMaps, EpilogueMaps;
+    ValueMapTy KernelMap, EpilogueMap;
+
+  public:
+    static char ID; // Pass identification
+    ModuloScheduler() : MachineFunctionPass(ID) {
+      initializeModuloSchedulerPass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual FunctionPass *createParallelClone() const {
+      return new ModuloScheduler();
+    }
+
+    virtual bool runOnMachineFunction(MachineFunction &MF);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<MachineLoopInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    virtual const char *getPassName() const {
+      return "Modulo Scheduling";
+    }
+
+  private:
+    bool canPipeline(MachineLoop *L);
+    bool buildGraph();
+    void addRegDeps(unsigned N);
+    void addMemDeps();
+    int getLatency(MachineInstr *Def, unsigned DefIdx,
+                   MachineInstr *Use, unsigned UseIdx) const;
+    int getBranchLatency(unsigned N) const;
+    unsigned computeResMII() const;
+    bool computeASAP(unsigned TryII);
+    void computeHeights();
+    void rebuildMRT();
+    bool placeNodes();
+    unsigned computeFlatLength();
+    bool scheduleLoop();
+    bool reserveResources(MachineInstr *MI, int Cycle, bool Commit);
+
+    unsigned getStage(unsigned N) const { return Nodes[N].Cycle / II; }
+    MachineInstr *getLoopDef(unsigned Reg) const;
+    unsigned getInitValue(MachineInstr *Phi) const;
+    unsigned getLoopValue(MachineInstr *Phi) const;
+
+    unsigned getAbsValue(unsigned Reg, int Iter, const ValueMapTy &VM);
+    unsigned getKernelValue(unsigned Reg, int Offset);
+    unsigned getEpilogueValue(unsigned Reg, int Offset);
+
+    void emitInstr(MachineBasicBlock *MBB, unsigned N, int Iter,
+                   ValueMapTy *VM, int Offset, bool InKernel, bool InEpilogue);
+    void emitLoopBranch(MachineBasicBlock *MBB, MachineBasicBlock *Next,
+                        MachineBasicBlock *Exit,
+                        const SmallVectorImpl<MachineOperand> &NewCond);
+    void generatePipelinedLoop();
+    unsigned getLastValue(unsigned Reg, unsigned Epilogue, int LastIter);
+    void rewriteLiveOuts(const SmallVectorImpl<MachineBasicBlock*> &Epilogues,
+                         const SmallVectorImpl<int> &LastIter);
+  };
+} // end anonymous namespace
+
+char ModuloScheduler::ID = 0;
+INITIALIZE_PASS_BEGIN(ModuloScheduler, "modulo-sched",
+                "Software pipeline innermost loops", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_END(ModuloScheduler, "modulo-sched",
+                "Software pipeline innermost loops", false, false)
+
+FunctionPass *llvm::createModuloSchedulingPass() {
+  return new ModuloScheduler();
+}
+
+/// getLoopDef - Return the instruction of the loop block defining Reg, or
+/// null if Reg is defined outside the loop.
+MachineInstr *ModuloScheduler::getLoopDef(unsigned Reg) const {
+  if (!TargetRegisterInfo::isVirtualRegister(Reg))
+    return 0;
+  MachineInstr *Def = MRI->getVRegDef(Reg);
+  if (!Def || Def->getParent() != LoopBB)
+    return 0;
+  return Def;
+}
+
+unsigned ModuloScheduler::getInitValue(MachineInstr *Phi) const {
+  for (unsigned i = 1, e = Phi->getNumOperands(); i != e; i += 2)
+    if (Phi->getOperand(i+1).getMBB() != LoopBB)
+      return Phi->getOperand(i).getReg();
+  llvm_unreachable("Loop PHI without an incoming value!");
+  return 0;
+}
+
+unsigned ModuloScheduler::getLoopValue(MachineInstr *Phi) const {
+  for (unsigned i = 1, e = Phi->getNumOperands(); i != e; i += 2)
+    if (Phi->getOperand(i+1).getMBB() == LoopBB)
+      return Phi->getOperand(i).getReg();
+  llvm_unreachable("Loop PHI without a back-edge value!");
+  return 0;
+}
+
+/// canPipeline - Check that L is a single block loop with a preheader, one
+/// exit and an analyzable conditional branch, and that every instruction in
+/// it can be freely reordered across iterations.
+bool ModuloScheduler::canPipeline(MachineLoop *L) {
+  if (L->getBlocks().size() != 1 || !L->empty())
+    return false;
+
+  LoopBB = L->getHeader();
+  Preheader = L->getLoopPreheader();
+  ExitBB = L->getExitBlock();
+  if (!Preheader || !ExitBB || ExitBB == LoopBB)
+    return false;
+
+  TBB = FBB = 0;
+  Cond.clear();
+  if (TII->AnalyzeBranch(*LoopBB, TBB, FBB, Cond, false) || Cond.empty())
+    return false;
+  if (TBB != LoopBB && TBB != ExitBB)
+    return false;
+
+  unsigned NumInstrs = 0;
+  for (MachineBasicBlock::iterator I = LoopBB->begin(),
+         E = LoopBB->getFirstTerminator(); I != E; ++I) {
+    MachineInstr *MI = I;
+    if (MI->isDebugValue())
+      continue;
+
+    if (MI->isPHI()) {
+      // A PHI fed by another PHI would carry a value over two iterations.
+      if (MI->getNumOperands() != 5)
+        return false;
+      MachineInstr *Def = getLoopDef(getLoopValue(MI));
+      if (Def && Def->isPHI())
+        return false;
+      continue;
+    }
+
+    const TargetInstrDesc &TID = MI->getDesc();
+    if (TID.isCall() || TID.isTerminator() || MI->isLabel() ||
+        MI->isInlineAsm() || MI->hasUnmodeledSideEffects() ||
+        MI->hasVolatileMemoryRef())
+      return false;
+
+    // Only reserved physical registers, such as a hardwired zero register or
+    // the stack pointer, may be read; no physical register may be written.
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (!MO.isReg() || !MO.getReg() ||
+          TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        continue;
+      if (MO.isDef() || !ReservedRegs.test(MO.getReg()))
+        return false;
+    }
+
+    if (++NumInstrs > MaxLoopSize)
+      return false;
+  }
+
+  // The terminators may only branch to the loop or its exit.
+  for (MachineBasicBlock::iterator I = LoopBB->getFirstTerminator(),
+         E = LoopBB->end(); I != E; ++I)
+    if (!I->getDesc().isBranch() || I->getDesc().isIndirectBranch())
+      return false;
+
+  return NumInstrs != 0;
+}
+
+/// getBranchLatency - Return the number of cycles between node N and the
+/// loop branch reading its result.
+int ModuloScheduler::getBranchLatency(unsigned N) const {
+  return std::max(TII->getInstrLatency(InstrItins, Nodes[N].MI), 1);
+}
+
+int ModuloScheduler::getLatency(MachineInstr *Def, unsigned DefIdx,
+                                MachineInstr *Use, unsigned UseIdx) const {
+  int Latency = TII->getOperandLatency(InstrItins, Def, DefIdx, Use, UseIdx);
+  if (Latency < 0)
+    Latency = TII->getInstrLatency(InstrItins, Def);
+  // A result cannot be used in the cycle it is produced.
+  return std::max(Latency, 1);
+}
+
+/// addRegDeps - Add the data dependences of node N on the instructions
+/// defining its operands, looking through the loop PHIs.
+void ModuloScheduler::addRegDeps(unsigned N) {
+  MachineInstr *MI = Nodes[N].MI;
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (!MO.isReg() || !MO.isUse())
+      continue;
+
+    unsigned Reg = MO.getReg(), Distance = 0;
+    MachineInstr *Def = getLoopDef(Reg);
+    if (Def && Def->isPHI()) {
+      Reg = getLoopValue(Def);
+      Def = getLoopDef(Reg);
+      Distance = 1;
+    }
+    if (!Def)
+      continue;
+
+    unsigned DefIdx = 0;
+    for (unsigned j = 0, je = Def->getNumOperands(); j != je; ++j) {
+      const MachineOperand &DefMO = Def->getOperand(j);
+      if (DefMO.isReg() && DefMO.isDef() && DefMO.getReg() == Reg) {
+        DefIdx = j;
+        break;
+      }
+    }
+
+    unsigned P = NodeOf[Def];
+    int Latency = getLatency(Def, DefIdx, MI, i);
+    Nodes[P].Succs.push_back(LoopDep(N, Latency, Distance));
+    Nodes[N].Preds.push_back(LoopDep(P, Latency, Distance));
+
+    // The kernel keeps each value in a single register, so the use must not
+    // come after the next definition of it: the one in the same iteration
+    // when reading through a PHI, the one in the next iteration otherwise.
+    if (P != N) {
+      Nodes[N].Succs.push_back(LoopDep(P, 0, 1 - Distance));
+      Nodes[P].Preds.push_back(LoopDep(N, 0, 1 - Distance));
+    }
+  }
+}
+
+/// getUnderlyingObject - Return the identified object MI accesses, or null
+/// if that is not known.
+static const Value *getUnderlyingObject(const MachineInstr *MI) {
+  if (!MI->hasOneMemOperand())
+    return 0;
+  const Value *V = (*MI->memoperands_begin())->getValue();
+  if (!V)
+    return 0;
+  V = GetUnderlyingObject(V);
+
+  // Look through the PHI of a pointer induction variable.
+  if (const PHINode *PN = dyn_cast<PHINode>(V)) {
+    const Value *Obj = 0;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i) {
+      const Value *In = GetUnderlyingObject(PN->getIncomingValue(i));
+      if (In == PN)
+        continue;
+      if (Obj && In != Obj)
+        return 0;
+      Obj = In;
+    }
+    if (!Obj)
+      return 0;
+    V = Obj;
+  }
+
+  if (isa<PseudoSourceValue>(V) || !isIdentifiedObject(V))
+    return 0;
+  return V;
+}
+
+/// addMemDeps - Order every store against all other memory operations, both
+/// within an iteration and with the next iteration, unless they access
+/// different identified objects.
+void ModuloScheduler::addMemDeps() {
+  SmallVector<unsigned, 16> MemOps;
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N) {
+    const TargetInstrDesc &TID = Nodes[N].MI->getDesc();
+    if (TID.mayLoad() || TID.mayStore())
+      MemOps.push_back(N);
+  }
+
+  for (unsigned i = 0, e = MemOps.size(); i != e; ++i)
+    for (unsigned j = i + 1; j != e; ++j) {
+      unsigned A = MemOps[i], B = MemOps[j];
+      bool AStore = Nodes[A].MI->getDesc().mayStore();
+      bool BStore = Nodes[B].MI->getDesc().mayStore();
+      if (!AStore && !BStore)
+        continue;
+
+      const Value *ObjA = getUnderlyingObject(Nodes[A].MI);
+      const Value *ObjB = getUnderlyingObject(Nodes[B].MI);
+      if (ObjA && ObjB && ObjA != ObjB)
+        continue;
+
+      // A load issued with a store to the same address sees the old value,
+      // so only an access after a store needs to wait a cycle.
+      int LatAB = AStore ? 1 : 0, LatBA = BStore ? 1 : 0;
+      Nodes[A].Succs.push_back(LoopDep(B, LatAB, 0));
+      Nodes[B].Preds.push_back(LoopDep(A, LatAB, 0));
+      Nodes[B].Succs.push_back(LoopDep(A, LatBA, 1));
+      Nodes[A].Preds.push_back(LoopDep(B, LatBA, 1));
+    }
+}
+
+/// buildGraph - Build the dependence graph of the loop body. Return false if
+/// the dependences within an iteration form a cycle, which happens when an
+/// instruction needs both the old and the new value of a loop variable.
+bool ModuloScheduler::buildGraph() {
+  Nodes.clear();
+  NodeOf.clear();
+  for (MachineBasicBlock::iterator I = LoopBB->begin(),
+         E = LoopBB->getFirstTerminator(); I != E; ++I)
+    if (!I->isPHI() && !I->isDebugValue()) {
+      NodeOf[I] = Nodes.size();
+      Nodes.push_back(LoopNode(I));
+    }
+
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+    addRegDeps(N);
+  addMemDeps();
+
+  // The exit test of iteration p decides whether iteration p+1 starts, so
+  // its operands must be computed in the first stage.
+  for (unsigned i = 0, e = Cond.size(); i != e; ++i) {
+    if (!Cond[i].isReg())
+      continue;
+    MachineInstr *Def = getLoopDef(Cond[i].getReg());
+    if (Def && Def->isPHI())
+      Def = getLoopDef(getLoopValue(Def));
+    if (Def)
+      Nodes[NodeOf[Def]].FeedsBranch = true;
+  }
+
+  // Number the nodes in a topological order of the dependences that do not
+  // cross iterations.
+  std::vector<unsigned> NumPreds(Nodes.size(), 0), Ready;
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+    for (unsigned i = 0, ie = Nodes[N].Succs.size(); i != ie; ++i)
+      if (Nodes[N].Succs[i].Distance == 0)
+        ++NumPreds[Nodes[N].Succs[i].Node];
+  for (unsigned N = Nodes.size(); N-- != 0; )
+    if (!NumPreds[N])
+      Ready.push_back(N);
+  unsigned NumOrdered = 0;
+  while (!Ready.empty()) {
+    unsigned N = Ready.back();
+    Ready.pop_back();
+    Nodes[N].Order = NumOrdered++;
+    for (unsigned i = 0, ie = Nodes[N].Succs.size(); i != ie; ++i) {
+      const LoopDep &D = Nodes[N].Succs[i];
+      if (D.Distance == 0 && --NumPreds[D.Node] == 0)
+        Ready.push_back(D.Node);
+    }
+  }
+  return NumOrdered == Nodes.size();
+}
+
+/// computeResMII - Return the resource bound on II: every functional unit
+/// class must have enough rows in the reservation table for all the stages
+/// that need it.
+unsigned ModuloScheduler::computeResMII() const {
+  std::map<unsigned, unsigned> UnitCycles;
+  unsigned NumIssued = 0;
+  for (unsigned N = 0, e = Nodes.size() + 1; N != e; ++N) {
+    // The last one is the loop branch.
+    const MachineInstr *MI = N == Nodes.size() ? &*LoopBB->getFirstTerminator()
+                                               : Nodes[N].MI;
+    const TargetInstrDesc &TID = MI->getDesc();
+    if (TII->isZeroCost(TID.getOpcode()))
+      continue;
+    ++NumIssued;
+    unsigned Idx = TID.getSchedClass();
+    for (const InstrStage *IS = InstrItins->beginStage(Idx),
+           *E = InstrItins->endStage(Idx); IS != E; ++IS)
+      UnitCycles[IS->getUnits()] += IS->getCycles();
+  }
+
+  unsigned ResMII = 1;
+  if (InstrItins->IssueWidth)
+    ResMII = (NumIssued + InstrItins->IssueWidth - 1) / InstrItins->IssueWidth;
+  for (std::map<unsigned, unsigned>::const_iterator I = UnitCycles.begin(),
+         E = UnitCycles.end(); I != E; ++I) {
+    unsigned Units = CountPopulation_32(I->first);
+    if (Units)
+      ResMII = std::max(ResMII, (I->second + Units - 1) / Units);
+  }
+  return ResMII;
+}
+
+/// computeASAP - Compute the earliest cycle of every node for TryII. Return
+/// false if some recurrence does not fit in TryII cycles.
+bool ModuloScheduler::computeASAP(unsigned TryII) {
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+    Nodes[N].ASAP = 0;
+
+  // Bellman-Ford: a change in the last round means a positive cycle.
+  for (unsigned Round = 0, e = Nodes.size(); Round <= e; ++Round) {
+    bool Changed = false;
+    for (unsigned N = 0; N != e; ++N)
+      for (unsigned i = 0, ie = Nodes[N].Succs.size(); i != ie; ++i) {
+        const LoopDep &D = Nodes[N].Succs[i];
+        int Start = Nodes[N].ASAP + D.Latency - (int)(TryII * D.Distance);
+        if (Start > Nodes[D.Node].ASAP) {
+          Nodes[D.Node].ASAP = Start;
+          Changed = true;
+        }
+      }
+    if (!Changed)
+      return true;
+  }
+  return false;
+}
+
+/// computeHeights - Compute the length of the longest path from each node to
+/// the end of the iteration, ignoring loop carried dependences.
+void ModuloScheduler::computeHeights() {
+  // Edges within an iteration always go forward in the block.
+  for (unsigned N = Nodes.size(); N-- != 0; ) {
+    int Height = 0;
+    for (unsigned i = 0, e = Nodes[N].Succs.size(); i != e; ++i) {
+      const LoopDep &D = Nodes[N].Succs[i];
+      if (D.Distance == 0)
+        Height = std::max(Height, Nodes[D.Node].Height + D.Latency);
+    }
+    Nodes[N].Height = Height;
+  }
+}
+
+/// reserveResources - Check whether MI can issue in Cycle of the modulo
+/// reservation table, and mark its units busy if Commit is set.
+bool ModuloScheduler::reserveResources(MachineInstr *MI, int Cycle,
+                                       bool Commit) {
+  const TargetInstrDesc &TID = MI->getDesc();
+  if (TII->isZeroCost(TID.getOpcode()))
+    return true;
+
+  unsigned Row = Cycle % II;
+  if (InstrItins->IssueWidth && IssuedInRow[Row] >= InstrItins->IssueWidth)
+    return false;
+
+  std::vector<unsigned> Table(MRT);
+  unsigned Idx = TID.getSchedClass(), StageCycle = Cycle;
+  for (const InstrStage *IS = InstrItins->beginStage(Idx),
+         *E = InstrItins->endStage(Idx); IS != E; ++IS) {
+    for (unsigned i = 0; i < IS->getCycles(); ++i) {
+      unsigned &Busy = Table[(StageCycle + i) % II];
+      unsigned FreeUnits = IS->getUnits() & ~Busy;
+      if (!FreeUnits)
+        return false;
+      // Take the lowest free unit.
+      Busy |= FreeUnits & -FreeUnits;
+    }
+    StageCycle += IS->getNextCycles();
+  }
+
+  if (Commit) {
+    MRT.swap(Table);
+    ++IssuedInRow[Row];
+  }
+  return true;
+}
+
+/// rebuildMRT - Recompute the modulo reservation table from the nodes that
+/// are currently scheduled. The loop branch always issues in the last row.
+void ModuloScheduler::rebuildMRT() {
+  MRT.assign(II, 0);
+  IssuedInRow.assign(II, 0);
+  reserveResources(LoopBB->getFirstTerminator(), II - 1, true);
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+    if (Nodes[N].Cycle >= 0)
+      reserveResources(Nodes[N].MI, Nodes[N].Cycle, true);
+}
+
+/// placeNodes - Place every node in the modulo reservation table for the
+/// current II, in order of increasing earliest cycle. A node that finds no
+/// free slot between its scheduled predecessors and successors evicts the
+/// nodes in its way, as in iterative modulo scheduling. Return false if
+/// this does not settle within a fixed budget of placements.
+bool ModuloScheduler::placeNodes() {
+  // Schedule the nodes by increasing earliest cycle, the ones with the
+  // longest path to the end of the iteration first.
+  std::vector<std::pair<std::pair<int, int>, unsigned> > Order;
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N) {
+    Nodes[N].Cycle = -1;
+    Order.push_back(std::make_pair(std::make_pair(Nodes[N].ASAP,
+                                                  -Nodes[N].Height), N));
+  }
+  std::sort(Order.begin(), Order.end());
+
+  std::vector<int> PrevCycle(Nodes.size(), -1);
+  rebuildMRT();
+  for (unsigned Budget = 4 * Nodes.size(); Budget != 0; --Budget) {
+    unsigned i = 0, e = Order.size();
+    while (i != e && Nodes[Order[i].second].Cycle >= 0)
+      ++i;
+    if (i == e)
+      return true;
+
+    unsigned N = Order[i].second;
+    LoopNode &Node = Nodes[N];
+    int Early = 0, Late = INT_MAX;
+    for (unsigned j = 0, je = Node.Preds.size(); j != je; ++j) {
+      const LoopDep &D = Node.Preds[j];
+      if (D.Node != N && Nodes[D.Node].Cycle >= 0)
+        Early = std::max(Early, Nodes[D.Node].Cycle + D.Latency -
+                                (int)(II * D.Distance));
+    }
+    for (unsigned j = 0, je = Node.Succs.size(); j != je; ++j) {
+      const LoopDep &D = Node.Succs[j];
+      if (D.Node != N && Nodes[D.Node].Cycle >= 0)
+        Late = std::min(Late, Nodes[D.Node].Cycle - D.Latency +
+                              (int)(II * D.Distance));
+    }
+    int Limit = std::min(Early + (int)II - 1, (int)(MaxStages * II) - 1);
+    if (Node.FeedsBranch)
+      Limit = std::min(Limit, (int)II - 1 - getBranchLatency(N));
+    if (Early > Limit)
+      return false;
+
+    int Cycle = -1;
+    for (int C = Early, CE = std::min(Late, Limit); C <= CE; ++C)
+      if (reserveResources(Node.MI, C, false)) {
+        Cycle = C;
+        break;
+      }
+
+    if (Cycle < 0) {
+      // Force the node in, trying a later cycle each time it comes back.
+      Cycle = Early > PrevCycle[N] ? Early : PrevCycle[N] + 1;
+      if (Cycle > Limit)
+        return false;
+
+      // Unschedule the successors whose dependences are now violated, then
+      // the nodes issued in the same row until the resources are free.
+      for (unsigned j = 0, je = Node.Succs.size(); j != je; ++j) {
+        const LoopDep &D = Node.Succs[j];
+        if (D.Node != N && Nodes[D.Node].Cycle >= 0 &&
+            Cycle + D.Latency - (int)(II * D.Distance) > Nodes[D.Node].Cycle)
+          Nodes[D.Node].Cycle = -1;
+      }
+      rebuildMRT();
+      for (unsigned M = 0, Row = Cycle % II;
+           !reserveResources(Node.MI, Cycle, false); ++M) {
+        while (M != Nodes.size() &&
+               (Nodes[M].Cycle < 0 || Nodes[M].Cycle % II != Row))
+          ++M;
+        if (M == Nodes.size())
+          return false;
+        Nodes[M].Cycle = -1;
+        rebuildMRT();
+      }
+    }
+
+    reserveResources(Node.MI, Cycle, true);
+    Node.Cycle = PrevCycle[N] = Cycle;
+  }
+  return false;
+}
+
+/// computeFlatLength - Return the number of cycles an iteration takes when
+/// it does not overlap with the next one: every instruction, the branch
+/// included, must issue before the next iteration starts, and the values
+/// carried around the loop must be ready when they are used.
+unsigned ModuloScheduler::computeFlatLength() {
+  // With this many rows nothing wraps around the reservation table.
+  II = 1;
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+    II += std::max(1, TII->getInstrLatency(InstrItins, Nodes[N].MI));
+  if (!computeASAP(II) || !placeNodes())
+    return II;
+
+  int Length = 0;
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N) {
+    Length = std::max(Length, Nodes[N].Cycle + 1);
+    if (Nodes[N].FeedsBranch)
+      Length = std::max(Length, Nodes[N].Cycle + getBranchLatency(N) + 1);
+    for (unsigned i = 0, ie = Nodes[N].Succs.size(); i != ie; ++i) {
+      const LoopDep &D = Nodes[N].Succs[i];
+      if (D.Distance)
+        Length = std::max(Length, Nodes[N].Cycle + D.Latency -
+                                  Nodes[D.Node].Cycle);
+    }
+  }
+  return Length;
+}
+
+/// scheduleLoop - Find the smallest II for which every node fits in the
+/// modulo reservation table without violating a dependence.
+bool ModuloScheduler::scheduleLoop() {
+  if (!InstrItins || InstrItins->isEmpty())
+    return false;
+
+  unsigned MII = computeResMII();
+  while (!computeASAP(MII))
+    ++MII;
+
+  // Pipelining only pays off if it beats the loop as it is scheduled now.
+  computeHeights();
+  unsigned FlatLength = computeFlatLength();
+
+  DEBUG(dbgs() << "MII = " << MII << ", flat length = " << FlatLength
+               << '\n');
+
+  for (II = MII; II < FlatLength; ++II) {
+    if (!computeASAP(II) || !placeNodes())
+      continue;
+
+    NumStagesInLoop = 0;
+    for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+      NumStagesInLoop = std::max(NumStagesInLoop, getStage(N) + 1);
+    DEBUG({
+        dbgs() << "Scheduled with II = " << II << ", " << NumStagesInLoop
+               << " stages\n";
+        for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+          dbgs() << "  cycle " << Nodes[N].Cycle << ": " << *Nodes[N].MI;
+      });
+    return NumStagesInLoop > 1;
+  }
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// Code generation
+//===----------------------------------------------------------------------===//
+
+/// getAbsValue - Return the register holding the value of Reg in iteration
+/// Iter, for the straight line code of the prologue and the epilogues that
+/// follow it. VM maps (Reg, iteration) to the registers defined so far.
+unsigned ModuloScheduler::getAbsValue(unsigned Reg, int Iter,
+                                      const ValueMapTy &VM) {
+  MachineInstr *Def = getLoopDef(Reg);
+  if (!Def)
+    return Reg;
+  if (Def->isPHI())
+    return Iter == 0 ? getInitValue(Def)
+                     : getAbsValue(getLoopValue(Def), Iter - 1, VM);
+  ValueMapTy::const_iterator I = VM.find(std::make_pair(Reg, Iter));
+  assert(I != VM.end() && "Value used before it is defined!");
+  return I->second;
+}
+
+/// getKernelValue - Return the register that holds, during the k-th trip of
+/// the kernel, the value of Reg in iteration k+Offset. Values of older
+/// iterations are passed down a chain of PHIs, one per trip.
+unsigned ModuloScheduler::getKernelValue(unsigned Reg, int Offset) {
+  MachineInstr *Def = getLoopDef(Reg);
+  if (!Def)
+    return Reg;
+  if (Def->isPHI() && Offset > 0)
+    return getKernelValue(getLoopValue(Def), Offset - 1);
+
+  std::pair<unsigned, int> Key(Reg, Offset);
+  ValueMapTy::iterator I = KernelMap.find(Key);
+  if (I != KernelMap.end())
+    return I->second;
+
+  // Not defined in this trip; it comes from the previous one, or from the
+  // prologue on entry.
+  assert((Def->isPHI() ||
+          Offset < (int)(NumStagesInLoop - 1 - getStage(NodeOf[Def]))) &&
+         "Value used before it is defined!");
+  unsigned NewReg = MRI->createVirtualRegister(MRI->getRegClass(Reg));
+  KernelMap[Key] = NewReg;
+
+  unsigned EntryValue, LoopValue;
+  if (Def->isPHI()) {
+    EntryValue = getInitValue(Def);
+    LoopValue = getKernelValue(getLoopValue(Def), 0);
+  } else {
+    EntryValue = getAbsValue(Reg, Offset, PrologueMaps.back());
+    LoopValue = getKernelValue(Reg, Offset + 1);
+  }
+  BuildMI(*KernelBB, KernelBB->begin(), DebugLoc(),
+          TII->get(TargetOpcode::PHI), NewReg)
+    .addReg(EntryValue).addMBB(LastPrologue)
+    .addReg(LoopValue).addMBB(KernelBB);
+  return NewReg;
+}
+
+/// getEpilogueValue - Return the register holding the value of Reg in
+/// iteration k+Offset in the epilogue following the k-th, and last, trip of
+/// the kernel.
+unsigned ModuloScheduler::getEpilogueValue(unsigned Reg, int Offset) {
+  MachineInstr *Def = getLoopDef(Reg);
+  if (!Def)
+    return Reg;
+  if (Def->isPHI())
+    return Offset == 0 ? getKernelValue(Reg, 0)
+                       : getEpilogueValue(getLoopValue(Def), Offset - 1);
+  if ((int)getStage(NodeOf[Def]) <= (int)NumStagesInLoop - 1 - Offset)
+    return getKernelValue(Reg, Offset);
+  ValueMapTy::iterator I = EpilogueMap.find(std::make_pair(Reg, Offset));
+  assert(I != EpilogueMap.end() && "Value used before it is defined!");
+  return I->second;
+}
+
+/// emitInstr - Append a copy of node N to MBB, renaming its registers for
+/// iteration Iter of the straight line code (VM), for iteration k+Offset of
+/// the kernel, or for iteration k+Offset of the kernel's epilogue.
+void ModuloScheduler::emitInstr(MachineBasicBlock *MBB, unsigned N, int Iter,
+                                ValueMapTy *VM, int Offset, bool InKernel,
+                                bool InEpilogue) {
+  MachineInstr *NewMI = MF->CloneMachineInstr(Nodes[N].MI);
+  for (unsigned i = 0, e = NewMI->getNumOperands(); i != e; ++i) {
+    MachineOperand &MO = NewMI->getOperand(i);
+    if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      continue;
+    unsigned Reg = MO.getReg();
+    if (MO.isUse()) {
+      if (InKernel)
+        MO.setReg(getKernelValue(Reg, Offset));
+      else if (InEpilogue)
+        MO.setReg(getEpilogueValue(Reg, Offset));
+      else
+        MO.setReg(getAbsValue(Reg, Iter, *VM));
+      MO.setIsKill(false);
+      continue;
+    }
+
+    unsigned NewReg;
+    if (InKernel) {
+      NewReg = KernelMap[std::make_pair(Reg, Offset)];
+    } else {
+      NewReg = MRI->createVirtualRegister(MRI->getRegClass(Reg));
+      if (InEpilogue)
+        EpilogueMap[std::make_pair(Reg, Offset)] = NewReg;
+      else
+        (*VM)[std::make_pair(Reg, Iter)] = NewReg;
+    }
+    MO.setReg(NewReg);
+  }
+  MBB->push_back(NewMI);
+}
+
+/// emitLoopBranch - Terminate MBB with a copy of the loop branch, going to
+/// Next where the loop would branch back and to Exit where it would leave.
+void ModuloScheduler::
+emitLoopBranch(MachineBasicBlock *MBB, MachineBasicBlock *Next,
+               MachineBasicBlock *Exit,
+               const SmallVectorImpl<MachineOperand> &NewCond) {
+  DebugLoc DL = LoopBB->getFirstTerminator()->getDebugLoc();
+  if (TBB == LoopBB)
+    TII->InsertBranch(*MBB, Next, Exit, NewCond, DL);
+  else
+    TII->InsertBranch(*MBB, Exit, Next, NewCond, DL);
+  MBB->addSuccessor(Next);
+  MBB->addSuccessor(Exit);
+}
+
+namespace {
+  /// Instance - One copy of a loop instruction in the generated code, ordered
+  /// by issue time, then oldest iteration first, then original position.
+  struct Instance {
+    int Time, Iter;
+    unsigned Node, Order;
+    Instance(int T, int I, unsigned N, unsigned O)
+      : Time(T), Iter(I), Node(N), Order(O) {}
+    bool operator<(const Instance &RHS) const {
+      if (Time != RHS.Time) return Time < RHS.Time;
+      if (Iter != RHS.Iter) return Iter < RHS.Iter;
+      return Order < RHS.Order;
+    }
+  };
+}
+
+void ModuloScheduler::generatePipelinedLoop() {
+  unsigned S = NumStagesInLoop;
+  MachineFunction::iterator InsertPt = LoopBB;
+  const BasicBlock *BB = LoopBB->getBasicBlock();
+
+  // Epilogues[p] finishes the iterations started by the first p+1 prologue
+  // blocks; Epilogues[S-1] the ones in flight when the kernel exits.
+  SmallVector<MachineBasicBlock*, 4> Prologues, Epilogues;
+  for (unsigned p = 0; p != S - 1; ++p) {
+    Prologues.push_back(MF->CreateMachineBasicBlock(BB));
+    MF->insert(InsertPt, Prologues.back());
+  }
+  KernelBB = MF->CreateMachineBasicBlock(BB);
+  MF->insert(InsertPt, KernelBB);
+  for (unsigned p = 0; p != S; ++p) {
+    Epilogues.push_back(MF->CreateMachineBasicBlock(BB));
+    MF->insert(InsertPt, Epilogues.back());
+  }
+  LastPrologue = Prologues.back();
+
+  Preheader->ReplaceUsesOfBlockWith(LoopBB, Prologues.front());
+
+  // Prologue block p starts iteration p and runs stage p-j of iteration j.
+  PrologueMaps.clear();
+  ValueMapTy VM;
+  for (unsigned p = 0; p != S - 1; ++p) {
+    std::vector<Instance> Work;
+    for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+      if (getStage(N) <= p) {
+        int Iter = p - getStage(N);
+        Work.push_back(Instance(Iter * II + Nodes[N].Cycle, Iter, N,
+                                Nodes[N].Order));
+      }
+    std::sort(Work.begin(), Work.end());
+    for (unsigned i = 0, e = Work.size(); i != e; ++i)
+      emitInstr(Prologues[p], Work[i].Node, Work[i].Iter, &VM, 0,
+                false, false);
+    PrologueMaps.push_back(VM);
+  }
+
+  // The kernel runs stage s of iteration k+S-1-s. Name the values it
+  // defines up front, so that its PHIs can refer to them.
+  KernelMap.clear();
+  for (unsigned N = 0, e = Nodes.size(); N != e; ++N) {
+    MachineInstr *MI = Nodes[N].MI;
+    for (unsigned i = 0, ie = MI->getNumOperands(); i != ie; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (MO.isReg() && MO.isDef() &&
+          TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        KernelMap[std::make_pair(MO.getReg(), (int)(S - 1 - getStage(N)))] =
+          MRI->createVirtualRegister(MRI->getRegClass(MO.getReg()));
+    }
+  }
+  {
+    std::vector<Instance> Work;
+    for (unsigned N = 0, e = Nodes.size(); N != e; ++N) {
+      int Iter = S - 1 - getStage(N);
+      Work.push_back(Instance(Iter * II + Nodes[N].Cycle, Iter, N,
+                              Nodes[N].Order));
+    }
+    std::sort(Work.begin(), Work.end());
+    for (unsigned i = 0, e = Work.size(); i != e; ++i)
+      emitInstr(KernelBB, Work[i].Node, 0, 0, Work[i].Iter, true, false);
+  }
+
+  // Each prologue block tests whether its iteration is the last one.
+  for (unsigned p = 0; p != S - 1; ++p) {
+    // The operands of Cond still belong to the loop branch, so build fresh
+    // register operands rather than calling setReg on copies of them.
+    SmallVector<MachineOperand, 4> NewCond;
+    for (unsigned i = 0, e = Cond.size(); i != e; ++i)
+      if (Cond[i].isReg())
+        NewCond.push_back(MachineOperand::CreateReg(
+            getAbsValue(Cond[i].getReg(), p, PrologueMaps[p]), false));
+      else
+        NewCond.push_back(Cond[i]);
+    emitLoopBranch(Prologues[p], p + 2 == S ? KernelBB : Prologues[p + 1],
+                   Epilogues[p], NewCond);
+  }
+
+  // The kernel tests the iteration it has just started.
+  SmallVector<MachineOperand, 4> KernelCond;
+  for (unsigned i = 0, e = Cond.size(); i != e; ++i)
+    if (Cond[i].isReg())
+      KernelCond.push_back(MachineOperand::CreateReg(
+          getKernelValue(Cond[i].getReg(), S - 1), false));
+    else
+      KernelCond.push_back(Cond[i]);
+  emitLoopBranch(KernelBB, KernelBB, Epilogues.back(), KernelCond);
+
+  // Leaving after prologue block p, iterations 0..p are in flight and
+  // iteration j has run stages 0..p-j.
+  EpilogueMaps.clear();
+  SmallVector<int, 4> LastIter;
+  for (unsigned p = 0; p != S - 1; ++p) {
+    ValueMapTy EVM(PrologueMaps[p]);
+    std::vector<Instance> Work;
+    for (unsigned j = 0; j <= p; ++j)
+      for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+        if (getStage(N) > p - j)
+          Work.push_back(Instance(j * II + Nodes[N].Cycle, j, N,
+                                  Nodes[N].Order));
+    std::sort(Work.begin(), Work.end());
+    for (unsigned i = 0, e = Work.size(); i != e; ++i)
+      emitInstr(Epilogues[p], Work[i].Node, Work[i].Iter, &EVM, 0,
+                false, false);
+    EpilogueMaps.push_back(EVM);
+    LastIter.push_back(p);
+  }
+
+  // Leaving the k-th kernel trip, iteration k+c has run stages 0..S-1-c.
+  EpilogueMap.clear();
+  {
+    std::vector<Instance> Work;
+    for (unsigned c = 1; c != S; ++c)
+      for (unsigned N = 0, e = Nodes.size(); N != e; ++N)
+        if (getStage(N) > S - 1 - c)
+          Work.push_back(Instance(c * II + Nodes[N].Cycle, c, N,
+                                  Nodes[N].Order));
+    std::sort(Work.begin(), Work.end());
+    for (unsigned i = 0, e = Work.size(); i != e; ++i)
+      emitInstr(Epilogues.back(), Work[i].Node, 0, 0, Work[i].Iter,
+                false, true);
+  }
+  LastIter.push_back(S - 1);
+
+  SmallVector<MachineOperand, 0> NoCond;
+  for (unsigned p = 0; p != S; ++p) {
+    TII->InsertBranch(*Epilogues[p], ExitBB, 0, NoCond, DebugLoc());
+    Epilogues[p]->addSuccessor(ExitBB);
+  }
+
+  // The original loop is dead now. Unlink it before rewriting the live-outs
+  // so that the SSA updater does not look for values coming from it.
+  while (!LoopBB->succ_empty())
+    LoopBB->removeSuccessor(LoopBB->succ_begin());
+  rewriteLiveOuts(Epilogues, LastIter);
+
+  while (!LoopBB->empty())
+    LoopBB->begin()->eraseFromParent();
+  LoopBB->eraseFromParent();
+}
+
+/// getLastValue - Return the value Reg had in the last iteration of the loop
+/// when leaving through Epilogue, whose last iteration is LastIter.
+unsigned ModuloScheduler::getLastValue(unsigned Reg, unsigned Epilogue,
+                                       int LastIter) {
+  if (Epilogue == EpilogueMaps.size())
+    return getEpilogueValue(Reg, LastIter);
+  return getAbsValue(Reg, LastIter, EpilogueMaps[Epilogue]);
+}
+
+/// rewriteLiveOuts - Make the users of values computed in the loop use the
+/// value of the last iteration, which depends on the epilogue the code left
+/// through. LastIter[i] is the iteration finished last by Epilogues[i], as
+/// an absolute number for the prologue epilogues and relative to the last
+/// kernel trip for the kernel epilogue.
+void ModuloScheduler::
+rewriteLiveOuts(const SmallVectorImpl<MachineBasicBlock*> &Epilogues,
+                const SmallVectorImpl<int> &LastIter) {
+  unsigned NumEpilogues = Epilogues.size();
+
+  // PHIs in the exit block get one incoming value per epilogue.
+  for (MachineBasicBlock::iterator I = ExitBB->begin(), E = ExitBB->end();
+       I != E && I->isPHI(); ++I) {
+    MachineInstr *Phi = I;
+    unsigned Reg = 0;
+    for (unsigned i = 1, e = Phi->getNumOperands(); i != e; i += 2)
+      if (Phi->getOperand(i+1).getMBB() == LoopBB) {
+        Reg = Phi->getOperand(i).getReg();
+        Phi->RemoveOperand(i+1);
+        Phi->RemoveOperand(i);
+        break;
+      }
+    if (!Reg)
+      continue;
+    for (unsigned j = 0; j != NumEpilogues; ++j) {
+      unsigned Value = getLastValue(Reg, j, LastIter[j]);
+      Phi->addOperand(MachineOperand::CreateReg(Value, false));
+      Phi->addOperand(MachineOperand::CreateMBB(Epilogues[j]));
+    }
+  }
+
+  // Any other use outside the loop goes through the SSA updater.
+  MachineSSAUpdater SSAUpdate(*MF);
+  for (MachineBasicBlock::iterator I = LoopBB->begin(),
+         E = LoopBB->getFirstTerminator(); I != E; ++I) {
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = I->getOperand(i);
+      if (!MO.isReg() || !MO.isDef() ||
+          !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        continue;
+      unsigned Reg = MO.getReg();
+
+      SmallVector<MachineOperand*, 8> Uses;
+      for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(Reg),
+             UE = MRI->use_end(); UI != UE; ++UI)
+        if (UI->getParent() != LoopBB)
+          Uses.push_back(&UI.getOperand());
+      if (Uses.empty())
+        continue;
+
+      SSAUpdate.Initialize(Reg);
+      for (unsigned j = 0; j != NumEpilogues; ++j)
+        SSAUpdate.AddAvailableValue(Epilogues[j],
+                                    getLastValue(Reg, j, LastIter[j]));
+      for (unsigned j = 0, je = Uses.size(); j != je; ++j)
+        SSAUpdate.RewriteUse(*Uses[j]);
+    }
+  }
+}
+
+bool ModuloScheduler::runOnMachineFunction(MachineFunction &Fn) {
+  if (DisableModuloSched)
+    return false;
+
+  MF = &Fn;
+  TII = Fn.getTarget().getInstrInfo();
+  TRI = Fn.getTarget().getRegisterInfo();
+  InstrItins = Fn.getTarget().getInstrItineraryData();
+  MRI = &Fn.getRegInfo();
+  ReservedRegs = TRI->getReservedRegs(Fn);
+  if (!InstrItins || InstrItins->isEmpty())
+    return false;
+
+  // Collect the innermost loops first; pipelining replaces their blocks.
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+  SmallVector<MachineLoop*, 8> Worklist(MLI.begin(), MLI.end());
+  SmallVector<MachineLoop*, 8> Innermost;
+  while (!Worklist.empty()) {
+    MachineLoop *L = Worklist.pop_back_val();
+    if (L->empty())
+      Innermost.push_back(L);
+    else
+      Worklist.append(L->begin(), L->end());
+  }
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Innermost.size(); i != e; ++i) {
+    if (!canPipeline(Innermost[i]))
+      continue;
+    DEBUG(dbgs() << "Pipelining loop BB#" << LoopBB->getNumber() << " in "
+                 << Fn.getFunction()->getName() << '\n');
+    if (!buildGraph() || !scheduleLoop())
+      continue;
+
+    generatePipelinedLoop();
+    ++NumPipelined;
+    NumStages += NumStagesInLoop;
+    Changed = true;
+  }
+
+  Nodes.clear();
+  NodeOf.clear();
+  PrologueMaps.clear();
+  EpilogueMaps.clear();
+  KernelMap.clear();
+  EpilogueMap.clear();
+  return Changed;
+}
@@ -44,6 +44,10 @@ namespace {
       initializePHIEliminationPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new PHIElimination();
+    }
+
     virtual bool runOnMachineFunction(MachineFunction &Fn);
     virtual void getAnalysisUsage(AnalysisUsage &AU) const;
 
@@ -87,6 +87,11 @@ namespace {
     PostRAScheduler(CodeGenOpt::Level ol) :
       MachineFunctionPass(ID), OptLevel(ol) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      // The blocks -postra-sched-debugdiv counts run across functions.
+      return DebugDiv ? 0 : new PostRAScheduler(OptLevel);
+    }
+
     void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesCFG();
       AU.addRequired<AliasAnalysis>();
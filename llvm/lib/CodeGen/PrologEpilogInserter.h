@@ -40,6 +40,10 @@ namespace llvm {
       initializePEIPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new PEI();
+    }
+
     const char *getPassName() const {
       return "Prolog/Epilog Insertion & Frame Finalization";
     }
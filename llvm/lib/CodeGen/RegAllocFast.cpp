@@ -52,6 +52,10 @@ namespace {
       initializePHIEliminationPass(*PassRegistry::getPassRegistry());
       initializeTwoAddressInstructionPassPass(*PassRegistry::getPassRegistry());
     }
+
+    virtual FunctionPass *createParallelClone() const {
+      return new RAFast();
+    }
   private:
     const TargetMachine *TM;
     MachineFunction *MF;
@@ -111,6 +111,11 @@ namespace {
       RecentNext = RecentRegs.begin();
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      // The recently used registers carry over from one function to the next.
+      return NumRecentlyUsedRegs ? 0 : new RALinScan();
+    }
+
     typedef std::pair<LiveInterval*, LiveInterval::iterator> IntervalPtr;
     typedef SmallVector<IntervalPtr, 32> IntervalPtrs;
   private:
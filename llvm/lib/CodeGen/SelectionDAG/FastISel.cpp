@@ -1172,6 +1172,17 @@ unsigned FastISel::FastEmitInst_extractsubreg(MVT RetVT,
   return ResultReg;
 }
 
+/// FastEmitInst_copytoregclass - Emit a copy of a register into a new
+/// virtual register of the specified class.
+unsigned FastISel::FastEmitInst_copytoregclass(const TargetRegisterClass *RC,
+                                               unsigned Op0, bool Op0IsKill) {
+  unsigned ResultReg = createResultReg(RC);
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt,
+          DL, TII.get(TargetOpcode::COPY), ResultReg)
+    .addReg(Op0, getKillRegState(Op0IsKill));
+  return ResultReg;
+}
+
 /// FastEmitZExtFromI1 - Emit MachineInstrs to compute the value of Op
 /// with all but the least significant bit set to zero.
 unsigned FastISel::FastEmitZExtFromI1(MVT VT, unsigned Op0, bool Op0IsKill) {
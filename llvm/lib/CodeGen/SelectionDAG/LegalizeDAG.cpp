@@ -66,6 +66,10 @@ class SelectionDAGLegalize {
   /// against each other, including inserted libcalls.
   SDValue LastCALLSEQ_END;
 
+  /// CallSeqDepth - The number of CALLSEQ_START nodes being legalized whose
+  /// call has not been legalized yet.
+  int CallSeqDepth;
+
   enum LegalizeAction {
     Legal,      // The target natively supports this operation.
     Promote,    // This operation should be executed in a larger type.
@@ -216,7 +220,7 @@ SelectionDAGLegalize::ShuffleWithNarrowerEltType(EVT NVT, EVT VT,  DebugLoc dl,
 SelectionDAGLegalize::SelectionDAGLegalize(SelectionDAG &dag,
                                            CodeGenOpt::Level ol)
   : TM(dag.getTarget()), TLI(dag.getTargetLoweringInfo()),
-    DAG(dag), OptLevel(ol),
+    DAG(dag), OptLevel(ol), CallSeqDepth(0),
     ValueTypeActions(TLI.getValueTypeActions()) {
   assert(MVT::LAST_VALUETYPE <= MVT::MAX_ALLOWED_VALUETYPE &&
          "Too many value types for ValueTypeActions to hold!");
@@ -1026,7 +1030,6 @@ SDValue SelectionDAGLegalize::LegalizeOp(SDValue Op) {
     }
     break;
   case ISD::CALLSEQ_START: {
-    static int depth = 0;
     SDNode *CallEnd = FindCallEndFromCallStart(Node);
 
     // Recursively Legalize all of the inputs of the call end that do not lead
@@ -1044,7 +1047,7 @@ SDValue SelectionDAGLegalize::LegalizeOp(SDValue Op) {
 
     // Merge in the last call to ensure that this call starts after the last
     // call ended.
-    if (LastCALLSEQ_END.getOpcode() != ISD::EntryToken && depth == 0) {
+    if (LastCALLSEQ_END.getOpcode() != ISD::EntryToken && CallSeqDepth == 0) {
       Tmp1 = DAG.getNode(ISD::TokenFactor, dl, MVT::Other,
                          Tmp1, LastCALLSEQ_END);
       Tmp1 = LegalizeOp(Tmp1);
@@ -1072,12 +1075,12 @@ SDValue SelectionDAGLegalize::LegalizeOp(SDValue Op) {
     // Note that we are selecting this call!
     LastCALLSEQ_END = SDValue(CallEnd, 0);
 
-    depth++;
+    ++CallSeqDepth;
     // Legalize the call, starting from the CALLSEQ_END.
     LegalizeOp(LastCALLSEQ_END);
-    depth--;
-    assert(depth >= 0 && "Un-matched CALLSEQ_START?");
-    if (depth > 0)
+    --CallSeqDepth;
+    assert(CallSeqDepth >= 0 && "Un-matched CALLSEQ_START?");
+    if (CallSeqDepth > 0)
       LastCALLSEQ_END = Saved_LastCALLSEQ_END;
     return Result;
   }
@@ -3291,6 +3294,81 @@ void SelectionDAGLegalize::ExpandNode(SDNode *Node,
     Results.push_back(TopHalf);
     break;
   }
+  case ISD::SADDSAT:
+  case ISD::SSUBSAT: {
+    EVT VT = Node->getValueType(0);
+    SDValue LHS = Node->getOperand(0);
+    SDValue RHS = Node->getOperand(1);
+    bool isAdd = Node->getOpcode() == ISD::SADDSAT;
+    SDValue Sum = DAG.getNode(isAdd ? ISD::ADD : ISD::SUB, dl, VT, LHS, RHS);
+
+    // The operation overflowed iff the sign of the result differs from the
+    // sign of LHS and, for an add, from the sign of RHS too, or for a
+    // subtract, LHS and RHS have different signs.
+    SDValue Ovf = DAG.getNode(ISD::XOR, dl, VT, LHS, Sum);
+    Tmp1 = DAG.getNode(ISD::XOR, dl, VT, isAdd ? RHS : LHS, isAdd ? Sum : RHS);
+    Ovf = DAG.getNode(ISD::AND, dl, VT, Ovf, Tmp1);
+    Ovf = DAG.getSetCC(dl, TLI.getSetCCResultType(VT), Ovf,
+                       DAG.getConstant(0, VT), ISD::SETLT);
+
+    // The wrapped result has the wrong sign, so an overflow towards the
+    // maximum leaves it negative and turns this into the maximum.
+    unsigned Bits = VT.getSizeInBits();
+    Tmp1 = DAG.getNode(ISD::SRA, dl, VT, Sum,
+                       DAG.getConstant(Bits - 1, TLI.getShiftAmountTy(VT)));
+    Tmp1 = DAG.getNode(ISD::XOR, dl, VT, Tmp1,
+                       DAG.getConstant(APInt::getSignedMinValue(Bits), VT));
+    Results.push_back(DAG.getNode(ISD::SELECT, dl, VT, Ovf, Tmp1, Sum));
+    break;
+  }
+  case ISD::SMULFIXSAT: {
+    EVT VT = Node->getValueType(0);
+    EVT ShTy = TLI.getShiftAmountTy(VT);
+    SDValue LHS = Node->getOperand(0);
+    SDValue RHS = Node->getOperand(1);
+    unsigned Scale = cast<ConstantSDNode>(Node->getOperand(2))->getZExtValue();
+    unsigned Bits = VT.getSizeInBits();
+
+    // Form the full product in two halves.
+    SDValue Lo, Hi;
+    if (TLI.isOperationLegalOrCustom(ISD::SMUL_LOHI, VT)) {
+      Lo = DAG.getNode(ISD::SMUL_LOHI, dl, DAG.getVTList(VT, VT), LHS, RHS);
+      Hi = Lo.getValue(1);
+    } else {
+      Lo = DAG.getNode(ISD::MUL, dl, VT, LHS, RHS);
+      Hi = DAG.getNode(ISD::MULHS, dl, VT, LHS, RHS);
+    }
+
+    // The product shifted right by Scale fits in the type iff the bits of
+    // the product from Bits + Scale - 1 upwards all equal its sign bit.
+    SDValue Sign = DAG.getNode(ISD::SRA, dl, VT, Hi,
+                               DAG.getConstant(Bits - 1, ShTy));
+    SDValue Res, Ovf;
+    if (Scale == 0) {
+      Res = Lo;
+      Tmp1 = DAG.getNode(ISD::SRA, dl, VT, Lo,
+                         DAG.getConstant(Bits - 1, ShTy));
+      Ovf = DAG.getSetCC(dl, TLI.getSetCCResultType(VT), Hi, Tmp1,
+                         ISD::SETNE);
+    } else {
+      Res = DAG.getNode(ISD::OR, dl, VT,
+                        DAG.getNode(ISD::SRL, dl, VT, Lo,
+                                    DAG.getConstant(Scale, ShTy)),
+                        DAG.getNode(ISD::SHL, dl, VT, Hi,
+                                    DAG.getConstant(Bits - Scale, ShTy)));
+      Tmp1 = DAG.getNode(ISD::SRA, dl, VT, Hi,
+                         DAG.getConstant(Scale - 1, ShTy));
+      Ovf = DAG.getSetCC(dl, TLI.getSetCCResultType(VT), Tmp1, Sign,
+                         ISD::SETNE);
+    }
+
+    // A negative product saturates to the minimum, a positive one to the
+    // maximum.
+    Tmp1 = DAG.getNode(ISD::XOR, dl, VT, Sign,
+                       DAG.getConstant(APInt::getSignedMaxValue(Bits), VT));
+    Results.push_back(DAG.getNode(ISD::SELECT, dl, VT, Ovf, Tmp1, Res));
+    break;
+  }
   case ISD::BUILD_PAIR: {
     EVT PairTy = Node->getValueType(0);
     Tmp1 = DAG.getNode(ISD::ZERO_EXTEND, dl, PairTy, Node->getOperand(0));
@@ -102,6 +102,10 @@ void DAGTypeLegalizer::PromoteIntegerResult(SDNode *N, unsigned ResNo) {
   case ISD::SMULO:
   case ISD::UMULO:       Res = PromoteIntRes_XMULO(N, ResNo); break;
 
+  case ISD::SADDSAT:
+  case ISD::SSUBSAT:     Res = PromoteIntRes_SADDSUBSAT(N); break;
+  case ISD::SMULFIXSAT:  Res = PromoteIntRes_SMULFIXSAT(N); break;
+
   case ISD::ATOMIC_LOAD_ADD:
   case ISD::ATOMIC_LOAD_SUB:
   case ISD::ATOMIC_LOAD_AND:
@@ -426,6 +430,42 @@ SDValue DAGTypeLegalizer::PromoteIntRes_SADDSUBO(SDNode *N, unsigned ResNo) {
   return Res;
 }
 
+SDValue DAGTypeLegalizer::PromoteIntRes_SADDSUBSAT(SDNode *N) {
+  // Move the operands to the top of the larger type, so that it saturates at
+  // the same points, and shift the result back down.
+  SDValue LHS = GetPromotedInteger(N->getOperand(0));
+  SDValue RHS = GetPromotedInteger(N->getOperand(1));
+  EVT OVT = N->getValueType(0);
+  EVT NVT = LHS.getValueType();
+  DebugLoc dl = N->getDebugLoc();
+
+  SDValue ShAmt = DAG.getConstant(NVT.getSizeInBits() - OVT.getSizeInBits(),
+                                  TLI.getShiftAmountTy(NVT));
+  LHS = DAG.getNode(ISD::SHL, dl, NVT, LHS, ShAmt);
+  RHS = DAG.getNode(ISD::SHL, dl, NVT, RHS, ShAmt);
+  SDValue Res = DAG.getNode(N->getOpcode(), dl, NVT, LHS, RHS);
+  return DAG.getNode(ISD::SRA, dl, NVT, Res, ShAmt);
+}
+
+SDValue DAGTypeLegalizer::PromoteIntRes_SMULFIXSAT(SDNode *N) {
+  // As for SADDSAT, with the extra fraction bits of the product added to the
+  // scale. This keeps Q15 multiplies in Q31 form on 32-bit targets.
+  SDValue LHS = GetPromotedInteger(N->getOperand(0));
+  SDValue RHS = GetPromotedInteger(N->getOperand(1));
+  EVT OVT = N->getValueType(0);
+  EVT NVT = LHS.getValueType();
+  DebugLoc dl = N->getDebugLoc();
+
+  unsigned Diff = NVT.getSizeInBits() - OVT.getSizeInBits();
+  unsigned Scale = cast<ConstantSDNode>(N->getOperand(2))->getZExtValue();
+  SDValue ShAmt = DAG.getConstant(Diff, TLI.getShiftAmountTy(NVT));
+  LHS = DAG.getNode(ISD::SHL, dl, NVT, LHS, ShAmt);
+  RHS = DAG.getNode(ISD::SHL, dl, NVT, RHS, ShAmt);
+  SDValue Res = DAG.getNode(ISD::SMULFIXSAT, dl, NVT, LHS, RHS,
+                            DAG.getTargetConstant(Scale + Diff, MVT::i32));
+  return DAG.getNode(ISD::SRA, dl, NVT, Res, ShAmt);
+}
+
 SDValue DAGTypeLegalizer::PromoteIntRes_SDIV(SDNode *N) {
   // Sign extend the input.
   SDValue LHS = SExtPromotedInteger(N->getOperand(0));
@@ -1051,6 +1091,10 @@ void DAGTypeLegalizer::ExpandIntegerResult(SDNode *N, unsigned ResNo) {
   case ISD::SSUBO: ExpandIntRes_SADDSUBO(N, Lo, Hi); break;
   case ISD::UADDO:
   case ISD::USUBO: ExpandIntRes_UADDSUBO(N, Lo, Hi); break;
+
+  case ISD::SADDSAT:
+  case ISD::SSUBSAT: ExpandIntRes_SADDSUBSAT(N, Lo, Hi); break;
+  case ISD::SMULFIXSAT: ExpandIntRes_SMULFIXSAT(N, Lo, Hi); break;
   }
 
   // If Lo/Hi is null, the sub-method took care of registering results etc.
@@ -1906,6 +1950,109 @@ void DAGTypeLegalizer::ExpandIntRes_SADDSUBO(SDNode *Node,
   ReplaceValueWith(SDValue(Node, 1), Cmp);
 }
 
+void DAGTypeLegalizer::ExpandIntRes_SADDSUBSAT(SDNode *N,
+                                               SDValue &Lo, SDValue &Hi) {
+  SDValue LHS = N->getOperand(0);
+  SDValue RHS = N->getOperand(1);
+  EVT VT = LHS.getValueType();
+  DebugLoc dl = N->getDebugLoc();
+
+  // Do the overflow-checking operation and clamp the result if it overflowed.
+  // The wrapped result has the opposite sign of the true one, so its sign
+  // bits select the bound.
+  SDValue Sum = DAG.getNode(N->getOpcode() == ISD::SADDSAT ?
+                            ISD::SADDO : ISD::SSUBO, dl,
+                            DAG.getVTList(VT, TLI.getSetCCResultType(VT)),
+                            LHS, RHS);
+  unsigned Bits = VT.getSizeInBits();
+  SDValue Sat = DAG.getNode(ISD::SRA, dl, VT, Sum,
+                            DAG.getConstant(Bits - 1,
+                                            TLI.getShiftAmountTy(VT)));
+  Sat = DAG.getNode(ISD::XOR, dl, VT, Sat,
+                    DAG.getConstant(APInt::getSignedMinValue(Bits), VT));
+  SplitInteger(DAG.getNode(ISD::SELECT, dl, VT, Sum.getValue(1), Sat, Sum),
+               Lo, Hi);
+}
+
+void DAGTypeLegalizer::ExpandIntRes_SMULFIXSAT(SDNode *N,
+                                               SDValue &Lo, SDValue &Hi) {
+  EVT VT = N->getValueType(0);
+  EVT NVT = TLI.getTypeToTransformTo(*DAG.getContext(), VT);
+  EVT WideVT = EVT::getIntegerVT(*DAG.getContext(), VT.getSizeInBits() * 2);
+  unsigned Scale = cast<ConstantSDNode>(N->getOperand(2))->getZExtValue();
+  unsigned Bits = VT.getSizeInBits();
+  unsigned HalfBits = NVT.getSizeInBits();
+  DebugLoc dl = N->getDebugLoc();
+
+  // Form the unsigned product in the type of twice the width from the four
+  // products of the halves.  Each of those multiplies zero extended values,
+  // which the expansion of MUL turns into a multiply of the halves and a
+  // MULHU or UMUL_LOHI, without a libcall.
+  SDValue LL, LH, RL, RH;
+  GetExpandedInteger(N->getOperand(0), LL, LH);
+  GetExpandedInteger(N->getOperand(1), RL, RH);
+  SDValue Parts[2][2];
+  SDValue L[2] = { DAG.getNode(ISD::ZERO_EXTEND, dl, VT, LL),
+                   DAG.getNode(ISD::ZERO_EXTEND, dl, VT, LH) };
+  SDValue R[2] = { DAG.getNode(ISD::ZERO_EXTEND, dl, VT, RL),
+                   DAG.getNode(ISD::ZERO_EXTEND, dl, VT, RH) };
+  for (unsigned i = 0; i != 2; ++i)
+    for (unsigned j = 0; j != 2; ++j)
+      Parts[i][j] = DAG.getNode(ISD::ZERO_EXTEND, dl, WideVT,
+                                DAG.getNode(ISD::MUL, dl, VT, L[i], R[j]));
+  EVT WideShTy = TLI.getShiftAmountTy(WideVT);
+  SDValue Mid = DAG.getNode(ISD::ADD, dl, WideVT, Parts[0][1], Parts[1][0]);
+  SDValue Prod = DAG.getNode(ISD::ADD, dl, WideVT, Parts[0][0],
+                             DAG.getNode(ISD::SHL, dl, WideVT, Mid,
+                                         DAG.getConstant(HalfBits, WideShTy)));
+  SDValue HighPart = DAG.getNode(ISD::SHL, dl, WideVT, Parts[1][1],
+                                 DAG.getConstant(Bits, WideShTy));
+  Prod = DAG.getNode(ISD::ADD, dl, WideVT, Prod, HighPart);
+
+  // The signed product differs from the unsigned one by the other operand in
+  // the upper half for each negative operand.
+  SDValue LHS = N->getOperand(0);
+  SDValue RHS = N->getOperand(1);
+  EVT ShTy = TLI.getShiftAmountTy(VT);
+  SDValue SignBit = DAG.getConstant(Bits - 1, ShTy);
+  SDValue Fix = DAG.getNode(ISD::ADD, dl, VT,
+                  DAG.getNode(ISD::AND, dl, VT, RHS,
+                              DAG.getNode(ISD::SRA, dl, VT, LHS, SignBit)),
+                  DAG.getNode(ISD::AND, dl, VT, LHS,
+                              DAG.getNode(ISD::SRA, dl, VT, RHS, SignBit)));
+  Fix = DAG.getNode(ISD::SHL, dl, WideVT,
+                    DAG.getNode(ISD::ZERO_EXTEND, dl, WideVT, Fix),
+                    DAG.getConstant(Bits, WideShTy));
+  Prod = DAG.getNode(ISD::SUB, dl, WideVT, Prod, Fix);
+
+  // From here on as in the expansion of SMULFIXSAT in a legal type: the
+  // product shifted right by Scale fits iff the bits from Bits + Scale - 1
+  // upwards all equal its sign bit.
+  SDValue ProdLo = DAG.getNode(ISD::TRUNCATE, dl, VT, Prod);
+  SDValue ProdHi = DAG.getNode(ISD::TRUNCATE, dl, VT,
+                               DAG.getNode(ISD::SRL, dl, WideVT, Prod,
+                                           DAG.getConstant(Bits, WideShTy)));
+  SDValue Sign = DAG.getNode(ISD::SRA, dl, VT, ProdHi, SignBit);
+  SDValue Res, Ovf;
+  if (Scale == 0) {
+    Res = ProdLo;
+    Ovf = DAG.getSetCC(dl, TLI.getSetCCResultType(VT), ProdHi,
+                       DAG.getNode(ISD::SRA, dl, VT, ProdLo, SignBit),
+                       ISD::SETNE);
+  } else {
+    Res = DAG.getNode(ISD::TRUNCATE, dl, VT,
+                      DAG.getNode(ISD::SRL, dl, WideVT, Prod,
+                                  DAG.getConstant(Scale, WideShTy)));
+    Ovf = DAG.getSetCC(dl, TLI.getSetCCResultType(VT),
+                       DAG.getNode(ISD::SRA, dl, VT, ProdHi,
+                                   DAG.getConstant(Scale - 1, ShTy)),
+                       Sign, ISD::SETNE);
+  }
+  SDValue Sat = DAG.getNode(ISD::XOR, dl, VT, Sign,
+                            DAG.getConstant(APInt::getSignedMaxValue(Bits), VT));
+  SplitInteger(DAG.getNode(ISD::SELECT, dl, VT, Ovf, Sat, Res), Lo, Hi);
+}
+
 void DAGTypeLegalizer::ExpandIntRes_SDIV(SDNode *N,
                                          SDValue &Lo, SDValue &Hi) {
   EVT VT = N->getValueType(0);
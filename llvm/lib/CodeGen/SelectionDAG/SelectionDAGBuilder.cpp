@@ -4697,6 +4697,22 @@ SelectionDAGBuilder::visitIntrinsicCall(const CallInst &I, unsigned Intrinsic) {
     return implVisitAluOverflow(I, ISD::UMULO);
   case Intrinsic::smul_with_overflow:
     return implVisitAluOverflow(I, ISD::SMULO);
+  case Intrinsic::sadd_sat:
+  case Intrinsic::ssub_sat:
+    setValue(&I, DAG.getNode(Intrinsic == Intrinsic::sadd_sat ?
+                             ISD::SADDSAT : ISD::SSUBSAT, dl,
+                             getValue(I.getArgOperand(0)).getValueType(),
+                             getValue(I.getArgOperand(0)),
+                             getValue(I.getArgOperand(1))));
+    return 0;
+  case Intrinsic::smul_fix_sat: {
+    SDValue Op1 = getValue(I.getArgOperand(0));
+    unsigned Scale = cast<ConstantInt>(I.getArgOperand(2))->getZExtValue();
+    setValue(&I, DAG.getNode(ISD::SMULFIXSAT, dl, Op1.getValueType(), Op1,
+                             getValue(I.getArgOperand(1)),
+                             DAG.getTargetConstant(Scale, MVT::i32)));
+    return 0;
+  }
 
   case Intrinsic::prefetch: {
     SDValue Ops[4];
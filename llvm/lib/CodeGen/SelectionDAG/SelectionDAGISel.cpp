@@ -47,6 +47,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/PostOrderIterator.h"
@@ -208,6 +209,70 @@ void SelectionDAGISel::getAnalysisUsage(AnalysisUsage &AU) const {
   MachineFunctionPass::getAnalysisUsage(AU);
 }
 
+namespace {
+/// FastISelMissCompare - Order FastISel misses by the number of instructions
+/// they sent to SelectionDAG, then by count, then by name.
+struct FastISelMissCompare {
+  template<typename EntryTy>
+  bool operator()(const EntryTy *LHS, const EntryTy *RHS) const {
+    if (LHS->getValue().DAGInsts != RHS->getValue().DAGInsts)
+      return LHS->getValue().DAGInsts > RHS->getValue().DAGInsts;
+    if (LHS->getValue().Count != RHS->getValue().Count)
+      return LHS->getValue().Count > RHS->getValue().Count;
+    return LHS->getKey() < RHS->getKey();
+  }
+};
+}
+
+bool SelectionDAGISel::canRunInParallel() {
+  return !EnableFastISelVerbose;
+}
+
+bool SelectionDAGISel::doFinalization(Module &M) {
+  if (FastISelMisses.empty())
+    return false;
+
+  typedef StringMapEntry<FastISelMiss> MissEntry;
+  std::vector<const MissEntry*> Misses;
+  for (StringMap<FastISelMiss>::const_iterator I = FastISelMisses.begin(),
+       E = FastISelMisses.end(); I != E; ++I)
+    Misses.push_back(&*I);
+  std::sort(Misses.begin(), Misses.end(), FastISelMissCompare());
+
+  dbgs() << "===" << std::string(73, '-') << "===\n"
+         << "                        ... FastISel Misses ...\n"
+         << "===" << std::string(73, '-') << "===\n\n"
+         << "  Misses  DAG Insts  Instruction\n";
+  for (unsigned i = 0, e = Misses.size(); i != e; ++i)
+    dbgs() << format("%8u  %9u  ", Misses[i]->getValue().Count,
+                     Misses[i]->getValue().DAGInsts)
+           << Misses[i]->getKey() << '\n';
+  dbgs() << '\n';
+
+  FastISelMisses.clear();
+  return false;
+}
+
+/// RecordFastISelMiss - Count a FastISel miss on I, which sent DAGInsts
+/// instructions to SelectionDAG.
+void SelectionDAGISel::RecordFastISelMiss(const Instruction *I,
+                                          unsigned DAGInsts) {
+  std::string Key = I->getOpcodeName();
+  if (const IntrinsicInst *II = dyn_cast<IntrinsicInst>(I)) {
+    Key += " " + II->getCalledFunction()->getName().str();
+  } else {
+    const Type *Ty = I->getType();
+    if (const StoreInst *SI = dyn_cast<StoreInst>(I))
+      Ty = SI->getValueOperand()->getType();
+    if (!Ty->isVoidTy())
+      Key += " " + Ty->getDescription();
+  }
+
+  FastISelMiss &Miss = FastISelMisses[Key];
+  ++Miss.Count;
+  Miss.DAGInsts += DAGInsts;
+}
+
 /// FunctionCallsSetJmp - Return true if the function has a call to setjmp or
 /// other function that gcc recognizes as "returning twice". This is used to
 /// limit code-gen optimizations on the machine function.
@@ -931,6 +996,8 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
             dbgs() << "FastISel missed call: ";
             Inst->dump();
           }
+          if (EnableFastISelVerbose)
+            RecordFastISelMiss(Inst, 1);
 
           if (!Inst->getType()->isVoidTy() && !Inst->use_empty()) {
             unsigned &R = FuncInfo->ValueMap[Inst];
@@ -963,6 +1030,10 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
             // For the purpose of debugging, just abort.
             llvm_unreachable("FastISel didn't select the entire block");
         }
+        // The instruction and everything above it in the block go to
+        // SelectionDAG.
+        if (EnableFastISelVerbose)
+          RecordFastISelMiss(Inst, std::distance(Begin, BI));
         break;
       }
 
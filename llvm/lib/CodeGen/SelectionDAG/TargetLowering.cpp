@@ -535,6 +535,9 @@ TargetLowering::TargetLowering(const TargetMachine &tm,
     // These operations default to expand.
     setOperationAction(ISD::FGETSIGN, (MVT::SimpleValueType)VT, Expand);
     setOperationAction(ISD::CONCAT_VECTORS, (MVT::SimpleValueType)VT, Expand);
+    setOperationAction(ISD::SADDSAT, (MVT::SimpleValueType)VT, Expand);
+    setOperationAction(ISD::SSUBSAT, (MVT::SimpleValueType)VT, Expand);
+    setOperationAction(ISD::SMULFIXSAT, (MVT::SimpleValueType)VT, Expand);
   }
 
   // Most targets ignore the @llvm.prefetch intrinsic.
@@ -3074,6 +3077,10 @@ bool TargetLowering::isLegalAddressingMode(const AddrMode &AM,
   // The default implementation of this implements a conservative RISCy, r+r and
   // r+i addr mode.
 
+  // Circular addressing is only available on targets that say so.
+  if (AM.IsCircular)
+    return false;
+
   // Allows a sign-extended 16-bit immediate field.
   if (AM.BaseOffs <= -(1LL << 16) || AM.BaseOffs >= (1LL << 16)-1)
     return false;
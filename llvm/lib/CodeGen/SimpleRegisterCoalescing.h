@@ -68,6 +68,10 @@ namespace llvm {
       initializeSimpleRegisterCoalescingPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new SimpleRegisterCoalescing();
+    }
+
     struct InstrSlots {
       enum {
         LOAD  = 0,
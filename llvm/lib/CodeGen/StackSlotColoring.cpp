@@ -102,6 +102,10 @@ namespace {
       MachineFunctionPass(ID), ColorWithRegs(RegColor), NextColor(-1) {
         initializeStackSlotColoringPass(*PassRegistry::getPassRegistry());
       }
+
+    virtual FunctionPass *createParallelClone() const {
+      return new StackSlotColoring(ColorWithRegs);
+    }
     
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesCFG();
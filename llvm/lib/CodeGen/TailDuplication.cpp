@@ -71,6 +71,10 @@ namespace {
     explicit TailDuplicatePass(bool PreRA) :
       MachineFunctionPass(ID), PreRegAlloc(PreRA) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      return new TailDuplicatePass(PreRegAlloc);
+    }
+
     virtual bool runOnMachineFunction(MachineFunction &MF);
     virtual const char *getPassName() const { return "Tail Duplication"; }
 
@@ -146,6 +146,10 @@ namespace {
       initializeTwoAddressInstructionPassPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new TwoAddressInstructionPass();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesCFG();
       AU.addRequired<AliasAnalysis>();
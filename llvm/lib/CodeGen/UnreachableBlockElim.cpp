@@ -105,6 +105,10 @@ namespace {
   public:
     static char ID; // Pass identification, replacement for typeid
     UnreachableMachineBlockElim() : MachineFunctionPass(ID) {}
+
+    virtual FunctionPass *createParallelClone() const {
+      return new UnreachableMachineBlockElim();
+    }
   };
 }
 char UnreachableMachineBlockElim::ID = 0;
@@ -0,0 +1,462 @@
+//===---- VLIWPacketizer.cpp - Issue bundle formation ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This implements a top-down, cycle-by-cycle list scheduler that fills one
+// issue bundle per cycle. Resource conflicts come from the target's
+// itineraries through its post-RA hazard recognizer, which is normally a
+// ScoreboardHazardRecognizer; the bundle width is the itinerary issue width.
+//
+// The pipeline is assumed to interlock, so the scheduler never inserts noops:
+// a cycle where nothing can issue just ends the current bundle. Instructions
+// of one bundle read their operands before any of them writes a result, so
+// a true or output dependence always puts the two instructions in different
+// bundles, while anti and memory order dependences may share one.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "packets"
+#include "ScheduleDAGInstrs.h"
+#include "llvm/CodeGen/VLIWPacketizer.h"
+#include "llvm/CodeGen/LatencyPriorityQueue.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/ScheduleHazardRecognizer.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetInstrItineraries.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/Statistic.h"
+#include <algorithm>
+using namespace llvm;
+
+STATISTIC(NumBundled, "Number of instructions issued with a predecessor");
+STATISTIC(NumBundles, "Number of multi-instruction bundles formed");
+
+namespace llvm {
+  /// VLIWScheduler - Assign an issue cycle to each instruction of a
+  /// scheduling region, never issuing more than a bundle can hold.
+  class LLVM_LIBRARY_VISIBILITY VLIWScheduler : public ScheduleDAGInstrs {
+    const VLIWPacketizerList &Packetizer;
+
+    /// AA - AliasAnalysis for making memory reference queries.
+    AliasAnalysis *AA;
+
+    /// AvailableQueue - The priority queue to use for the available SUnits.
+    LatencyPriorityQueue AvailableQueue;
+
+    /// PendingQueue - Instructions whose predecessors have all been
+    /// scheduled but whose operands are not ready yet.
+    std::vector<SUnit*> PendingQueue;
+
+    /// HazardRec - The hazard recognizer to use.
+    ScheduleHazardRecognizer *HazardRec;
+
+  public:
+    /// Cycles - Issue cycle of each SUnit, indexed by NodeNum.
+    std::vector<unsigned> Cycles;
+
+    VLIWScheduler(MachineFunction &MF, MachineLoopInfo &MLI,
+                  MachineDominatorTree &MDT, AliasAnalysis *AA,
+                  const VLIWPacketizerList &P);
+    ~VLIWScheduler();
+
+    void Schedule();
+
+    /// fitsInBundle - Return true if MI can issue in the same cycle as the
+    /// instructions of Bundle, whichever units they are given.
+    bool fitsInBundle(const SmallVectorImpl<MachineInstr*> &Bundle,
+                      MachineInstr *MI);
+
+  private:
+    void ReleaseSucc(SUnit *SU, SDep *SuccEdge);
+    void ReleaseSuccessors(SUnit *SU);
+    void ScheduleNodeTopDown(SUnit *SU, unsigned CurCycle);
+    void ListScheduleTopDown();
+  };
+}
+
+VLIWScheduler::VLIWScheduler(MachineFunction &MF, MachineLoopInfo &MLI,
+                             MachineDominatorTree &MDT, AliasAnalysis *AA,
+                             const VLIWPacketizerList &P)
+  : ScheduleDAGInstrs(MF, MLI, MDT), Packetizer(P), AA(AA) {
+  const TargetMachine &TM = MF.getTarget();
+  HazardRec =
+    TM.getInstrInfo()->CreateTargetPostRAHazardRecognizer(
+                                          TM.getInstrItineraryData(), this);
+}
+
+VLIWScheduler::~VLIWScheduler() {
+  delete HazardRec;
+}
+
+void VLIWScheduler::Schedule() {
+  BuildSchedGraph(AA);
+
+  DEBUG(dbgs() << "********** VLIW Packetizing **********\n");
+  DEBUG(for (unsigned su = 0, e = SUnits.size(); su != e; ++su)
+          SUnits[su].dumpAll(this));
+
+  Cycles.assign(SUnits.size(), 0);
+  AvailableQueue.initNodes(SUnits);
+  ListScheduleTopDown();
+  AvailableQueue.releaseState();
+}
+
+/// getNumIssueUnits - Return the number of functional units MI can issue on,
+/// or ~0U if its itinerary has no stages.
+static unsigned getNumIssueUnits(const InstrItineraryData *Itins,
+                                 const MachineInstr *MI) {
+  unsigned Idx = MI->getDesc().getSchedClass();
+  if (Itins->beginStage(Idx) == Itins->endStage(Idx))
+    return ~0U;
+  return CountPopulation_32(Itins->beginStage(Idx)->getUnits());
+}
+
+namespace {
+  /// FewerIssueUnits - Order instructions by the number of functional units
+  /// they can issue on.
+  struct FewerIssueUnits {
+    const InstrItineraryData *Itins;
+    explicit FewerIssueUnits(const InstrItineraryData *Itins) : Itins(Itins) {}
+    bool operator()(const MachineInstr *A, const MachineInstr *B) const {
+      return getNumIssueUnits(Itins, A) < getNumIssueUnits(Itins, B);
+    }
+  };
+}
+
+bool VLIWScheduler::fitsInBundle(const SmallVectorImpl<MachineInstr*> &Bundle,
+                                 MachineInstr *MI) {
+  // The scoreboard takes whichever unit of a stage it finds free first, so
+  // an ALU op that can issue in either slot may take the only slot a branch
+  // can use. Reserve the units of the instructions with the fewest choices
+  // first; the others then take what is left.
+  const InstrItineraryData *Itins = MF.getTarget().getInstrItineraryData();
+  SmallVector<MachineInstr*, 4> Order(Bundle.begin(), Bundle.end());
+  Order.push_back(MI);
+  std::stable_sort(Order.begin(), Order.end(), FewerIssueUnits(Itins));
+
+  HazardRec->Reset();
+  bool Fits = true;
+  for (unsigned i = 0, e = Order.size(); i != e && Fits; ++i) {
+    SUnit Member(Order[i], i);
+    // An instruction without itinerary stages, such as the end marker of a
+    // hardware loop, does not take an issue slot of its own.
+    bool NeedsSlot = getNumIssueUnits(Itins, Order[i]) != ~0U;
+    Fits = (!NeedsSlot || !HazardRec->atIssueLimit()) &&
+      HazardRec->getHazardType(&Member, 0) ==
+        ScheduleHazardRecognizer::NoHazard;
+    if (Fits)
+      HazardRec->EmitInstruction(&Member);
+  }
+  HazardRec->Reset();
+  return Fits;
+}
+
+/// ReleaseSucc - Decrement the NumPredsLeft count of a successor. Add it to
+/// the PendingQueue if the count reaches zero. Also update its cycle bound.
+void VLIWScheduler::ReleaseSucc(SUnit *SU, SDep *SuccEdge) {
+  SUnit *SuccSU = SuccEdge->getSUnit();
+  --SuccSU->NumPredsLeft;
+
+  // A value produced in a bundle is not visible inside that bundle.
+  unsigned Latency = SuccEdge->getLatency();
+  if (Latency == 0 &&
+      (SuccEdge->getKind() == SDep::Data ||
+       SuccEdge->getKind() == SDep::Output))
+    Latency = 1;
+  SuccSU->setDepthToAtLeast(SU->getDepth() + Latency);
+
+  if (SuccSU->NumPredsLeft == 0 && SuccSU != &ExitSU)
+    PendingQueue.push_back(SuccSU);
+}
+
+/// ReleaseSuccessors - Call ReleaseSucc on each of SU's successors.
+void VLIWScheduler::ReleaseSuccessors(SUnit *SU) {
+  for (SUnit::succ_iterator I = SU->Succs.begin(), E = SU->Succs.end();
+       I != E; ++I)
+    ReleaseSucc(SU, &*I);
+}
+
+/// ScheduleNodeTopDown - Add the node to the schedule in bundle CurCycle.
+void VLIWScheduler::ScheduleNodeTopDown(SUnit *SU, unsigned CurCycle) {
+  DEBUG(dbgs() << "*** Bundling [" << CurCycle << "]: ");
+  DEBUG(SU->dump(this));
+
+  Sequence.push_back(SU);
+  assert(CurCycle >= SU->getDepth() && "Node scheduled above its depth!");
+  SU->setDepthToAtLeast(CurCycle);
+  Cycles[SU->NodeNum] = CurCycle;
+
+  ReleaseSuccessors(SU);
+  SU->isScheduled = true;
+  AvailableQueue.ScheduledNode(SU);
+}
+
+/// ListScheduleTopDown - Fill bundles one cycle at a time.
+void VLIWScheduler::ListScheduleTopDown() {
+  unsigned CurCycle = 0;
+  unsigned IssuedInCycle = 0;
+  bool CycleClosed = false;
+
+  HazardRec->Reset();
+
+  // Release any successors of the special Entry node.
+  ReleaseSuccessors(&EntrySU);
+
+  // Add all leaves to Available queue.
+  for (unsigned i = 0, e = SUnits.size(); i != e; ++i) {
+    if (SUnits[i].Preds.empty()) {
+      AvailableQueue.push(&SUnits[i]);
+      SUnits[i].isAvailable = true;
+    }
+  }
+
+  std::vector<SUnit*> NotReady;
+  Sequence.reserve(SUnits.size());
+  while (!AvailableQueue.empty() || !PendingQueue.empty()) {
+    // Move the instructions whose operands are ready by now.
+    for (unsigned i = 0, e = PendingQueue.size(); i != e; ++i) {
+      if (PendingQueue[i]->getDepth() <= CurCycle) {
+        AvailableQueue.push(PendingQueue[i]);
+        PendingQueue[i]->isAvailable = true;
+        PendingQueue[i] = PendingQueue.back();
+        PendingQueue.pop_back();
+        --i; --e;
+      }
+    }
+
+    SUnit *FoundSUnit = 0;
+    bool CycleFull = CycleClosed || HazardRec->atIssueLimit();
+    while (!AvailableQueue.empty()) {
+      SUnit *CurSUnit = AvailableQueue.pop();
+      MachineInstr *MI = CurSUnit->getInstr();
+
+      if (!VLIWPacketizerList::emitsCode(MI)) {
+        FoundSUnit = CurSUnit;
+        break;
+      }
+      if (!CycleFull &&
+          (IssuedInCycle == 0 || !Packetizer.isSoloInstruction(MI)) &&
+          HazardRec->getHazardType(CurSUnit, 0) ==
+            ScheduleHazardRecognizer::NoHazard) {
+        FoundSUnit = CurSUnit;
+        break;
+      }
+      NotReady.push_back(CurSUnit);
+    }
+
+    if (!NotReady.empty()) {
+      AvailableQueue.push_all(NotReady);
+      NotReady.clear();
+    }
+
+    if (FoundSUnit) {
+      ScheduleNodeTopDown(FoundSUnit, CurCycle);
+      MachineInstr *MI = FoundSUnit->getInstr();
+      if (VLIWPacketizerList::emitsCode(MI)) {
+        HazardRec->EmitInstruction(FoundSUnit);
+        ++IssuedInCycle;
+        if (Packetizer.isSoloInstruction(MI) || Packetizer.endsPacket(MI))
+          CycleClosed = true;
+      }
+      continue;
+    }
+
+    // Nothing else fits in this bundle; start the next one.
+    DEBUG(dbgs() << "*** Finished bundle " << CurCycle << '\n');
+    HazardRec->AdvanceCycle();
+    ++CurCycle;
+    IssuedInCycle = 0;
+    CycleClosed = false;
+  }
+
+#ifndef NDEBUG
+  VerifySchedule(/*isBottomUp=*/false);
+#endif
+}
+
+//===----------------------------------------------------------------------===//
+// VLIWPacketizerList
+//===----------------------------------------------------------------------===//
+
+VLIWPacketizerList::VLIWPacketizerList(MachineFunction &mf,
+                                       MachineLoopInfo &MLI,
+                                       MachineDominatorTree &MDT,
+                                       AliasAnalysis *AA)
+  : NextPacket(0), MF(mf), TII(mf.getTarget().getInstrInfo()),
+    TRI(mf.getTarget().getRegisterInfo()),
+    InstrItins(mf.getTarget().getInstrItineraryData()) {
+  Scheduler = new VLIWScheduler(MF, MLI, MDT, AA, *this);
+}
+
+VLIWPacketizerList::~VLIWPacketizerList() {
+  delete Scheduler;
+}
+
+bool VLIWPacketizerList::emitsCode(const MachineInstr *MI) {
+  return !MI->isLabel() && !MI->isDebugValue() && !MI->isKill() &&
+         !MI->isImplicitDef();
+}
+
+bool VLIWPacketizerList::isSoloInstruction(const MachineInstr *MI) const {
+  return MI->isInlineAsm() || MI->getDesc().hasUnmodeledSideEffects();
+}
+
+bool VLIWPacketizerList::endsPacket(const MachineInstr *MI) const {
+  const TargetInstrDesc &TID = MI->getDesc();
+  return TID.isCall() || TID.isBranch() || TID.isReturn();
+}
+
+unsigned VLIWPacketizerList::PacketizeBlock(MachineBasicBlock *MBB) {
+  if (!InstrItins || InstrItins->isEmpty() || InstrItins->IssueWidth < 2)
+    return 0;
+
+  PacketOf.clear();
+  NextPacket = 0;
+  Scheduler->StartBlock(MBB);
+
+  // Schedule each sequence of instructions not interrupted by a label or a
+  // terminator, the same way the post-RA scheduler splits a block.
+  MachineBasicBlock::iterator Current = MBB->end();
+  unsigned Count = MBB->size(), CurrentCount = Count;
+  for (MachineBasicBlock::iterator I = Current; I != MBB->begin(); ) {
+    MachineInstr *MI = llvm::prior(I);
+    if (TII->isSchedulingBoundary(MI, MBB, MF)) {
+      scheduleRegion(MBB, I, Current, CurrentCount);
+      Current = MI;
+      CurrentCount = Count - 1;
+    }
+    I = MI;
+    --Count;
+  }
+  scheduleRegion(MBB, MBB->begin(), Current, CurrentCount);
+
+  Scheduler->FinishBlock();
+  return formBundles(MBB);
+}
+
+void VLIWPacketizerList::scheduleRegion(MachineBasicBlock *MBB,
+                                        MachineBasicBlock::iterator Begin,
+                                        MachineBasicBlock::iterator End,
+                                        unsigned EndCount) {
+  if (Begin == End)
+    return;
+
+  SmallVector<MachineInstr*, 32> OldOrder;
+  for (MachineBasicBlock::iterator I = Begin; I != End; ++I)
+    if (!I->isDebugValue())
+      OldOrder.push_back(I);
+
+  Scheduler->Run(MBB, Begin, End, EndCount);
+  Scheduler->EmitSchedule();
+
+  const std::vector<SUnit*> &Sequence = Scheduler->Sequence;
+  unsigned Bundles = 0;
+  for (unsigned i = 0, e = Sequence.size(); i != e; ++i) {
+    unsigned Cycle = Scheduler->Cycles[Sequence[i]->NodeNum];
+    PacketOf[Sequence[i]->getInstr()] = NextPacket + Cycle;
+    Bundles = std::max(Bundles, Cycle + 1);
+  }
+  NextPacket += Bundles;
+
+  // Kill flags are only valid in the original order.
+  bool Moved = false;
+  for (unsigned i = 0, e = Sequence.size(); i != e && !Moved; ++i)
+    Moved = i >= OldOrder.size() || Sequence[i]->getInstr() != OldOrder[i];
+  if (!Moved)
+    return;
+  for (unsigned i = 0, e = Sequence.size(); i != e; ++i) {
+    MachineInstr *MI = Sequence[i]->getInstr();
+    for (unsigned j = 0, je = MI->getNumOperands(); j != je; ++j) {
+      MachineOperand &MO = MI->getOperand(j);
+      if (MO.isReg() && MO.isUse())
+        MO.setIsKill(false);
+    }
+  }
+}
+
+/// canJoinBundle - A scheduling boundary such as a branch was not scheduled
+/// with the region before it, but may still issue with the last bundle of
+/// that region if nothing in the bundle feeds it.
+bool VLIWPacketizerList::
+canJoinBundle(const SmallVectorImpl<MachineInstr*> &Bundle,
+              MachineInstr *MI) const {
+  if (Bundle.empty() || isSoloInstruction(MI))
+    return false;
+
+  const TargetInstrDesc &TID = MI->getDesc();
+  for (unsigned i = 0, e = Bundle.size(); i != e; ++i) {
+    MachineInstr *Member = Bundle[i];
+    if (isSoloInstruction(Member) || endsPacket(Member))
+      return false;
+
+    const TargetInstrDesc &MemberTID = Member->getDesc();
+    if ((TID.mayStore() && (MemberTID.mayLoad() || MemberTID.mayStore())) ||
+        (TID.mayLoad() && MemberTID.mayStore()))
+      return false;
+
+    for (unsigned j = 0, je = MI->getNumOperands(); j != je; ++j) {
+      const MachineOperand &MO = MI->getOperand(j);
+      if (MO.isReg() && MO.getReg() &&
+          Member->modifiesRegister(MO.getReg(), TRI))
+        return false;
+    }
+  }
+
+  return Scheduler->fitsInBundle(Bundle, MI);
+}
+
+unsigned VLIWPacketizerList::formBundles(MachineBasicBlock *MBB) {
+  unsigned Bundled = 0;
+  SmallVector<MachineInstr*, 4> Bundle;
+  unsigned CurPacket = ~0U;
+
+  for (MachineBasicBlock::iterator I = MBB->begin(), E = MBB->end();
+       I != E; ++I) {
+    MachineInstr *MI = I;
+    MI->clearFlag(MachineInstr::InsideBundle);
+
+    // Labels mark addresses, so nothing may be bundled across them.
+    if (MI->isLabel()) {
+      Bundle.clear();
+      CurPacket = ~0U;
+      continue;
+    }
+    if (!emitsCode(MI))
+      continue;
+
+    bool Join;
+    DenseMap<MachineInstr*, unsigned>::iterator P = PacketOf.find(MI);
+    if (P != PacketOf.end()) {
+      Join = !Bundle.empty() && P->second == CurPacket;
+      CurPacket = P->second;
+    } else {
+      Join = canJoinBundle(Bundle, MI);
+      if (!Join)
+        CurPacket = ~0U;
+    }
+
+    if (!Join) {
+      Bundle.clear();
+      Bundle.push_back(MI);
+      continue;
+    }
+
+    if (Bundle.size() == 1)
+      ++NumBundles;
+    MI->setFlag(MachineInstr::InsideBundle);
+    Bundle.push_back(MI);
+    ++Bundled;
+  }
+
+  NumBundled += Bundled;
+  return Bundled;
+}
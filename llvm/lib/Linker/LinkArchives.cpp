@@ -165,9 +165,6 @@ Linker::LinkInArchive(const sys::Path &Filename, bool &is_native) {
       std::string moduleErrorMsg;
       Module* aModule = *I;
       if (aModule != NULL) {
-        if (aModule->MaterializeAll(&moduleErrorMsg))
-          return error("Could not load a module: " + moduleErrorMsg);
-
         verbose("  Linking in module: " + aModule->getModuleIdentifier());
 
         // Link it in
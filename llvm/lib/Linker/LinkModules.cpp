@@ -40,6 +40,12 @@ static inline bool Error(std::string *E, const Twine &Message) {
   return true;
 }
 
+// isDefinition - Return true if GV has a body or an initializer.  The body of a
+// function in a module that is read lazily may still be in the bitcode file.
+static bool isDefinition(const GlobalValue *GV) {
+  return !GV->isDeclaration() || GV->isMaterializable();
+}
+
 // Function: ResolveTypes()
 //
 // Description:
@@ -370,7 +376,7 @@ static bool GetLinkageResult(GlobalValue *Dest, const GlobalValue *Src,
     // Linking something to nothing.
     LinkFromSrc = true;
     LT = Src->getLinkage();
-  } else if (Src->isDeclaration()) {
+  } else if (!isDefinition(Src)) {
     // If Src is external or if both Src & Dest are external..  Just link the
     // external globals, we aren't adding anything.
     if (Src->hasDLLImportLinkage()) {
@@ -435,7 +441,7 @@ static bool GetLinkageResult(GlobalValue *Dest, const GlobalValue *Src,
 
   // Check visibility
   if (Dest && Src->getVisibility() != Dest->getVisibility() &&
-      !Src->isDeclaration() && !Dest->isDeclaration() &&
+      isDefinition(Src) && !Dest->isDeclaration() &&
       !Src->hasAvailableExternallyLinkage() &&
       !Dest->hasAvailableExternallyLinkage())
       return Error(Err, "Linking globals named '" + Src->getName() +
@@ -965,7 +971,7 @@ static bool LinkFunctionProtos(Module *Dest, const Module *Src,
       // The only valid mappings are:
       // - SF is external declaration, which is effectively a no-op.
       // - SF is weak, when we just need to throw SF out.
-      if (!SF->isDeclaration() && !SF->isWeakForLinker())
+      if (isDefinition(SF) && !SF->isWeakForLinker())
         return Error(Err, "Function-Alias Collision on '" + SF->getName() +
                      "': symbol multiple defined");
     }
@@ -1018,25 +1024,58 @@ static bool LinkFunctionBody(Function *Dest, Function *Src,
 
 
 // LinkFunctionBodies - Link in the function bodies that are defined in the
-// source module into the DestModule.  This consists basically of copying the
+// source module into the DestModule.  This consists basically of moving the
 // function over and fixing up references to values.
+//
+// If the source module is read lazily, a body is only read from its file once
+// it is moved, so that no more than one body at a time is read and not yet
+// linked.  Bodies the destination module already has are never read.  Neither
+// are local bodies nothing links to: their prototypes are added to Unlinked.
 static bool LinkFunctionBodies(Module *Dest, Module *Src,
                                ValueToValueMapTy &ValueMap,
+                               std::vector<Function*> &Unlinked,
                                std::string *Err) {
+  std::vector<std::pair<Function*, Function*> > Unread;
 
   // Loop over all of the functions in the src module, mapping them over as we
   // go
   for (Module::iterator SF = Src->begin(), E = Src->end(); SF != E; ++SF) {
-    if (!SF->isDeclaration()) {               // No body if function is external
+    if (isDefinition(SF)) {                   // No body if function is external
       Function *DF = dyn_cast<Function>(ValueMap[SF]); // Destination function
 
-      // DF not external SF external?
-      if (DF && DF->isDeclaration())
-        // Only provide the function body if there isn't one already.
-        if (LinkFunctionBody(DF, SF, ValueMap, Err))
-          return true;
+      // DF not external SF external?  Only provide the function body if there
+      // isn't one already.
+      if (!DF || !DF->isDeclaration())
+        continue;
+
+      if (SF->isMaterializable() && (SF->hasLocalLinkage() ||
+                                     SF->hasAvailableExternallyLinkage())) {
+        Unread.push_back(std::make_pair(&*SF, DF));
+        continue;
+      }
+
+      if (SF->Materialize(Err) || LinkFunctionBody(DF, SF, ValueMap, Err))
+        return true;
     }
   }
+
+  // Each body that is linked in can use more of the local ones.
+  for (bool Changed = true; Changed; ) {
+    Changed = false;
+    for (unsigned i = 0; i != Unread.size(); ++i) {
+      Function *SF = Unread[i].first, *DF = Unread[i].second;
+      if (DF->use_empty())
+        continue;
+      if (SF->Materialize(Err) || LinkFunctionBody(DF, SF, ValueMap, Err))
+        return true;
+      Unread[i--] = Unread.back();
+      Unread.pop_back();
+      Changed = true;
+    }
+  }
+
+  for (unsigned i = 0, e = Unread.size(); i != e; ++i)
+    Unlinked.push_back(Unread[i].second);
   return false;
 }
 
@@ -1274,9 +1313,10 @@ Linker::LinkModules(Module *Dest, Module *Src, std::string *ErrorMsg) {
   if (LinkGlobalInits(Dest, Src, ValueMap, ErrorMsg)) return true;
 
   // Link in the function bodies that are defined in the source module into the
-  // DestModule.  This consists basically of copying the function over and
+  // DestModule.  This consists basically of moving the function over and
   // fixing up references to values.
-  if (LinkFunctionBodies(Dest, Src, ValueMap, ErrorMsg)) return true;
+  std::vector<Function*> Unlinked;
+  if (LinkFunctionBodies(Dest, Src, ValueMap, Unlinked, ErrorMsg)) return true;
 
   // If there were any appending global variables, link them together now.
   if (LinkAppendingVars(Dest, AppendingVars, ErrorMsg)) return true;
@@ -1289,6 +1329,11 @@ Linker::LinkModules(Module *Dest, Module *Src, std::string *ErrorMsg) {
   // are properly remapped.
   LinkNamedMDNodes(Dest, Src, ValueMap);
 
+  // The prototypes of the local functions that were not linked go away now,
+  // which leaves nulls where metadata refers to them.
+  for (unsigned i = 0, e = Unlinked.size(); i != e; ++i)
+    Unlinked[i]->eraseFromParent();
+
   // If the source library's module id is in the dependent library list of the
   // destination library, remove it since that module is now linked in.
   const std::string &modId = Src->getModuleIdentifier();
@@ -103,8 +103,9 @@ Linker::LoadObject(const sys::Path &FN) {
   if (error_code ec = MemoryBuffer::getFileOrSTDIN(FN.c_str(), Buffer))
     ParseErrorMessage = "Error reading file '" + FN.str() + "'" + ": "
                       + ec.message();
-  else
-    Result = ParseBitcodeFile(Buffer.get(), Context, &ParseErrorMessage);
+  else if ((Result = getLazyBitcodeModule(Buffer.get(), Context,
+                                          &ParseErrorMessage)))
+    Buffer.take(); // The module reads its function bodies from the buffer.
 
   if (Result)
     return std::auto_ptr<Module>(Result);
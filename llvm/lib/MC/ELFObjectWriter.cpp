@@ -28,6 +28,7 @@
 
 #include "../Target/X86/X86FixupKinds.h"
 #include "../Target/ARM/ARMFixupKinds.h"
+#include "../Target/MDSP/MDSPFixupKinds.h"
 
 #include <vector>
 using namespace llvm;
@@ -1106,6 +1107,8 @@ MCObjectWriter *llvm::createELFObjectWriter(MCELFObjectTargetWriter *MOTW,
       return new ARMELFObjectWriter(MOTW, OS, IsLittleEndian); break;
     case ELF::EM_MBLAZE:
       return new MBlazeELFObjectWriter(MOTW, OS, IsLittleEndian); break;
+    case ELF::EM_MDSP:
+      return new MDSPELFObjectWriter(MOTW, OS, IsLittleEndian); break;
     default: llvm_unreachable("Unsupported architecture"); break;
   }
 }
@@ -1319,6 +1322,54 @@ unsigned MBlazeELFObjectWriter::GetRelocType(const MCValue &Target,
   return Type;
 }
 
+//===- MDSPELFObjectWriter ---------------------------------------------===//
+
+MDSPELFObjectWriter::MDSPELFObjectWriter(MCELFObjectTargetWriter *MOTW,
+                                         raw_ostream &_OS,
+                                         bool IsLittleEndian)
+  : ELFObjectWriter(MOTW, _OS, IsLittleEndian) {
+}
+
+MDSPELFObjectWriter::~MDSPELFObjectWriter() {
+}
+
+unsigned MDSPELFObjectWriter::GetRelocType(const MCValue &Target,
+                                           const MCFixup &Fixup,
+                                           bool IsPCRel,
+                                           bool IsRelocWithSymbol,
+                                           int64_t Addend) {
+  // determine the type of the relocation
+  unsigned Type;
+  if (IsPCRel) {
+    switch ((unsigned)Fixup.getKind()) {
+    default: llvm_unreachable("invalid fixup kind!");
+    case FK_PCRel_4:
+      Type = ELF::R_MDSP_PC32;
+      break;
+    case MDSP::fixup_mdsp_pc16:
+      Type = ELF::R_MDSP_PC16;
+      break;
+    case MDSP::fixup_mdsp_pc26:
+      Type = ELF::R_MDSP_PC26;
+      break;
+    }
+  } else {
+    switch ((unsigned)Fixup.getKind()) {
+    default: llvm_unreachable("invalid fixup kind!");
+    case FK_Data_4:
+      Type = ELF::R_MDSP_32;
+      break;
+    case MDSP::fixup_mdsp_hi16:
+      Type = ELF::R_MDSP_HI16;
+      break;
+    case MDSP::fixup_mdsp_lo16:
+      Type = ELF::R_MDSP_LO16;
+      break;
+    }
+  }
+  return Type;
+}
+
 //===- X86ELFObjectWriter -------------------------------------------===//
 
 
@@ -19,6 +19,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/ELF.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
 typedef StringMap<const MCSectionMachO*> MachOUniqueMapTy;
@@ -84,8 +85,8 @@ MCSymbol *MCContext::CreateSymbol(StringRef Name) {
     assert(isTemporary && "Cannot rename non temporary symbols");
     SmallString<128> NewName;
     do {
-      Twine T = Name + Twine(NextUniqueID++);
-      T.toVector(NewName);
+      NewName.clear();
+      raw_svector_ostream(NewName) << Name << NextUniqueID++;
       StringRef foo = NewName;
       NameEntry = &UsedNames.GetOrCreateValue(foo);
     } while (NameEntry->getValue());
@@ -107,9 +108,8 @@ MCSymbol *MCContext::GetOrCreateSymbol(const Twine &Name) {
 
 MCSymbol *MCContext::CreateTempSymbol() {
   SmallString<128> NameSV;
-  Twine Name = Twine(MAI.getPrivateGlobalPrefix()) + "tmp" +
-    Twine(NextUniqueID++);
-  Name.toVector(NameSV);
+  raw_svector_ostream(NameSV)
+    << MAI.getPrivateGlobalPrefix() << "tmp" << NextUniqueID++;
   return CreateSymbol(NameSV);
 }
 
@@ -37,6 +37,8 @@ void MCOperand::dump() const {
 
 void MCInst::print(raw_ostream &OS, const MCAsmInfo *MAI) const {
   OS << "<MCInst " << getOpcode();
+  if (getFlags())
+    OS << " flags:" << getFlags();
   for (unsigned i = 0, e = getNumOperands(); i != e; ++i) {
     OS << " ";
     getOperand(i).print(OS, MAI);
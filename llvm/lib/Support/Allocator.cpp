@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Atomic.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Recycler.h"
 #include "llvm/Support/raw_ostream.h"
@@ -23,10 +24,11 @@ namespace llvm {
 BumpPtrAllocator::BumpPtrAllocator(size_t size, size_t threshold,
                                    SlabAllocator &allocator)
     : SlabSize(size), SizeThreshold(threshold), Allocator(allocator),
-      CurSlab(0), BytesAllocated(0) { }
+      CurSlab(0), FreeSlabs(0), BytesAllocated(0) { }
 
 BumpPtrAllocator::~BumpPtrAllocator() {
   DeallocateSlabs(CurSlab);
+  DeallocateSlabs(FreeSlabs);
 }
 
 /// AlignPtr - Align Ptr to Alignment bytes, rounding up.  Alignment should
@@ -50,7 +52,9 @@ void BumpPtrAllocator::StartNewSlab() {
   if (BytesAllocated >= SlabSize * 128)
     SlabSize *= 2;
 
-  MemSlab *NewSlab = Allocator.Allocate(SlabSize);
+  MemSlab *NewSlab = TakeFreeSlab(SlabSize);
+  if (!NewSlab)
+    NewSlab = Allocator.Allocate(SlabSize);
   NewSlab->NextPtr = CurSlab;
   CurSlab = NewSlab;
   CurPtr = (char*)(CurSlab + 1);
@@ -73,6 +77,48 @@ void BumpPtrAllocator::DeallocateSlabs(MemSlab *Slab) {
   }
 }
 
+/// TakeFreeSlab - Remove a slab of at least MinSize bytes from FreeSlabs and
+/// return it, or return null if there is none.  Recycled slabs that are
+/// smaller than the slab size has grown to are released on the way.
+MemSlab *BumpPtrAllocator::TakeFreeSlab(size_t MinSize) {
+  for (MemSlab **Prev = &FreeSlabs; MemSlab *Slab = *Prev; ) {
+    if (Slab->Size >= MinSize) {
+      *Prev = Slab->NextPtr;
+      Slab->NextPtr = 0;
+      return Slab;
+    }
+    if (Slab->Size < SlabSize) {
+      *Prev = Slab->NextPtr;
+      Allocator.Deallocate(Slab);
+      continue;
+    }
+    Prev = &Slab->NextPtr;
+  }
+  return 0;
+}
+
+/// Recycle - Like Reset, but keep every slab for the allocations that follow
+/// instead of returning them to the slab allocator.
+void BumpPtrAllocator::Recycle() {
+  if (!CurSlab)
+    return;
+  MemSlab *Slab = CurSlab->NextPtr;
+  while (Slab) {
+    MemSlab *NextSlab = Slab->NextPtr;
+#ifndef NDEBUG
+    // Poison the memory so stale pointers crash sooner, as DeallocateSlabs
+    // does.
+    memset(Slab + 1, 0xCD, Slab->Size - sizeof(MemSlab));
+#endif
+    Slab->NextPtr = FreeSlabs;
+    FreeSlabs = Slab;
+    Slab = NextSlab;
+  }
+  CurSlab->NextPtr = 0;
+  CurPtr = (char*)(CurSlab + 1);
+  End = ((char*)CurSlab) + CurSlab->Size;
+}
+
 /// Reset - Deallocate all but the current slab and reset the current pointer
 /// to the beginning of it, freeing all memory allocated so far.
 void BumpPtrAllocator::Reset() {
@@ -108,7 +154,9 @@ void *BumpPtrAllocator::Allocate(size_t Size, size_t Alignment) {
   // If Size is really big, allocate a separate slab for it.
   size_t PaddedSize = Size + sizeof(MemSlab) + Alignment - 1;
   if (PaddedSize > SizeThreshold) {
-    MemSlab *NewSlab = Allocator.Allocate(PaddedSize);
+    MemSlab *NewSlab = FreeSlabs ? TakeFreeSlab(PaddedSize) : 0;
+    if (!NewSlab)
+      NewSlab = Allocator.Allocate(PaddedSize);
 
     // Put the new slab after the current slab, since we are not allocating
     // into it.
@@ -158,7 +206,16 @@ SlabAllocator::~SlabAllocator() { }
 
 MallocSlabAllocator::~MallocSlabAllocator() { }
 
+/// TotalSlabBytes - The number of bytes handed out as slabs, for
+/// MallocSlabAllocator::getTotalSlabBytes.
+static volatile sys::cas_flag TotalSlabBytes = 0;
+
+size_t MallocSlabAllocator::getTotalSlabBytes() {
+  return TotalSlabBytes;
+}
+
 MemSlab *MallocSlabAllocator::Allocate(size_t Size) {
+  sys::AtomicAdd(&TotalSlabBytes, (sys::cas_flag)Size);
   MemSlab *Slab = (MemSlab*)Allocator.Allocate(Size, 0);
   Slab->Size = Size;
   Slab->NextPtr = 0;
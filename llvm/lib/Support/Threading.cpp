@@ -16,6 +16,7 @@
 #include "llvm/Support/Mutex.h"
 #include "llvm/Config/config.h"
 #include <cassert>
+#include <vector>
 
 using namespace llvm;
 
@@ -103,6 +104,45 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
   ::pthread_attr_destroy(&Attr);
 }
 
+void llvm::llvm_execute_in_parallel(void (*Fn)(void*), void **UserData,
+                                    unsigned NumThreads,
+                                    unsigned RequestedStackSize) {
+  if (NumThreads == 0)
+    return;
+
+  std::vector<ThreadInfo> Info(NumThreads);
+  std::vector<pthread_t> Threads(NumThreads);
+  std::vector<bool> Started(NumThreads, false);
+  pthread_attr_t Attr;
+
+  bool HaveAttr = ::pthread_attr_init(&Attr) == 0;
+  if (HaveAttr && RequestedStackSize != 0 &&
+      ::pthread_attr_setstacksize(&Attr, RequestedStackSize) != 0) {
+    ::pthread_attr_destroy(&Attr);
+    HaveAttr = false;
+  }
+
+  for (unsigned i = 1; HaveAttr && i != NumThreads; ++i) {
+    Info[i].UserFn = Fn;
+    Info[i].UserData = UserData[i];
+    Started[i] = ::pthread_create(&Threads[i], &Attr, ExecuteOnThread_Dispatch,
+                                  &Info[i]) == 0;
+  }
+
+  // Make the calls that did not get a thread of their own here.
+  Fn(UserData[0]);
+  for (unsigned i = 1; i != NumThreads; ++i)
+    if (!Started[i])
+      Fn(UserData[i]);
+
+  for (unsigned i = 1; i != NumThreads; ++i)
+    if (Started[i])
+      ::pthread_join(Threads[i], 0);
+
+  if (HaveAttr)
+    ::pthread_attr_destroy(&Attr);
+}
+
 #else
 
 // No non-pthread implementation, currently.
@@ -113,4 +153,12 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
   Fn(UserData);
 }
 
+void llvm::llvm_execute_in_parallel(void (*Fn)(void*), void **UserData,
+                                    unsigned NumThreads,
+                                    unsigned RequestedStackSize) {
+  (void) RequestedStackSize;
+  for (unsigned i = 0; i != NumThreads; ++i)
+    Fn(UserData[i]);
+}
+
 #endif
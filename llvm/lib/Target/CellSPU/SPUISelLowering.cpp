@@ -3241,6 +3241,8 @@ bool SPUTargetLowering::isLegalICmpImmediate(int64_t Imm) const {
 bool
 SPUTargetLowering::isLegalAddressingMode(const AddrMode &AM,
                                          const Type * ) const{
+  if (AM.IsCircular)
+    return false;
 
   // A-form: 18bit absolute address.
   if (AM.BaseGV && !AM.HasBaseReg && AM.Scale == 0 && AM.BaseOffs == 0)
@@ -0,0 +1,109 @@
+//===-- MDSPInstPrinter.cpp - Convert MDSP MCInst to assembly syntax ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class prints a MDSP MCInst to a .s file.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "asm-printer"
+#include "MDSP.h"
+#include "MDSPInstPrinter.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCExpr.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormattedStream.h"
+using namespace llvm;
+
+
+// Include the auto-generated portion of the assembly writer.
+#include "MDSPGenAsmWriter.inc"
+
+void MDSPInstPrinter::printInst(const MCInst *MI, raw_ostream &O) {
+  if (MI->getFlags() & MDSP::Parallel)
+    O << "||";
+  printInstruction(MI, O);
+}
+
+void MDSPInstPrinter::printPCRelImmOperand(const MCInst *MI, unsigned OpNo,
+                                           raw_ostream &O) {
+  const MCOperand &Op = MI->getOperand(OpNo);
+  if (Op.isImm())
+    O << Op.getImm();
+  else {
+    assert(Op.isExpr() && "unknown pcrel immediate operand");
+    O << *Op.getExpr();
+  }
+}
+
+void MDSPInstPrinter::printOperand(const MCInst *MI, unsigned OpNo,
+                                   raw_ostream &O, const char *Modifier) {
+  assert((Modifier == 0 || Modifier[0] == 0) && "No modifiers supported");
+  const MCOperand &Op = MI->getOperand(OpNo);
+  if (Op.isReg()) {
+    O << getRegisterName(Op.getReg());
+  } else if (Op.isImm()) {
+    O << Op.getImm();
+  } else {
+    assert(Op.isExpr() && "unknown operand kind in printOperand");
+    O << *Op.getExpr();
+  }
+}
+
+void MDSPInstPrinter::printMemOperand(const MCInst *MI, unsigned OpNo,
+                                     raw_ostream &O) {
+  const MCOperand &Base = MI->getOperand(OpNo);
+  const MCOperand &Disp = MI->getOperand(OpNo+1);
+
+  // Print displacement first
+  if (Disp.isExpr())
+    O << "%lo(" << *Disp.getExpr() << ')';
+  else {
+    assert(Disp.isImm() && "Expected immediate in displacement field");
+    O << Disp.getImm();
+  }
+
+  // Print register base field
+  O << '(' << getRegisterName(Base.getReg()) << ')';
+}
+
+/// printCircMemOperand - Print a circular buffer address as
+/// '(base)[index%length]'.
+void MDSPInstPrinter::printCircMemOperand(const MCInst *MI, unsigned OpNo,
+                                         raw_ostream &O) {
+  O << '(' << getRegisterName(MI->getOperand(OpNo).getReg()) << ")["
+    << getRegisterName(MI->getOperand(OpNo+1).getReg()) << '%'
+    << getRegisterName(MI->getOperand(OpNo+2).getReg()) << ']';
+}
+
+/// printHi16Operand - Print the operand of 'movhi'. Symbolic operands stand
+/// for the upper half of their address.
+void MDSPInstPrinter::printHi16Operand(const MCInst *MI, unsigned OpNo,
+                                      raw_ostream &O) {
+  const MCOperand &Op = MI->getOperand(OpNo);
+  if (Op.isImm())
+    O << Op.getImm();
+  else {
+    assert(Op.isExpr() && "unknown operand kind in printHi16Operand");
+    O << "%hi(" << *Op.getExpr() << ')';
+  }
+}
+
+/// printLo16Operand - Print an unsigned 16-bit operand. Symbolic operands
+/// stand for the lower half of their address.
+void MDSPInstPrinter::printLo16Operand(const MCInst *MI, unsigned OpNo,
+                                      raw_ostream &O) {
+  const MCOperand &Op = MI->getOperand(OpNo);
+  if (Op.isImm())
+    O << Op.getImm();
+  else {
+    assert(Op.isExpr() && "unknown operand kind in printLo16Operand");
+    O << "%lo(" << *Op.getExpr() << ')';
+  }
+}
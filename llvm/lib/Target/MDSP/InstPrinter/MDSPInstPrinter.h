@@ -0,0 +1,43 @@
+//===-- MDSPInstPrinter.h - Convert MDSP MCInst to assembly syntax -*- C++ -*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This class prints a MDSP MCInst to a .s file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MDSPINSTPRINTER_H
+#define MDSPINSTPRINTER_H
+
+#include "llvm/MC/MCInstPrinter.h"
+
+namespace llvm {
+  class MCOperand;
+
+  class MDSPInstPrinter : public MCInstPrinter {
+  public:
+    MDSPInstPrinter(const MCAsmInfo &MAI) : MCInstPrinter(MAI) {
+    }
+
+    virtual void printInst(const MCInst *MI, raw_ostream &O);
+
+    // Autogenerated by tblgen.
+    void printInstruction(const MCInst *MI, raw_ostream &O);
+    static const char *getRegisterName(unsigned RegNo);
+
+    void printOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O,
+                      const char *Modifier = 0);
+    void printPCRelImmOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+    void printMemOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+    void printCircMemOperand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+    void printHi16Operand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+    void printLo16Operand(const MCInst *MI, unsigned OpNo, raw_ostream &O);
+  };
+}
+
+#endif
@@ -1,15 +1,65 @@
+//===-- MDSP.h - Top-level interface for MDSP representation ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the entry points for global functions defined in
+// the LLVM MDSP backend.
+//
+//===----------------------------------------------------------------------===//
+
 #ifndef MDSP_H
 #define MDSP_H
 
-
 #include "llvm/Target/TargetMachine.h"
+
 namespace llvm {
   class MDSPTargetMachine;
+  class FunctionPass;
+  class MCCodeEmitter;
+  class MCContext;
+  class TargetAsmBackend;
+
+  FunctionPass *createMDSPISelDag(MDSPTargetMachine &TM,
+                                  CodeGenOpt::Level OptLevel);
+  FunctionPass *createMDSPPacketizer(MDSPTargetMachine &TM);
+  FunctionPass *createMDSPHardwareLoopPrep();
+  FunctionPass *createMDSPHardwareLoops(MDSPTargetMachine &TM);
+
+  MCCodeEmitter *createMDSPMCCodeEmitter(const Target &,
+                                         TargetMachine &TM,
+                                         MCContext &Ctx);
+  TargetAsmBackend *createMDSPAsmBackend(const Target &, const std::string &);
+
+  namespace MDSP {
+    /// MCInst flags.
+    enum {
+      /// Parallel - The instruction issues in the same cycle as the
+      /// instruction before it.
+      Parallel = 1 << 0,
+
+      /// PacketSizeShift - The first instruction of a packet carries the
+      /// number of instructions in the packet in the flags above this bit.
+      PacketSizeShift = 1
+    };
+
+    /// PacketHeaderOpcode - The primary opcode of the word that the code
+    /// emitter places in front of a packet of more than one instruction.
+    enum { PacketHeaderOpcode = 0x3f };
+  }
 
   extern Target TheMDSPTarget;
 } // end namespace llvm
 
+// Defines symbolic names for MDSP registers.
+// This defines a mapping from register name to register number.
+#include "MDSPGenRegisterNames.inc"
 
-
+// Defines symbolic names for the MDSP instructions.
+#include "MDSPGenInstrNames.inc"
 
 #endif
@@ -0,0 +1,117 @@
+//===-- MDSPAsmBackend.cpp - MDSP Assembler Backend -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Target/TargetAsmBackend.h"
+#include "MDSP.h"
+#include "MDSPFixupKinds.h"
+#include "llvm/MC/MCELFObjectWriter.h"
+#include "llvm/MC/MCObjectWriter.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Target/TargetRegistry.h"
+using namespace llvm;
+
+/// adjustFixupValue - Turn the resolved value of a fixup into the bits of the
+/// instruction field it patches.
+static unsigned adjustFixupValue(unsigned Kind, uint64_t Value) {
+  switch (Kind) {
+  default: llvm_unreachable("Unknown fixup kind!");
+  case FK_Data_4:
+  case FK_PCRel_4:
+    return Value;
+  case MDSP::fixup_mdsp_pc16:
+    // Branch offsets count instruction words.
+    return (Value >> 2) & 0xffff;
+  case MDSP::fixup_mdsp_pc26:
+    return (Value >> 2) & 0x3ffffff;
+  case MDSP::fixup_mdsp_hi16:
+    return (Value >> 16) & 0xffff;
+  case MDSP::fixup_mdsp_lo16:
+    return Value & 0xffff;
+  }
+}
+
+namespace {
+class MDSPELFObjectWriter : public MCELFObjectTargetWriter {
+public:
+  MDSPELFObjectWriter(Triple::OSType OSType)
+    : MCELFObjectTargetWriter(/*is64Bit*/ false, OSType, ELF::EM_MDSP,
+                              /*HasRelocationAddend*/ true) {}
+};
+
+class MDSPAsmBackend : public TargetAsmBackend {
+  Triple::OSType OSType;
+public:
+  MDSPAsmBackend(const Target &T, Triple::OSType _OSType)
+    : TargetAsmBackend(), OSType(_OSType) {}
+
+  unsigned getNumFixupKinds() const { return MDSP::NumTargetFixupKinds; }
+
+  const MCFixupKindInfo &getFixupKindInfo(MCFixupKind Kind) const {
+    const static MCFixupKindInfo Infos[MDSP::NumTargetFixupKinds] = {
+      // name                    offset  bits  flags
+      { "fixup_mdsp_pc16",       0,      16,   MCFixupKindInfo::FKF_IsPCRel },
+      { "fixup_mdsp_pc26",       0,      26,   MCFixupKindInfo::FKF_IsPCRel },
+      { "fixup_mdsp_hi16",       0,      16,   0 },
+      { "fixup_mdsp_lo16",       0,      16,   0 }
+    };
+
+    if (Kind < FirstTargetFixupKind)
+      return TargetAsmBackend::getFixupKindInfo(Kind);
+
+    assert(unsigned(Kind - FirstTargetFixupKind) < getNumFixupKinds() &&
+           "Invalid kind!");
+    return Infos[Kind - FirstTargetFixupKind];
+  }
+
+  void ApplyFixup(const MCFixup &Fixup, char *Data, unsigned DataSize,
+                  uint64_t Value) const {
+    unsigned Bits = adjustFixupValue(Fixup.getKind(), Value);
+    assert(Fixup.getOffset() + 4 <= DataSize && "Invalid fixup offset!");
+
+    // All fields start at bit 0 of a little endian word, so the value is
+    // or'ed in byte by byte.
+    for (unsigned i = 0; i != 4; ++i)
+      Data[Fixup.getOffset() + i] |= uint8_t(Bits >> (i * 8));
+  }
+
+  bool MayNeedRelaxation(const MCInst &Inst) const {
+    // Branches are resolved to their full field width, nothing is relaxed.
+    return false;
+  }
+
+  void RelaxInstruction(const MCInst &Inst, MCInst &Res) const {
+    llvm_unreachable("RelaxInstruction() unimplemented");
+  }
+
+  bool WriteNopData(uint64_t Count, MCObjectWriter *OW) const {
+    // The all zero word is 'nop'.
+    if ((Count % 4) != 0)
+      return false;
+
+    for (uint64_t i = 0; i < Count; i += 4)
+      OW->Write32(0x00000000);
+    return true;
+  }
+
+  unsigned getPointerSize() const {
+    return 4;
+  }
+
+  MCObjectWriter *createObjectWriter(raw_ostream &OS) const {
+    return createELFObjectWriter(new MDSPELFObjectWriter(OSType), OS,
+                                 /*IsLittleEndian*/ true);
+  }
+};
+} // end anonymous namespace
+
+TargetAsmBackend *llvm::createMDSPAsmBackend(const Target &T,
+                                             const std::string &TT) {
+  return new MDSPAsmBackend(T, Triple(TT).getOS());
+}
@@ -0,0 +1,40 @@
+//===-- MDSPFixupKinds.h - MDSP Specific Fixup Entries ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_MDSP_MDSPFIXUPKINDS_H
+#define LLVM_MDSP_MDSPFIXUPKINDS_H
+
+#include "llvm/MC/MCFixup.h"
+
+namespace llvm {
+namespace MDSP {
+enum Fixups {
+  /// fixup_mdsp_pc16 - 16-bit PC relative word offset for conditional
+  /// branches. Offsets are relative to the branch itself.
+  fixup_mdsp_pc16 = FirstTargetFixupKind,
+
+  /// fixup_mdsp_pc26 - 26-bit PC relative word offset for 'br', 'call' and
+  /// 'endloop'.
+  fixup_mdsp_pc26,
+
+  /// fixup_mdsp_hi16 - The upper half of an address, for 'movhi'.
+  fixup_mdsp_hi16,
+
+  /// fixup_mdsp_lo16 - The lower half of an address, for 'ori' and memory
+  /// displacements.
+  fixup_mdsp_lo16,
+
+  // Marker
+  LastTargetFixupKind,
+  NumTargetFixupKinds = LastTargetFixupKind - FirstTargetFixupKind
+};
+}
+}
+
+#endif
@@ -0,0 +1,134 @@
+//===-- MDSPFrameLowering.cpp - MDSP Frame Information ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the MDSP implementation of TargetFrameLowering class.
+//
+// The frame is laid out below the incoming stack pointer:
+//
+//   incoming r29 / r28 (fp) -> +-------------------------+
+//                              | callee-saved registers  |
+//                              | locals and spill slots  |
+//                              | outgoing arguments      |
+//                   r29 (sp) -> +-------------------------+
+//
+// When a frame pointer is needed it holds the incoming stack pointer, so
+// frame object offsets apply to it unchanged.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MDSPFrameLowering.h"
+#include "MDSPInstrInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+bool MDSPFrameLowering::hasFP(const MachineFunction &MF) const {
+  const MachineFrameInfo *MFI = MF.getFrameInfo();
+
+  return (DisableFramePointerElim(MF) ||
+          MFI->hasVarSizedObjects() ||
+          MFI->isFrameAddressTaken());
+}
+
+bool MDSPFrameLowering::hasReservedCallFrame(const MachineFunction &MF) const {
+  return !MF.getFrameInfo()->hasVarSizedObjects();
+}
+
+void MDSPFrameLowering::emitPrologue(MachineFunction &MF) const {
+  MachineBasicBlock &MBB = MF.front();   // Prolog goes in entry BB
+  MachineFrameInfo *MFI = MF.getFrameInfo();
+  const MDSPInstrInfo &TII =
+    *static_cast<const MDSPInstrInfo*>(MF.getTarget().getInstrInfo());
+
+  MachineBasicBlock::iterator MBBI = MBB.begin();
+  DebugLoc DL = MBBI != MBB.end() ? MBBI->getDebugLoc() : DebugLoc();
+
+  // Get the number of bytes to allocate from the FrameInfo, rounded up so
+  // that the stack stays aligned across calls.
+  uint64_t StackSize =
+    RoundUpToAlignment(MFI->getStackSize(), getStackAlignment());
+  MFI->setStackSize(StackSize);
+
+  if (StackSize == 0 && !hasFP(MF))
+    return;
+
+  // addi r29, r29, -StackSize
+  if (StackSize)
+    TII.adjustReg(MBB, MBBI, DL, MDSP::R29, MDSP::R29, -(int64_t)StackSize);
+
+  if (hasFP(MF)) {
+    // The callee-saved register spills come right after the stack
+    // adjustment; the frame pointer is set up once the old one is saved.
+    for (unsigned i = 0, e = MFI->getCalleeSavedInfo().size(); i != e; ++i) {
+      assert(MBBI != MBB.end() && MBBI->getOpcode() == MDSP::STW &&
+             "Unexpected callee-saved register spill sequence!");
+      ++MBBI;
+    }
+
+    // addi r28, r29, StackSize
+    TII.adjustReg(MBB, MBBI, DL, MDSP::R28, MDSP::R29, StackSize);
+  }
+}
+
+void MDSPFrameLowering::emitEpilogue(MachineFunction &MF,
+                                     MachineBasicBlock &MBB) const {
+  const MachineFrameInfo *MFI = MF.getFrameInfo();
+  const MDSPInstrInfo &TII =
+    *static_cast<const MDSPInstrInfo*>(MF.getTarget().getInstrInfo());
+
+  MachineBasicBlock::iterator MBBI = MBB.getLastNonDebugInstr();
+  assert(MBBI->getDesc().isReturn() &&
+         "Can only insert epilog into returning blocks");
+  DebugLoc DL = MBBI->getDebugLoc();
+
+  uint64_t StackSize = MFI->getStackSize();
+
+  if (hasFP(MF)) {
+    // The stack pointer may have moved because of dynamic allocas; rebuild
+    // it from the frame pointer before the callee-saved registers are
+    // reloaded from their stack pointer based slots.
+    MachineBasicBlock::iterator I = MBBI;
+    for (unsigned i = 0, e = MFI->getCalleeSavedInfo().size(); i != e; ++i) {
+      --I;
+      assert(I->getOpcode() == MDSP::LDW &&
+             "Unexpected callee-saved register reload sequence!");
+    }
+
+    // addi r29, r28, -StackSize
+    TII.adjustReg(MBB, I, DL, MDSP::R29, MDSP::R28, -(int64_t)StackSize);
+  }
+
+  // addi r29, r29, StackSize
+  if (StackSize)
+    TII.adjustReg(MBB, MBBI, DL, MDSP::R29, MDSP::R29, StackSize);
+}
+
+void MDSPFrameLowering::
+processFunctionBeforeCalleeSavedScan(MachineFunction &MF,
+                                     RegScavenger *RS) const {
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  // The frame pointer is a callee-saved register; make sure it gets a spill
+  // slot when this function sets it up.
+  if (hasFP(MF))
+    MRI.setPhysRegUsed(MDSP::R28);
+
+  // Calls overwrite the link register, so it has to be saved in any function
+  // that makes them.  Leaf functions leave it alone.
+  if (MF.getFrameInfo()->hasCalls())
+    MRI.setPhysRegUsed(MDSP::R31);
+  else
+    MRI.setPhysRegUnused(MDSP::R31);
+}
@@ -0,0 +1,42 @@
+//===-- MDSPFrameLowering.h - Define frame lowering for MDSP ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the MDSP implementation of TargetFrameLowering class.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MDSP_FRAMEINFO_H
+#define MDSP_FRAMEINFO_H
+
+#include "MDSP.h"
+#include "llvm/Target/TargetFrameLowering.h"
+
+namespace llvm {
+
+class MDSPFrameLowering : public TargetFrameLowering {
+public:
+  explicit MDSPFrameLowering()
+    : TargetFrameLowering(TargetFrameLowering::StackGrowsDown, 8, 0) {
+  }
+
+  /// emitProlog/emitEpilog - These methods insert prolog and epilog code into
+  /// the function.
+  void emitPrologue(MachineFunction &MF) const;
+  void emitEpilogue(MachineFunction &MF, MachineBasicBlock &MBB) const;
+
+  bool hasFP(const MachineFunction &MF) const;
+  bool hasReservedCallFrame(const MachineFunction &MF) const;
+
+  void processFunctionBeforeCalleeSavedScan(MachineFunction &MF,
+                                            RegScavenger *RS = NULL) const;
+};
+
+} // End llvm namespace
+
+#endif
@@ -0,0 +1,534 @@
+//===-- MDSPHardwareLoops.cpp - Form MDSP zero-overhead loops -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains two passes that turn counted innermost loops into MDSP
+// hardware loops.
+//
+// The trip count is only known to ScalarEvolution, so the first pass runs on
+// LLVM IR just before instruction selection. It expands the backedge-taken
+// count plus one in the block entering each suitable loop and passes it to
+// llvm.mdsp.loop.count, which is selected to the loop instruction.
+//
+// The second pass runs on machine code before register allocation. For each
+// loop instruction it checks that the loop is still the one the count was
+// computed for and that nothing in it clobbers the loop counter, replaces the
+// compare and branch of the latch with endloop and deletes the induction
+// variable arithmetic that only fed the exit test. Loop instructions that
+// cannot be used, for example because the loop has been software pipelined,
+// are deleted together with the count computation. Loops that have no count
+// from ScalarEvolution still become hardware loops if their exit test steps
+// an induction variable by one up or down to a bound; this is how the kernel
+// of a pipelined loop gets one.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "mdsp-hwloops"
+#include "MDSP.h"
+#include "MDSPTargetMachine.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/IntrinsicInst.h"
+#include "llvm/Module.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+using namespace llvm;
+
+STATISTIC(NumCounted, "Number of loops with a hardware loop count");
+STATISTIC(NumHWLoops, "Number of hardware loops formed");
+
+static cl::opt<bool>
+DisableHWLoops("disable-mdsp-hwloops", cl::Hidden,
+               cl::desc("Keep the compare and branch of counted loops"));
+
+//===----------------------------------------------------------------------===//
+// Trip count computation
+//===----------------------------------------------------------------------===//
+
+namespace {
+  struct MDSPHardwareLoopPrep : public FunctionPass {
+    static char ID;
+    MDSPHardwareLoopPrep() : FunctionPass(ID) {}
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesCFG();
+      AU.addRequired<LoopInfo>();
+      AU.addRequired<ScalarEvolution>();
+    }
+
+    virtual bool runOnFunction(Function &F);
+
+    virtual const char *getPassName() const {
+      return "MDSP Hardware Loop Count";
+    }
+
+  private:
+    LoopInfo *LI;
+    ScalarEvolution *SE;
+
+    bool processLoop(Loop *L);
+  };
+  char MDSPHardwareLoopPrep::ID = 0;
+}
+
+/// createMDSPHardwareLoopPrep - returns an instance of the pass that marks
+/// counted loops with their trip count.
+FunctionPass *llvm::createMDSPHardwareLoopPrep() {
+  return new MDSPHardwareLoopPrep();
+}
+
+/// isCheapToExpand - Return true if S can be computed without a division,
+/// which MDSP would have to call a library routine for.
+static bool isCheapToExpand(const SCEV *S) {
+  if (const SCEVUDivExpr *D = dyn_cast<SCEVUDivExpr>(S)) {
+    const SCEVConstant *C = dyn_cast<SCEVConstant>(D->getRHS());
+    if (!C || !C->getValue()->getValue().isPowerOf2())
+      return false;
+    return isCheapToExpand(D->getLHS());
+  }
+  if (const SCEVCastExpr *C = dyn_cast<SCEVCastExpr>(S))
+    return isCheapToExpand(C->getOperand());
+  if (const SCEVNAryExpr *N = dyn_cast<SCEVNAryExpr>(S)) {
+    for (SCEVNAryExpr::op_iterator I = N->op_begin(), E = N->op_end();
+         I != E; ++I)
+      if (!isCheapToExpand(*I))
+        return false;
+  }
+  return true;
+}
+
+bool MDSPHardwareLoopPrep::runOnFunction(Function &F) {
+  if (DisableHWLoops)
+    return false;
+
+  LI = &getAnalysis<LoopInfo>();
+  SE = &getAnalysis<ScalarEvolution>();
+
+  // Only innermost loops get a hardware loop, there is a single counter.
+  SmallVector<Loop*, 8> Worklist(LI->begin(), LI->end());
+  bool Changed = false;
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    if (L->empty())
+      Changed |= processLoop(L);
+    else
+      Worklist.append(L->begin(), L->end());
+  }
+  return Changed;
+}
+
+bool MDSPHardwareLoopPrep::processLoop(Loop *L) {
+  // CodeGenPrepare deletes empty preheaders, so the count goes to the block
+  // entering the loop, which is usually the guard of the loop. It must not
+  // be inside another loop or enter another loop, since both would need the
+  // counter while this loop runs.
+  BasicBlock *Pred = L->getLoopPredecessor();
+  BasicBlock *Latch = L->getLoopLatch();
+  if (!Pred || !Latch || L->getExitingBlock() != Latch ||
+      LI->getLoopFor(Pred) != L->getParentLoop())
+    return false;
+  TerminatorInst *TI = Pred->getTerminator();
+  for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
+    if (TI->getSuccessor(i) != L->getHeader() &&
+        LI->isLoopHeader(TI->getSuccessor(i)))
+      return false;
+
+  // Calls would clobber the loop counter.
+  for (Loop::block_iterator BI = L->block_begin(), BE = L->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end();
+         I != E; ++I)
+      if (isa<CallInst>(I) && !isa<DbgInfoIntrinsic>(I))
+        return false;
+
+  const SCEV *BackedgeTaken = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BackedgeTaken) ||
+      SE->getTypeSizeInBits(BackedgeTaken->getType()) > 32 ||
+      !isCheapToExpand(BackedgeTaken))
+    return false;
+
+  // The body runs once more than the backedge is taken. A count that wraps
+  // to zero is still right: endloop decrements before it tests.
+  const Type *Int32Ty = Type::getInt32Ty(Pred->getContext());
+  const SCEV *TripCount =
+    SE->getAddExpr(SE->getNoopOrZeroExtend(BackedgeTaken, Int32Ty),
+                   SE->getConstant(Int32Ty, 1));
+
+  DEBUG(dbgs() << "MDSP hardware loop: " << L->getHeader()->getName()
+               << " runs " << *TripCount << " times\n");
+
+  SCEVExpander Rewriter(*SE);
+  Value *Count = Rewriter.expandCodeFor(TripCount, Int32Ty, TI);
+  Function *LoopCount =
+    Intrinsic::getDeclaration(Pred->getParent()->getParent(),
+                              Intrinsic::mdsp_loop_count);
+  CallInst::Create(LoopCount, Count, "", TI);
+  ++NumCounted;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Hardware loop formation
+//===----------------------------------------------------------------------===//
+
+namespace {
+  struct MDSPHardwareLoops : public MachineFunctionPass {
+    static char ID;
+    MDSPHardwareLoops() : MachineFunctionPass(ID) {}
+
+    virtual FunctionPass *createParallelClone() const {
+      return new MDSPHardwareLoops();
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesCFG();
+      AU.addRequired<MachineLoopInfo>();
+      AU.addPreserved<MachineLoopInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    virtual bool runOnMachineFunction(MachineFunction &MF);
+
+    virtual const char *getPassName() const {
+      return "MDSP Hardware Loops";
+    }
+
+  private:
+    const TargetInstrInfo *TII;
+    MachineRegisterInfo *MRI;
+    MachineLoopInfo *MLI;
+
+    MachineLoop *getCountedLoop(MachineInstr *Setup);
+    bool canConvert(MachineLoop *L);
+    unsigned buildInductionCount(MachineLoop *L, MachineBasicBlock *Pred);
+    void convertLoop(MachineLoop *L);
+    void deleteDeadDefs(SmallVectorImpl<unsigned> &Regs);
+  };
+  char MDSPHardwareLoops::ID = 0;
+}
+
+/// createMDSPHardwareLoops - returns an instance of the pass that forms
+/// hardware loops.
+FunctionPass *llvm::createMDSPHardwareLoops(MDSPTargetMachine &TM) {
+  return new MDSPHardwareLoops();
+}
+
+bool MDSPHardwareLoops::runOnMachineFunction(MachineFunction &MF) {
+  if (DisableHWLoops)
+    return false;
+
+  TII = MF.getTarget().getInstrInfo();
+  MRI = &MF.getRegInfo();
+  MLI = &getAnalysis<MachineLoopInfo>();
+
+  SmallVector<MachineInstr*, 4> Setups;
+  for (MachineFunction::iterator MBB = MF.begin(), E = MF.end();
+       MBB != E; ++MBB)
+    for (MachineBasicBlock::iterator I = MBB->begin(), IE = MBB->end();
+         I != IE; ++I)
+      if (I->getOpcode() == MDSP::LOOP)
+        Setups.push_back(I);
+
+  SmallPtrSet<MachineLoop*, 8> Converted;
+  for (unsigned i = 0, e = Setups.size(); i != e; ++i) {
+    MachineInstr *Setup = Setups[i];
+    MachineLoop *L = getCountedLoop(Setup);
+    if (L && canConvert(L)) {
+      convertLoop(L);
+      Converted.insert(L);
+      continue;
+    }
+
+    DEBUG(dbgs() << "Dropping hardware loop count in BB#"
+                 << Setup->getParent()->getNumber() << '\n');
+    SmallVector<unsigned, 1> Regs;
+    Regs.push_back(Setup->getOperand(0).getReg());
+    Setup->eraseFromParent();
+    deleteDeadDefs(Regs);
+  }
+
+  // Loops without a count from ScalarEvolution, such as the kernels of
+  // software pipelined loops, may still step an induction variable by one
+  // until it reaches a bound.
+  bool Changed = !Setups.empty();
+  SmallVector<MachineLoop*, 8> Worklist(MLI->begin(), MLI->end());
+  while (!Worklist.empty()) {
+    MachineLoop *L = Worklist.pop_back_val();
+    if (!L->empty()) {
+      Worklist.append(L->begin(), L->end());
+      continue;
+    }
+    if (Converted.count(L) || !canConvert(L))
+      continue;
+
+    // The counter is set up in the block entering the loop, so that block
+    // must not be inside another loop or enter another loop.
+    MachineBasicBlock *Pred = L->getLoopPredecessor();
+    if (!Pred || MLI->getLoopFor(Pred) != L->getParentLoop())
+      continue;
+    bool EntersOther = false;
+    for (MachineBasicBlock::succ_iterator SI = Pred->succ_begin(),
+         SE = Pred->succ_end(); SI != SE; ++SI)
+      EntersOther |= *SI != L->getHeader() && MLI->isLoopHeader(*SI);
+    if (EntersOther)
+      continue;
+
+    unsigned Count = buildInductionCount(L, Pred);
+    if (!Count)
+      continue;
+    MachineBasicBlock::iterator InsertPt = Pred->getFirstTerminator();
+    DebugLoc DL;
+    if (InsertPt != Pred->end())
+      DL = InsertPt->getDebugLoc();
+    BuildMI(*Pred, InsertPt, DL, TII->get(MDSP::LOOP)).addReg(Count);
+    convertLoop(L);
+    Changed = true;
+  }
+  return Changed;
+}
+
+/// getCountedLoop - Return the loop that the count of Setup was computed
+/// for, or null if that loop is no longer entered from the block of Setup.
+/// The block enters only one loop, so any loop it enters is the right one.
+MachineLoop *MDSPHardwareLoops::getCountedLoop(MachineInstr *Setup) {
+  MachineBasicBlock *Pred = Setup->getParent();
+  MachineLoop *Found = 0;
+  for (MachineBasicBlock::succ_iterator SI = Pred->succ_begin(),
+       SE = Pred->succ_end(); SI != SE; ++SI) {
+    // Skip the blocks that machine sinking splits critical edges with.
+    MachineBasicBlock *Entering = Pred, *Header = *SI;
+    while (Header->pred_size() == 1 && Header->succ_size() == 1 &&
+           !MLI->isLoopHeader(Header)) {
+      Entering = Header;
+      Header = *Header->succ_begin();
+    }
+
+    MachineLoop *L = MLI->getLoopFor(Header);
+    if (!L || L->getHeader() != Header ||
+        L->getLoopPredecessor() != Entering)
+      continue;
+    if (Found)
+      return 0;
+    Found = L;
+  }
+  return Found;
+}
+
+/// canConvert - Return true if L is an innermost loop that only exits from
+/// its latch through an analyzable branch, and that leaves the loop counter
+/// alone.
+bool MDSPHardwareLoops::canConvert(MachineLoop *L) {
+  if (!L->empty())
+    return false;
+
+  MachineBasicBlock *Latch = L->getLoopLatch();
+  if (!Latch || L->getExitingBlock() != Latch || Latch->succ_size() != 2)
+    return false;
+
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 3> Cond;
+  if (TII->AnalyzeBranch(*Latch, TBB, FBB, Cond, false) || Cond.size() != 3)
+    return false;
+
+  // Library calls may have been introduced by instruction selection.
+  for (MachineLoop::block_iterator BI = L->block_begin(),
+       BE = L->block_end(); BI != BE; ++BI)
+    for (MachineBasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end();
+         I != E; ++I)
+      if (I->getDesc().isCall() || I->isInlineAsm() ||
+          I->modifiesRegister(MDSP::LC, 0))
+        return false;
+  return true;
+}
+
+/// buildInductionCount - If the latch of L leaves the loop when a header
+/// PHI stepped by plus or minus one reaches a loop invariant bound, compute
+/// the trip count at the end of Pred and return its register, otherwise
+/// return 0. The count is exact in modular arithmetic, like the counter.
+unsigned MDSPHardwareLoops::buildInductionCount(MachineLoop *L,
+                                                MachineBasicBlock *Pred) {
+  MachineBasicBlock *Header = L->getHeader();
+  MachineBasicBlock *Latch = L->getLoopLatch();
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 3> Cond;
+  TII->AnalyzeBranch(*Latch, TBB, FBB, Cond, false);
+
+  // The loop has to keep running while the operands differ.
+  unsigned Opc = Cond[0].getImm();
+  if (!(Opc == MDSP::BNE && TBB == Header) &&
+      !(Opc == MDSP::BEQ && TBB != Header))
+    return 0;
+
+  for (unsigned i = 1; i != 3; ++i) {
+    unsigned Next = Cond[i].getReg(), Bound = Cond[3 - i].getReg();
+    if (!TargetRegisterInfo::isVirtualRegister(Next))
+      continue;
+    if (Bound != MDSP::R0 &&
+        (!TargetRegisterInfo::isVirtualRegister(Bound) ||
+         L->contains(MRI->getVRegDef(Bound)->getParent())))
+      continue;
+
+    MachineInstr *Inc = MRI->getVRegDef(Next);
+    if (Inc->getOpcode() != MDSP::ADDI || !Inc->getOperand(2).isImm() ||
+        !L->contains(Inc->getParent()))
+      continue;
+    int64_t Step = Inc->getOperand(2).getImm();
+    if ((Step != 1 && Step != -1) || !Inc->getOperand(1).isReg() ||
+        !TargetRegisterInfo::isVirtualRegister(Inc->getOperand(1).getReg()))
+      continue;
+    unsigned IV = Inc->getOperand(1).getReg();
+    MachineInstr *Phi = MRI->getVRegDef(IV);
+    if (!Phi->isPHI() || Phi->getParent() != Header)
+      continue;
+
+    unsigned Init = 0;
+    bool Carried = false;
+    for (unsigned j = 1, je = Phi->getNumOperands(); j != je; j += 2) {
+      MachineBasicBlock *From = Phi->getOperand(j + 1).getMBB();
+      if (From == Pred)
+        Init = Phi->getOperand(j).getReg();
+      else if (From == Latch)
+        Carried = Phi->getOperand(j).getReg() == Next;
+    }
+    if (!Init || !Carried)
+      continue;
+
+    DEBUG(dbgs() << "Loop BB#" << Header->getNumber() << " steps "
+                 << PrintReg(IV) << " by " << Step << '\n');
+
+    // Counting down to zero is the form loop strength reduction prefers.
+    if (Step == -1 && Bound == MDSP::R0)
+      return Init;
+
+    MachineBasicBlock::iterator InsertPt = Pred->getFirstTerminator();
+    DebugLoc DL;
+    if (InsertPt != Pred->end())
+      DL = InsertPt->getDebugLoc();
+    unsigned Count = MRI->createVirtualRegister(MDSP::GPRRegisterClass);
+    if (Step == 1)
+      BuildMI(*Pred, InsertPt, DL, TII->get(MDSP::SUB), Count)
+        .addReg(Bound).addReg(Init);
+    else
+      BuildMI(*Pred, InsertPt, DL, TII->get(MDSP::SUB), Count)
+        .addReg(Init).addReg(Bound);
+    return Count;
+  }
+  return 0;
+}
+
+/// convertLoop - Replace the exit test of L with endloop.
+void MDSPHardwareLoops::convertLoop(MachineLoop *L) {
+  MachineBasicBlock *Header = L->getHeader();
+  MachineBasicBlock *Latch = L->getLoopLatch();
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 3> Cond;
+  TII->AnalyzeBranch(*Latch, TBB, FBB, Cond, false);
+
+  MachineBasicBlock *Exit = *Latch->succ_begin();
+  if (Exit == Header)
+    Exit = *llvm::next(Latch->succ_begin());
+
+  DEBUG(dbgs() << "Forming hardware loop BB#" << Header->getNumber()
+               << " exiting to BB#" << Exit->getNumber() << '\n');
+
+  SmallVector<unsigned, 2> Regs;
+  for (unsigned i = 1, e = Cond.size(); i != e; ++i)
+    Regs.push_back(Cond[i].getReg());
+
+  DebugLoc DL = Latch->getFirstTerminator()->getDebugLoc();
+  TII->RemoveBranch(*Latch);
+  BuildMI(Latch, DL, TII->get(MDSP::ENDLOOP)).addMBB(Header);
+  if (!Latch->isLayoutSuccessor(Exit))
+    BuildMI(Latch, DL, TII->get(MDSP::BR)).addMBB(Exit);
+
+  deleteDeadDefs(Regs);
+  ++NumHWLoops;
+}
+
+/// isDeletable - Return true if MI only computes its virtual register
+/// results, so it can be deleted once they are unused.
+static bool isDeletable(MachineInstr *MI, const TargetInstrInfo *TII) {
+  bool SawStore = false;
+  if (!MI->isPHI() && !MI->isSafeToMove(TII, 0, SawStore))
+    return false;
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (MO.isReg() && MO.isDef() &&
+        !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      return false;
+  }
+  return true;
+}
+
+/// deleteDeadDefs - Delete the instructions computing Regs that have no
+/// other uses. An induction variable is a cycle through a PHI, so all the
+/// candidates are collected first, and those with a use outside of the set
+/// are then pruned until nothing changes.
+void MDSPHardwareLoops::deleteDeadDefs(SmallVectorImpl<unsigned> &Regs) {
+  SmallPtrSet<MachineInstr*, 16> Dead;
+  SmallVector<MachineInstr*, 16> Candidates;
+  while (!Regs.empty()) {
+    unsigned Reg = Regs.pop_back_val();
+    if (!TargetRegisterInfo::isVirtualRegister(Reg))
+      continue;
+    MachineInstr *MI = MRI->getVRegDef(Reg);
+    if (!MI || !isDeletable(MI, TII) || !Dead.insert(MI))
+      continue;
+    Candidates.push_back(MI);
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (MO.isReg() && MO.isUse() && MO.getReg())
+        Regs.push_back(MO.getReg());
+    }
+  }
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+      MachineInstr *MI = Candidates[i];
+      if (!Dead.count(MI))
+        continue;
+      unsigned Reg = MI->getOperand(0).getReg();
+      for (MachineRegisterInfo::use_nodbg_iterator UI =
+           MRI->use_nodbg_begin(Reg), UE = MRI->use_nodbg_end();
+           UI != UE; ++UI)
+        if (!Dead.count(&*UI)) {
+          Dead.erase(MI);
+          Changed = true;
+          break;
+        }
+    }
+  }
+
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    MachineInstr *MI = Candidates[i];
+    if (!Dead.count(MI))
+      continue;
+
+    // Debug values of the deleted registers go with them.
+    unsigned Reg = MI->getOperand(0).getReg();
+    for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(Reg),
+         UE = MRI->use_end(); UI != UE; ) {
+      MachineInstr *User = &*UI++;
+      if (User->isDebugValue())
+        User->eraseFromParent();
+    }
+    MI->eraseFromParent();
+  }
+}
@@ -0,0 +1,291 @@
+//===-- MDSPISelDAGToDAG.cpp - A dag to dag inst selector for MDSP --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines an instruction selector for the MDSP target.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "mdsp-isel"
+
+#include "MDSP.h"
+#include "MDSPTargetMachine.h"
+#include "llvm/CodeGen/SelectionDAG.h"
+#include "llvm/CodeGen/SelectionDAGISel.h"
+#include "llvm/Target/TargetLowering.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+//===----------------------------------------------------------------------===//
+// Instruction Selector Implementation
+//===----------------------------------------------------------------------===//
+
+//===--------------------------------------------------------------------===//
+/// MDSPDAGToDAGISel - MDSP specific code to select MDSP machine
+/// instructions for SelectionDAG operations.
+///
+namespace {
+class MDSPDAGToDAGISel : public SelectionDAGISel {
+  /// Subtarget - Keep a pointer to the MDSP Subtarget around so that we can
+  /// make the right decision when generating code for different targets.
+  const MDSPSubtarget &Subtarget;
+  MDSPTargetMachine &TM;
+public:
+  MDSPDAGToDAGISel(MDSPTargetMachine &tm, CodeGenOpt::Level OptLevel)
+    : SelectionDAGISel(tm, OptLevel),
+      Subtarget(tm.getSubtarget<MDSPSubtarget>()), TM(tm) {
+  }
+
+  virtual FunctionPass *createParallelClone() const {
+    return canRunInParallel() ? new MDSPDAGToDAGISel(TM, OptLevel) : 0;
+  }
+
+  virtual const char *getPassName() const {
+    return "MDSP DAG->DAG Pattern Instruction Selection";
+  }
+
+  /// SelectInlineAsmMemoryOperand - Implement addressing mode selection for
+  /// inline asm expressions.
+  virtual bool SelectInlineAsmMemoryOperand(const SDValue &Op,
+                                            char ConstraintCode,
+                                            std::vector<SDValue> &OutOps);
+
+  // Include the pieces autogenerated from the target description.
+#include "MDSPGenDAGISel.inc"
+
+private:
+  SDNode *Select(SDNode *N);
+
+  // Complex Pattern Selectors.
+  bool SelectAddr(SDValue Addr, SDValue &Base, SDValue &Offset);
+  bool SelectCircAddr(SDValue Addr, unsigned Size,
+                      SDValue &Base, SDValue &Index, SDValue &Length);
+  bool SelectCircAddr4(SDValue Addr,
+                       SDValue &Base, SDValue &Index, SDValue &Length) {
+    return SelectCircAddr(Addr, 4, Base, Index, Length);
+  }
+  bool SelectCircAddr2(SDValue Addr,
+                       SDValue &Base, SDValue &Index, SDValue &Length) {
+    return SelectCircAddr(Addr, 2, Base, Index, Length);
+  }
+  bool SelectCircAddr1(SDValue Addr,
+                       SDValue &Base, SDValue &Index, SDValue &Length) {
+    return SelectCircAddr(Addr, 1, Base, Index, Length);
+  }
+  bool SelectWrappedIndex(SDValue N, SDValue &Index, SDValue &Length);
+  SDValue getConstantReg(uint64_t Imm, DebugLoc dl);
+};
+}  // end anonymous namespace
+
+/// SelectAddr - Match a base register plus a signed 16-bit displacement.
+/// Frame indices are kept symbolic and resolved by eliminateFrameIndex.
+bool MDSPDAGToDAGISel::SelectAddr(SDValue Addr,
+                                  SDValue &Base, SDValue &Offset) {
+  if (FrameIndexSDNode *FIN = dyn_cast<FrameIndexSDNode>(Addr)) {
+    Base = CurDAG->getTargetFrameIndex(FIN->getIndex(), MVT::i32);
+    Offset = CurDAG->getTargetConstant(0, MVT::i32);
+    return true;
+  }
+
+  if (Addr.getOpcode() == ISD::TargetExternalSymbol ||
+      Addr.getOpcode() == ISD::TargetGlobalAddress)
+    return false;  // direct calls.
+
+  if (CurDAG->isBaseWithConstantOffset(Addr)) {
+    ConstantSDNode *CN = cast<ConstantSDNode>(Addr.getOperand(1));
+    if (isInt<16>(CN->getSExtValue())) {
+      if (FrameIndexSDNode *FIN =
+            dyn_cast<FrameIndexSDNode>(Addr.getOperand(0))) {
+        // Constant offset from frame ref.
+        Base = CurDAG->getTargetFrameIndex(FIN->getIndex(), MVT::i32);
+      } else {
+        Base = Addr.getOperand(0);
+      }
+      Offset = CurDAG->getTargetConstant(CN->getSExtValue(), MVT::i32);
+      return true;
+    }
+  }
+
+  Base = Addr;
+  Offset = CurDAG->getTargetConstant(0, MVT::i32);
+  return true;
+}
+
+/// getConstantReg - Materialize a 32-bit constant into a register. Complex
+/// patterns run in the middle of selection, so the nodes must already be
+/// machine nodes.
+SDValue MDSPDAGToDAGISel::getConstantReg(uint64_t Imm, DebugLoc dl) {
+  if (isInt<16>((int32_t)Imm))
+    return SDValue(CurDAG->getMachineNode(MDSP::ADDI, dl, MVT::i32,
+                                          CurDAG->getRegister(MDSP::R0,
+                                                              MVT::i32),
+                                          CurDAG->getTargetConstant(Imm,
+                                                                    MVT::i32)),
+                   0);
+  SDNode *Hi = CurDAG->getMachineNode(MDSP::MOVHI, dl, MVT::i32,
+                     CurDAG->getTargetConstant((Imm >> 16) & 0xFFFF,
+                                               MVT::i32));
+  return SDValue(CurDAG->getMachineNode(MDSP::ORI, dl, MVT::i32,
+                     SDValue(Hi, 0),
+                     CurDAG->getTargetConstant(Imm & 0xFFFF, MVT::i32)), 0);
+}
+
+/// SelectWrappedIndex - Match 'Index >= Length ? Index - Length : Index',
+/// the single wrap CodeGenPrepare emits for a circular buffer index. A
+/// constant length shows up as 'Index > Length-1 ? Index + -Length : Index'
+/// once the DAG combiner is done with it.
+bool MDSPDAGToDAGISel::SelectWrappedIndex(SDValue N, SDValue &Index,
+                                          SDValue &Length) {
+  if (N.getOpcode() != ISD::SELECT ||
+      N.getOperand(0).getOpcode() != ISD::SETCC)
+    return false;
+
+  SDValue Cond = N.getOperand(0);
+  SDValue LHS = Cond.getOperand(0), RHS = Cond.getOperand(1);
+  ISD::CondCode CC = cast<CondCodeSDNode>(Cond.getOperand(2))->get();
+  if (RHS == N.getOperand(1) || RHS == N.getOperand(2)) {
+    std::swap(LHS, RHS);
+    CC = ISD::getSetCCSwappedOperands(CC);
+  }
+
+  // Make the true operand the wrapped one.
+  SDValue Wrapped = N.getOperand(1), Unwrapped = N.getOperand(2);
+  if (CC == ISD::SETULT || CC == ISD::SETULE) {
+    std::swap(Wrapped, Unwrapped);
+    CC = ISD::getSetCCInverse(CC, true);
+  }
+  if (LHS != Unwrapped ||
+      (Wrapped.getOpcode() != ISD::SUB && Wrapped.getOpcode() != ISD::ADD) ||
+      Wrapped.getOperand(0) != Unwrapped)
+    return false;
+
+  ConstantSDNode *CN = dyn_cast<ConstantSDNode>(RHS);
+  if (CC == ISD::SETUGE && !CN) {
+    if (Wrapped.getOpcode() != ISD::SUB || Wrapped.getOperand(1) != RHS)
+      return false;
+    Index = Unwrapped;
+    Length = RHS;
+    return true;
+  }
+
+  if (!CN || (CC != ISD::SETUGE && CC != ISD::SETUGT))
+    return false;
+  uint64_t Len = CN->getZExtValue() + (CC == ISD::SETUGT);
+  ConstantSDNode *Adj = dyn_cast<ConstantSDNode>(Wrapped.getOperand(1));
+  if (!Adj || Len == 0 || (uint32_t)Len != Len)
+    return false;
+  if (!(Wrapped.getOpcode() == ISD::SUB && Adj->getZExtValue() == Len) &&
+      !(Wrapped.getOpcode() == ISD::ADD &&
+        (uint32_t)-Adj->getSExtValue() == Len))
+    return false;
+  Index = Unwrapped;
+  Length = getConstantReg(Len, N.getDebugLoc());
+  return true;
+}
+
+/// SelectCircAddr - Match a circular buffer access of Size bytes: a base
+/// register plus a wrapped index scaled by the access size.
+bool MDSPDAGToDAGISel::SelectCircAddr(SDValue Addr, unsigned Size,
+                                      SDValue &Base, SDValue &Index,
+                                      SDValue &Length) {
+  if (!Subtarget.hasCircular() || Addr.getOpcode() != ISD::ADD)
+    return false;
+
+  for (unsigned i = 0; i != 2; ++i) {
+    SDValue Off = Addr.getOperand(i);
+    if (Size != 1) {
+      if (Off.getOpcode() != ISD::SHL)
+        continue;
+      ConstantSDNode *Amt = dyn_cast<ConstantSDNode>(Off.getOperand(1));
+      if (!Amt || Amt->getZExtValue() != Log2_32(Size))
+        continue;
+      Off = Off.getOperand(0);
+    }
+    if (SelectWrappedIndex(Off, Index, Length)) {
+      Base = Addr.getOperand(1 - i);
+      return true;
+    }
+  }
+  return false;
+}
+
+SDNode *MDSPDAGToDAGISel::Select(SDNode *Node) {
+  DebugLoc dl = Node->getDebugLoc();
+
+  // Dump information about the Node being selected
+  DEBUG(errs() << "Selecting: ");
+  DEBUG(Node->dump(CurDAG));
+  DEBUG(errs() << "\n");
+
+  // If we have a custom node, we already have selected!
+  if (Node->isMachineOpcode()) {
+    DEBUG(errs() << "== ";
+          Node->dump(CurDAG);
+          errs() << "\n");
+    return NULL;
+  }
+
+  // Few custom selection stuff.
+  switch (Node->getOpcode()) {
+  default: break;
+  case ISD::FrameIndex: {
+    // The address of a stack object is 'addi rd, <base>, <offset>' once the
+    // frame index is eliminated.
+    assert(Node->getValueType(0) == MVT::i32);
+    int FI = cast<FrameIndexSDNode>(Node)->getIndex();
+    SDValue TFI = CurDAG->getTargetFrameIndex(FI, MVT::i32);
+    if (Node->hasOneUse())
+      return CurDAG->SelectNodeTo(Node, MDSP::ADDI, MVT::i32,
+                                  TFI, CurDAG->getTargetConstant(0, MVT::i32));
+    return CurDAG->getMachineNode(MDSP::ADDI, dl, MVT::i32,
+                                  TFI, CurDAG->getTargetConstant(0, MVT::i32));
+  }
+  }
+
+  // Select the default instruction
+  SDNode *ResNode = SelectCode(Node);
+
+  DEBUG(errs() << "=> ");
+  if (ResNode == NULL || ResNode == Node)
+    DEBUG(Node->dump(CurDAG));
+  else
+    DEBUG(ResNode->dump(CurDAG));
+  DEBUG(errs() << "\n");
+
+  return ResNode;
+}
+
+bool
+MDSPDAGToDAGISel::SelectInlineAsmMemoryOperand(const SDValue &Op,
+                                               char ConstraintCode,
+                                               std::vector<SDValue> &OutOps) {
+  SDValue Op0, Op1;
+  switch (ConstraintCode) {
+  default: return true;
+  case 'm':   // memory
+    if (!SelectAddr(Op, Op0, Op1))
+      return true;
+    break;
+  }
+
+  OutOps.push_back(Op0);
+  OutOps.push_back(Op1);
+  return false;
+}
+
+/// createMDSPISelDag - This pass converts a legalized DAG into a
+/// MDSP-specific DAG, ready for instruction scheduling.
+///
+FunctionPass *llvm::createMDSPISelDag(MDSPTargetMachine &TM,
+                                      CodeGenOpt::Level OptLevel) {
+  return new MDSPDAGToDAGISel(TM, OptLevel);
+}
@@ -0,0 +1,347 @@
+//===- MDSPInstrInfo.cpp - MDSP Instruction Information ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the MDSP implementation of the TargetInstrInfo class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MDSP.h"
+#include "MDSPInstrInfo.h"
+#include "MDSPTargetMachine.h"
+#include "MDSPGenInstrInfo.inc"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/PseudoSourceValue.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+MDSPInstrInfo::MDSPInstrInfo(MDSPTargetMachine &tm)
+  : TargetInstrInfoImpl(MDSPInsts, array_lengthof(MDSPInsts)),
+    RI(tm, *this), TM(tm) {}
+
+static bool isZeroImm(const MachineOperand &op) {
+  return op.isImm() && op.getImm() == 0;
+}
+
+/// isLoadFromStackSlot - If the specified machine instruction is a direct
+/// load from a stack slot, return the virtual or physical register number of
+/// the destination along with the FrameIndex of the loaded stack slot.  If
+/// not, return 0.  This predicate must return 0 if the instruction has
+/// any side effects other than loading from the stack slot.
+unsigned MDSPInstrInfo::isLoadFromStackSlot(const MachineInstr *MI,
+                                            int &FrameIndex) const {
+  if (MI->getOpcode() == MDSP::LDW &&
+      MI->getOperand(1).isFI() &&       // is a stack slot
+      isZeroImm(MI->getOperand(2))) {   // the offset is zero
+    FrameIndex = MI->getOperand(1).getIndex();
+    return MI->getOperand(0).getReg();
+  }
+  return 0;
+}
+
+/// isStoreToStackSlot - If the specified machine instruction is a direct
+/// store to a stack slot, return the virtual or physical register number of
+/// the source reg along with the FrameIndex of the loaded stack slot.  If
+/// not, return 0.  This predicate must return 0 if the instruction has
+/// any side effects other than storing to the stack slot.
+unsigned MDSPInstrInfo::isStoreToStackSlot(const MachineInstr *MI,
+                                           int &FrameIndex) const {
+  if (MI->getOpcode() == MDSP::STW &&
+      MI->getOperand(1).isFI() &&       // is a stack slot
+      isZeroImm(MI->getOperand(2))) {   // the offset is zero
+    FrameIndex = MI->getOperand(1).getIndex();
+    return MI->getOperand(0).getReg();
+  }
+  return 0;
+}
+
+void MDSPInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
+                                MachineBasicBlock::iterator I, DebugLoc DL,
+                                unsigned DestReg, unsigned SrcReg,
+                                bool KillSrc) const {
+  if (!MDSP::GPRRegClass.contains(DestReg, SrcReg))
+    llvm_unreachable("Impossible reg-to-reg copy");
+
+  // There is no dedicated move; or with the zero register does the job.
+  BuildMI(MBB, I, DL, get(MDSP::OR), DestReg)
+    .addReg(SrcReg, getKillRegState(KillSrc)).addReg(MDSP::R0);
+}
+
+void MDSPInstrInfo::storeRegToStackSlot(MachineBasicBlock &MBB,
+                                        MachineBasicBlock::iterator MI,
+                                        unsigned SrcReg, bool isKill, int FI,
+                                        const TargetRegisterClass *RC,
+                                        const TargetRegisterInfo *TRI) const {
+  DebugLoc DL;
+  if (MI != MBB.end()) DL = MI->getDebugLoc();
+  MachineFunction &MF = *MBB.getParent();
+  MachineFrameInfo &MFI = *MF.getFrameInfo();
+
+  MachineMemOperand *MMO =
+    MF.getMachineMemOperand(
+              MachinePointerInfo(PseudoSourceValue::getFixedStack(FI)),
+                            MachineMemOperand::MOStore,
+                            MFI.getObjectSize(FI),
+                            MFI.getObjectAlignment(FI));
+
+  if (RC != MDSP::GPRRegisterClass)
+    llvm_unreachable("Cannot store this register to stack slot!");
+
+  BuildMI(MBB, MI, DL, get(MDSP::STW))
+    .addReg(SrcReg, getKillRegState(isKill))
+    .addFrameIndex(FI).addImm(0).addMemOperand(MMO);
+}
+
+void MDSPInstrInfo::loadRegFromStackSlot(MachineBasicBlock &MBB,
+                                         MachineBasicBlock::iterator MI,
+                                         unsigned DestReg, int FI,
+                                         const TargetRegisterClass *RC,
+                                         const TargetRegisterInfo *TRI) const {
+  DebugLoc DL;
+  if (MI != MBB.end()) DL = MI->getDebugLoc();
+  MachineFunction &MF = *MBB.getParent();
+  MachineFrameInfo &MFI = *MF.getFrameInfo();
+
+  MachineMemOperand *MMO =
+    MF.getMachineMemOperand(
+              MachinePointerInfo(PseudoSourceValue::getFixedStack(FI)),
+                            MachineMemOperand::MOLoad,
+                            MFI.getObjectSize(FI),
+                            MFI.getObjectAlignment(FI));
+
+  if (RC != MDSP::GPRRegisterClass)
+    llvm_unreachable("Cannot load this register from stack slot!");
+
+  BuildMI(MBB, MI, DL, get(MDSP::LDW), DestReg)
+    .addFrameIndex(FI).addImm(0).addMemOperand(MMO);
+}
+
+void MDSPInstrInfo::adjustReg(MachineBasicBlock &MBB,
+                              MachineBasicBlock::iterator I, DebugLoc DL,
+                              unsigned DstReg, unsigned SrcReg,
+                              int64_t Amount) const {
+  if (isInt<16>(Amount)) {
+    BuildMI(MBB, I, DL, get(MDSP::ADDI), DstReg)
+      .addReg(SrcReg).addImm(Amount);
+    return;
+  }
+
+  BuildMI(MBB, I, DL, get(MDSP::MOVHI), MDSP::R30)
+    .addImm((uint32_t)Amount >> 16);
+  BuildMI(MBB, I, DL, get(MDSP::ORI), MDSP::R30)
+    .addReg(MDSP::R30).addImm(Amount & 0xFFFF);
+  BuildMI(MBB, I, DL, get(MDSP::ADD), DstReg)
+    .addReg(SrcReg).addReg(MDSP::R30);
+}
+
+//===----------------------------------------------------------------------===//
+// Branch Analysis
+//===----------------------------------------------------------------------===//
+
+bool MDSPInstrInfo::isCondBranchOpcode(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return false;
+  case MDSP::BEQ:
+  case MDSP::BNE:
+  case MDSP::BLT:
+  case MDSP::BGE:
+  case MDSP::BLTU:
+  case MDSP::BGEU:
+  case MDSP::ENDLOOP:
+    return true;
+  }
+}
+
+/// GetOppositeBranchOpc - Return the inverse of the specified
+/// compare-and-branch opcode.
+static unsigned GetOppositeBranchOpc(unsigned Opc) {
+  switch (Opc) {
+  default: llvm_unreachable("Illegal opcode!");
+  case MDSP::BEQ:  return MDSP::BNE;
+  case MDSP::BNE:  return MDSP::BEQ;
+  case MDSP::BLT:  return MDSP::BGE;
+  case MDSP::BGE:  return MDSP::BLT;
+  case MDSP::BLTU: return MDSP::BGEU;
+  case MDSP::BGEU: return MDSP::BLTU;
+  }
+}
+
+static void AnalyzeCondBr(const MachineInstr *Inst, unsigned Opc,
+                          MachineBasicBlock *&BB,
+                          SmallVectorImpl<MachineOperand> &Cond) {
+  // The condition of endloop is the loop counter, so only the opcode is
+  // recorded. Such a condition cannot be reversed.
+  if (Opc == MDSP::ENDLOOP) {
+    BB = Inst->getOperand(0).getMBB();
+    Cond.push_back(MachineOperand::CreateImm(Opc));
+    return;
+  }
+
+  BB = Inst->getOperand(2).getMBB();
+  Cond.push_back(MachineOperand::CreateImm(Opc));
+  Cond.push_back(Inst->getOperand(0));
+  Cond.push_back(Inst->getOperand(1));
+}
+
+bool MDSPInstrInfo::AnalyzeBranch(MachineBasicBlock &MBB,
+                                  MachineBasicBlock *&TBB,
+                                  MachineBasicBlock *&FBB,
+                                  SmallVectorImpl<MachineOperand> &Cond,
+                                  bool AllowModify) const {
+  MachineBasicBlock::reverse_iterator I = MBB.rbegin(), REnd = MBB.rend();
+
+  // Skip all the debug instructions.
+  while (I != REnd && I->isDebugValue())
+    ++I;
+
+  if (I == REnd || !isUnpredicatedTerminator(&*I)) {
+    // If this block ends with no branches (it just falls through to its succ)
+    // just return false, leaving TBB/FBB null.
+    TBB = FBB = NULL;
+    return false;
+  }
+
+  MachineInstr *LastInst = &*I;
+  unsigned LastOpc = LastInst->getOpcode();
+
+  // Not an analyzable branch (must be an indirect jump).
+  if (LastOpc != MDSP::BR && !isCondBranchOpcode(LastOpc))
+    return true;
+
+  // Get the second to last instruction in the block.
+  unsigned SecondLastOpc = 0;
+  MachineInstr *SecondLastInst = NULL;
+
+  if (++I != REnd && isUnpredicatedTerminator(&*I)) {
+    SecondLastInst = &*I;
+    SecondLastOpc = SecondLastInst->getOpcode();
+
+    // Not an analyzable branch (must be an indirect jump).
+    if (SecondLastOpc != MDSP::BR && !isCondBranchOpcode(SecondLastOpc))
+      return true;
+  }
+
+  // If there is only one terminator instruction, process it.
+  if (!SecondLastOpc) {
+    // Unconditional branch
+    if (LastOpc == MDSP::BR) {
+      TBB = LastInst->getOperand(0).getMBB();
+      return false;
+    }
+
+    // Conditional branch
+    AnalyzeCondBr(LastInst, LastOpc, TBB, Cond);
+    return false;
+  }
+
+  // If we reached here, there are two branches.
+  // If there are three terminators, we don't know what sort of block this is.
+  if (++I != REnd && isUnpredicatedTerminator(&*I))
+    return true;
+
+  // If second to last instruction is an unconditional branch,
+  // analyze it and remove the last instruction.
+  if (SecondLastOpc == MDSP::BR) {
+    // Return if the last instruction cannot be removed.
+    if (!AllowModify)
+      return true;
+
+    TBB = SecondLastInst->getOperand(0).getMBB();
+    LastInst->eraseFromParent();
+    return false;
+  }
+
+  // Conditional branch followed by an unconditional branch.
+  // The last one must be unconditional.
+  if (LastOpc != MDSP::BR)
+    return true;
+
+  AnalyzeCondBr(SecondLastInst, SecondLastOpc, TBB, Cond);
+  FBB = LastInst->getOperand(0).getMBB();
+
+  return false;
+}
+
+unsigned MDSPInstrInfo::InsertBranch(MachineBasicBlock &MBB,
+                                     MachineBasicBlock *TBB,
+                                     MachineBasicBlock *FBB,
+                                     const SmallVectorImpl<MachineOperand> &Cond,
+                                     DebugLoc DL) const {
+  // Shouldn't be a fall through.
+  assert(TBB && "InsertBranch must not be told to insert a fallthrough");
+  assert((Cond.size() == 3 || Cond.size() == 1 || Cond.size() == 0) &&
+         "MDSP branch conditions have three components or one for endloop!");
+
+  if (Cond.empty()) {
+    // Unconditional branch?
+    assert(!FBB && "Unconditional branch with multiple successors!");
+    BuildMI(&MBB, DL, get(MDSP::BR)).addMBB(TBB);
+    return 1;
+  }
+
+  // Conditional branch.
+  if (Cond.size() == 1)
+    BuildMI(&MBB, DL, get(MDSP::ENDLOOP)).addMBB(TBB);
+  else
+    BuildMI(&MBB, DL, get(Cond[0].getImm()))
+      .addReg(Cond[1].getReg()).addReg(Cond[2].getReg()).addMBB(TBB);
+
+  if (!FBB)
+    return 1;
+
+  // Two-way Conditional branch. Insert the second branch.
+  BuildMI(&MBB, DL, get(MDSP::BR)).addMBB(FBB);
+  return 2;
+}
+
+unsigned MDSPInstrInfo::RemoveBranch(MachineBasicBlock &MBB) const {
+  MachineBasicBlock::reverse_iterator I = MBB.rbegin(), REnd = MBB.rend();
+  MachineBasicBlock::reverse_iterator FirstBr;
+  unsigned removed;
+
+  // Skip all the debug instructions.
+  while (I != REnd && I->isDebugValue())
+    ++I;
+
+  FirstBr = I;
+
+  // Up to 2 branches are removed.
+  // Note that indirect branches are not removed.
+  for (removed = 0; I != REnd && removed < 2; ++I, ++removed) {
+    unsigned Opc = I->getOpcode();
+    if (Opc != MDSP::BR && !isCondBranchOpcode(Opc))
+      break;
+  }
+
+  MBB.erase(I.base(), FirstBr.base());
+
+  return removed;
+}
+
+/// ReverseBranchCondition - Return the inverse opcode of the
+/// specified Branch instruction.
+bool MDSPInstrInfo::
+ReverseBranchCondition(SmallVectorImpl<MachineOperand> &Cond) const {
+  assert((Cond.size() == 3 || Cond.size() == 1) &&
+         "Invalid MDSP branch condition!");
+  if (Cond.size() == 1)
+    return true;
+  Cond[0].setImm(GetOppositeBranchOpc(Cond[0].getImm()));
+  return false;
+}
+
+/// insertNoop - Insert a NOP instruction.
+void MDSPInstrInfo::insertNoop(MachineBasicBlock &MBB,
+                               MachineBasicBlock::iterator MI) const {
+  DebugLoc DL;
+  BuildMI(MBB, MI, DL, get(MDSP::NOP));
+}
@@ -0,0 +1,26 @@
+//===-- MDSPMCAsmInfo.cpp - MDSP asm properties ---------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the declarations of the MDSPMCAsmInfo properties.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MDSPMCAsmInfo.h"
+using namespace llvm;
+
+MDSPMCAsmInfo::MDSPMCAsmInfo(const Target &T, StringRef TT) {
+  PrivateGlobalPrefix = ".L";
+  WeakRefDirective ="\t.weak\t";
+  PCSymbol=".";
+  CommentString = ";";
+
+  AlignmentIsInBytes = false;
+  AllowNameToStartWithDigit = true;
+  UsesELFSectionDirectiveForBSS = true;
+}
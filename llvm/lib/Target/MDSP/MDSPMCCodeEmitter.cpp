@@ -0,0 +1,187 @@
+//===-- MDSPMCCodeEmitter.cpp - Convert MDSP code to machine code ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the MDSPMCCodeEmitter class.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "mccodeemitter"
+#include "MDSP.h"
+#include "MDSPRegisterInfo.h"
+#include "MDSPFixupKinds.h"
+#include "llvm/MC/MCCodeEmitter.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/ErrorHandling.h"
+using namespace llvm;
+
+STATISTIC(MCNumEmitted, "Number of MC instructions emitted");
+STATISTIC(MCNumPackets, "Number of packet headers emitted");
+
+namespace {
+class MDSPMCCodeEmitter : public MCCodeEmitter {
+  MDSPMCCodeEmitter(const MDSPMCCodeEmitter &); // DO NOT IMPLEMENT
+  void operator=(const MDSPMCCodeEmitter &);    // DO NOT IMPLEMENT
+  const TargetMachine &TM;
+  MCContext &Ctx;
+
+public:
+  MDSPMCCodeEmitter(TargetMachine &tm, MCContext &ctx)
+    : TM(tm), Ctx(ctx) {
+  }
+
+  ~MDSPMCCodeEmitter() {}
+
+  unsigned getBranchTargetEncoding(const MCInst &MI, unsigned OpNo,
+                                   SmallVectorImpl<MCFixup> &Fixups) const;
+  unsigned getJumpTargetEncoding(const MCInst &MI, unsigned OpNo,
+                                 SmallVectorImpl<MCFixup> &Fixups) const;
+  unsigned getHi16Encoding(const MCInst &MI, unsigned OpNo,
+                           SmallVectorImpl<MCFixup> &Fixups) const;
+  unsigned getLo16Encoding(const MCInst &MI, unsigned OpNo,
+                           SmallVectorImpl<MCFixup> &Fixups) const;
+  unsigned getMemEncoding(const MCInst &MI, unsigned OpNo,
+                          SmallVectorImpl<MCFixup> &Fixups) const;
+  unsigned getCircMemEncoding(const MCInst &MI, unsigned OpNo,
+                              SmallVectorImpl<MCFixup> &Fixups) const;
+
+  /// getMachineOpValue - Return binary encoding of operand. If the machine
+  /// operand requires relocation, record the relocation and return zero.
+  unsigned getMachineOpValue(const MCInst &MI, const MCOperand &MO,
+                             SmallVectorImpl<MCFixup> &Fixups) const;
+
+  // getBinaryCodeForInstr - TableGen'erated function for getting the
+  // binary encoding for an instruction.
+  unsigned getBinaryCodeForInstr(const MCInst &MI,
+                                 SmallVectorImpl<MCFixup> &Fixups) const;
+
+  void EmitWord(unsigned Bits, raw_ostream &OS) const {
+    // Output the constant in little endian byte order.
+    for (unsigned i = 0; i != 4; ++i) {
+      OS << (char)Bits;
+      Bits >>= 8;
+    }
+  }
+
+  void EncodeInstruction(const MCInst &MI, raw_ostream &OS,
+                         SmallVectorImpl<MCFixup> &Fixups) const {
+    unsigned Bits = getBinaryCodeForInstr(MI, Fixups);
+
+    // The first instruction of a packet is preceded by a header word that
+    // tells the core how many of the following words issue together. The
+    // fixups of the instruction move along with it.
+    unsigned Size = MI.getFlags() >> MDSP::PacketSizeShift;
+    if (Size > 1) {
+      EmitWord((MDSP::PacketHeaderOpcode << 26) | Size, OS);
+      for (unsigned i = 0, e = Fixups.size(); i != e; ++i)
+        Fixups[i].setOffset(Fixups[i].getOffset() + 4);
+      ++MCNumPackets;
+    }
+
+    EmitWord(Bits, OS);
+    ++MCNumEmitted;  // Keep track of the # of mi's emitted.
+  }
+};
+
+} // end anonymous namespace
+
+MCCodeEmitter *llvm::createMDSPMCCodeEmitter(const Target &, TargetMachine &TM,
+                                             MCContext &Ctx) {
+  return new MDSPMCCodeEmitter(TM, Ctx);
+}
+
+unsigned MDSPMCCodeEmitter::
+getBranchTargetEncoding(const MCInst &MI, unsigned OpNo,
+                        SmallVectorImpl<MCFixup> &Fixups) const {
+  const MCOperand &MO = MI.getOperand(OpNo);
+  if (MO.isReg() || MO.isImm()) return getMachineOpValue(MI, MO, Fixups);
+
+  // Add a fixup for the branch target.
+  Fixups.push_back(MCFixup::Create(0, MO.getExpr(),
+                                   (MCFixupKind)MDSP::fixup_mdsp_pc16));
+  return 0;
+}
+
+unsigned MDSPMCCodeEmitter::
+getJumpTargetEncoding(const MCInst &MI, unsigned OpNo,
+                      SmallVectorImpl<MCFixup> &Fixups) const {
+  const MCOperand &MO = MI.getOperand(OpNo);
+  if (MO.isReg() || MO.isImm()) return getMachineOpValue(MI, MO, Fixups);
+
+  // Add a fixup for the jump or call target.
+  Fixups.push_back(MCFixup::Create(0, MO.getExpr(),
+                                   (MCFixupKind)MDSP::fixup_mdsp_pc26));
+  return 0;
+}
+
+unsigned MDSPMCCodeEmitter::
+getHi16Encoding(const MCInst &MI, unsigned OpNo,
+                SmallVectorImpl<MCFixup> &Fixups) const {
+  const MCOperand &MO = MI.getOperand(OpNo);
+  if (MO.isReg() || MO.isImm()) return getMachineOpValue(MI, MO, Fixups);
+
+  // Add a fixup for the upper half of the address.
+  Fixups.push_back(MCFixup::Create(0, MO.getExpr(),
+                                   (MCFixupKind)MDSP::fixup_mdsp_hi16));
+  return 0;
+}
+
+unsigned MDSPMCCodeEmitter::
+getLo16Encoding(const MCInst &MI, unsigned OpNo,
+                SmallVectorImpl<MCFixup> &Fixups) const {
+  const MCOperand &MO = MI.getOperand(OpNo);
+  if (MO.isReg() || MO.isImm()) return getMachineOpValue(MI, MO, Fixups);
+
+  // Add a fixup for the lower half of the address.
+  Fixups.push_back(MCFixup::Create(0, MO.getExpr(),
+                                   (MCFixupKind)MDSP::fixup_mdsp_lo16));
+  return 0;
+}
+
+unsigned MDSPMCCodeEmitter::
+getMemEncoding(const MCInst &MI, unsigned OpNo,
+               SmallVectorImpl<MCFixup> &Fixups) const {
+  // Encode (reg, imm) as a mem, which has the low 16-bits as the
+  // displacement and the next 5 bits as the base register #.
+  assert(MI.getOperand(OpNo).isReg());
+  unsigned RegBits = getMachineOpValue(MI, MI.getOperand(OpNo), Fixups) << 16;
+
+  const MCOperand &MO = MI.getOperand(OpNo+1);
+  if (MO.isImm())
+    return (getMachineOpValue(MI, MO, Fixups) & 0xFFFF) | RegBits;
+
+  // Add a fixup for the displacement field.
+  Fixups.push_back(MCFixup::Create(0, MO.getExpr(),
+                                   (MCFixupKind)MDSP::fixup_mdsp_lo16));
+  return RegBits;
+}
+
+unsigned MDSPMCCodeEmitter::
+getCircMemEncoding(const MCInst &MI, unsigned OpNo,
+                   SmallVectorImpl<MCFixup> &Fixups) const {
+  // Encode (base, index, length) as three register numbers, base first.
+  unsigned Base = getMachineOpValue(MI, MI.getOperand(OpNo), Fixups);
+  unsigned Index = getMachineOpValue(MI, MI.getOperand(OpNo+1), Fixups);
+  unsigned Length = getMachineOpValue(MI, MI.getOperand(OpNo+2), Fixups);
+  return (Base << 10) | (Index << 5) | Length;
+}
+
+unsigned MDSPMCCodeEmitter::
+getMachineOpValue(const MCInst &MI, const MCOperand &MO,
+                  SmallVectorImpl<MCFixup> &Fixups) const {
+  if (MO.isReg())
+    return MDSPRegisterInfo::getRegisterNumbering(MO.getReg());
+
+  assert(MO.isImm() &&
+         "Relocation required in an instruction that we cannot encode!");
+  return MO.getImm();
+}
+
+#include "MDSPGenMCCodeEmitter.inc"
@@ -0,0 +1,40 @@
+//===- MDSPMachineFunctionInfo.h - MDSP Machine Function Info ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares MDSP specific per-machine-function information.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MDSPMACHINEFUNCTIONINFO_H
+#define MDSPMACHINEFUNCTIONINFO_H
+
+#include "llvm/CodeGen/MachineFunction.h"
+
+namespace llvm {
+
+/// MDSPMachineFunctionInfo - This class is derived from MachineFunction and
+/// contains private MDSP target-specific information for each MachineFunction.
+class MDSPMachineFunctionInfo : public MachineFunctionInfo {
+  /// VarArgsFrameIndex - FrameIndex for the first variadic argument passed
+  /// on the stack.
+  int VarArgsFrameIndex;
+
+public:
+  MDSPMachineFunctionInfo() : VarArgsFrameIndex(0) {}
+
+  explicit MDSPMachineFunctionInfo(MachineFunction &MF)
+    : VarArgsFrameIndex(0) {}
+
+  int getVarArgsFrameIndex() const { return VarArgsFrameIndex; }
+  void setVarArgsFrameIndex(int Index) { VarArgsFrameIndex = Index; }
+};
+
+} // End llvm namespace
+
+#endif
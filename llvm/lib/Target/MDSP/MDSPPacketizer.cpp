@@ -0,0 +1,80 @@
+//===-- MDSPPacketizer.cpp - Form MDSP issue bundles ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains a pass that packs independent MDSP instructions into
+// issue bundles using the itineraries from MDSPSchedule.td. An instruction
+// that issues together with the one before it is printed with a leading
+// "||". This pass should be run last, just before the assembly printer.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "mdsp-packetizer"
+#include "MDSP.h"
+#include "MDSPTargetMachine.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/MachineDominators.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/VLIWPacketizer.h"
+#include "llvm/Support/CommandLine.h"
+using namespace llvm;
+
+static cl::opt<bool>
+DisablePacketizer("disable-mdsp-packetizer", cl::Hidden,
+                  cl::desc("Issue MDSP instructions one per cycle"));
+
+namespace {
+  struct MDSPPacketizer : public MachineFunctionPass {
+    static char ID;
+    MDSPPacketizer() : MachineFunctionPass(ID) {}
+
+    virtual FunctionPass *createParallelClone() const {
+      return new MDSPPacketizer();
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesCFG();
+      AU.addRequired<AliasAnalysis>();
+      AU.addRequired<MachineDominatorTree>();
+      AU.addPreserved<MachineDominatorTree>();
+      AU.addRequired<MachineLoopInfo>();
+      AU.addPreserved<MachineLoopInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+    virtual bool runOnMachineFunction(MachineFunction &Fn);
+
+    virtual const char *getPassName() const {
+      return "MDSP VLIW Packetizer";
+    }
+  };
+  char MDSPPacketizer::ID = 0;
+}
+
+/// createMDSPPacketizer - returns an instance of the packetizer pass.
+///
+FunctionPass *llvm::createMDSPPacketizer(MDSPTargetMachine &TM) {
+  return new MDSPPacketizer();
+}
+
+bool MDSPPacketizer::runOnMachineFunction(MachineFunction &Fn) {
+  if (DisablePacketizer)
+    return false;
+
+  VLIWPacketizerList Packetizer(Fn, getAnalysis<MachineLoopInfo>(),
+                                getAnalysis<MachineDominatorTree>(),
+                                &getAnalysis<AliasAnalysis>());
+
+  for (MachineFunction::iterator MBB = Fn.begin(), E = Fn.end();
+       MBB != E; ++MBB)
+    Packetizer.PacketizeBlock(MBB);
+
+  // Even without bundling the instructions may have been reordered.
+  return true;
+}
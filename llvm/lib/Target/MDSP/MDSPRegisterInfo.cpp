@@ -0,0 +1,218 @@
+//===- MDSPRegisterInfo.cpp - MDSP Register Information ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the MDSP implementation of the TargetRegisterInfo class.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "mdsp-reg-info"
+
+#include "MDSP.h"
+#include "MDSPRegisterInfo.h"
+#include "MDSPTargetMachine.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+MDSPRegisterInfo::MDSPRegisterInfo(MDSPTargetMachine &tm,
+                                   const TargetInstrInfo &tii)
+  : MDSPGenRegisterInfo(MDSP::ADJCALLSTACKDOWN, MDSP::ADJCALLSTACKUP),
+    TM(tm), TII(tii) {
+}
+
+/// getRegisterNumbering - Given the enum value for some register, e.g.
+/// MDSP::R31, return the number that it corresponds to (e.g. 31).
+unsigned MDSPRegisterInfo::getRegisterNumbering(unsigned RegEnum) {
+  switch (RegEnum) {
+  case MDSP::R0:   return 0;
+  case MDSP::R1:   return 1;
+  case MDSP::R2:   return 2;
+  case MDSP::R3:   return 3;
+  case MDSP::R4:   return 4;
+  case MDSP::R5:   return 5;
+  case MDSP::R6:   return 6;
+  case MDSP::R7:   return 7;
+  case MDSP::R8:   return 8;
+  case MDSP::R9:   return 9;
+  case MDSP::R10:  return 10;
+  case MDSP::R11:  return 11;
+  case MDSP::R12:  return 12;
+  case MDSP::R13:  return 13;
+  case MDSP::R14:  return 14;
+  case MDSP::R15:  return 15;
+  case MDSP::R16:  return 16;
+  case MDSP::R17:  return 17;
+  case MDSP::R18:  return 18;
+  case MDSP::R19:  return 19;
+  case MDSP::R20:  return 20;
+  case MDSP::R21:  return 21;
+  case MDSP::R22:  return 22;
+  case MDSP::R23:  return 23;
+  case MDSP::R24:  return 24;
+  case MDSP::R25:  return 25;
+  case MDSP::R26:  return 26;
+  case MDSP::R27:  return 27;
+  case MDSP::R28:  return 28;
+  case MDSP::R29:  return 29;
+  case MDSP::R30:  return 30;
+  case MDSP::R31:  return 31;
+  default: llvm_unreachable("Unknown register number!");
+  }
+  return 0; // Not reached
+}
+
+const unsigned*
+MDSPRegisterInfo::getCalleeSavedRegs(const MachineFunction *MF) const {
+  // The link register is listed so that non-leaf functions preserve their
+  // return address; see processFunctionBeforeCalleeSavedScan.
+  static const unsigned CalleeSavedRegs[] = {
+    MDSP::R16, MDSP::R17, MDSP::R18, MDSP::R19,
+    MDSP::R20, MDSP::R21, MDSP::R22, MDSP::R23,
+    MDSP::R24, MDSP::R25, MDSP::R26, MDSP::R27,
+    MDSP::R28, MDSP::R31,
+    0
+  };
+
+  return CalleeSavedRegs;
+}
+
+BitVector MDSPRegisterInfo::getReservedRegs(const MachineFunction &MF) const {
+  BitVector Reserved(getNumRegs());
+  const TargetFrameLowering *TFI = MF.getTarget().getFrameLowering();
+
+  // The zero register, the stack pointer, the frame lowering scratch
+  // register and the link register are never allocatable.
+  Reserved.set(MDSP::R0);
+  Reserved.set(MDSP::R29);
+  Reserved.set(MDSP::R30);
+  Reserved.set(MDSP::R31);
+
+  // The loop counter is only written by the hardware loop instructions.
+  Reserved.set(MDSP::LC);
+
+  // Mark frame pointer as reserved if needed.
+  if (TFI->hasFP(MF))
+    Reserved.set(MDSP::R28);
+
+  return Reserved;
+}
+
+const TargetRegisterClass *
+MDSPRegisterInfo::getPointerRegClass(unsigned Kind) const {
+  return &MDSP::GPRRegClass;
+}
+
+void MDSPRegisterInfo::
+eliminateCallFramePseudoInstr(MachineFunction &MF, MachineBasicBlock &MBB,
+                              MachineBasicBlock::iterator I) const {
+  const TargetFrameLowering *TFI = MF.getTarget().getFrameLowering();
+
+  if (!TFI->hasReservedCallFrame(MF)) {
+    // If the stack pointer can be changed after prologue, turn the
+    // adjcallstackdown instruction into 'addi r29, r29, -<amt>' and the
+    // adjcallstackup instruction into 'addi r29, r29, <amt>'.
+    MachineInstr *Old = I;
+    int64_t Amount = Old->getOperand(0).getImm();
+    if (Amount != 0) {
+      // We need to keep the stack aligned properly.  To do this, we round the
+      // amount of space needed for the outgoing arguments up to the next
+      // alignment boundary.
+      unsigned Align = TFI->getStackAlignment();
+      Amount = (Amount+Align-1)/Align*Align;
+
+      if (Old->getOpcode() == getCallFrameSetupOpcode())
+        Amount = -Amount;
+
+      TM.getInstrInfo()->adjustReg(MBB, I, Old->getDebugLoc(),
+                                   MDSP::R29, MDSP::R29, Amount);
+    }
+  }
+
+  MBB.erase(I);
+}
+
+void
+MDSPRegisterInfo::eliminateFrameIndex(MachineBasicBlock::iterator II,
+                                      int SPAdj, RegScavenger *RS) const {
+  assert(SPAdj == 0 && "Unexpected");
+
+  unsigned i = 0;
+  MachineInstr &MI = *II;
+  MachineBasicBlock &MBB = *MI.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  const MachineFrameInfo *MFI = MF.getFrameInfo();
+  const TargetFrameLowering *TFI = MF.getTarget().getFrameLowering();
+  DebugLoc dl = MI.getDebugLoc();
+
+  while (!MI.getOperand(i).isFI()) {
+    ++i;
+    assert(i < MI.getNumOperands() && "Instr doesn't have FrameIndex operand!");
+  }
+
+  int FrameIndex = MI.getOperand(i).getIndex();
+
+  // Callee-saved registers are spilled before the frame pointer is set up
+  // and reloaded after it is torn down, so their slots are always addressed
+  // off the stack pointer.
+  bool IsCSRSlot = false;
+  const std::vector<CalleeSavedInfo> &CSI = MFI->getCalleeSavedInfo();
+  for (unsigned j = 0, e = CSI.size(); j != e; ++j)
+    if (CSI[j].getFrameIdx() == FrameIndex) {
+      IsCSRSlot = true;
+      break;
+    }
+
+  // The frame pointer holds the stack pointer value at function entry;
+  // all frame object offsets are relative to that.
+  int Offset = MFI->getObjectOffset(FrameIndex);
+  unsigned BasePtr;
+  if (TFI->hasFP(MF) && !IsCSRSlot)
+    BasePtr = MDSP::R28;
+  else {
+    BasePtr = MDSP::R29;
+    Offset += MFI->getStackSize();
+  }
+
+  // Fold imm into offset.  Loads, stores and the frame address 'addi' all
+  // carry the offset right after the base register.
+  Offset += MI.getOperand(i+1).getImm();
+
+  if (!isInt<16>(Offset)) {
+    // The offset does not fit the immediate field; compute the address in
+    // the reserved scratch register.
+    TM.getInstrInfo()->adjustReg(MBB, II, dl, MDSP::R30, BasePtr, Offset);
+    BasePtr = MDSP::R30;
+    Offset = 0;
+  }
+
+  MI.getOperand(i).ChangeToRegister(BasePtr, false);
+  MI.getOperand(i+1).ChangeToImmediate(Offset);
+}
+
+unsigned MDSPRegisterInfo::getRARegister() const {
+  return MDSP::R31;
+}
+
+unsigned MDSPRegisterInfo::getFrameRegister(const MachineFunction &MF) const {
+  const TargetFrameLowering *TFI = MF.getTarget().getFrameLowering();
+
+  return TFI->hasFP(MF) ? MDSP::R28 : MDSP::R29;
+}
+
+int MDSPRegisterInfo::getDwarfRegNum(unsigned RegNum, bool isEH) const {
+  return MDSPGenRegisterInfo::getDwarfRegNumFull(RegNum, 0);
+}
+
+#include "MDSPGenRegisterInfo.inc"
@@ -0,0 +1,51 @@
+//===- MDSPSubtarget.cpp - MDSP Subtarget Information -------------*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the MDSP specific subclass of TargetSubtarget.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MDSPSubtarget.h"
+#include "MDSP.h"
+#include "MDSPGenSubtarget.inc"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Target/SubtargetFeature.h"
+
+using namespace llvm;
+
+MDSPSubtarget::MDSPSubtarget(const std::string &TT, const std::string &FS)
+  : CPUString("generic"), HasMAC(false), HasHWLoop(false),
+    HasCircular(false) {
+  // Parse features string. A -mcpu= choice in FS overrides the generic core
+  // and also selects the itineraries of that core.
+  CPUString = ParseSubtargetFeatures(FS, CPUString);
+
+  // An unknown core has been reported and is ignored; fall back to the
+  // generic one, which has itineraries.
+  if (InstrItins.isEmpty()) {
+    SubtargetFeatures Features(FS);
+    Features.setCPU("generic");
+    CPUString = ParseSubtargetFeatures(Features.getString(), "generic");
+  }
+
+  computeIssueWidth();
+}
+
+/// computeIssueWidth - The issue width is the number of distinct units
+/// that an instruction can occupy in its first stage, i.e. issue slots.
+void MDSPSubtarget::computeIssueWidth() {
+  unsigned IssueSlots = 0;
+  for (const InstrItinerary *Itin = InstrItins.Itineraries;
+       Itin->FirstStage != ~0U; ++Itin) {
+    if (Itin->FirstStage == Itin->LastStage)
+      continue;
+    IssueSlots |= InstrItins.Stages[Itin->FirstStage].getUnits();
+  }
+  InstrItins.IssueWidth = CountPopulation_32(IssueSlots);
+}
@@ -0,0 +1,58 @@
+//===-- MDSPSubtarget.h - Define Subtarget for the MDSP ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the MDSP specific subclass of TargetSubtarget.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MDSPSUBTARGET_H
+#define MDSPSUBTARGET_H
+
+#include "llvm/Target/TargetSubtarget.h"
+#include "llvm/Target/TargetInstrItineraries.h"
+
+#include <string>
+
+namespace llvm {
+
+class MDSPSubtarget : public TargetSubtarget {
+  /// CPUString - The MDSP core to generate code for, e.g. "mdsp300".
+  std::string CPUString;
+
+  bool HasMAC;
+  bool HasHWLoop;
+  bool HasCircular;
+
+  InstrItineraryData InstrItins;
+
+  void computeIssueWidth();
+public:
+  /// This constructor initializes the data members to match that
+  /// of the specified triple.
+  ///
+  MDSPSubtarget(const std::string &TT, const std::string &FS);
+
+  /// ParseSubtargetFeatures - Parses features string setting specified
+  /// subtarget options.  Definition of function is auto generated by tblgen.
+  std::string ParseSubtargetFeatures(const std::string &FS,
+                                     const std::string &CPU);
+
+  const std::string &getCPUString() const { return CPUString; }
+
+  bool hasMAC() const { return HasMAC; }
+  bool hasHWLoop() const { return HasHWLoop; }
+  bool hasCircular() const { return HasCircular; }
+
+  /// getInstrItins - Return the instruction itineraries based on subtarget
+  /// selection.
+  const InstrItineraryData &getInstrItineraryData() const { return InstrItins; }
+};
+} // End llvm namespace
+
+#endif  // MDSPSUBTARGET_H
@@ -1,4 +1,4 @@
-//===-- MDSPTargetMachine.cpp - Define TargetMachine for MDSP -----------===//
+//===-- MDSPTargetMachine.cpp - Define TargetMachine for MDSP -------------===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -7,40 +7,93 @@
 //
 //===----------------------------------------------------------------------===//
 //
+// Top-level implementation for the MDSP target.
 //
 //===----------------------------------------------------------------------===//
 
 #include "MDSP.h"
+#include "MDSPMCAsmInfo.h"
 #include "MDSPTargetMachine.h"
 #include "llvm/PassManager.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/MC/MCStreamer.h"
 #include "llvm/Target/TargetRegistry.h"
-#include "llvm/Module.h"
 
 using namespace llvm;
 
+static MCStreamer *createMCStreamer(const Target &T, const std::string &TT,
+                                    MCContext &Ctx, TargetAsmBackend &TAB,
+                                    raw_ostream &_OS,
+                                    MCCodeEmitter *_Emitter,
+                                    bool RelaxAll,
+                                    bool NoExecStack) {
+  // MDSP objects are always ELF.
+  return createELFStreamer(Ctx, TAB, _OS, _Emitter, RelaxAll, NoExecStack);
+}
 
-//extern "C" void LLVMInitializeMDSPTargetInfo ()
-//{
-//	 RegisterTarget<Triple::mdsp, false> X(TheMDSPTarget, "mdsp", "MDSP");
-//}
+extern "C" void LLVMInitializeMDSPTarget() {
+  // Register the target.
+  RegisterTargetMachine<MDSPTargetMachine> X(TheMDSPTarget);
+  RegisterAsmInfo<MDSPMCAsmInfo> Z(TheMDSPTarget);
 
-/// MDSPTargetMachine ctor - Create an ILP32 architecture model
+  // Register the MC code emitter
+  TargetRegistry::RegisterCodeEmitter(TheMDSPTarget,
+                                      llvm::createMDSPMCCodeEmitter);
 
-MDSPTargetMachine::MDSPTargetMachine (const Target &T, const std::string &TT,
-									  const std::string &FS)
-  : llvm::LLVMTargetMachine	(T, TT),
-    DataLayout			("e-P:32:32-F128:128:128")
-    //Subtarget(TT, FS, is64bit),
+  // Register the asm backend
+  TargetRegistry::RegisterAsmBackend(TheMDSPTarget, createMDSPAsmBackend);
 
-  //  TLInfo(*this), TSInfo(*this), InstrInfo(Subtarget),
-   // FrameLowering(Subtarget)
-{
+  // Register the object streamer
+  TargetRegistry::RegisterObjectStreamer(TheMDSPTarget, createMCStreamer);
 }
 
+/// MDSPTargetMachine ctor - Create an ILP32 architecture model
+///
+MDSPTargetMachine::MDSPTargetMachine(const Target &T, const std::string &TT,
+                                     const std::string &FS)
+  : LLVMTargetMachine(T, TT),
+    Subtarget(TT, FS),
+    DataLayout("e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:32:64-"
+               "f32:32:32-f64:32:64-n32"),
+    InstrInfo(*this), TLInfo(*this), TSInfo(*this),
+    InstrItins(Subtarget.getInstrItineraryData()) {
+}
 
-extern "C" void LLVMInitializeMDSPTarget()
-{
-  // Register the target.
-  RegisterTargetMachine <MDSPTargetMachine> X(TheMDSPTarget);
+bool MDSPTargetMachine::addPreISel(PassManagerBase &PM,
+                                   CodeGenOpt::Level OptLevel) {
+  // Trip counts are only known to ScalarEvolution, so hardware loops are
+  // prepared on LLVM IR.
+  if (OptLevel != CodeGenOpt::None && Subtarget.hasHWLoop())
+    PM.add(createMDSPHardwareLoopPrep());
+  return true;
 }
 
+bool MDSPTargetMachine::addInstSelector(PassManagerBase &PM,
+                                        CodeGenOpt::Level OptLevel) {
+  // Install an instruction selector.
+  PM.add(createMDSPISelDag(*this, OptLevel));
+  return false;
+}
+
+bool MDSPTargetMachine::addPreRegAlloc(PassManagerBase &PM,
+                                       CodeGenOpt::Level OptLevel) {
+  // Overlap the iterations of DSP kernel loops while the code is still in
+  // SSA form, so that the register allocator sees the longer live ranges.
+  // Then close the counted loops with endloop. A pipelined kernel runs fewer
+  // times than the loop, so its count is taken from the induction variable.
+  if (OptLevel != CodeGenOpt::None) {
+    PM.add(createModuloSchedulingPass());
+    if (Subtarget.hasHWLoop())
+      PM.add(createMDSPHardwareLoops(*this));
+  }
+  return true;
+}
+
+bool MDSPTargetMachine::addPreEmitPass(PassManagerBase &PM,
+                                       CodeGenOpt::Level OptLevel) {
+  // Pack independent instructions into issue bundles. This has to run last,
+  // after anything that may still insert or move instructions.
+  if (OptLevel != CodeGenOpt::None)
+    PM.add(createMDSPPacketizer(*this));
+  return true;
+}
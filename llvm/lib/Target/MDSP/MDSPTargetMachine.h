@@ -1,4 +1,4 @@
-//===-- MDSPTargetMachine.h - Define TargetMachine for MDSP ---*- C++ -*-===//
+//===-- MDSPTargetMachine.h - Define TargetMachine for MDSP -----*- C++ -*-===//
 //
 //                     The LLVM Compiler Infrastructure
 //
@@ -14,22 +14,61 @@
 #ifndef MDSPTARGETMACHINE_H
 #define MDSPTARGETMACHINE_H
 
+#include "MDSPInstrInfo.h"
+#include "MDSPISelLowering.h"
+#include "MDSPFrameLowering.h"
+#include "MDSPSelectionDAGInfo.h"
+#include "MDSPRegisterInfo.h"
+#include "MDSPSubtarget.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetFrameLowering.h"
 
-namespace llvm
-{
+namespace llvm {
 
-class MDSPTargetMachine : public LLVMTargetMachine
-{
-  const TargetData DataLayout;       // Calculates type size & alignment
+/// MDSPTargetMachine
+///
+class MDSPTargetMachine : public LLVMTargetMachine {
+  MDSPSubtarget          Subtarget;
+  const TargetData       DataLayout;       // Calculates type size & alignment
+  MDSPInstrInfo          InstrInfo;
+  MDSPTargetLowering     TLInfo;
+  MDSPSelectionDAGInfo   TSInfo;
+  MDSPFrameLowering      FrameLowering;
+  InstrItineraryData     InstrItins;
 
 public:
-  MDSPTargetMachine (const Target &T, const std::string &TT, const std::string &FS);
+  MDSPTargetMachine(const Target &T, const std::string &TT,
+                    const std::string &FS);
 
-  virtual const TargetData       *getTargetData() const { return &DataLayout; }
-};
+  virtual const TargetFrameLowering *getFrameLowering() const {
+    return &FrameLowering;
+  }
+  virtual const MDSPInstrInfo *getInstrInfo() const  { return &InstrInfo; }
+  virtual const TargetData *getTargetData() const    { return &DataLayout; }
+  virtual const MDSPSubtarget *getSubtargetImpl() const { return &Subtarget; }
+
+  virtual const MDSPRegisterInfo *getRegisterInfo() const {
+    return &InstrInfo.getRegisterInfo();
+  }
+
+  virtual const MDSPTargetLowering *getTargetLowering() const {
+    return &TLInfo;
+  }
+
+  virtual const MDSPSelectionDAGInfo* getSelectionDAGInfo() const {
+    return &TSInfo;
+  }
+
+  virtual const InstrItineraryData *getInstrItineraryData() const {
+    return &InstrItins;
+  }
+
+  virtual bool addPreISel(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
+  virtual bool addInstSelector(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
+  virtual bool addPreRegAlloc(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
+  virtual bool addPreEmitPass(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
+}; // MDSPTargetMachine.
 
 } // end namespace llvm
 
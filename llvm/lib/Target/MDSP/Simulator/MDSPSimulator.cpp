@@ -0,0 +1,1106 @@
+//===-- MDSPSimulator.cpp - MDSP instruction set simulator ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the MDSPSimulator class. The instruction encodings are
+// those of MDSPInstrFormats.td and MDSPInstrInfo.td.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MDSPSimulator.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/ELF.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+using namespace llvm;
+
+namespace {
+  /// Primary opcodes, bits 31-26 of every instruction word.
+  enum {
+    OP_ALU     = 0x00,
+    OP_MUL     = 0x01,
+    OP_SEL     = 0x02,
+    OP_ADDI    = 0x04,
+    OP_ANDI    = 0x05,
+    OP_ORI     = 0x06,
+    OP_XORI    = 0x07,
+    OP_SLTI    = 0x08,
+    OP_SLTIU   = 0x09,
+    OP_MOVHI   = 0x0a,
+    OP_SHLI    = 0x0b,
+    OP_SRLI    = 0x0c,
+    OP_SRAI    = 0x0d,
+    OP_LDW     = 0x10,
+    OP_LDH     = 0x11,
+    OP_LDHU    = 0x12,
+    OP_LDB     = 0x13,
+    OP_LDBU    = 0x14,
+    OP_LDC     = 0x15,
+    OP_STW     = 0x18,
+    OP_STH     = 0x19,
+    OP_STB     = 0x1a,
+    OP_STC     = 0x1b,
+    OP_BEQ     = 0x20,
+    OP_BNE     = 0x21,
+    OP_BLT     = 0x22,
+    OP_BGE     = 0x23,
+    OP_BLTU    = 0x24,
+    OP_BGEU    = 0x25,
+    OP_BR      = 0x28,
+    OP_CALL    = 0x29,
+    OP_JR      = 0x2a,
+    OP_CALLR   = 0x2b,
+    OP_LOOP    = 0x2c,
+    OP_ENDLOOP = 0x2d,
+    OP_PACKET  = 0x3f
+  };
+
+  /// Register number used for the loop counter in the scoreboard.
+  const unsigned LCReg = 32;
+
+  /// Nothing is mapped below this address. Returning to address zero ends a
+  /// run, and runtime functions live in the first page.
+  const uint32_t FirstMappedAddr = 0x1000;
+  const uint32_t HaltAddr = 0;
+  const uint32_t RuntimeBase = 0x100;
+
+  /// No packet holds more than this many words.
+  const unsigned MaxPacketSize = 8;
+
+  enum RuntimeFunction {
+    RT_DIVSI3,
+    RT_UDIVSI3,
+    RT_MODSI3,
+    RT_UMODSI3,
+    RT_MEMCPY,
+    RT_MEMMOVE,
+    RT_MEMSET,
+    RT_PUTCHAR,
+    RT_ABORT,
+    RT_NUM
+  };
+
+  const char *const RuntimeNames[RT_NUM] = {
+    "__divsi3", "__udivsi3", "__modsi3", "__umodsi3",
+    "memcpy", "memmove", "memset", "putchar", "abort"
+  };
+
+  /// CoreTiming - The latencies of an MDSP core, as in its itineraries in
+  /// MDSPSchedule.td. The MAC reads its accumulator when the multiply
+  /// completes.
+  struct CoreTiming {
+    const char *Name;
+    unsigned LoadLatency;
+    unsigned MulLatency;
+  };
+
+  const CoreTiming Cores[] = {
+    { "generic", 2, 2 },
+    { "mdsp100", 2, 2 },
+    { "mdsp200", 2, 2 },
+    { "mdsp300", 3, 3 }
+  };
+
+  /// Inst - A decoded instruction.
+  struct Inst {
+    unsigned Opcode, Func;
+    unsigned Rd, Rs, Rt, Rf;
+    uint32_t Imm;
+
+    // Registers read, with the cycle of the itinerary that reads them.
+    unsigned NumSrcs;
+    unsigned Srcs[4];
+    unsigned SrcCycles[4];
+
+    // Register written and the number of cycles until it can be read.
+    unsigned Dst;
+    unsigned Latency;
+
+    void addSrc(unsigned Reg, unsigned Cycle = 1) {
+      Srcs[NumSrcs] = Reg;
+      SrcCycles[NumSrcs++] = Cycle;
+    }
+    void setDst(unsigned Reg, unsigned Lat) { Dst = Reg; Latency = Lat; }
+
+    /// usesSlot - endloop is executed by the loop unit, everything else needs
+    /// an issue slot.
+    bool usesSlot() const { return Opcode != OP_ENDLOOP; }
+  };
+
+  /// SectionHeader - The fields of an Elf32_Shdr the simulator looks at.
+  struct SectionHeader {
+    uint32_t Type, Flags, Offset, Size, Link, Info, AddrAlign, EntSize;
+  };
+}
+
+static uint16_t read16(StringRef Data, uint32_t Offset) {
+  return support::endian::read_le<uint16_t, support::unaligned>(
+           Data.data() + Offset);
+}
+
+static uint32_t read32(StringRef Data, uint32_t Offset) {
+  return support::endian::read_le<uint32_t, support::unaligned>(
+           Data.data() + Offset);
+}
+
+static int32_t signExtend(uint32_t Value, unsigned Bits) {
+  return int32_t(Value << (32 - Bits)) >> (32 - Bits);
+}
+
+static std::string hex(uint32_t Value) {
+  return "0x" + utohexstr(Value);
+}
+
+/// decode - Split an instruction word into its fields and record the
+/// registers it reads and writes, with the timing of Core. Returns false for
+/// an illegal encoding.
+static bool decode(uint32_t Word, const CoreTiming &Core, Inst &I) {
+  I.Opcode = Word >> 26;
+  I.Rd = (Word >> 21) & 31;
+  I.Rs = (Word >> 16) & 31;
+  I.Rt = (Word >> 11) & 31;
+  I.Rf = (Word >> 6) & 31;
+  I.Func = Word & 0x7ff;
+  I.Imm = Word & 0xffff;
+  I.NumSrcs = 0;
+  I.Dst = 0;
+  I.Latency = 0;
+
+  switch (I.Opcode) {
+  default:
+    return false;
+  case OP_ALU:
+    if (I.Func > 0x12)
+      return false;
+    I.addSrc(I.Rs);
+    I.addSrc(I.Rt);
+    I.setDst(I.Rd, 1);
+    return true;
+  case OP_MUL:
+    switch (I.Func) {
+    default:
+      return false;
+    case 0x03: case 0x04:
+      I.addSrc(I.Rd, Core.MulLatency);
+      // FALL THROUGH
+    case 0x00: case 0x01: case 0x02: case 0x05:
+      I.addSrc(I.Rs);
+      I.addSrc(I.Rt);
+      I.setDst(I.Rd, Core.MulLatency);
+      return true;
+    }
+  case OP_SEL:
+    if ((Word & 0x3f) != 0)
+      return false;
+    I.addSrc(I.Rs);
+    I.addSrc(I.Rt);
+    I.addSrc(I.Rf);
+    I.setDst(I.Rd, 1);
+    return true;
+  case OP_ADDI: case OP_ANDI: case OP_ORI: case OP_XORI:
+  case OP_SLTI: case OP_SLTIU: case OP_MOVHI:
+  case OP_SHLI: case OP_SRLI: case OP_SRAI:
+    I.addSrc(I.Rs);
+    I.setDst(I.Rd, 1);
+    return true;
+  case OP_LDW: case OP_LDH: case OP_LDHU: case OP_LDB: case OP_LDBU:
+    I.addSrc(I.Rs);
+    I.setDst(I.Rd, Core.LoadLatency);
+    return true;
+  case OP_LDC:
+    if ((Word & 0x3f) > 0x04)
+      return false;
+    I.addSrc(I.Rs);
+    I.addSrc(I.Rt);
+    I.addSrc(I.Rf);
+    I.setDst(I.Rd, Core.LoadLatency);
+    return true;
+  case OP_STW: case OP_STH: case OP_STB:
+    I.addSrc(I.Rd);
+    I.addSrc(I.Rs);
+    return true;
+  case OP_STC:
+    if ((Word & 0x3f) > 0x02)
+      return false;
+    I.addSrc(I.Rd);
+    I.addSrc(I.Rs);
+    I.addSrc(I.Rt);
+    I.addSrc(I.Rf);
+    return true;
+  case OP_BEQ: case OP_BNE: case OP_BLT:
+  case OP_BGE: case OP_BLTU: case OP_BGEU:
+    // The registers of a compare and branch sit in the rd and rs fields.
+    I.addSrc(I.Rd);
+    I.addSrc(I.Rs);
+    return true;
+  case OP_BR:
+    I.Imm = Word & 0x3ffffff;
+    return true;
+  case OP_CALL:
+    I.Imm = Word & 0x3ffffff;
+    I.setDst(31, 1);
+    return true;
+  case OP_JR:
+    I.addSrc(I.Rs);
+    return true;
+  case OP_CALLR:
+    I.addSrc(I.Rs);
+    I.setDst(31, 1);
+    return true;
+  case OP_LOOP:
+    I.addSrc(I.Rs);
+    I.setDst(LCReg, 1);
+    return true;
+  case OP_ENDLOOP:
+    I.Imm = Word & 0x3ffffff;
+    I.addSrc(LCReg);
+    I.setDst(LCReg, 1);
+    return true;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Loading and linking
+//===----------------------------------------------------------------------===//
+
+MDSPSimulator::MDSPSimulator(uint32_t MemorySize)
+  : Memory(MemorySize), NextAddr(FirstMappedAddr), Linked(false), Core(0),
+    LC(0), PC(HaltAddr), Now(0), LastFunction(~0U), TotalStalls(0),
+    TotalPackets(0), TotalInsts(0), Out(0) {
+  std::memset(Regs, 0, sizeof(Regs));
+  std::memset(Ready, 0, sizeof(Ready));
+}
+
+bool MDSPSimulator::setCPU(StringRef CPU) {
+  for (unsigned i = 0, e = array_lengthof(Cores); i != e; ++i)
+    if (CPU == Cores[i].Name) {
+      Core = i;
+      return true;
+    }
+  return false;
+}
+
+MDSPSimulator::~MDSPSimulator() {
+  for (unsigned i = 0, e = Objects.size(); i != e; ++i) {
+    delete Objects[i]->Buffer;
+    delete Objects[i];
+  }
+}
+
+/// allocate - Reserve Size bytes of memory for a section or common symbol.
+/// Returns true if memory is exhausted.
+bool MDSPSimulator::allocate(uint32_t Size, uint32_t Align, uint32_t &Addr) {
+  if (Align == 0)
+    Align = 1;
+  Addr = (NextAddr + Align - 1) & ~(Align - 1);
+  if (Addr < NextAddr || uint64_t(Addr) + Size > Memory.size())
+    return true;
+  NextAddr = Addr + Size;
+  return false;
+}
+
+static SectionHeader readSectionHeader(StringRef Data, uint32_t Offset) {
+  SectionHeader SH;
+  SH.Type = read32(Data, Offset + 4);
+  SH.Flags = read32(Data, Offset + 8);
+  SH.Offset = read32(Data, Offset + 16);
+  SH.Size = read32(Data, Offset + 20);
+  SH.Link = read32(Data, Offset + 24);
+  SH.Info = read32(Data, Offset + 28);
+  SH.AddrAlign = read32(Data, Offset + 32);
+  SH.EntSize = read32(Data, Offset + 36);
+  return SH;
+}
+
+/// getSectionHeaders - Read the section header table of an ELF object.
+/// Returns true and sets ErrMsg if the table does not fit in the file.
+static bool getSectionHeaders(StringRef Data, StringRef Name,
+                              std::vector<SectionHeader> &Headers,
+                              std::string *ErrMsg) {
+  uint32_t ShOff = read32(Data, 32);
+  uint16_t ShEntSize = read16(Data, 46);
+  uint16_t ShNum = read16(Data, 48);
+  if (ShEntSize < 40 || uint64_t(ShOff) + uint64_t(ShEntSize) * ShNum >
+                          Data.size()) {
+    if (ErrMsg)
+      *ErrMsg = Name.str() + ": malformed section header table";
+    return true;
+  }
+
+  for (unsigned i = 0; i != ShNum; ++i) {
+    SectionHeader SH = readSectionHeader(Data, ShOff + i * ShEntSize);
+    if (SH.Type != ELF::SHT_NOBITS &&
+        uint64_t(SH.Offset) + SH.Size > Data.size()) {
+      if (ErrMsg)
+        *ErrMsg = Name.str() + ": section " + utostr(i) +
+                  " extends past the end of the file";
+      return true;
+    }
+    Headers.push_back(SH);
+  }
+  return false;
+}
+
+bool MDSPSimulator::addObject(MemoryBuffer *Buffer, std::string *ErrMsg) {
+  Objects.push_back(new Object());
+  Object &Obj = *Objects.back();
+  Obj.Name = Buffer->getBufferIdentifier();
+  Obj.Buffer = Buffer;
+  Linked = false;
+
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < sizeof(ELF::Elf32_Ehdr) ||
+      std::memcmp(Data.data(), ELF::ElfMagic, 4) != 0) {
+    if (ErrMsg)
+      *ErrMsg = Obj.Name + ": not an ELF file";
+    return true;
+  }
+  if (Data[ELF::EI_CLASS] != ELF::ELFCLASS32 ||
+      Data[ELF::EI_DATA] != ELF::ELFDATA2LSB ||
+      read16(Data, 18) != ELF::EM_MDSP) {
+    if (ErrMsg)
+      *ErrMsg = Obj.Name + ": not an MDSP object";
+    return true;
+  }
+  if (read16(Data, 16) != ELF::ET_REL) {
+    if (ErrMsg)
+      *ErrMsg = Obj.Name + ": not a relocatable object";
+    return true;
+  }
+
+  std::vector<SectionHeader> Headers;
+  if (getSectionHeaders(Data, Obj.Name, Headers, ErrMsg))
+    return true;
+
+  // Lay out the allocatable sections one after the other.
+  for (unsigned i = 0, e = Headers.size(); i != e; ++i) {
+    const SectionHeader &SH = Headers[i];
+    Section S;
+    S.Addr = 0;
+    S.Size = 0;
+    if ((SH.Flags & ELF::SHF_ALLOC) && SH.Size != 0) {
+      if (allocate(SH.Size, SH.AddrAlign, S.Addr)) {
+        if (ErrMsg)
+          *ErrMsg = Obj.Name + ": program does not fit in memory";
+        return true;
+      }
+      S.Size = SH.Size;
+      if (SH.Type != ELF::SHT_NOBITS)
+        std::memcpy(&Memory[S.Addr], Data.data() + SH.Offset, SH.Size);
+    }
+    Obj.Sections.push_back(S);
+  }
+
+  // Give every symbol an address and enter the global ones into the global
+  // symbol table.
+  for (unsigned i = 0, e = Headers.size(); i != e; ++i) {
+    const SectionHeader &SH = Headers[i];
+    if (SH.Type != ELF::SHT_SYMTAB)
+      continue;
+    if (SH.EntSize < 16 || SH.Link >= Headers.size()) {
+      if (ErrMsg)
+        *ErrMsg = Obj.Name + ": malformed symbol table";
+      return true;
+    }
+    StringRef StrTab = Data.substr(Headers[SH.Link].Offset,
+                                   Headers[SH.Link].Size);
+
+    unsigned NumSymbols = SH.Size / SH.EntSize;
+    Obj.SymbolAddrs.assign(NumSymbols, 0);
+    Obj.SymbolDefined.assign(NumSymbols, true);
+    Obj.SymbolNames.assign(NumSymbols, StringRef());
+    for (unsigned s = 1; s < NumSymbols; ++s) {
+      uint32_t Offset = SH.Offset + s * SH.EntSize;
+      uint32_t NameIdx = read32(Data, Offset);
+      uint32_t Value = read32(Data, Offset + 4);
+      uint32_t Size = read32(Data, Offset + 8);
+      uint8_t Info = Data[Offset + 12];
+      uint16_t Shndx = read16(Data, Offset + 14);
+      unsigned Binding = Info >> 4;
+      unsigned Type = Info & 0xf;
+
+      StringRef Name;
+      if (NameIdx < StrTab.size())
+        Name = StrTab.substr(NameIdx).data();
+      Obj.SymbolNames[s] = Name;
+
+      uint32_t Addr;
+      if (Shndx == ELF::SHN_UNDEF) {
+        Obj.SymbolDefined[s] = false;
+        continue;
+      } else if (Shndx == ELF::SHN_ABS) {
+        Addr = Value;
+      } else if (Shndx == ELF::SHN_COMMON) {
+        // Common symbols keep their alignment in the value field.
+        if (allocate(Size, Value, Addr)) {
+          if (ErrMsg)
+            *ErrMsg = Obj.Name + ": program does not fit in memory";
+          return true;
+        }
+      } else if (Shndx < Obj.Sections.size()) {
+        Addr = Obj.Sections[Shndx].Addr + Value;
+      } else {
+        if (ErrMsg)
+          *ErrMsg = Obj.Name + ": symbol '" + Name.str() +
+                    "' has a bad section index";
+        return true;
+      }
+      Obj.SymbolAddrs[s] = Addr;
+
+      if (Type == ELF::STT_FUNC)
+        Profile.push_back(FunctionProfile(Name, Addr, Addr + Size));
+
+      if (Binding != ELF::STB_GLOBAL && Binding != ELF::STB_WEAK)
+        continue;
+      bool Weak = Binding == ELF::STB_WEAK;
+      StringMap<bool>::iterator W = WeakGlobals.find(Name);
+      if (W != WeakGlobals.end()) {
+        if (Weak)
+          continue;
+        if (!W->second) {
+          if (ErrMsg)
+            *ErrMsg = Obj.Name + ": duplicate symbol '" + Name.str() + "'";
+          return true;
+        }
+      }
+      Globals[Name] = Addr;
+      WeakGlobals[Name] = Weak;
+    }
+  }
+  return false;
+}
+
+/// resolveUndefined - Return true and set Addr if the simulator provides the
+/// function Name itself.
+bool MDSPSimulator::resolveUndefined(StringRef Name, uint32_t &Addr) {
+  for (unsigned i = 0; i != RT_NUM; ++i)
+    if (Name == RuntimeNames[i]) {
+      Addr = RuntimeBase + 4 * i;
+      if (!Globals.count(Name)) {
+        Globals[Name] = Addr;
+        Profile.push_back(FunctionProfile(Name, Addr, Addr + 4));
+      }
+      return true;
+    }
+  return false;
+}
+
+/// applyRelocations - Patch the relocated fields of all allocated sections of
+/// Obj now that every symbol has an address.
+bool MDSPSimulator::applyRelocations(Object &Obj, std::string *ErrMsg) {
+  StringRef Data = Obj.Buffer->getBuffer();
+  std::vector<SectionHeader> Headers;
+  if (getSectionHeaders(Data, Obj.Name, Headers, ErrMsg))
+    return true;
+
+  for (unsigned i = 0, e = Headers.size(); i != e; ++i) {
+    const SectionHeader &SH = Headers[i];
+    if (SH.Type == ELF::SHT_REL) {
+      if (ErrMsg)
+        *ErrMsg = Obj.Name + ": REL relocations are not supported";
+      return true;
+    }
+    if (SH.Type != ELF::SHT_RELA || SH.Info >= Obj.Sections.size())
+      continue;
+    const Section &Target = Obj.Sections[SH.Info];
+    if (Target.Size == 0)
+      continue;
+
+    unsigned EntSize = SH.EntSize ? SH.EntSize : 12;
+    for (uint32_t Offset = SH.Offset, End = SH.Offset + SH.Size;
+         Offset + 12 <= End; Offset += EntSize) {
+      uint32_t ROffset = read32(Data, Offset);
+      uint32_t RInfo = read32(Data, Offset + 4);
+      int32_t Addend = read32(Data, Offset + 8);
+      unsigned Sym = RInfo >> 8;
+      unsigned Type = RInfo & 0xff;
+
+      if (Sym >= Obj.SymbolAddrs.size() || ROffset + 4 > Target.Size ||
+          (ROffset & 3) != 0) {
+        if (ErrMsg)
+          *ErrMsg = Obj.Name + ": malformed relocation";
+        return true;
+      }
+
+      uint32_t P = Target.Addr + ROffset;
+      uint32_t S = Obj.SymbolAddrs[Sym];
+      uint32_t Field = load(P, 4);
+      uint32_t Value = S + Addend;
+      int32_t Delta = int32_t(Value - P);
+      switch (Type) {
+      default:
+        if (ErrMsg)
+          *ErrMsg = Obj.Name + ": unsupported relocation type " +
+                    utostr(Type);
+        return true;
+      case ELF::R_MDSP_NONE:
+        continue;
+      case ELF::R_MDSP_32:
+        Field = Value;
+        break;
+      case ELF::R_MDSP_PC32:
+        Field = Delta;
+        break;
+      case ELF::R_MDSP_PC16:
+        if ((Delta & 3) != 0 || signExtend(Delta >> 2, 16) != Delta >> 2) {
+          if (ErrMsg)
+            *ErrMsg = Obj.Name + ": branch to '" +
+                      Obj.SymbolNames[Sym].str() + "' out of range";
+          return true;
+        }
+        Field = (Field & ~0xffffU) | ((Delta >> 2) & 0xffff);
+        break;
+      case ELF::R_MDSP_PC26:
+        if ((Delta & 3) != 0 || signExtend(Delta >> 2, 26) != Delta >> 2) {
+          if (ErrMsg)
+            *ErrMsg = Obj.Name + ": call or jump to '" +
+                      Obj.SymbolNames[Sym].str() + "' out of range";
+          return true;
+        }
+        Field = (Field & ~0x3ffffffU) | ((Delta >> 2) & 0x3ffffff);
+        break;
+      case ELF::R_MDSP_HI16:
+        Field = (Field & ~0xffffU) | (Value >> 16);
+        break;
+      case ELF::R_MDSP_LO16:
+        Field = (Field & ~0xffffU) | (Value & 0xffff);
+        break;
+      }
+      store(P, 4, Field);
+    }
+  }
+  return false;
+}
+
+bool MDSPSimulator::link(std::string *ErrMsg) {
+  for (unsigned i = 0, e = Objects.size(); i != e; ++i) {
+    Object &Obj = *Objects[i];
+    for (unsigned s = 1, se = Obj.SymbolAddrs.size(); s < se; ++s) {
+      if (Obj.SymbolDefined[s])
+        continue;
+      StringRef Name = Obj.SymbolNames[s];
+      StringMap<uint32_t>::iterator G = Globals.find(Name);
+      if (G != Globals.end())
+        Obj.SymbolAddrs[s] = G->second;
+      else if (!resolveUndefined(Name, Obj.SymbolAddrs[s])) {
+        if (ErrMsg)
+          *ErrMsg = Obj.Name + ": undefined symbol '" + Name.str() + "'";
+        return true;
+      }
+    }
+  }
+
+  for (unsigned i = 0, e = Objects.size(); i != e; ++i)
+    if (applyRelocations(*Objects[i], ErrMsg))
+      return true;
+
+  std::sort(Profile.begin(), Profile.end(), FunctionProfile::startsBefore);
+  LastFunction = ~0U;
+  Linked = true;
+  return false;
+}
+
+bool MDSPSimulator::lookupSymbol(StringRef Name, uint32_t &Addr) const {
+  StringMap<uint32_t>::const_iterator G = Globals.find(Name);
+  if (G == Globals.end())
+    return false;
+  Addr = G->second;
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// Execution
+//===----------------------------------------------------------------------===//
+
+bool MDSPSimulator::checkAccess(uint32_t Addr, unsigned Size,
+                                std::string *ErrMsg) const {
+  if (Addr < FirstMappedAddr || uint64_t(Addr) + Size > Memory.size()) {
+    if (ErrMsg)
+      *ErrMsg = "access to unmapped address " + hex(Addr) + " at " + hex(PC);
+    return true;
+  }
+  if ((Addr & (Size - 1)) != 0) {
+    if (ErrMsg)
+      *ErrMsg = "misaligned access to " + hex(Addr) + " at " + hex(PC);
+    return true;
+  }
+  return false;
+}
+
+uint32_t MDSPSimulator::load(uint32_t Addr, unsigned Size) const {
+  uint32_t Value = 0;
+  for (unsigned i = 0; i != Size; ++i)
+    Value |= uint32_t(Memory[Addr + i]) << (8 * i);
+  return Value;
+}
+
+void MDSPSimulator::store(uint32_t Addr, unsigned Size, uint32_t Value) {
+  for (unsigned i = 0; i != Size; ++i)
+    Memory[Addr + i] = uint8_t(Value >> (8 * i));
+}
+
+/// getFunction - Return the index of the profile entry of the function
+/// containing Addr, or ~0U if Addr is outside of all known functions.
+unsigned MDSPSimulator::getFunction(uint32_t Addr) {
+  if (LastFunction < Profile.size() && Profile[LastFunction].Start <= Addr &&
+      Addr < Profile[LastFunction].End)
+    return LastFunction;
+
+  // Find the last function starting at or below Addr.
+  unsigned Lo = 0, Hi = Profile.size();
+  while (Lo < Hi) {
+    unsigned Mid = (Lo + Hi) / 2;
+    if (Profile[Mid].Start <= Addr)
+      Lo = Mid + 1;
+    else
+      Hi = Mid;
+  }
+  if (Lo == 0 || Addr >= Profile[Lo - 1].End)
+    return ~0U;
+  return LastFunction = Lo - 1;
+}
+
+/// callRuntime - Execute one of the runtime functions the simulator provides
+/// and return to the caller.
+bool MDSPSimulator::callRuntime(unsigned Index, std::string *ErrMsg) {
+  uint32_t A = Regs[1], B = Regs[2], C = Regs[3];
+  uint32_t Result = 0;
+  switch (Index) {
+  case RT_DIVSI3:
+  case RT_UDIVSI3:
+  case RT_MODSI3:
+  case RT_UMODSI3:
+    if (B == 0) {
+      if (ErrMsg)
+        *ErrMsg = std::string("division by zero in ") + RuntimeNames[Index];
+      return true;
+    }
+    if (Index == RT_DIVSI3)
+      Result = uint32_t(int64_t(int32_t(A)) / int32_t(B));
+    else if (Index == RT_MODSI3)
+      Result = uint32_t(int64_t(int32_t(A)) % int32_t(B));
+    else if (Index == RT_UDIVSI3)
+      Result = A / B;
+    else
+      Result = A % B;
+    break;
+  case RT_MEMCPY:
+  case RT_MEMMOVE:
+  case RT_MEMSET:
+    if (C != 0 && (checkAccess(A, 1, ErrMsg) || checkAccess(A + C - 1, 1,
+                                                            ErrMsg)))
+      return true;
+    if (Index == RT_MEMSET)
+      std::memset(&Memory[A], int(B), C);
+    else if (C != 0) {
+      if (checkAccess(B, 1, ErrMsg) || checkAccess(B + C - 1, 1, ErrMsg))
+        return true;
+      std::memmove(&Memory[A], &Memory[B], C);
+    }
+    Result = A;
+    break;
+  case RT_PUTCHAR:
+    if (Out)
+      *Out << char(A);
+    Result = A;
+    break;
+  case RT_ABORT:
+    if (ErrMsg)
+      *ErrMsg = "program called abort";
+    return true;
+  }
+
+  unsigned F = getFunction(PC);
+  if (F != ~0U)
+    Profile[F].Cycles += RuntimeCallCycles;
+  Now += RuntimeCallCycles;
+  Regs[1] = Result;
+  PC = Regs[31];
+  return false;
+}
+
+/// stepPacket - Issue the packet at PC.
+bool MDSPSimulator::stepPacket(std::string *ErrMsg) {
+  if (PC >= RuntimeBase && PC < RuntimeBase + 4 * RT_NUM && (PC & 3) == 0)
+    return callRuntime((PC - RuntimeBase) / 4, ErrMsg);
+
+  if ((PC & 3) != 0 || checkAccess(PC, 4, 0)) {
+    if (ErrMsg)
+      *ErrMsg = "jump to bad address " + hex(PC);
+    return true;
+  }
+
+  // Read the packet header, if any.
+  uint32_t Addr = PC;
+  unsigned Size = 1;
+  uint32_t Word = load(Addr, 4);
+  if ((Word >> 26) == OP_PACKET) {
+    Size = Word & 0x3ffffff;
+    if (Size < 2 || Size > MaxPacketSize) {
+      if (ErrMsg)
+        *ErrMsg = "malformed packet header at " + hex(PC);
+      return true;
+    }
+    Addr += 4;
+  }
+
+  Inst Insts[MaxPacketSize];
+  uint32_t InstAddrs[MaxPacketSize];
+  for (unsigned i = 0; i != Size; ++i, Addr += 4) {
+    if (checkAccess(Addr, 4, 0)) {
+      if (ErrMsg)
+        *ErrMsg = "packet at " + hex(PC) + " runs off the end of memory";
+      return true;
+    }
+    InstAddrs[i] = Addr;
+    if (!decode(load(Addr, 4), Cores[Core], Insts[i])) {
+      if (ErrMsg)
+        *ErrMsg = "illegal instruction " + hex(load(Addr, 4)) + " at " +
+                  hex(Addr);
+      return true;
+    }
+  }
+  uint32_t NextPC = Addr;
+
+  // The packet issues once the last of its operands is ready.
+  uint64_t Issue = Now;
+  unsigned SlotInsts = 0;
+  for (unsigned i = 0; i != Size; ++i) {
+    const Inst &I = Insts[i];
+    for (unsigned s = 0; s != I.NumSrcs; ++s) {
+      uint64_t Needed = Ready[I.Srcs[s]];
+      if (Needed > Issue + I.SrcCycles[s] - 1)
+        Issue = Needed - (I.SrcCycles[s] - 1);
+    }
+    if (I.usesSlot())
+      ++SlotInsts;
+  }
+
+  // All instructions of a packet read their operands before any of them
+  // writes a result.
+  uint32_t Results[MaxPacketSize];
+  bool Taken = false, Call = false, EndLoop = false;
+  uint32_t Target = 0, LoopTarget = 0;
+  for (unsigned i = 0; i != Size; ++i) {
+    const Inst &I = Insts[i];
+    uint32_t S = Regs[I.Rs], T = Regs[I.Rt], D = Regs[I.Rd];
+    uint32_t SImm = uint32_t(signExtend(I.Imm, 16));
+    uint32_t &R = Results[i];
+    R = 0;
+
+    switch (I.Opcode) {
+    case OP_ALU:
+      switch (I.Func) {
+      case 0x00: R = S + T; break;
+      case 0x01: R = S - T; break;
+      case 0x02: R = S & T; break;
+      case 0x03: R = S | T; break;
+      case 0x04: R = S ^ T; break;
+      case 0x05: R = S << (T & 31); break;
+      case 0x06: R = S >> (T & 31); break;
+      case 0x07: R = uint32_t(int32_t(S) >> (T & 31)); break;
+      case 0x08: R = int32_t(S) < int32_t(T); break;
+      case 0x09: R = S < T; break;
+      case 0x0a: R = int32_t(S) < int32_t(T) ? S : T; break;
+      case 0x0b: R = int32_t(S) > int32_t(T) ? S : T; break;
+      case 0x0c: R = S < T ? S : T; break;
+      case 0x0d: R = S > T ? S : T; break;
+      case 0x0e:
+      case 0x0f: {
+        int64_t V = I.Func == 0x0e ? int64_t(int32_t(S)) + int32_t(T)
+                                   : int64_t(int32_t(S)) - int32_t(T);
+        V = std::max<int64_t>(std::min<int64_t>(V, INT32_MAX), INT32_MIN);
+        R = uint32_t(V);
+        break;
+      }
+      case 0x10: R = CountLeadingZeros_32(S); break;
+      case 0x11: R = uint32_t(signExtend(S, 8)); break;
+      case 0x12: R = uint32_t(signExtend(S, 16)); break;
+      }
+      break;
+    case OP_MUL:
+      switch (I.Func) {
+      case 0x00: R = S * T; break;
+      case 0x01: R = uint32_t((int64_t(int32_t(S)) * int32_t(T)) >> 32); break;
+      case 0x02: R = uint32_t((uint64_t(S) * T) >> 32); break;
+      case 0x03: R = D + S * T; break;
+      case 0x04: R = D - S * T; break;
+      case 0x05: {
+        int64_t V = (int64_t(int32_t(S)) * int32_t(T)) >> 31;
+        V = std::max<int64_t>(std::min<int64_t>(V, INT32_MAX), INT32_MIN);
+        R = uint32_t(V);
+        break;
+      }
+      }
+      break;
+    case OP_SEL:   R = S != 0 ? T : Regs[I.Rf]; break;
+    case OP_ADDI:  R = S + SImm; break;
+    case OP_ANDI:  R = S & I.Imm; break;
+    case OP_ORI:   R = S | I.Imm; break;
+    case OP_XORI:  R = S ^ I.Imm; break;
+    case OP_SLTI:  R = int32_t(S) < int32_t(SImm); break;
+    case OP_SLTIU: R = S < SImm; break;
+    case OP_MOVHI: R = I.Imm << 16; break;
+    case OP_SHLI:  R = S << (I.Imm & 31); break;
+    case OP_SRLI:  R = S >> (I.Imm & 31); break;
+    case OP_SRAI:  R = uint32_t(int32_t(S) >> (I.Imm & 31)); break;
+    case OP_LDW: case OP_LDH: case OP_LDHU: case OP_LDB: case OP_LDBU:
+    case OP_LDC: case OP_STW: case OP_STH: case OP_STB: case OP_STC: {
+      // The access size and kind of a circular access is in its func field,
+      // the circular index wraps once around the buffer length.
+      unsigned Kind = I.Opcode;
+      uint32_t EA = S + SImm;
+      if (I.Opcode == OP_LDC || I.Opcode == OP_STC) {
+        unsigned F = I.Func & 0x3f;
+        Kind = I.Opcode == OP_LDC ? OP_LDW + F : OP_STW + F;
+        uint32_t Index = T >= Regs[I.Rf] ? T - Regs[I.Rf] : T;
+        unsigned Scale = (Kind == OP_LDW || Kind == OP_STW) ? 4 :
+                         (Kind == OP_LDB || Kind == OP_LDBU ||
+                          Kind == OP_STB) ? 1 : 2;
+        EA = S + Scale * Index;
+      }
+      switch (Kind) {
+      case OP_LDW:
+        if (checkAccess(EA, 4, ErrMsg)) return true;
+        R = load(EA, 4);
+        break;
+      case OP_LDH:
+        if (checkAccess(EA, 2, ErrMsg)) return true;
+        R = uint32_t(signExtend(load(EA, 2), 16));
+        break;
+      case OP_LDHU:
+        if (checkAccess(EA, 2, ErrMsg)) return true;
+        R = load(EA, 2);
+        break;
+      case OP_LDB:
+        if (checkAccess(EA, 1, ErrMsg)) return true;
+        R = uint32_t(signExtend(load(EA, 1), 8));
+        break;
+      case OP_LDBU:
+        if (checkAccess(EA, 1, ErrMsg)) return true;
+        R = load(EA, 1);
+        break;
+      case OP_STW:
+        if (checkAccess(EA, 4, ErrMsg)) return true;
+        store(EA, 4, D);
+        break;
+      case OP_STH:
+        if (checkAccess(EA, 2, ErrMsg)) return true;
+        store(EA, 2, D);
+        break;
+      case OP_STB:
+        if (checkAccess(EA, 1, ErrMsg)) return true;
+        store(EA, 1, D);
+        break;
+      }
+      break;
+    }
+    case OP_BEQ: case OP_BNE: case OP_BLT:
+    case OP_BGE: case OP_BLTU: case OP_BGEU: {
+      bool Cond = false;
+      switch (I.Opcode) {
+      case OP_BEQ:  Cond = D == S; break;
+      case OP_BNE:  Cond = D != S; break;
+      case OP_BLT:  Cond = int32_t(D) < int32_t(S); break;
+      case OP_BGE:  Cond = int32_t(D) >= int32_t(S); break;
+      case OP_BLTU: Cond = D < S; break;
+      case OP_BGEU: Cond = D >= S; break;
+      }
+      if (Cond) {
+        Taken = true;
+        Target = InstAddrs[i] + 4 * SImm;
+      }
+      break;
+    }
+    case OP_BR:
+    case OP_CALL:
+      Taken = true;
+      Target = InstAddrs[i] + 4 * uint32_t(signExtend(I.Imm, 26));
+      if (I.Opcode == OP_CALL) {
+        Call = true;
+        R = NextPC;
+      }
+      break;
+    case OP_JR:
+      Taken = true;
+      Target = S;
+      break;
+    case OP_CALLR:
+      Taken = true;
+      Call = true;
+      Target = S;
+      R = NextPC;
+      break;
+    case OP_LOOP:
+      R = S;
+      break;
+    case OP_ENDLOOP:
+      EndLoop = true;
+      R = LC - 1;
+      LoopTarget = InstAddrs[i] + 4 * uint32_t(signExtend(I.Imm, 26));
+      break;
+    }
+  }
+
+  // Write back the results and note when they can be read.
+  for (unsigned i = 0; i != Size; ++i) {
+    const Inst &I = Insts[i];
+    if (I.Latency == 0)
+      continue;
+    if (I.Dst == LCReg)
+      LC = Results[i];
+    else if (I.Dst != 0)
+      Regs[I.Dst] = Results[i];
+    else
+      continue;
+    Ready[I.Dst] = Issue + I.Latency;
+  }
+
+  // A branch out of the last packet of a hardware loop leaves the loop,
+  // otherwise endloop goes back to the top while the count lasts.
+  uint32_t OldPC = PC;
+  if (Taken)
+    PC = Target;
+  else if (EndLoop && LC != 0)
+    PC = LoopTarget;
+  else
+    PC = NextPC;
+
+  uint64_t Stalls = Issue - Now;
+  if (Taken)
+    Stalls += BranchPenalty;
+  uint64_t Cycles = (Issue - Now) + (SlotInsts ? 1 : 0) +
+                    (Taken ? BranchPenalty : 0);
+  Now += Cycles;
+  TotalStalls += Stalls;
+  if (SlotInsts) {
+    ++TotalPackets;
+    TotalInsts += SlotInsts;
+  }
+
+  unsigned F = getFunction(OldPC);
+  if (F != ~0U) {
+    FunctionProfile &FP = Profile[F];
+    FP.Cycles += Cycles;
+    FP.Stalls += Stalls;
+    if (SlotInsts) {
+      ++FP.Packets;
+      FP.Insts += SlotInsts;
+    }
+  }
+  if (Call) {
+    unsigned Callee = getFunction(PC);
+    if (Callee != ~0U)
+      ++Profile[Callee].Calls;
+  }
+  return false;
+}
+
+bool MDSPSimulator::run(uint32_t Entry, ArrayRef<uint32_t> Args,
+                        uint64_t MaxCycles, std::string *ErrMsg) {
+  if (!Linked) {
+    if (ErrMsg)
+      *ErrMsg = "the program has not been linked";
+    return true;
+  }
+
+  std::memset(Regs, 0, sizeof(Regs));
+  LC = 0;
+  for (unsigned i = 0; i != 33; ++i)
+    Ready[i] = Now;
+
+  // The first four arguments go in r1-r4, the rest on the stack.
+  uint32_t SP = uint32_t(Memory.size()) & ~7U;
+  if (Args.size() > 4)
+    SP = (SP - 4 * (Args.size() - 4)) & ~7U;
+  for (unsigned i = 0, e = Args.size(); i != e; ++i) {
+    if (i < 4)
+      Regs[i + 1] = Args[i];
+    else
+      store(SP + 4 * (i - 4), 4, Args[i]);
+  }
+  Regs[29] = SP;
+  Regs[31] = HaltAddr;
+  PC = Entry;
+
+  unsigned F = getFunction(Entry);
+  if (F != ~0U)
+    ++Profile[F].Calls;
+
+  uint64_t Start = Now;
+  while (PC != HaltAddr) {
+    if (MaxCycles && Now - Start >= MaxCycles) {
+      if (ErrMsg)
+        *ErrMsg = "cycle limit of " + utostr(MaxCycles) + " reached at " +
+                  hex(PC);
+      return true;
+    }
+    if (stepPacket(ErrMsg))
+      return true;
+  }
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// Reporting
+//===----------------------------------------------------------------------===//
+
+static bool moreCycles(const MDSPSimulator::FunctionProfile *A,
+                       const MDSPSimulator::FunctionProfile *B) {
+  if (A->Cycles != B->Cycles)
+    return A->Cycles > B->Cycles;
+  return A->Name < B->Name;
+}
+
+static void printUtilization(raw_ostream &OS, uint64_t Packets,
+                             uint64_t Insts) {
+  if (Packets == 0)
+    OS << "      -";
+  else
+    OS << format("%6.1f%%", 100.0 * Insts /
+                            (Packets * MDSPSimulator::IssueWidth));
+}
+
+static void printRow(raw_ostream &OS, StringRef Name, uint64_t Calls,
+                     uint64_t Cycles, uint64_t Stalls, uint64_t Packets,
+                     uint64_t Insts) {
+  OS << format("%-24s ", Name.str().c_str());
+  if (Calls)
+    OS << format("%8llu ", (unsigned long long)Calls);
+  else
+    OS << "         ";
+  OS << format("%12llu %10llu ", (unsigned long long)Cycles,
+               (unsigned long long)Stalls);
+  OS << format("%10llu %10llu ", (unsigned long long)Packets,
+               (unsigned long long)Insts);
+  printUtilization(OS, Packets, Insts);
+  OS << '\n';
+}
+
+void MDSPSimulator::printProfile(raw_ostream &OS) const {
+  std::vector<const FunctionProfile*> Sorted;
+  for (unsigned i = 0, e = Profile.size(); i != e; ++i)
+    if (Profile[i].Calls || Profile[i].Cycles)
+      Sorted.push_back(&Profile[i]);
+  std::sort(Sorted.begin(), Sorted.end(), moreCycles);
+
+  OS << "Function                    Calls       Cycles     Stalls    Packets"
+        "      Insts   Slots\n";
+  for (unsigned i = 0, e = Sorted.size(); i != e; ++i) {
+    const FunctionProfile &FP = *Sorted[i];
+    printRow(OS, FP.Name, FP.Calls, FP.Cycles, FP.Stalls, FP.Packets,
+             FP.Insts);
+  }
+  printRow(OS, "Total", 0, Now, TotalStalls, TotalPackets, TotalInsts);
+}
@@ -0,0 +1,171 @@
+//===-- MDSPSimulator.h - MDSP instruction set simulator --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the MDSPSimulator class, a cycle counting instruction set
+// simulator for MDSP. It links MDSP ELF relocatable objects into a flat memory
+// image, runs a function and keeps a profile of cycles, stalls and issue slot
+// use per function.
+//
+// The timing model follows the MDSP itineraries: every packet issues in one
+// cycle, loads and multiplies deliver their result one cycle late (two on the
+// MDSP300) and a packet waits until its operands are ready. A taken branch, jump, call or
+// return costs one extra cycle to refill the fetch stage; endloop branches
+// back without a bubble and does not take an issue slot.
+//
+// Calls to a few runtime functions that MDSP code needs but cannot provide
+// itself (division, memcpy and friends) are executed natively at a fixed
+// cost.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MDSPSIMULATOR_H
+#define MDSPSIMULATOR_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+  class MemoryBuffer;
+  class raw_ostream;
+
+class MDSPSimulator {
+public:
+  /// FunctionProfile - What the simulator measured while the PC was inside
+  /// one function. Cycles include stall cycles and branch bubbles.
+  struct FunctionProfile {
+    std::string Name;
+    uint32_t Start, End;
+    uint64_t Calls;
+    uint64_t Cycles;
+    uint64_t Stalls;
+    uint64_t Packets;
+    uint64_t Insts;
+
+    FunctionProfile(StringRef name, uint32_t start, uint32_t end)
+      : Name(name), Start(start), End(end), Calls(0), Cycles(0), Stalls(0),
+        Packets(0), Insts(0) {}
+
+    static bool startsBefore(const FunctionProfile &A,
+                             const FunctionProfile &B) {
+      return A.Start < B.Start;
+    }
+  };
+
+  /// Number of issue slots per packet.
+  static const unsigned IssueWidth = 2;
+
+  /// Extra cycles for a taken branch, jump, call or return.
+  static const unsigned BranchPenalty = 1;
+
+  /// Cycles charged for a runtime function executed by the simulator.
+  static const unsigned RuntimeCallCycles = 20;
+
+private:
+  struct Section {
+    uint32_t Addr;
+    uint32_t Size;
+  };
+
+  struct Object {
+    std::string Name;
+    MemoryBuffer *Buffer;
+    std::vector<Section> Sections;
+    std::vector<StringRef> SymbolNames;
+    std::vector<uint32_t> SymbolAddrs;
+    std::vector<bool> SymbolDefined;
+  };
+
+  std::vector<uint8_t> Memory;
+  std::vector<Object*> Objects;
+  StringMap<uint32_t> Globals;
+  StringMap<bool> WeakGlobals;
+  uint32_t NextAddr;
+  bool Linked;
+  unsigned Core;
+
+  uint32_t Regs[32];
+  uint32_t LC;
+  uint32_t PC;
+  uint64_t Now;
+  uint64_t Ready[33];
+
+  std::vector<FunctionProfile> Profile;
+  unsigned LastFunction;
+  uint64_t TotalStalls, TotalPackets, TotalInsts;
+
+  raw_ostream *Out;
+
+  MDSPSimulator(const MDSPSimulator &);  // DO NOT IMPLEMENT
+  void operator=(const MDSPSimulator &); // DO NOT IMPLEMENT
+
+  bool allocate(uint32_t Size, uint32_t Align, uint32_t &Addr);
+  bool applyRelocations(Object &Obj, std::string *ErrMsg);
+  bool resolveUndefined(StringRef Name, uint32_t &Addr);
+
+  bool checkAccess(uint32_t Addr, unsigned Size, std::string *ErrMsg) const;
+  uint32_t load(uint32_t Addr, unsigned Size) const;
+  void store(uint32_t Addr, unsigned Size, uint32_t Value);
+
+  unsigned getFunction(uint32_t Addr);
+  bool stepPacket(std::string *ErrMsg);
+  bool callRuntime(unsigned Index, std::string *ErrMsg);
+
+public:
+  /// MDSPSimulator ctor - Create a simulator with MemorySize bytes of memory.
+  /// The first page is never mapped; the stack starts at the top.
+  explicit MDSPSimulator(uint32_t MemorySize = 1 << 24);
+  ~MDSPSimulator();
+
+  /// setCPU - Use the latencies of the named MDSP core instead of those of
+  /// the generic one. Returns false if the core is unknown.
+  bool setCPU(StringRef CPU);
+
+  /// setOutput - Set the stream that putchar writes to.
+  void setOutput(raw_ostream &OS) { Out = &OS; }
+
+  /// addObject - Load the allocatable sections of an MDSP ELF relocatable
+  /// object into memory. The simulator takes ownership of the buffer. Returns
+  /// true and sets ErrMsg on failure.
+  bool addObject(MemoryBuffer *Buffer, std::string *ErrMsg);
+
+  /// link - Resolve the symbols of all loaded objects and apply their
+  /// relocations. Returns true and sets ErrMsg on failure.
+  bool link(std::string *ErrMsg);
+
+  /// lookupSymbol - Return true and set Addr if Name is a global symbol.
+  bool lookupSymbol(StringRef Name, uint32_t &Addr) const;
+
+  /// run - Call the function at Entry with Args, following the MDSP calling
+  /// convention, until it returns. Stops with an error after MaxCycles cycles
+  /// if that is not zero. Returns true and sets ErrMsg on failure.
+  bool run(uint32_t Entry, ArrayRef<uint32_t> Args, uint64_t MaxCycles,
+           std::string *ErrMsg);
+
+  /// getReturnValue - The value the last run returned in r1.
+  uint32_t getReturnValue() const { return Regs[1]; }
+
+  uint64_t getCycles() const { return Now; }
+  uint64_t getStalls() const { return TotalStalls; }
+  uint64_t getPackets() const { return TotalPackets; }
+  uint64_t getInsts() const { return TotalInsts; }
+
+  /// getProfile - The per function profile of all runs so far.
+  const std::vector<FunctionProfile> &getProfile() const { return Profile; }
+
+  /// printProfile - Print the functions that executed, most cycles first.
+  void printProfile(raw_ostream &OS) const;
+};
+
+} // end namespace llvm
+
+#endif
@@ -2443,7 +2443,8 @@ unsigned PrepareCall(SelectionDAG &DAG, SDValue &Callee, SDValue &InFlag,
       unsigned OpFlags = 0;
       if (DAG.getTarget().getRelocationModel() != Reloc::Static &&
           PPCSubTarget.getDarwinVers() < 9 &&
-          (G->getGlobal()->isDeclaration() ||
+          ((G->getGlobal()->isDeclaration() &&
+            !G->getGlobal()->isMaterializable()) ||
            G->getGlobal()->isWeakForLinker())) {
         // PC-relative references to external symbols should go through $stub,
         // unless we're building with the leopard linker or later, which
@@ -5503,6 +5504,10 @@ bool PPCTargetLowering::isLegalAddressingMode(const AddrMode &AM,
                                               const Type *Ty) const {
   // FIXME: PPC does not allow r+i addressing modes for vectors!
 
+  // PPC has no circular addressing.
+  if (AM.IsCircular)
+    return false;
+
   // PPC allows a sign-extended 16-bit immediate field.
   if (AM.BaseOffs <= -(1LL << 16) || AM.BaseOffs >= (1LL << 16)-1)
     return false;
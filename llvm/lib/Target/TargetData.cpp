@@ -380,11 +380,16 @@ public:
 
 } // end anonymous namespace
 
+// The struct layouts are computed on demand, possibly by function passes that
+// run on several functions at once.
+static ManagedStatic<sys::SmartMutex<true> > LayoutLock;
+
 TargetData::~TargetData() {
   delete static_cast<StructLayoutMap*>(LayoutMap);
 }
 
 const StructLayout *TargetData::getStructLayout(const StructType *Ty) const {
+  sys::SmartScopedLock<true> Lock(*LayoutLock);
   if (!LayoutMap)
     LayoutMap = new StructLayoutMap();
 
@@ -415,6 +420,7 @@ const StructLayout *TargetData::getStructLayout(const StructType *Ty) const {
 /// removed, this method must be called whenever a StructType is removed to
 /// avoid a dangling pointer in this cache.
 void TargetData::InvalidateStructLayoutInfo(const StructType *Ty) const {
+  sys::SmartScopedLock<true> Lock(*LayoutLock);
   if (!LayoutMap) return;  // No cache.
 
   static_cast<StructLayoutMap*>(LayoutMap)->InvalidateEntry(Ty);
@@ -117,6 +117,10 @@ class SSEDomainFixPass : public MachineFunctionPass {
 public:
   SSEDomainFixPass() : MachineFunctionPass(ID) {}
 
+  virtual FunctionPass *createParallelClone() const {
+    return new SSEDomainFixPass();
+  }
+
   virtual void getAnalysisUsage(AnalysisUsage &AU) const {
     AU.setPreservesAll();
     MachineFunctionPass::getAnalysisUsage(AU);
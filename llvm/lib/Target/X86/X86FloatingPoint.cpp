@@ -59,6 +59,10 @@ namespace {
       memset(RegMap, 0, sizeof(RegMap));
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new FPS();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesCFG();
       AU.addRequired<EdgeBundles>();
@@ -155,12 +155,20 @@ namespace {
     bool OptForSize;
 
   public:
-    explicit X86DAGToDAGISel(X86TargetMachine &tm, CodeGenOpt::Level OptLevel)
+    explicit X86DAGToDAGISel(const X86TargetMachine &tm,
+                             CodeGenOpt::Level OptLevel)
       : SelectionDAGISel(tm, OptLevel),
         X86Lowering(*tm.getTargetLowering()),
         Subtarget(&tm.getSubtarget<X86Subtarget>()),
         OptForSize(false) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      if (!canRunInParallel())
+        return 0;
+      return new X86DAGToDAGISel(static_cast<const X86TargetMachine &>(TM),
+                                 OptLevel);
+    }
+
     virtual const char *getPassName() const {
       return "X86 DAG->DAG Instruction Selection";
     }
@@ -2265,7 +2265,8 @@ X86TargetLowering::LowerCall(SDValue Chain, SDValue Callee,
           GV->hasDefaultVisibility() && !GV->hasLocalLinkage()) {
         OpFlags = X86II::MO_PLT;
       } else if (Subtarget->isPICStyleStubAny() &&
-                 (GV->isDeclaration() || GV->isWeakForLinker()) &&
+                 ((GV->isDeclaration() && !GV->isMaterializable()) ||
+                  GV->isWeakForLinker()) &&
                  Subtarget->getDarwinVers() < 9) {
         // PC-relative references to external symbols should go through $stub,
         // unless we're building with the leopard linker or later, which
@@ -9401,7 +9402,10 @@ const char *X86TargetLowering::getTargetNodeName(unsigned Opcode) const {
 // by AM is legal for this target, for a load/store of the specified type.
 bool X86TargetLowering::isLegalAddressingMode(const AddrMode &AM,
                                               const Type *Ty) const {
-  // X86 supports extremely general addressing modes.
+  // X86 supports extremely general addressing modes, but not circular ones.
+  if (AM.IsCircular)
+    return false;
+
   CodeModel::Model M = getTargetMachine().getCodeModel();
   Reloc::Model R = getTargetMachine().getRelocationModel();
 
@@ -3131,6 +3131,10 @@ namespace {
     static char ID;
     CGBR() : MachineFunctionPass(ID) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      return new CGBR();
+    }
+
     virtual bool runOnMachineFunction(MachineFunction &MF) {
       const X86TargetMachine *TM =
         static_cast<const X86TargetMachine *>(&MF.getTarget());
@@ -829,6 +829,10 @@ namespace {
     static char ID;
     MSAH() : MachineFunctionPass(ID) {}
 
+    virtual FunctionPass *createParallelClone() const {
+      return new MSAH();
+    }
+
     virtual bool runOnMachineFunction(MachineFunction &MF) {
       const X86TargetMachine *TM =
         static_cast<const X86TargetMachine *>(&MF.getTarget());
@@ -12,29 +12,52 @@
 //===----------------------------------------------------------------------===//
 
 #include "InstCombine.h"
+#include "llvm/IntrinsicInst.h"
 #include "llvm/Support/PatternMatch.h"
 #include "llvm/Analysis/InstructionSimplify.h"
 using namespace llvm;
 using namespace PatternMatch;
 
-/// MatchSelectPattern - Pattern match integer [SU]MIN, [SU]MAX, and ABS idioms,
-/// returning the kind and providing the out parameter results if we
-/// successfully match.
+/// MatchSelectPattern - Pattern match integer [SU]MIN, [SU]MAX, and ABS idioms
+/// in a select of TrueVal and FalseVal on ICI, returning the kind and providing
+/// the out parameter results if we successfully match.
 static SelectPatternFlavor
-MatchSelectPattern(Value *V, Value *&LHS, Value *&RHS) {
-  SelectInst *SI = dyn_cast<SelectInst>(V);
-  if (SI == 0) return SPF_UNKNOWN;
-
-  ICmpInst *ICI = dyn_cast<ICmpInst>(SI->getCondition());
-  if (ICI == 0) return SPF_UNKNOWN;
-
+MatchSelectPattern(ICmpInst *ICI, Value *TrueVal, Value *FalseVal,
+                   Value *&LHS, Value *&RHS) {
   LHS = ICI->getOperand(0);
   RHS = ICI->getOperand(1);
+  ICmpInst::Predicate Pred = ICI->getPredicate();
+
+  // (X > 4) ? X : 5   -->  (X >= 5) ? X : 5  -->  MAX(X, 5)
+  // Compares against a constant are canonicalized to strict ones, so this is
+  // how clamps to a constant bound usually look.
+  Value *Other = TrueVal == LHS ? FalseVal : TrueVal;
+  ConstantInt *CmpC = dyn_cast<ConstantInt>(RHS);
+  ConstantInt *SelC = dyn_cast<ConstantInt>(Other);
+  if (CmpC && SelC && CmpC->getType() == SelC->getType()) {
+    const APInt &C = CmpC->getValue();
+    if (Pred == ICmpInst::ICMP_SGT && !C.isMaxSignedValue() &&
+        SelC->getValue() == C + 1) {
+      Pred = ICmpInst::ICMP_SGE;
+      RHS = SelC;
+    } else if (Pred == ICmpInst::ICMP_UGT && !C.isMaxValue() &&
+               SelC->getValue() == C + 1) {
+      Pred = ICmpInst::ICMP_UGE;
+      RHS = SelC;
+    } else if (Pred == ICmpInst::ICMP_SLT && !C.isMinSignedValue() &&
+               SelC->getValue() == C - 1) {
+      Pred = ICmpInst::ICMP_SLE;
+      RHS = SelC;
+    } else if (Pred == ICmpInst::ICMP_ULT && !C.isMinValue() &&
+               SelC->getValue() == C - 1) {
+      Pred = ICmpInst::ICMP_ULE;
+      RHS = SelC;
+    }
+  }
 
   // (icmp X, Y) ? X : Y
-  if (SI->getTrueValue() == ICI->getOperand(0) &&
-      SI->getFalseValue() == ICI->getOperand(1)) {
-    switch (ICI->getPredicate()) {
+  if (TrueVal == LHS && FalseVal == RHS) {
+    switch (Pred) {
     default: return SPF_UNKNOWN; // Equality.
     case ICmpInst::ICMP_UGT:
     case ICmpInst::ICMP_UGE: return SPF_UMAX;
@@ -48,9 +71,8 @@ MatchSelectPattern(Value *V, Value *&LHS, Value *&RHS) {
   }
 
   // (icmp X, Y) ? Y : X
-  if (SI->getTrueValue() == ICI->getOperand(1) &&
-      SI->getFalseValue() == ICI->getOperand(0)) {
-    switch (ICI->getPredicate()) {
+  if (TrueVal == RHS && FalseVal == LHS) {
+    switch (Pred) {
       default: return SPF_UNKNOWN; // Equality.
       case ICmpInst::ICMP_UGT:
       case ICmpInst::ICMP_UGE: return SPF_UMIN;
@@ -63,11 +85,24 @@ MatchSelectPattern(Value *V, Value *&LHS, Value *&RHS) {
     }
   }
 
-  // TODO: (X > 4) ? X : 5   -->  (X >= 5) ? X : 5  -->  MAX(X, 5)
-
   return SPF_UNKNOWN;
 }
 
+/// MatchSelectPattern - Pattern match integer [SU]MIN, [SU]MAX, and ABS idioms,
+/// returning the kind and providing the out parameter results if we
+/// successfully match.
+static SelectPatternFlavor
+MatchSelectPattern(Value *V, Value *&LHS, Value *&RHS) {
+  SelectInst *SI = dyn_cast<SelectInst>(V);
+  if (SI == 0) return SPF_UNKNOWN;
+
+  ICmpInst *ICI = dyn_cast<ICmpInst>(SI->getCondition());
+  if (ICI == 0) return SPF_UNKNOWN;
+
+  return MatchSelectPattern(ICI, SI->getTrueValue(), SI->getFalseValue(),
+                            LHS, RHS);
+}
+
 
 /// GetSelectFoldableOperands - We want to turn code that looks like this:
 ///   %C = or %A, %B
@@ -492,6 +527,114 @@ Instruction *InstCombiner::FoldSPFofSPF(Instruction *Inner,
 }
 
 
+/// isNarrowOperand - Return true if V is the sign extension of a value of at
+/// most Bits bits, or a constant that fits in Bits bits.
+static bool isNarrowOperand(Value *V, unsigned Bits) {
+  if (ConstantInt *C = dyn_cast<ConstantInt>(V))
+    return C->getValue().isSignedIntN(Bits);
+  if (SExtInst *SE = dyn_cast<SExtInst>(V))
+    return SE->getOperand(0)->getType()->getPrimitiveSizeInBits() <= Bits;
+  return false;
+}
+
+/// getNarrowOperand - Return an operand accepted by isNarrowOperand as a value
+/// of the narrow type Ty.
+static Value *getNarrowOperand(Value *V, const Type *Ty,
+                               InstCombiner::BuilderTy *Builder) {
+  if (ConstantInt *C = dyn_cast<ConstantInt>(V))
+    return ConstantExpr::getTrunc(C, Ty);
+  Value *Src = cast<SExtInst>(V)->getOperand(0);
+  if (Src->getType() == Ty)
+    return Src;
+  return Builder->CreateSExt(Src, Ty);
+}
+
+/// FoldSaturatingClamp - Look for a select that clamps X to a range [Lo, Hi],
+/// either as MIN(MAX(X, Lo), Hi) or MAX(MIN(X, Hi), Lo), or with both compares
+/// on X as in (X > Hi) ? Hi : MAX(X, Lo). If [Lo, Hi] is the range of a
+/// narrower signed type and X is the sum, difference or fixed-point product of
+/// values of that type, computed without overflow in the wider one, this is a
+/// saturating operation:
+///   %s = add (sext i16 %a to i32), (sext i16 %b to i32)
+///   MIN(MAX(%s, -32768), 32767)   -->  sext (sadd.sat.i16(%a, %b)) to i32
+///   MIN(MAX(ashr (mul %sa, %sb), 15), -32768), 32767)
+///                                 -->  sext (smul.fix.sat.i16(%a, %b, 15))
+Instruction *InstCombiner::FoldSaturatingClamp(SelectInst &SI) {
+  ICmpInst *ICI = dyn_cast<ICmpInst>(SI.getCondition());
+  if (!ICI)
+    return 0;
+
+  // Find the inner clamp and the bound of the outer one.
+  Value *TrueVal = SI.getTrueValue(), *FalseVal = SI.getFalseValue();
+  Value *X, *InnerBound, *OuterBound, *Cmp;
+  SelectPatternFlavor SPF = MatchSelectPattern(ICI, TrueVal, FalseVal,
+                                               Cmp, OuterBound);
+  SelectPatternFlavor InnerSPF = SPF_UNKNOWN;
+  if (SPF)
+    InnerSPF = MatchSelectPattern(Cmp, X, InnerBound);
+
+  // (X > Hi) ? Hi : MAX(X, Lo) is the same as MIN(MAX(X, Lo), Hi) as long as
+  // Lo < Hi, which holds for the bounds accepted below.
+  for (unsigned i = 1; i != 3 && !InnerSPF; ++i) {
+    InnerSPF = MatchSelectPattern(SI.getOperand(i), X, InnerBound);
+    SPF = SPF_UNKNOWN;
+    if (InnerSPF && X == ICI->getOperand(0))
+      SPF = MatchSelectPattern(ICI, i == 1 ? X : TrueVal,
+                               i == 2 ? X : FalseVal, Cmp, OuterBound);
+    if (!SPF)
+      InnerSPF = SPF_UNKNOWN;
+  }
+  if (SPF != SPF_SMIN && SPF != SPF_SMAX)
+    return 0;
+  if (InnerSPF != (SPF == SPF_SMIN ? SPF_SMAX : SPF_SMIN))
+    return 0;
+  ConstantInt *OuterC = dyn_cast<ConstantInt>(OuterBound);
+  ConstantInt *InnerC = dyn_cast<ConstantInt>(InnerBound);
+  if (!OuterC || !InnerC)
+    return 0;
+
+  // The bounds must be 2^(N-1)-1 and -2^(N-1).
+  const APInt &Hi = (SPF == SPF_SMIN ? OuterC : InnerC)->getValue();
+  const APInt &Lo = (SPF == SPF_SMIN ? InnerC : OuterC)->getValue();
+  if (!Hi.isStrictlyPositive() || !(Hi + 1).isPowerOf2() || Lo != ~Hi)
+    return 0;
+  unsigned Bits = (Hi + 1).logBase2() + 1;
+  unsigned WideBits = Hi.getBitWidth();
+
+  Intrinsic::ID ID;
+  Value *A, *B;
+  ConstantInt *ShAmt = 0;
+  if (match(X, m_Add(m_Value(A), m_Value(B))) && Bits < WideBits)
+    ID = Intrinsic::sadd_sat;
+  else if (match(X, m_Sub(m_Value(A), m_Value(B))) && Bits < WideBits)
+    ID = Intrinsic::ssub_sat;
+  else if ((match(X, m_AShr(m_Mul(m_Value(A), m_Value(B)),
+                            m_ConstantInt(ShAmt))) ||
+            match(X, m_Mul(m_Value(A), m_Value(B)))) &&
+           2 * Bits <= WideBits &&
+           (!ShAmt || ShAmt->getValue().ult(Bits)))
+    ID = Intrinsic::smul_fix_sat;
+  else
+    return 0;
+  if (!isNarrowOperand(A, Bits) || !isNarrowOperand(B, Bits))
+    return 0;
+
+  const Type *Ty = IntegerType::get(SI.getContext(), Bits);
+  Module *M = SI.getParent()->getParent()->getParent();
+  Value *F = Intrinsic::getDeclaration(M, ID, &Ty, 1);
+  A = getNarrowOperand(A, Ty, Builder);
+  B = getNarrowOperand(B, Ty, Builder);
+  Value *Res;
+  if (ID == Intrinsic::smul_fix_sat) {
+    Value *Scale = ConstantInt::get(Type::getInt32Ty(SI.getContext()),
+                                    ShAmt ? ShAmt->getZExtValue() : 0);
+    Res = Builder->CreateCall3(F, A, B, Scale, "sat");
+  } else {
+    Res = Builder->CreateCall2(F, A, B, "sat");
+  }
+  return new SExtInst(Res, SI.getType());
+}
+
 /// foldSelectICmpAnd - If one of the constants is zero (we know they can't
 /// both be) and we have an icmp instruction with zero, and we have an 'and'
 /// with the non-constant value and a power of two we can turn the select
@@ -776,8 +919,14 @@ Instruction *InstCombiner::visitSelectInst(SelectInst &SI) {
         if (Instruction *R = FoldSPFofSPF(cast<Instruction>(RHS),SPF2,LHS2,RHS2,
                                           SI, SPF, LHS))
           return R;
+
     }
 
+    // Clamping to the range of a narrower type may be a saturating operation
+    // on that type.
+    if (Instruction *R = FoldSaturatingClamp(SI))
+      return R;
+
     // TODO.
     // ABS(-X) -> ABS(X)
     // ABS(ABS(X)) -> ABS(X)
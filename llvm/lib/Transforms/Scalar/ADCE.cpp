@@ -38,6 +38,8 @@ namespace {
     }
     
     virtual bool runOnFunction(Function& F);
+
+    virtual FunctionPass *createParallelClone() const { return new ADCE(); }
     
     virtual void getAnalysisUsage(AnalysisUsage& AU) const {
       AU.setPreservesCFG();
@@ -58,6 +58,12 @@ STATISTIC(NumMemoryInsts, "Number of memory instructions whose address "
 STATISTIC(NumExtsMoved,  "Number of [s|z]ext instructions combined with loads");
 STATISTIC(NumExtUses,    "Number of uses of [s|z]ext instructions optimized");
 STATISTIC(NumRetsDup,    "Number of return instructions duplicated");
+STATISTIC(NumBlocksMerged, "Number of blocks merged into their predecessor");
+
+static cl::opt<bool> MergeStraightLine("cgp-merge-straight-line",
+  cl::Hidden, cl::init(false),
+  cl::desc("Merge chains of blocks linked by unconditional branches so that "
+           "instruction selection sees them as one block"));
 
 namespace {
   class CodeGenPrepare : public FunctionPass {
@@ -96,6 +102,7 @@ namespace {
 
   private:
     bool EliminateMostlyEmptyBlocks(Function &F);
+    bool MergeStraightLineBlocks(Function &F);
     bool CanMergeBlocks(const BasicBlock *BB, const BasicBlock *DestBB) const;
     void EliminateMostlyEmptyBlock(BasicBlock *BB);
     bool OptimizeBlock(BasicBlock &BB);
@@ -128,6 +135,11 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
   // unconditional branch.
   EverMadeChange |= EliminateMostlyEmptyBlocks(F);
 
+  // Then merge the blocks that are left into chains that isel can select as
+  // one DAG.
+  if (MergeStraightLine)
+    EverMadeChange |= MergeStraightLineBlocks(F);
+
   bool MadeChange = true;
   while (MadeChange) {
     MadeChange = false;
@@ -190,6 +202,47 @@ bool CodeGenPrepare::EliminateMostlyEmptyBlocks(Function &F) {
   return MadeChange;
 }
 
+/// MergeStraightLineBlocks - Merge every block whose only predecessor ends in
+/// an unconditional branch to it into that predecessor.  Instruction selection
+/// builds one DAG per block, so a chain of such blocks costs the fixed setup
+/// of a DAG for each link, and values flowing down the chain go through
+/// virtual registers, which keeps address computations and extends from
+/// being folded into their users.  Merging the chain gives isel one DAG for
+/// the whole straight-line region.
+bool CodeGenPrepare::MergeStraightLineBlocks(Function &F) {
+  bool MadeChange = false;
+  // The entry block has no predecessor, so start at the next one.
+  for (Function::iterator I = ++F.begin(), E = F.end(); I != E; ) {
+    BasicBlock *BB = I++;
+
+    BasicBlock *PredBB = BB->getSinglePredecessor();
+    if (!PredBB || PredBB == BB || BB->hasAddressTaken())
+      continue;
+    BranchInst *BI = dyn_cast<BranchInst>(PredBB->getTerminator());
+    if (!BI || !BI->isUnconditional())
+      continue;
+
+    // A PHI that is its own incoming value can only be in unreachable code;
+    // leave such blocks alone, as MergeBlockIntoPredecessor does.
+    bool PHILoop = false;
+    for (BasicBlock::iterator BBI = BB->begin();
+         PHINode *PN = dyn_cast<PHINode>(BBI); ++BBI)
+      PHILoop |= PN->getIncomingValue(0) == PN;
+    if (PHILoop)
+      continue;
+
+    DEBUG(dbgs() << "MERGING INTO PREDECESSOR:\n" << *BB << "\n\n");
+
+    if (PFI)
+      PFI->replaceAllUses(BB, PredBB);
+    bool Merged = MergeBlockIntoPredecessor(BB, this);
+    assert(Merged && "Block should have been mergeable!"); (void)Merged;
+    ++NumBlocksMerged;
+    MadeChange = true;
+  }
+  return MadeChange;
+}
+
 /// CanMergeBlocks - Return true if we can merge BB into DestBB if there is a
 /// single uncond branch between them, and BB contains no other non-phi
 /// instructions.
@@ -781,7 +834,9 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
   }
 
   // If all the instructions matched are already in this BB, don't do anything.
-  if (!AnyNonLocal) {
+  // A circular index still has to be rewritten, because isel cannot see that
+  // its remainder needs only one wrap.
+  if (!AnyNonLocal && !AddrMode.IsCircular) {
     DEBUG(dbgs() << "CGP: Found      local addrmode: " << AddrMode << "\n");
     return false;
   }
@@ -827,6 +882,16 @@ bool CodeGenPrepare::OptimizeMemoryInst(Instruction *MemoryInst, Value *Addr,
     // Add the scale value.
     if (AddrMode.Scale) {
       Value *V = AddrMode.ScaledReg;
+      // The index of a circular buffer is less than twice its length, so the
+      // remainder is a compare and subtract.
+      if (AddrMode.IsCircular) {
+        Value *Len = AddrMode.CircLength;
+        Value *Cmp = new ICmpInst(InsertPt, ICmpInst::ICMP_UGE, V, Len,
+                                  "sunkaddr");
+        Value *Wrapped = BinaryOperator::CreateSub(V, Len, "sunkaddr",
+                                                   InsertPt);
+        V = SelectInst::Create(Cmp, Wrapped, V, "sunkaddr", InsertPt);
+      }
       if (V->getType() == IntPtrTy) {
         // done.
       } else if (V->getType()->isPointerTy()) {
@@ -78,6 +78,8 @@ namespace {
 
     virtual bool runOnFunction(Function &F);
 
+    virtual FunctionPass *createParallelClone() const { return new DCE(); }
+
      virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesCFG();
     }
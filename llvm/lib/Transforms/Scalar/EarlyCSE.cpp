@@ -256,6 +256,8 @@ public:
 
   bool runOnFunction(Function &F);
 
+  virtual FunctionPass *createParallelClone() const { return new EarlyCSE(); }
+
 private:
   
   bool processNode(DomTreeNode *Node);
@@ -70,6 +70,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/IRBuilder.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetLowering.h"
@@ -1262,6 +1263,26 @@ struct UseMapDenseMapInfo {
   }
 };
 
+/// CircularIndex - The remainder of an induction variable by a loop-invariant
+/// buffer length, one of the indices that OptimizeCircularIndices rewrites.
+struct CircularIndex {
+  /// Rem - The urem instruction.
+  BinaryOperator *Rem;
+
+  /// AR - The induction variable that is being reduced.
+  const SCEVAddRecExpr *AR;
+
+  /// NoWrap - True if AR is known not to wrap around in the loop.
+  bool NoWrap;
+
+  /// Offset - The distance of AR from the first index of its group.
+  APInt Offset;
+
+  CircularIndex(BinaryOperator *R, const SCEVAddRecExpr *A, bool NW)
+    : Rem(R), AR(A), NoWrap(NW),
+      Offset(A->getType()->getPrimitiveSizeInBits(), 0) {}
+};
+
 /// LSRInstance - This class holds state for the main loop strength reduction
 /// logic.
 class LSRInstance {
@@ -1295,6 +1316,11 @@ class LSRInstance {
   RegUseTracker RegUses;
 
   void OptimizeShadowIV();
+  bool CollectCircularIndex(BinaryOperator *Rem,
+                            SmallVectorImpl<SmallVector<CircularIndex, 4> > &
+                              Groups);
+  void RewriteCircularIndices(SmallVectorImpl<CircularIndex> &Group);
+  void OptimizeCircularIndices();
   bool FindIVUserForCond(ICmpInst *Cond, IVStrideUse *&CondUse);
   ICmpInst *OptimizeMax(ICmpInst *Cond, IVStrideUse* &CondUse);
   void OptimizeLoopTermCond();
@@ -1503,6 +1529,259 @@ void LSRInstance::OptimizeShadowIV() {
   }
 }
 
+/// CreateAddMod - Return (J + S) mod Len for J and S less than Len, computed
+/// without overflow as "J >= Len-S ? J-(Len-S) : J+S".  CodeGenPrepare knows
+/// that the result is less than Len.
+static Value *CreateAddMod(IRBuilder<> &Builder, Value *J, Value *S,
+                           Value *Len, const Twine &Name = "") {
+  Value *T = Builder.CreateSub(Len, S);
+  Value *Wrap = Builder.CreateICmpUGE(J, T);
+  return Builder.CreateSelect(Wrap, Builder.CreateSub(J, T),
+                              Builder.CreateAdd(J, S), Name);
+}
+
+/// isUsedOnlyAsAddress - Return true if all uses of I are indices of GEPs
+/// that are only used as the address of loads and stores.
+static bool isUsedOnlyAsAddress(Instruction *I) {
+  for (Value::use_iterator UI = I->use_begin(), E = I->use_end();
+       UI != E; ++UI) {
+    GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(*UI);
+    if (!GEP || GEP->getPointerOperand() == I)
+      return false;
+    for (Value::use_iterator GI = GEP->use_begin(), GE = GEP->use_end();
+         GI != GE; ++GI) {
+      if (LoadInst *LI = dyn_cast<LoadInst>(*GI)) {
+        if (LI->getPointerOperand() != GEP)
+          return false;
+      } else if (StoreInst *SI = dyn_cast<StoreInst>(*GI)) {
+        if (SI->getPointerOperand() != GEP || SI->getValueOperand() == GEP)
+          return false;
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// CollectCircularIndex - If Rem is the remainder of an induction variable of
+/// this loop by a loop-invariant length, add it to the group of remainders
+/// with the same length and stride whose induction variables differ from it
+/// by a constant.  The index with the lowest start value leads its group.
+bool LSRInstance::CollectCircularIndex(BinaryOperator *Rem,
+                          SmallVectorImpl<SmallVector<CircularIndex, 4> > &
+                            Groups) {
+  Value *Len = Rem->getOperand(1);
+  if (!L->isLoopInvariant(Len))
+    return false;
+
+  // Remainders by a power of two are masks already.
+  if (ConstantInt *C = dyn_cast<ConstantInt>(Len))
+    if (C->isZero() || C->getValue().isPowerOf2())
+      return false;
+
+  // The first remainder is computed in the preheader, which is only safe if
+  // the remainder is computed whenever the loop is entered.  The leading
+  // index is also updated in the latch from the value of its induction
+  // variable.
+  BasicBlock *BB = Rem->getParent();
+  if (LI.getLoopFor(BB) != L || !DT.dominates(BB, L->getLoopLatch()))
+    return false;
+  SmallVector<BasicBlock *, 4> ExitingBlocks;
+  L->getExitingBlocks(ExitingBlocks);
+  for (unsigned i = 0, e = ExitingBlocks.size(); i != e; ++i)
+    if (!DT.dominates(BB, ExitingBlocks[i]))
+      return false;
+
+  const SCEVAddRecExpr *AR =
+    dyn_cast<SCEVAddRecExpr>(SE.getSCEV(Rem->getOperand(0)));
+  if (!AR || AR->getLoop() != L || !AR->isAffine())
+    return false;
+
+  // If the induction variable wraps around, the remainder does not simply
+  // advance by the stride in that iteration.  A negative step is an unsigned
+  // addition that overflows in every iteration, even though SCEV folds the
+  // zext of a count-down induction variable with a sign-extended step.
+  unsigned BitWidth = SE.getTypeSizeInBits(AR->getType());
+  const Type *WideTy = IntegerType::get(Rem->getContext(), BitWidth * 2);
+  bool NoWrap = SE.isKnownNonNegative(AR->getStepRecurrence(SE)) &&
+                isa<SCEVAddRecExpr>(SE.getZeroExtendExpr(AR, WideTy));
+  CircularIndex CI(Rem, AR, NoWrap);
+
+  const SCEV *Step = AR->getStepRecurrence(SE);
+  for (unsigned i = 0, e = Groups.size(); i != e; ++i) {
+    SmallVectorImpl<CircularIndex> &Group = Groups[i];
+    CircularIndex &Leader = Group[0];
+    if (Leader.Rem->getOperand(1) != Len ||
+        Leader.AR->getType() != AR->getType() ||
+        Leader.AR->getStepRecurrence(SE) != Step)
+      continue;
+    const SCEVConstant *Diff =
+      dyn_cast<SCEVConstant>(SE.getMinusSCEV(AR, Leader.AR));
+    if (!Diff)
+      continue;
+    const APInt &D = Diff->getValue()->getValue();
+    if (!D.isNegative()) {
+      CI.Offset = D;
+      Group.push_back(CI);
+      return true;
+    }
+    // The new index starts below the current leader and takes its place.
+    for (unsigned j = 0, je = Group.size(); j != je; ++j)
+      Group[j].Offset -= D;
+    Group.insert(Group.begin(), CI);
+    return true;
+  }
+
+  Groups.push_back(SmallVector<CircularIndex, 4>());
+  Groups.back().push_back(CI);
+  return true;
+}
+
+/// RewriteCircularIndices - Replace the leader of Group by an induction
+/// variable that wraps around at the buffer length, and the other remainders
+/// by the sum of that and their offset.  All arithmetic is modulo the buffer
+/// length Len: with Rem(X) = X mod Len and W the width of the type,
+///
+///   Rem(Start + Step)   = Rem(Start) + Rem(Step)
+///   Rem(X + Offset)     = Rem(X) + Rem(Offset)
+///
+/// unless the addition overflows, in which case 2^W has been lost and
+/// Rem(-2^W) = Len - Rem(2^W) has to be added as well.
+void LSRInstance::RewriteCircularIndices(SmallVectorImpl<CircularIndex> &Group) {
+  CircularIndex &Leader = Group[0];
+  Value *Len = Leader.Rem->getOperand(1);
+  const Type *Ty = Leader.AR->getType();
+  BasicBlock *Preheader = L->getLoopPreheader();
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = L->getLoopLatch();
+
+  IRBuilder<> Builder(Preheader->getTerminator());
+  SCEVExpander Rewriter(SE);
+  Value *Start = Rewriter.expandCodeFor(Leader.AR->getStart(), Ty,
+                                        Preheader->getTerminator());
+  Value *Step = Rewriter.expandCodeFor(Leader.AR->getStepRecurrence(SE), Ty,
+                                       Preheader->getTerminator());
+
+  Value *Init = Builder.CreateURem(Start, Len, "circ.init");
+  Value *Stride = Builder.CreateURem(Step, Len, "circ.stride");
+
+  // Correction for a lost 2^W, Rem(Len - Rem(-Len)).
+  Value *Carry = 0;
+  if (!Leader.NoWrap || Group.size() > 1)
+    Carry = Builder.CreateURem(
+      Builder.CreateSub(Len, Builder.CreateURem(Builder.CreateNeg(Len), Len)),
+      Len, "circ.carry");
+  Value *CarryStride = 0;
+  if (!Leader.NoWrap)
+    CarryStride = CreateAddMod(Builder, Stride, Carry, Len);
+
+  // Remainders of the offsets of the other indices, with and without the
+  // correction.
+  SmallVector<Value *, 4> OffsetRems, CarryOffsetRems;
+  for (unsigned i = 1, e = Group.size(); i != e; ++i) {
+    Value *Offset = ConstantInt::get(Ty, Group[i].Offset);
+    Value *OffsetRem = Builder.CreateURem(Offset, Len, "circ.offset");
+    Value *CarryOffsetRem = CreateAddMod(Builder, OffsetRem, Carry, Len);
+    // The distance between induction variables that both do not wrap around
+    // is the same in every iteration, so the carry is loop invariant.
+    if (Leader.NoWrap && Group[i].NoWrap) {
+      Value *Over = Builder.CreateICmpULT(
+        Rewriter.expandCodeFor(Group[i].AR->getStart(), Ty,
+                               Preheader->getTerminator()), Offset);
+      OffsetRem = Builder.CreateSelect(Over, CarryOffsetRem, OffsetRem,
+                                       "circ.offset");
+    }
+    OffsetRems.push_back(OffsetRem);
+    CarryOffsetRems.push_back(CarryOffsetRem);
+  }
+
+  PHINode *PN = PHINode::Create(Ty, "circ", Header->begin());
+
+  // Advance the index by the stride in the latch, or by the stride plus the
+  // correction if the induction variable is about to wrap around.
+  Builder.SetInsertPoint(Latch->getTerminator());
+  Value *Inc = Stride;
+  if (CarryStride) {
+    Value *Over = Builder.CreateICmpUGT(Leader.Rem->getOperand(0),
+                                        Builder.CreateNot(Step));
+    Inc = Builder.CreateSelect(Over, CarryStride, Stride);
+  }
+  Value *Next = CreateAddMod(Builder, PN, Inc, Len, "circ.next");
+  PN->addIncoming(Init, Preheader);
+  PN->addIncoming(Next, Latch);
+
+  SE.forgetValue(Leader.Rem);
+  Leader.Rem->replaceAllUsesWith(PN);
+  Leader.Rem->eraseFromParent();
+
+  // The other indices are offset from the leader.  If they only address
+  // memory, leave the sum as a remainder that wraps at most once, which the
+  // target folds into its circular addressing mode.
+  for (unsigned i = 1, e = Group.size(); i != e; ++i) {
+    BinaryOperator *Rem = Group[i].Rem;
+    Builder.SetInsertPoint(Rem->getParent(), Rem);
+    Value *Offset = OffsetRems[i-1];
+    if (!Leader.NoWrap || !Group[i].NoWrap) {
+      Value *Over = Builder.CreateICmpULT(Rem->getOperand(0),
+                                          ConstantInt::get(Ty, Group[i].Offset));
+      Offset = Builder.CreateSelect(Over, CarryOffsetRems[i-1], Offset);
+    }
+    Value *Idx;
+    if (isUsedOnlyAsAddress(Rem))
+      Idx = Builder.CreateURem(Builder.CreateAdd(PN, Offset), Len, "circ.idx");
+    else
+      Idx = CreateAddMod(Builder, PN, Offset, Len, "circ.idx");
+    SE.forgetValue(Rem);
+    Rem->replaceAllUsesWith(Idx);
+    Rem->eraseFromParent();
+  }
+
+  DEBUG(dbgs() << "LSR: Rewrote " << Group.size()
+               << " circular buffer indices modulo ";
+        WriteAsOperand(dbgs(), Len, /*PrintType=*/false);
+        dbgs() << " with " << *PN << '\n');
+  Changed = true;
+}
+
+/// OptimizeCircularIndices - On targets with circular addressing, turn the
+/// remainders of induction variables by a loop-invariant length into
+/// induction variables that wrap around at that length:
+///
+///   for (unsigned i = 0; i < n; ++i)
+///     sum += buf[(pos + i) % len] + buf[(pos + i + 3) % len];
+///
+/// becomes
+///
+///   unsigned j = pos % len;
+///   for (unsigned i = 0; i < n; ++i, j = (j + 1 == len ? 0 : j + 1))
+///     sum += buf[j] + buf[(j + 3) % len];
+///
+/// where the remaining remainder only needs to wrap once, and is folded into
+/// the circular addressing mode by CodeGenPrepare.
+void LSRInstance::OptimizeCircularIndices() {
+  if (!TLI)
+    return;
+  TargetLowering::AddrMode AM;
+  AM.HasBaseReg = true;
+  AM.Scale = 1;
+  AM.IsCircular = true;
+  if (!TLI->isLegalAddressingMode(AM,
+                                  Type::getInt8Ty(L->getHeader()->getContext())))
+    return;
+
+  SmallVector<SmallVector<CircularIndex, 4>, 4> Groups;
+  for (Loop::block_iterator BI = L->block_begin(), BE = L->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end();
+         I != E; ++I)
+      if (I->getOpcode() == Instruction::URem)
+        CollectCircularIndex(cast<BinaryOperator>(I), Groups);
+
+  for (unsigned i = 0, e = Groups.size(); i != e; ++i)
+    RewriteCircularIndices(Groups[i]);
+}
+
 /// FindIVUserForCond - If Cond has an operand that is an expression of an IV,
 /// set the IV user and stride information and return true, otherwise return
 /// false.
@@ -3672,6 +3951,7 @@ LSRInstance::LSRInstance(const TargetLowering *tli, Loop *l, Pass *P)
 
   // First, perform some low-level loop optimizations.
   OptimizeShadowIV();
+  OptimizeCircularIndices();
   OptimizeLoopTermCond();
 
   // Start collecting data and preparing for the solver.
@@ -1606,6 +1606,8 @@ namespace {
     // algorithm, and return true if the function was modified.
     //
     bool runOnFunction(Function &F);
+
+    virtual FunctionPass *createParallelClone() const { return new SCCP(); }
   };
 } // end anonymous namespace
 
@@ -14,9 +14,10 @@
 #include "llvm/Transforms/Utils/AddrModeMatcher.h"
 #include "llvm/DerivedTypes.h"
 #include "llvm/GlobalValue.h"
-#include "llvm/Instruction.h"
+#include "llvm/Instructions.h"
 #include "llvm/Assembly/Writer.h"
 #include "llvm/Target/TargetData.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/GetElementPtrTypeIterator.h"
 #include "llvm/Support/PatternMatch.h"
@@ -48,7 +49,14 @@ void ExtAddrMode::print(raw_ostream &OS) const {
   if (Scale) {
     OS << (NeedPlus ? " + " : "")
        << Scale << "*";
+    if (IsCircular)
+      OS << '(';
     WriteAsOperand(OS, ScaledReg, /*PrintType=*/false);
+    if (IsCircular) {
+      OS << " mod ";
+      WriteAsOperand(OS, CircLength, /*PrintType=*/false);
+      OS << ')';
+    }
     NeedPlus = true;
   }
 
@@ -66,6 +74,10 @@ void ExtAddrMode::dump() const {
 /// false if not.
 bool AddressingModeMatcher::MatchScaledValue(Value *ScaleReg, int64_t Scale,
                                              unsigned Depth) {
+  // A remainder that only has to wrap once indexes a circular buffer.
+  if (MatchCircularIndex(ScaleReg, Scale))
+    return true;
+
   // If Scale is 1, then this is the same as adding ScaleReg to the addressing
   // mode.  Just process that directly.
   if (Scale == 1)
@@ -116,6 +128,95 @@ bool AddressingModeMatcher::MatchScaledValue(Value *ScaleReg, int64_t Scale,
   return true;
 }
 
+/// isKnownBelow - Return true if V is known to be unsigned less than Len.
+/// This recognizes remainders by Len and the wrapped indices that
+/// LoopStrengthReduce builds for circular buffers: selects and PHIs of such
+/// values, and J+S modulo Len computed as "J >= Len-S ? J-(Len-S) : J+S".  A
+/// PHI that is reached again through its own operands is assumed to be in
+/// range; every other value it can take is checked.
+static bool isKnownBelow(Value *V, Value *Len,
+                         SmallPtrSet<PHINode*, 4> &Visited, unsigned Depth) {
+  if (Depth >= 6) return false;
+
+  if (match(V, m_URem(m_Value(), m_Specific(Len))))
+    return true;
+
+  if (ConstantInt *CI = dyn_cast<ConstantInt>(V)) {
+    ConstantInt *LenC = dyn_cast<ConstantInt>(Len);
+    return LenC && CI->getValue().ult(LenC->getValue());
+  }
+
+  if (PHINode *PN = dyn_cast<PHINode>(V)) {
+    if (!Visited.insert(PN))
+      return true;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i)
+      if (!isKnownBelow(PN->getIncomingValue(i), Len, Visited, Depth+1))
+        return false;
+    return true;
+  }
+
+  SelectInst *SI = dyn_cast<SelectInst>(V);
+  if (!SI) return false;
+
+  ICmpInst::Predicate Pred;
+  Value *J = 0, *T = 0, *S = 0;
+  if (match(SI->getCondition(), m_ICmp(Pred, m_Value(J), m_Value(T))) &&
+      Pred == ICmpInst::ICMP_UGE &&
+      match(SI->getTrueValue(), m_Sub(m_Specific(J), m_Specific(T))) &&
+      match(SI->getFalseValue(), m_Add(m_Specific(J), m_Value(S)))) {
+    // T must be Len-S.
+    ConstantInt *TC = dyn_cast<ConstantInt>(T), *SC = dyn_cast<ConstantInt>(S);
+    ConstantInt *LenC = dyn_cast<ConstantInt>(Len);
+    if (!match(T, m_Sub(m_Specific(Len), m_Specific(S))) &&
+        !(TC && SC && LenC && TC->getValue() + SC->getValue() ==
+                              LenC->getValue()))
+      return false;
+    return isKnownBelow(J, Len, Visited, Depth+1) &&
+           isKnownBelow(S, Len, Visited, Depth+1);
+  }
+
+  return isKnownBelow(SI->getTrueValue(), Len, Visited, Depth+1) &&
+         isKnownBelow(SI->getFalseValue(), Len, Visited, Depth+1);
+}
+
+/// WrapsAtMostOnce - Return true if Idx is known to be less than twice Len,
+/// so that Idx mod Len is at most one subtraction away.  This holds for the
+/// sum of two values below Len even if the add overflows, because the
+/// wrapped sum is then less than Len.
+static bool WrapsAtMostOnce(Value *Idx, Value *Len) {
+  SmallPtrSet<PHINode*, 4> Visited;
+  Value *A = 0, *B = 0;
+  if (match(Idx, m_Add(m_Value(A), m_Value(B))))
+    return isKnownBelow(A, Len, Visited, 0) &&
+           isKnownBelow(B, Len, Visited, 0);
+  return isKnownBelow(Idx, Len, Visited, 0);
+}
+
+/// MatchCircularIndex - Try adding ScaleReg*Scale to the current addressing
+/// mode as the index into a circular buffer.  This works if ScaleReg is the
+/// remainder of an index that has to wrap at most once, and the target has a
+/// circular addressing mode for this access.
+bool AddressingModeMatcher::MatchCircularIndex(Value *ScaleReg,
+                                               int64_t Scale) {
+  Value *Idx = 0, *Len = 0;
+  if (Scale == 0 || AddrMode.Scale != 0 || !isa<Instruction>(ScaleReg) ||
+      !match(ScaleReg, m_URem(m_Value(Idx), m_Value(Len))) ||
+      !WrapsAtMostOnce(Idx, Len))
+    return false;
+
+  ExtAddrMode TestAddrMode = AddrMode;
+  TestAddrMode.Scale = Scale;
+  TestAddrMode.ScaledReg = Idx;
+  TestAddrMode.IsCircular = true;
+  TestAddrMode.CircLength = Len;
+  if (!TLI.isLegalAddressingMode(TestAddrMode, AccessTy))
+    return false;
+
+  AddrMode = TestAddrMode;
+  AddrModeInsts.push_back(cast<Instruction>(ScaleReg));
+  return true;
+}
+
 /// MightBeFoldableInst - This is a little filter, which returns true if an
 /// addressing computation involving I might be folded into a load/store
 /// accessing it.  This doesn't need to be perfect, but needs to accept at least
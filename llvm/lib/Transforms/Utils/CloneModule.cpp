@@ -16,7 +16,8 @@
 #include "llvm/Module.h"
 #include "llvm/DerivedTypes.h"
 #include "llvm/TypeSymbolTable.h"
-#include "llvm/Constant.h"
+#include "llvm/Constants.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Transforms/Utils/ValueMapper.h"
 using namespace llvm;
 
@@ -60,8 +61,9 @@ Module *llvm::CloneModule(const Module *M,
                                             I->getType()->getElementType(),
                                             false,
                                             GlobalValue::ExternalLinkage, 0,
-                                            I->getName());
-    GV->setAlignment(I->getAlignment());
+                                            I->getName(), 0, false,
+                                            I->getType()->getAddressSpace());
+    GV->copyAttributesFrom(I);
     VMap[I] = GV;
   }
 
@@ -76,9 +78,12 @@ Module *llvm::CloneModule(const Module *M,
 
   // Loop over the aliases in the module
   for (Module::const_alias_iterator I = M->alias_begin(), E = M->alias_end();
-       I != E; ++I)
-    VMap[I] = new GlobalAlias(I->getType(), GlobalAlias::ExternalLinkage,
-                                  I->getName(), NULL, New);
+       I != E; ++I) {
+    GlobalAlias *GA = new GlobalAlias(I->getType(), GlobalAlias::ExternalLinkage,
+                                      I->getName(), NULL, New);
+    GA->copyAttributesFrom(I);
+    VMap[I] = GA;
+  }
   
   // Now that all of the things that global variable initializer can refer to
   // have been created, loop through and copy the global variable referrers
@@ -91,7 +96,6 @@ Module *llvm::CloneModule(const Module *M,
       GV->setInitializer(cast<Constant>(MapValue(I->getInitializer(),
                                                  VMap, RF_None)));
     GV->setLinkage(I->getLinkage());
-    GV->setThreadLocal(I->isThreadLocal());
     GV->setConstant(I->isConstant());
   }
 
@@ -114,6 +118,22 @@ Module *llvm::CloneModule(const Module *M,
     F->setLinkage(I->getLinkage());
   }
 
+  // A blockaddress that was mapped before the body of its function was cloned
+  // still refers to a block of the old function.  Point it at the new block.
+  for (Module::iterator F = New->begin(), E = New->end(); F != E; ++F) {
+    SmallVector<BlockAddress*, 4> Stale;
+    for (Value::use_iterator UI = F->use_begin(), UE = F->use_end();
+         UI != UE; ++UI)
+      if (BlockAddress *BA = dyn_cast<BlockAddress>(*UI))
+        if (BA->getBasicBlock()->getParent() != F)
+          Stale.push_back(BA);
+    for (unsigned i = 0, e = Stale.size(); i != e; ++i) {
+      Value *BB = VMap[Stale[i]->getBasicBlock()];
+      Stale[i]->replaceAllUsesWith(BlockAddress::get(F, cast<BasicBlock>(BB)));
+      Stale[i]->destroyConstant();
+    }
+  }
+
   // And aliases
   for (Module::const_alias_iterator I = M->alias_begin(), E = M->alias_end();
        I != E; ++I) {
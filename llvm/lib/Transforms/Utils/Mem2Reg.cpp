@@ -36,6 +36,10 @@ namespace {
     //
     virtual bool runOnFunction(Function &F);
 
+    virtual FunctionPass *createParallelClone() const {
+      return new PromotePass();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.addRequired<DominatorTree>();
       AU.setPreservesCFG();
@@ -0,0 +1,313 @@
+//===- PartitionModule.cpp - Split a module for parallel codegen ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements PartitionModule, which libLTO uses to generate the
+// code of the merged module on several threads.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/PartitionModule.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Module.h"
+#include "llvm/TypeSymbolTable.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/EquivalenceClasses.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
+using namespace llvm;
+
+typedef EquivalenceClasses<const GlobalValue*> GlobalGroups;
+typedef DenseMap<const GlobalValue*, unsigned> GlobalNumbering;
+
+/// getDefinitionWeight - The amount of code a definition turns into, roughly.
+static unsigned getDefinitionWeight(const GlobalValue *GV) {
+  const Function *F = dyn_cast<Function>(GV);
+  if (!F)
+    return 1;
+  unsigned Weight = 1;
+  for (Function::const_iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    Weight += BB->size();
+  return Weight;
+}
+
+/// findReferences - Add the definitions whose bodies, initializers or
+/// aliasees use V to Refs.
+static void findReferences(const Value *V,
+                           SmallPtrSet<const Value*, 16> &Visited,
+                           SmallVectorImpl<const GlobalValue*> &Refs) {
+  for (Value::const_use_iterator UI = V->use_begin(), E = V->use_end();
+       UI != E; ++UI) {
+    const User *U = *UI;
+    if (const Instruction *I = dyn_cast<Instruction>(U))
+      Refs.push_back(I->getParent()->getParent());
+    else if (const GlobalValue *GV = dyn_cast<GlobalValue>(U))
+      Refs.push_back(GV);
+    else if (isa<Constant>(U) && Visited.insert(U))
+      findReferences(U, Visited, Refs);
+  }
+}
+
+/// joinGroups - Put A and B in one group, unless the group would weigh more
+/// than Limit.
+static void joinGroups(GlobalGroups &Groups, GlobalNumbering &Weights,
+                       const GlobalValue *A, const GlobalValue *B,
+                       unsigned Limit) {
+  const GlobalValue *LeaderA = Groups.getLeaderValue(A);
+  const GlobalValue *LeaderB = Groups.getLeaderValue(B);
+  if (LeaderA == LeaderB)
+    return;
+  unsigned Weight = Weights[LeaderA] + Weights[LeaderB];
+  if (Weight > Limit)
+    return;
+  Weights[*Groups.unionSets(A, B)] = Weight;
+}
+
+/// isHeavierGroup - Order groups by decreasing weight, then by their place in
+/// the module.
+static bool isHeavierGroup(const std::pair<unsigned, unsigned> &A,
+                           const std::pair<unsigned, unsigned> &B) {
+  if (A.first != B.first)
+    return A.first > B.first;
+  return A.second < B.second;
+}
+
+void llvm::PartitionModule(Module *M, unsigned NumPartitions, bool Stable,
+                           std::vector<Module*> &Partitions) {
+  NumPartitions = std::max(NumPartitions, 1U);
+
+  // The definitions, in module order.  Appending variables such as
+  // llvm.global_ctors stay with the first partition only.
+  std::vector<const GlobalValue*> Defs;
+  for (Module::iterator F = M->begin(), E = M->end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Defs.push_back(F);
+  for (Module::global_iterator V = M->global_begin(), E = M->global_end();
+       V != E; ++V)
+    if (!V->isDeclaration() && !V->hasAppendingLinkage())
+      Defs.push_back(V);
+  for (Module::alias_iterator A = M->alias_begin(), E = M->alias_end();
+       A != E; ++A)
+    Defs.push_back(A);
+
+  GlobalGroups Groups;
+  GlobalNumbering Weights;
+  unsigned TotalWeight = 0;
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+    Groups.insert(Defs[i]);
+    Weights[Defs[i]] = getDefinitionWeight(Defs[i]);
+    TotalWeight += Weights[Defs[i]];
+  }
+  unsigned Limit = std::max(TotalWeight / NumPartitions, 1U);
+
+  SmallPtrSet<const Value*, 16> Visited;
+  SmallVector<const GlobalValue*, 16> Refs;
+
+  // An alias is defined with its aliasee, and a blockaddress can only be used
+  // in the partition of its function.
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+    if (const GlobalAlias *GA = dyn_cast<GlobalAlias>(Defs[i])) {
+      const GlobalValue *Aliasee = GA->getAliasedGlobal();
+      if (Aliasee && !Aliasee->isDeclaration())
+        joinGroups(Groups, Weights, GA, Aliasee, ~0U);
+      continue;
+    }
+    for (Value::const_use_iterator UI = Defs[i]->use_begin(),
+           UE = Defs[i]->use_end(); UI != UE; ++UI) {
+      if (!isa<BlockAddress>(*UI))
+        continue;
+      Visited.clear();
+      Refs.clear();
+      findReferences(*UI, Visited, Refs);
+      for (unsigned r = 0, re = Refs.size(); r != re; ++r)
+        if (!Refs[r]->hasAppendingLinkage())
+          joinGroups(Groups, Weights, Defs[i], Refs[r], ~0U);
+    }
+  }
+
+  // Keep locals with their users while the groups are light enough.
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+    if (!Defs[i]->hasLocalLinkage())
+      continue;
+    Visited.clear();
+    Refs.clear();
+    findReferences(Defs[i], Visited, Refs);
+    for (unsigned r = 0, re = Refs.size(); r != re; ++r)
+      if (!Refs[r]->hasAppendingLinkage())
+        joinGroups(Groups, Weights, Defs[i], Refs[r], Limit);
+  }
+
+  // Hand the groups out heaviest first, each to the lightest partition.
+  GlobalNumbering GroupOf;
+  std::vector<std::pair<unsigned, unsigned> > GroupWeights;
+  std::vector<unsigned> GroupHashes;
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+    const GlobalValue *Leader = Groups.getLeaderValue(Defs[i]);
+    unsigned Hash = Defs[i]->hasName() ? HashString(Defs[i]->getName()) : ~0U;
+    if (GroupOf.count(Leader)) {
+      unsigned &GroupHash = GroupHashes[GroupOf[Leader]];
+      GroupHash = std::min(GroupHash, Hash);
+      continue;
+    }
+    GroupOf[Leader] = GroupWeights.size();
+    GroupWeights.push_back(std::make_pair(Weights[Leader],
+                                          (unsigned)GroupWeights.size()));
+    GroupHashes.push_back(Hash);
+  }
+  std::sort(GroupWeights.begin(), GroupWeights.end(), isHeavierGroup);
+
+  unsigned NumUsed = std::max(std::min<unsigned>(NumPartitions,
+                                                 GroupWeights.size()), 1U);
+  std::vector<unsigned> Loads(NumUsed, 0);
+  std::vector<unsigned> PartitionOfGroup(GroupWeights.size());
+  for (unsigned g = 0, e = GroupWeights.size(); g != e; ++g) {
+    unsigned Group = GroupWeights[g].second;
+    if (Stable) {
+      PartitionOfGroup[Group] = GroupHashes[Group] % NumUsed;
+      continue;
+    }
+    unsigned Lightest = std::min_element(Loads.begin(), Loads.end()) -
+                        Loads.begin();
+    Loads[Lightest] += GroupWeights[g].first;
+    PartitionOfGroup[Group] = Lightest;
+  }
+
+  GlobalNumbering Owner;
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i)
+    Owner[Defs[i]] = PartitionOfGroup[GroupOf[Groups.getLeaderValue(Defs[i])]];
+  for (Module::global_iterator V = M->global_begin(), E = M->global_end();
+       V != E; ++V)
+    if (V->hasAppendingLinkage())
+      Owner[V] = 0;
+
+  // Locals used from another partition get a name no other global has.
+  std::vector<std::pair<const GlobalValue*, std::string> > Promoted;
+  SmallPtrSet<const GlobalValue*, 16> IsPromoted;
+  StringSet<> PromotedNames;
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+    if (!Defs[i]->hasLocalLinkage())
+      continue;
+    Visited.clear();
+    Refs.clear();
+    findReferences(Defs[i], Visited, Refs);
+    bool UsedElsewhere = false;
+    for (unsigned r = 0, re = Refs.size(); r != re && !UsedElsewhere; ++r)
+      UsedElsewhere = Owner.lookup(Refs[r]) != Owner[Defs[i]];
+    if (!UsedElsewhere)
+      continue;
+
+    std::string Base = Defs[i]->hasName() ? Defs[i]->getName().str()
+                                          : std::string("__unnamed");
+    Base += ".lto_part";
+    std::string Name = Base;
+    for (unsigned n = 1; M->getNamedValue(Name) || PromotedNames.count(Name);
+         ++n)
+      Name = Base + utostr(n);
+    PromotedNames.insert(Name);
+    Promoted.push_back(std::make_pair(Defs[i], Name));
+    IsPromoted.insert(Defs[i]);
+  }
+
+  for (unsigned p = 0; p != NumUsed; ++p) {
+    std::vector<std::pair<const GlobalValue*, GlobalValue*> > Clones;
+    Module *Part;
+    {
+      ValueToValueMapTy VMap;
+      Part = CloneModule(M, VMap);
+      for (unsigned i = 0, e = Defs.size(); i != e; ++i) {
+        Value *Clone = VMap[Defs[i]];
+        Clones.push_back(std::make_pair(Defs[i], cast<GlobalValue>(Clone)));
+      }
+      for (unsigned i = 0, e = Promoted.size(); i != e; ++i) {
+        Value *Clone = VMap[Promoted[i].first];
+        GlobalValue *GV = cast<GlobalValue>(Clone);
+        GV->setLinkage(GlobalValue::ExternalLinkage);
+        GV->setVisibility(GlobalValue::HiddenVisibility);
+        GV->setName(Promoted[i].second);
+      }
+    }
+
+    if (p != 0) {
+      Part->setModuleInlineAsm("");
+      for (Module::global_iterator V = Part->global_begin(),
+             E = Part->global_end(); V != E; ) {
+        GlobalVariable *GV = V++;
+        if (!GV->hasAppendingLinkage())
+          continue;
+        if (!GV->use_empty())
+          GV->replaceAllUsesWith(UndefValue::get(GV->getType()));
+        GV->eraseFromParent();
+      }
+    }
+
+    // Turn the definitions of other partitions into declarations.  Locals
+    // that no longer have a use go away.
+    std::vector<GlobalValue*> Unused;
+    for (unsigned i = 0, e = Clones.size(); i != e; ++i) {
+      if (Owner[Clones[i].first] == p)
+        continue;
+      GlobalValue *GV = Clones[i].second;
+      if (Function *F = dyn_cast<Function>(GV)) {
+        F->deleteBody();
+      } else if (GlobalVariable *V = dyn_cast<GlobalVariable>(GV)) {
+        V->setInitializer(0);
+        V->setLinkage(GlobalValue::ExternalLinkage);
+      } else {
+        GlobalAlias *GA = cast<GlobalAlias>(GV);
+        const PointerType *PTy = GA->getType();
+        GlobalValue *Decl;
+        if (const FunctionType *FTy =
+              dyn_cast<FunctionType>(PTy->getElementType()))
+          Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", Part);
+        else
+          Decl = new GlobalVariable(*Part, PTy->getElementType(), false,
+                                    GlobalValue::ExternalLinkage, 0, "", 0,
+                                    false, PTy->getAddressSpace());
+        Decl->takeName(GA);
+        Decl->setVisibility(GA->getVisibility());
+        GA->replaceAllUsesWith(Decl);
+        GA->eraseFromParent();
+        GV = Decl;
+      }
+      if (Clones[i].first->hasLocalLinkage() &&
+          !IsPromoted.count(Clones[i].first))
+        Unused.push_back(GV);
+    }
+    for (unsigned i = 0, e = Unused.size(); i != e; ++i) {
+      Unused[i]->removeDeadConstantUsers();
+      if (Unused[i]->use_empty())
+        Unused[i]->eraseFromParent();
+    }
+
+    // Neither unused declarations nor type names make it into the object
+    // file.  Without them, a partition does not change when code it does not
+    // reference does.
+    for (Module::iterator FI = Part->begin(), E = Part->end(); FI != E; ) {
+      Function *F = FI++;
+      F->removeDeadConstantUsers();
+      if (F->isDeclaration() && F->use_empty())
+        F->eraseFromParent();
+    }
+    for (Module::global_iterator V = Part->global_begin(),
+           E = Part->global_end(); V != E; ) {
+      GlobalVariable *GV = V++;
+      GV->removeDeadConstantUsers();
+      if (GV->isDeclaration() && GV->use_empty())
+        GV->eraseFromParent();
+    }
+    TypeSymbolTable &TypeNames = Part->getTypeSymbolTable();
+    while (!TypeNames.empty())
+      TypeNames.remove(TypeNames.begin());
+
+    Partitions.push_back(Part);
+  }
+}
@@ -31,6 +31,7 @@
 #include "llvm/Support/GetElementPtrTypeIterator.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Atomic.h"
 #include <algorithm>
 #include <map>
 #include <cstdarg>
@@ -326,18 +327,27 @@ ConstantInt::ConstantInt(const IntegerType *Ty, const APInt& V)
   assert(V.getBitWidth() == Ty->getBitWidth() && "Invalid constant for type");
 }
 
+// ConstantInt::get always returns the same constant for a value, so threads
+// racing to set these store the same pointer.  The fence makes sure the
+// constant is complete before other threads can see it.
 ConstantInt *ConstantInt::getTrue(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
-  if (!pImpl->TheTrueVal)
-    pImpl->TheTrueVal = ConstantInt::get(Type::getInt1Ty(Context), 1);
-  return pImpl->TheTrueVal;
+  if (ConstantInt *True = pImpl->TheTrueVal)
+    return True;
+  ConstantInt *True = ConstantInt::get(Type::getInt1Ty(Context), 1);
+  sys::MemoryFence();
+  pImpl->TheTrueVal = True;
+  return True;
 }
 
 ConstantInt *ConstantInt::getFalse(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
-  if (!pImpl->TheFalseVal)
-    pImpl->TheFalseVal = ConstantInt::get(Type::getInt1Ty(Context), 0);
-  return pImpl->TheFalseVal;
+  if (ConstantInt *False = pImpl->TheFalseVal)
+    return False;
+  ConstantInt *False = ConstantInt::get(Type::getInt1Ty(Context), 0);
+  sys::MemoryFence();
+  pImpl->TheFalseVal = False;
+  return False;
 }
 
 Constant *ConstantInt::getTrue(const Type *Ty) {
@@ -377,7 +387,11 @@ ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt &V) {
   const IntegerType *ITy = IntegerType::get(Context, V.getBitWidth());
   // get an existing value or the insertion position
   DenseMapAPIntKeyInfo::KeyTy Key(V, ITy);
-  ConstantInt *&Slot = Context.pImpl->IntConstants[Key]; 
+  LLVMContextImpl *pImpl = Context.pImpl;
+  ShardedMap<LLVMContextImpl::IntMapTy>::Shard &Shard =
+    pImpl->IntConstants.getShard(DenseMapAPIntKeyInfo::getHashValue(Key));
+  sys::SmartScopedLock<true> Lock(Shard.Lock);
+  ConstantInt *&Slot = Shard.Map[Key];
   if (!Slot) Slot = new ConstantInt(ITy, V);
   return Slot;
 }
@@ -506,8 +520,11 @@ ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   DenseMapAPFloatKeyInfo::KeyTy Key(V);
   
   LLVMContextImpl* pImpl = Context.pImpl;
+  ShardedMap<LLVMContextImpl::FPMapTy>::Shard &Shard =
+    pImpl->FPConstants.getShard(DenseMapAPFloatKeyInfo::getHashValue(Key));
+  sys::SmartScopedLock<true> Lock(Shard.Lock);
   
-  ConstantFP *&Slot = pImpl->FPConstants[Key];
+  ConstantFP *&Slot = Shard.Map[Key];
     
   if (!Slot) {
     const Type *Ty;
@@ -579,6 +596,7 @@ Constant *ConstantArray::get(const ArrayType *Ty,
            "Wrong type in array element initializer");
   }
   LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   // If this is an all-zero array, return a ConstantAggregateZero object
   if (!V.empty()) {
     Constant *C = V[0];
@@ -643,6 +661,7 @@ ConstantStruct::ConstantStruct(const StructType *T,
 Constant *ConstantStruct::get(const StructType* T,
                               const std::vector<Constant*>& V) {
   LLVMContextImpl* pImpl = T->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   // Create a ConstantAggregateZero value if all elements are zeros...
   for (unsigned i = 0, e = V.size(); i != e; ++i)
@@ -721,6 +740,7 @@ Constant *ConstantVector::get(const VectorType *T,
   if (isUndef)
     return UndefValue::get(T);
     
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->VectorConstants.getOrCreate(T, V);
 }
 
@@ -971,20 +991,25 @@ ConstantAggregateZero* ConstantAggregateZero::get(const Type* Ty) {
          "Cannot create an aggregate zero of non-aggregate type!");
   
   LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->AggZeroConstants.getOrCreate(Ty, 0);
 }
 
 /// destroyConstant - Remove the constant from the constant table...
 ///
 void ConstantAggregateZero::destroyConstant() {
-  getRawType()->getContext().pImpl->AggZeroConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->AggZeroConstants.remove(this);
   destroyConstantImpl();
 }
 
 /// destroyConstant - Remove the constant from the constant table...
 ///
 void ConstantArray::destroyConstant() {
-  getRawType()->getContext().pImpl->ArrayConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->ArrayConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1048,14 +1073,18 @@ namespace llvm {
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantStruct::destroyConstant() {
-  getRawType()->getContext().pImpl->StructConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->StructConstants.remove(this);
   destroyConstantImpl();
 }
 
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantVector::destroyConstant() {
-  getRawType()->getContext().pImpl->VectorConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->VectorConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1090,13 +1119,17 @@ Constant *ConstantVector::getSplatValue() const {
 //
 
 ConstantPointerNull *ConstantPointerNull::get(const PointerType *Ty) {
-  return Ty->getContext().pImpl->NullPtrConstants.getOrCreate(Ty, 0);
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  return pImpl->NullPtrConstants.getOrCreate(Ty, 0);
 }
 
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantPointerNull::destroyConstant() {
-  getRawType()->getContext().pImpl->NullPtrConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->NullPtrConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1105,13 +1138,17 @@ void ConstantPointerNull::destroyConstant() {
 //
 
 UndefValue *UndefValue::get(const Type *Ty) {
-  return Ty->getContext().pImpl->UndefValueConstants.getOrCreate(Ty, 0);
+  LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  return pImpl->UndefValueConstants.getOrCreate(Ty, 0);
 }
 
 // destroyConstant - Remove the constant from the constant table.
 //
 void UndefValue::destroyConstant() {
-  getRawType()->getContext().pImpl->UndefValueConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->UndefValueConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1124,8 +1161,9 @@ BlockAddress *BlockAddress::get(BasicBlock *BB) {
 }
 
 BlockAddress *BlockAddress::get(Function *F, BasicBlock *BB) {
-  BlockAddress *&BA =
-    F->getContext().pImpl->BlockAddresses[std::make_pair(F, BB)];
+  LLVMContextImpl *pImpl = F->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  BlockAddress *&BA = pImpl->BlockAddresses[std::make_pair(F, BB)];
   if (BA == 0)
     BA = new BlockAddress(F, BB);
   
@@ -1145,8 +1183,9 @@ BlockAddress::BlockAddress(Function *F, BasicBlock *BB)
 // destroyConstant - Remove the constant from the constant table.
 //
 void BlockAddress::destroyConstant() {
-  getFunction()->getRawType()->getContext().pImpl
-    ->BlockAddresses.erase(std::make_pair(getFunction(), getBasicBlock()));
+  LLVMContextImpl *pImpl = getFunction()->getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->BlockAddresses.erase(std::make_pair(getFunction(), getBasicBlock()));
   getBasicBlock()->AdjustBlockAddressRefCount(-1);
   destroyConstantImpl();
 }
@@ -1164,15 +1203,16 @@ void BlockAddress::replaceUsesOfWithOnConstant(Value *From, Value *To, Use *U) {
   
   // See if the 'new' entry already exists, if not, just update this in place
   // and return early.
-  BlockAddress *&NewBA =
-    getContext().pImpl->BlockAddresses[std::make_pair(NewF, NewBB)];
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  BlockAddress *&NewBA = pImpl->BlockAddresses[std::make_pair(NewF, NewBB)];
   if (NewBA == 0) {
     getBasicBlock()->AdjustBlockAddressRefCount(-1);
     
     // Remove the old entry, this can't cause the map to rehash (just a
     // tombstone will get added).
-    getContext().pImpl->BlockAddresses.erase(std::make_pair(getFunction(),
-                                                            getBasicBlock()));
+    pImpl->BlockAddresses.erase(std::make_pair(getFunction(),
+                                               getBasicBlock()));
     NewBA = this;
     setOperand(0, NewF);
     setOperand(1, NewBB);
@@ -1207,6 +1247,7 @@ static inline Constant *getFoldedCast(
   std::vector<Constant*> argVec(1, C);
   ExprMapKeyType Key(opc, argVec);
   
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(Ty, Key);
 }
  
@@ -1439,6 +1480,7 @@ Constant *ConstantExpr::getTy(const Type *ReqTy, unsigned Opcode,
   ExprMapKeyType Key(Opcode, argVec, 0, Flags);
   
   LLVMContextImpl *pImpl = ReqTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1587,6 +1629,7 @@ Constant *ConstantExpr::getSelectTy(const Type *ReqTy, Constant *C,
   ExprMapKeyType Key(Instruction::Select, argVec);
   
   LLVMContextImpl *pImpl = ReqTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1614,6 +1657,7 @@ Constant *ConstantExpr::getGetElementPtrTy(const Type *ReqTy, Constant *C,
                            InBounds ? GEPOperator::IsInBounds : 0);
 
   LLVMContextImpl *pImpl = ReqTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1659,6 +1703,7 @@ ConstantExpr::getICmp(unsigned short pred, Constant *LHS, Constant *RHS) {
     ResultTy = VectorType::get(ResultTy, VT->getNumElements());
 
   LLVMContextImpl *pImpl = LHS->getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ResultTy, Key);
 }
 
@@ -1682,6 +1727,7 @@ ConstantExpr::getFCmp(unsigned short pred, Constant *LHS, Constant *RHS) {
     ResultTy = VectorType::get(ResultTy, VT->getNumElements());
 
   LLVMContextImpl *pImpl = LHS->getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ResultTy, Key);
 }
 
@@ -1695,6 +1741,7 @@ Constant *ConstantExpr::getExtractElementTy(const Type *ReqTy, Constant *Val,
   const ExprMapKeyType Key(Instruction::ExtractElement,ArgVec);
   
   LLVMContextImpl *pImpl = ReqTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1718,6 +1765,7 @@ Constant *ConstantExpr::getInsertElementTy(const Type *ReqTy, Constant *Val,
   const ExprMapKeyType Key(Instruction::InsertElement,ArgVec);
   
   LLVMContextImpl *pImpl = ReqTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1743,6 +1791,7 @@ Constant *ConstantExpr::getShuffleVectorTy(const Type *ReqTy, Constant *V1,
   const ExprMapKeyType Key(Instruction::ShuffleVector,ArgVec);
   
   LLVMContextImpl *pImpl = ReqTy->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->ExprConstants.getOrCreate(ReqTy, Key);
 }
 
@@ -1919,7 +1968,9 @@ Constant *ConstantExpr::getAShr(Constant *C1, Constant *C2, bool isExact) {
 // destroyConstant - Remove the constant from the constant table...
 //
 void ConstantExpr::destroyConstant() {
-  getRawType()->getContext().pImpl->ExprConstants.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->ExprConstants.remove(this);
   destroyConstantImpl();
 }
 
@@ -1961,6 +2012,7 @@ void ConstantArray::replaceUsesOfWithOnConstant(Value *From, Value *To,
   Constant *ToC = cast<Constant>(To);
 
   LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
 
   std::pair<LLVMContextImpl::ArrayConstantsTy::MapKey, ConstantArray*> Lookup;
   Lookup.first.first = cast<ArrayType>(getRawType());
@@ -2071,6 +2123,7 @@ void ConstantStruct::replaceUsesOfWithOnConstant(Value *From, Value *To,
   Values[OperandToUpdate] = ToC;
   
   LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   Constant *Replacement = 0;
   if (isAllZeros) {
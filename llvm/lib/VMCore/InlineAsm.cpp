@@ -30,6 +30,7 @@ InlineAsm *InlineAsm::get(const FunctionType *Ty, StringRef AsmString,
                           bool isAlignStack) {
   InlineAsmKeyType Key(AsmString, Constraints, hasSideEffects, isAlignStack);
   LLVMContextImpl *pImpl = Ty->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return pImpl->InlineAsms.getOrCreate(PointerType::getUnqual(Ty), Key);
 }
 
@@ -47,7 +48,9 @@ InlineAsm::InlineAsm(const PointerType *Ty, const std::string &asmString,
 }
 
 void InlineAsm::destroyConstant() {
-  getRawType()->getContext().pImpl->InlineAsms.remove(this);
+  LLVMContextImpl *pImpl = getRawType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->InlineAsms.remove(this);
   delete this;
 }
 
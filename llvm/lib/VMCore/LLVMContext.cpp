@@ -128,6 +128,7 @@ unsigned LLVMContext::getMDKindID(StringRef Name) const {
   assert(isValidName(Name) && "Invalid MDNode name");
 
   // If this is new, assign it its ID.
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   return
     pImpl->CustomMDKindNames.GetOrCreateValue(
       Name, pImpl->CustomMDKindNames.size()).second;
@@ -78,13 +78,15 @@ LLVMContextImpl::~LLVMContextImpl() {
   NullPtrConstants.freeConstants();
   UndefValueConstants.freeConstants();
   InlineAsms.freeConstants();
-  for (IntMapTy::iterator I = IntConstants.begin(), E = IntConstants.end(); 
-       I != E; ++I) {
-    delete I->second;
+  for (unsigned i = 0, e = IntConstants.size(); i != e; ++i) {
+    IntMapTy &Map = IntConstants[i].Map;
+    for (IntMapTy::iterator I = Map.begin(), E = Map.end(); I != E; ++I)
+      delete I->second;
   }
-  for (FPMapTy::iterator I = FPConstants.begin(), E = FPConstants.end(); 
-       I != E; ++I) {
-    delete I->second;
+  for (unsigned i = 0, e = FPConstants.size(); i != e; ++i) {
+    FPMapTy &Map = FPConstants[i].Map;
+    for (FPMapTy::iterator I = Map.begin(), E = Map.end(); I != E; ++I)
+      delete I->second;
   }
   AlwaysOpaqueTy->dropRef();
   for (OpaqueTypesTy::iterator I = OpaqueTypes.begin(), E = OpaqueTypes.end();
@@ -108,8 +110,10 @@ LLVMContextImpl::~LLVMContextImpl() {
   assert(MDNodeSet.empty() && NonUniquedMDNodes.empty() &&
          "Destroying all MDNodes didn't empty the Context's sets.");
   // Destroy MDStrings.
-  for (StringMap<MDString*>::iterator I = MDStringCache.begin(),
-         E = MDStringCache.end(); I != E; ++I) {
-    delete I->second;
+  for (unsigned i = 0, e = MDStringCache.size(); i != e; ++i) {
+    StringMap<MDString*> &Map = MDStringCache[i].Map;
+    for (StringMap<MDString*>::iterator I = Map.begin(), E = Map.end();
+         I != E; ++I)
+      delete I->second;
   }
 }
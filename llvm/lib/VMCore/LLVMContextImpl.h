@@ -23,6 +23,7 @@
 #include "llvm/DerivedTypes.h"
 #include "llvm/Metadata.h"
 #include "llvm/Assembly/Writer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
@@ -90,6 +91,33 @@ struct DenseMapAPFloatKeyInfo {
   }
 };
 
+/// ShardedMap - A uniquing table split into shards by the hash of the key,
+/// each with its own lock, so that threads creating different values seldom
+/// wait for each other.  Only tables whose values are created without taking
+/// any other lock of the context can be sharded; the others are guarded by
+/// LLVMContextImpl::Lock.
+template<typename MapT, unsigned NumShards = 16>
+class ShardedMap {
+public:
+  struct Shard {
+    sys::SmartMutex<true> Lock;
+    MapT Map;
+  };
+
+  /// getShard - Return the shard for keys with the given hash.  The maps
+  /// pick their buckets by the low bits of the hash, so the shard is picked
+  /// by other bits of it.
+  Shard &getShard(unsigned Hash) {
+    return Shards[((Hash * 0x9E3779B9U) >> 16) % NumShards];
+  }
+
+  unsigned size() const { return NumShards; }
+  Shard &operator[](unsigned i) { return Shards[i]; }
+
+private:
+  Shard Shards[NumShards];
+};
+
 /// DebugRecVH - This is a CallbackVH used to keep the Scope -> index maps
 /// up to date as MDNodes mutate.  This class is implemented in DebugLoc.cpp.
 class DebugRecVH : public CallbackVH {
@@ -118,19 +146,30 @@ public:
   /// OwnedModules - The set of modules instantiated in this context, and which
   /// will be automatically deleted if this context is deleted.
   SmallPtrSet<Module*, 4> OwnedModules;
+
+  /// Lock - Guards the uniquing tables below that are not sharded and the
+  /// other state of the context that functions share: value handles,
+  /// instruction metadata and the use lists of constants and globals.
+  /// Function passes take it implicitly when they run on several functions
+  /// at once; it does nothing unless llvm_is_multithreaded().
+  ///
+  /// The constant maps, MDNodeSet and the type tables are not sharded, as
+  /// type refinement and value handle callbacks update them while holding
+  /// this lock.
+  sys::SmartMutex<true> Lock;
   
   LLVMContext::InlineAsmDiagHandlerTy InlineAsmDiagHandler;
   void *InlineAsmDiagContext;
   
   typedef DenseMap<DenseMapAPIntKeyInfo::KeyTy, ConstantInt*, 
                          DenseMapAPIntKeyInfo> IntMapTy;
-  IntMapTy IntConstants;
+  ShardedMap<IntMapTy> IntConstants;
   
   typedef DenseMap<DenseMapAPFloatKeyInfo::KeyTy, ConstantFP*, 
                          DenseMapAPFloatKeyInfo> FPMapTy;
-  FPMapTy FPConstants;
+  ShardedMap<FPMapTy> FPConstants;
   
-  StringMap<MDString*> MDStringCache;
+  ShardedMap<StringMap<MDString*> > MDStringCache;
   
   FoldingSet<MDNode> MDNodeSet;
   // MDNodes may be uniqued or not uniqued.  When they're not uniqued, they
@@ -161,8 +200,10 @@ public:
 
   ConstantUniqueMap<InlineAsmKeyType, PointerType, InlineAsm> InlineAsms;
   
-  ConstantInt *TheTrueVal;
-  ConstantInt *TheFalseVal;
+  /// TheTrueVal, TheFalseVal - The i1 constants, created on first use.  Once
+  /// set they are read without taking a lock.
+  ConstantInt *volatile TheTrueVal;
+  ConstantInt *volatile TheFalseVal;
   
   LeakDetectorImpl<Value> LLVMObjects;
   
@@ -19,6 +19,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "SymbolTableListTraitsImpl.h"
 #include "llvm/Support/LeakDetector.h"
 #include "llvm/Support/ValueHandle.h"
@@ -33,8 +34,10 @@ MDString::MDString(LLVMContext &C, StringRef S)
 
 MDString *MDString::get(LLVMContext &Context, StringRef Str) {
   LLVMContextImpl *pImpl = Context.pImpl;
-  StringMapEntry<MDString *> &Entry =
-    pImpl->MDStringCache.GetOrCreateValue(Str);
+  ShardedMap<StringMap<MDString*> >::Shard &Shard =
+    pImpl->MDStringCache.getShard(HashString(Str));
+  sys::SmartScopedLock<true> Lock(Shard.Lock);
+  StringMapEntry<MDString *> &Entry = Shard.Map.GetOrCreateValue(Str);
   MDString *&S = Entry.getValue();
   if (!S) S = new MDString(Context, Entry.getKey());
   return S;
@@ -104,6 +107,7 @@ MDNode::~MDNode() {
   assert((getSubclassDataFromValue() & DestroyFlag) != 0 &&
          "Not being destroyed through destroy()?");
   LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   if (isNotUniqued()) {
     pImpl->NonUniquedMDNodes.erase(this);
   } else {
@@ -187,6 +191,7 @@ MDNode *MDNode::getMDNode(LLVMContext &Context, Value *const *Vals,
                           unsigned NumVals, FunctionLocalness FL,
                           bool Insert) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
 
   // Add all the operand pointers. Note that we don't have to add the
   // isFunctionLocal bit because that's implied by the operands.
@@ -288,13 +293,16 @@ void MDNode::Profile(FoldingSetNodeID &ID) const {
 }
 
 void MDNode::setIsNotUniqued() {
-  setValueSubclassData(getSubclassDataFromValue() | NotUniquedBit);
   LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  setValueSubclassData(getSubclassDataFromValue() | NotUniquedBit);
   pImpl->NonUniquedMDNodes.insert(this);
 }
 
 // Replace value from this node's operand list.
 void MDNode::replaceOperand(MDNodeOperand *Op, Value *To) {
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   Value *From = *Op;
 
   // If is possible that someone did GV->RAUW(inst), replacing a global variable
@@ -325,8 +333,6 @@ void MDNode::replaceOperand(MDNodeOperand *Op, Value *To) {
   // already went to null), then there is nothing else to do here.
   if (isNotUniqued()) return;
 
-  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
-
   // Remove "this" from the context map.  FoldingSet doesn't have to reprofile
   // this node to remove it, so we don't care what state the operands are in.
   pImpl->MDNodeSet.RemoveNode(this);
@@ -449,9 +455,12 @@ void Instruction::setMetadata(unsigned KindID, MDNode *Node) {
     return;
   }
   
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+
   // Handle the case when we're adding/updating metadata on an instruction.
   if (Node) {
-    LLVMContextImpl::MDMapTy &Info = getContext().pImpl->MetadataStore[this];
+    LLVMContextImpl::MDMapTy &Info = pImpl->MetadataStore[this];
     assert(!Info.empty() == hasMetadataHashEntry() &&
            "HasMetadata bit is wonked");
     if (Info.empty()) {
@@ -471,14 +480,13 @@ void Instruction::setMetadata(unsigned KindID, MDNode *Node) {
   }
 
   // Otherwise, we're removing metadata from an instruction.
-  assert(hasMetadataHashEntry() &&
-         getContext().pImpl->MetadataStore.count(this) &&
+  assert(hasMetadataHashEntry() && pImpl->MetadataStore.count(this) &&
          "HasMetadata bit out of date!");
-  LLVMContextImpl::MDMapTy &Info = getContext().pImpl->MetadataStore[this];
+  LLVMContextImpl::MDMapTy &Info = pImpl->MetadataStore[this];
 
   // Common case is removing the only entry.
   if (Info.size() == 1 && Info[0].first == KindID) {
-    getContext().pImpl->MetadataStore.erase(this);
+    pImpl->MetadataStore.erase(this);
     setHasMetadataHashEntry(false);
     return;
   }
@@ -501,7 +509,9 @@ MDNode *Instruction::getMetadataImpl(unsigned KindID) const {
   
   if (!hasMetadataHashEntry()) return 0;
   
-  LLVMContextImpl::MDMapTy &Info = getContext().pImpl->MetadataStore[this];
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  LLVMContextImpl::MDMapTy &Info = pImpl->MetadataStore[this];
   assert(!Info.empty() && "bit out of sync with hash table");
 
   for (LLVMContextImpl::MDMapTy::iterator I = Info.begin(), E = Info.end();
@@ -522,11 +532,12 @@ void Instruction::getAllMetadataImpl(SmallVectorImpl<std::pair<unsigned,
     if (!hasMetadataHashEntry()) return;
   }
   
-  assert(hasMetadataHashEntry() &&
-         getContext().pImpl->MetadataStore.count(this) &&
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  assert(hasMetadataHashEntry() && pImpl->MetadataStore.count(this) &&
          "Shouldn't have called this");
   const LLVMContextImpl::MDMapTy &Info =
-    getContext().pImpl->MetadataStore.find(this)->second;
+    pImpl->MetadataStore.find(this)->second;
   assert(!Info.empty() && "Shouldn't have called this");
 
   Result.append(Info.begin(), Info.end());
@@ -540,11 +551,12 @@ void Instruction::
 getAllMetadataOtherThanDebugLocImpl(SmallVectorImpl<std::pair<unsigned,
                                     MDNode*> > &Result) const {
   Result.clear();
-  assert(hasMetadataHashEntry() &&
-         getContext().pImpl->MetadataStore.count(this) &&
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  assert(hasMetadataHashEntry() && pImpl->MetadataStore.count(this) &&
          "Shouldn't have called this");
   const LLVMContextImpl::MDMapTy &Info =
-  getContext().pImpl->MetadataStore.find(this)->second;
+    pImpl->MetadataStore.find(this)->second;
   assert(!Info.empty() && "Shouldn't have called this");
   
   Result.append(Info.begin(), Info.end());
@@ -559,7 +571,9 @@ getAllMetadataOtherThanDebugLocImpl(SmallVectorImpl<std::pair<unsigned,
 /// this instruction.
 void Instruction::clearMetadataHashEntries() {
   assert(hasMetadataHashEntry() && "Caller should check");
-  getContext().pImpl->MetadataStore.erase(this);
+  LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  pImpl->MetadataStore.erase(this);
   setHasMetadataHashEntry(false);
 }
 
@@ -20,11 +20,17 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Module.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/PassNameParser.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Atomic.h"
+#include "llvm/Support/Threading.h"
 #include <algorithm>
 #include <cstdio>
 #include <map>
@@ -78,6 +84,25 @@ PrintAfterAll("print-after-all",
               llvm::cl::desc("Print IR after each pass"),
               cl::init(false));
 
+// Run function passes on several functions at once.
+static cl::opt<unsigned>
+FunctionPassThreads("function-pass-threads",
+                    cl::desc("Number of threads to run function passes on, "
+                             "when all passes of a group support it"),
+                    cl::init(0));
+
+// Record what each pass costs.
+static cl::opt<std::string>
+PassProfileFile("profile-passes", cl::value_desc("filename"),
+                cl::desc("Write the time, memory and instruction count "
+                         "changes of each pass, per pass and per function, "
+                         "to a JSON file"));
+
+static cl::opt<std::string>
+PassTraceFile("profile-passes-trace", cl::value_desc("filename"),
+              cl::desc("Write each run of a pass to a file in the Chrome "
+                       "trace event format"));
+
 /// This is a helper to determine whether to print IR before or
 /// after a pass.
 
@@ -300,7 +325,8 @@ class MPPassManager : public Pass, public PMDataManager {
 public:
   static char ID;
   explicit MPPassManager(int Depth) :
-    Pass(PT_PassManager, ID), PMDataManager(Depth) { }
+    Pass(PT_PassManager, ID), PMDataManager(Depth),
+    MaterializeForModulePasses(false) { }
 
   // Delete on the fly managers.
   virtual ~MPPassManager() {
@@ -366,6 +392,10 @@ public:
     return PMT_ModulePassManager;
   }
 
+  /// MaterializeForModulePasses - Whether to read all of a lazily loaded
+  /// module in before running a module pass on it.
+  bool MaterializeForModulePasses;
+
  private:
   /// Collection of on the fly FPPassManagers. These managers manage
   /// function passes that are required by module passes.
@@ -386,7 +416,8 @@ public:
   static char ID;
   explicit PassManagerImpl(int Depth) :
     Pass(PT_PassManager, ID), PMDataManager(Depth),
-                              PMTopLevelManager(new MPPassManager(1)) {}
+                              PMTopLevelManager(new MPPassManager(1)),
+                              MaterializeForModulePasses(false) {}
 
   /// add - Add a pass to the queue of passes to run.  This passes ownership of
   /// the Pass to the PassManager.  When the PassManager is destroyed, the pass
@@ -432,6 +463,10 @@ public:
     MPPassManager *MP = static_cast<MPPassManager *>(PassManagers[N]);
     return MP;
   }
+
+  /// MaterializeForModulePasses - Whether the module pass managers read all
+  /// of a lazily loaded module in before running a module pass on it.
+  bool MaterializeForModulePasses;
 };
 
 char PassManagerImpl::ID = 0;
@@ -482,9 +517,113 @@ public:
   }
 };
 
+//===----------------------------------------------------------------------===//
+/// PassProfiler Class - This class is used to record the time, memory and
+/// instruction count changes of each run of a pass.  This only happens when
+/// -profile-passes or -profile-passes-trace is given on the command line.
+///
+
+/// ResourceUsage - The counters sampled before and after each run of a pass.
+struct ResourceUsage {
+  double Wall, User, System;  // In seconds.
+  size_t PeakRSS;             // Largest resident set size so far.
+  size_t Malloc;              // Bytes in use by malloc.
+  size_t SlabBytes;           // Bytes of bump allocator slabs handed out.
+
+  static ResourceUsage getCurrent() {
+    ResourceUsage Result;
+    sys::TimeValue now(0,0), user(0,0), sys(0,0);
+    sys::Process::GetTimeUsage(now, user, sys);
+    Result.Wall   =  now.seconds() +  now.microseconds() / 1000000.0;
+    Result.User   = user.seconds() + user.microseconds() / 1000000.0;
+    Result.System =  sys.seconds() +  sys.microseconds() / 1000000.0;
+    Result.PeakRSS = sys::Process::GetPeakResidentSetSize();
+    Result.Malloc = sys::Process::GetMallocUsage();
+    Result.SlabBytes = MallocSlabAllocator::getTotalSlabBytes();
+    return Result;
+  }
+};
+
+/// PassEvent - One run of a pass on a module, function or basic block.
+struct PassEvent {
+  unsigned Pass;              // Name index of the pass.
+  unsigned IRUnit;            // Name index of what the pass ran on.
+  const char *Kind;           // "module", "function", "basicblock", ...
+  double Start;               // Seconds since the profiler was created.
+  double Wall, User, System;
+  int64_t PeakRSS, Malloc, SlabBytes, Insts;
+};
+
+/// PassTotals - The sum of some PassEvents.
+struct PassTotals {
+  unsigned Runs;
+  double Wall, User, System;
+  int64_t PeakRSS, Malloc, SlabBytes, Insts;
+
+  PassTotals() : Runs(0), Wall(0), User(0), System(0), PeakRSS(0), Malloc(0),
+                 SlabBytes(0), Insts(0) {}
+
+  void add(const PassEvent &E) {
+    ++Runs;
+    Wall += E.Wall;
+    User += E.User;
+    System += E.System;
+    PeakRSS += E.PeakRSS;
+    Malloc += E.Malloc;
+    SlabBytes += E.SlabBytes;
+    Insts += E.Insts;
+  }
+};
+
+class PassProfiler {
+  sys::SmartMutex<true> Lock;
+  StringMap<unsigned> NameIDs;
+  std::vector<StringRef> Names;
+  std::vector<PassEvent> Events;
+  double Origin;
+
+  unsigned getNameID(StringRef Name) {
+    StringMapEntry<unsigned> &Entry = NameIDs.GetOrCreateValue(Name, ~0U);
+    if (Entry.getValue() == ~0U) {
+      Entry.setValue(Names.size());
+      Names.push_back(Entry.getKey());
+    }
+    return Entry.getValue();
+  }
+
+  void writeTotals(raw_ostream &OS, const PassTotals &T);
+  void writeReport(raw_ostream &OS);
+  void writeTrace(raw_ostream &OS);
+
+public:
+  // Use 'create' member to get this.
+  PassProfiler() : Origin(ResourceUsage::getCurrent().Wall) {}
+
+  // Write out the report and the trace that were asked for.
+  ~PassProfiler();
+
+  // createThePassProfiler - This method either initializes the
+  // ThePassProfiler pointer to a non null value (if -profile-passes or
+  // -profile-passes-trace is given) or it leaves it null.  It may be called
+  // multiple times.
+  static void createThePassProfiler();
+
+  double getOrigin() const { return Origin; }
+
+  /// addEvent - Record a run of PassName on IRName.  The Pass and IRUnit
+  /// fields of E are filled in here.
+  void addEvent(PassEvent &E, StringRef PassName, StringRef IRName) {
+    sys::SmartScopedLock<true> Guard(Lock);
+    E.Pass = getNameID(PassName);
+    E.IRUnit = getNameID(IRName);
+    Events.push_back(E);
+  }
+};
+
 } // End of anon namespace
 
 static TimingInfo *TheTimeInfo;
+static PassProfiler *ThePassProfiler;
 
 //===----------------------------------------------------------------------===//
 // PMTopLevelManager implementation
@@ -567,6 +706,31 @@ void PMTopLevelManager::collectLastUses(SmallVectorImpl<Pass *> &LastUses,
 
 }
 
+/// Make each pass in Clones the last user of the clones of the passes
+/// whose last user is the pass at the same position in Originals.
+void
+PMTopLevelManager::cloneLastUses(const SmallVectorImpl<Pass *> &Originals,
+                                 const SmallVectorImpl<Pass *> &Clones) {
+  assert(Originals.size() == Clones.size() && "Not a clone of each pass!");
+  for (unsigned i = 0, e = Originals.size(); i != e; ++i) {
+    SmallVector<Pass *, 12> LastUses;
+    collectLastUses(LastUses, Originals[i]);
+
+    // Passes of other managers keep their last users.
+    SmallVector<Pass *, 12> ClonedLastUses;
+    for (unsigned j = 0, je = LastUses.size(); j != je; ++j) {
+      SmallVectorImpl<Pass *>::const_iterator Pos =
+        std::find(Originals.begin(), Originals.end(), LastUses[j]);
+      if (Pos != Originals.end())
+        ClonedLastUses.push_back(Clones[Pos - Originals.begin()]);
+    }
+
+    if (!ClonedLastUses.empty())
+      InversedLastUser[Clones[i]].insert(ClonedLastUses.begin(),
+                                         ClonedLastUses.end());
+  }
+}
+
 AnalysisUsage *PMTopLevelManager::findAnalysisUsage(Pass *P) {
   AnalysisUsage *AnUsage = NULL;
   DenseMap<Pass *, AnalysisUsage *>::iterator DMI = AnUsageMap.find(P);
@@ -1246,6 +1410,7 @@ bool BBPassManager::runOnFunction(Function &F) {
         // If the pass crashes, remember this.
         PassManagerPrettyStackEntry X(BP, *I);
         TimeRegion PassTimer(getPassTimer(BP));
+        PassProfileRegion PassProfile(BP, *I);
 
         LocalChanged |= BP->runOnBasicBlock(*I);
       }
@@ -1307,6 +1472,16 @@ bool BBPassManager::doFinalization(Function &F) {
 }
 
 
+/// MaterializeFunction - Read the body of F, if it is still in the bitcode
+/// file a lazily loaded module came from.
+static void MaterializeFunction(Function &F) {
+  if (!F.isMaterializable())
+    return;
+  std::string errstr;
+  if (F.Materialize(&errstr))
+    report_fatal_error("Error reading bitcode file: " + Twine(errstr));
+}
+
 //===----------------------------------------------------------------------===//
 // FunctionPassManager implementation
 
@@ -1356,11 +1531,7 @@ void FunctionPassManager::add(Pass *P) {
 /// so, return true.
 ///
 bool FunctionPassManager::run(Function &F) {
-  if (F.isMaterializable()) {
-    std::string errstr;
-    if (F.Materialize(&errstr))
-      report_fatal_error("Error reading bitcode file: " + Twine(errstr));
-  }
+  MaterializeFunction(F);
   return FPM->run(F);
 }
 
@@ -1428,6 +1599,7 @@ void FunctionPassManagerImpl::releaseMemoryOnTheFly() {
 bool FunctionPassManagerImpl::run(Function &F) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  PassProfiler::createThePassProfiler();
 
   initializeAllAnalysisInfo();
   for (unsigned Index = 0; Index < getNumContainedManagers(); ++Index)
@@ -1455,6 +1627,11 @@ void FPPassManager::dumpPassStructure(unsigned Offset) {
 }
 
 
+FPPassManager::~FPPassManager() {
+  for (unsigned i = 0, e = Shards.size(); i != e; ++i)
+    delete Shards[i];
+}
+
 /// Execute all of the passes scheduled for execution by invoking
 /// runOnFunction method.  Keep track of whether any of the passes modifies
 /// the function, and if so, return true.
@@ -1462,12 +1639,16 @@ bool FPPassManager::runOnFunction(Function &F) {
   if (F.isDeclaration())
     return false;
 
-  bool Changed = false;
-
   // Collect inherited analysis from Module level pass manager.
   populateInheritedAnalysis(TPM->activeStack);
 
-  for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
+  return runPassesOn(F);
+}
+
+bool FPPassManager::runPassesOn(Function &F, unsigned Begin, unsigned End) {
+  bool Changed = false;
+
+  for (unsigned Index = Begin; Index < End; ++Index) {
     FunctionPass *FP = getContainedPass(Index);
     bool LocalChanged = false;
 
@@ -1479,6 +1660,7 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      PassProfileRegion PassProfile(FP, F);
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1496,15 +1678,371 @@ bool FPPassManager::runOnFunction(Function &F) {
   return Changed;
 }
 
+void FPPassManager::freeUnreleasedPasses(Function &F) {
+  for (unsigned i = 0, e = Unreleased.size(); i != e; ++i)
+    freePass(Unreleased[i], F.getName(), ON_FUNCTION_MSG);
+}
+
 bool FPPassManager::runOnModule(Module &M) {
   bool Changed = doInitialization(M);
 
-  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
-    runOnFunction(*I);
+  if (unsigned NumShards = getNumShards(M)) {
+    if (PipelineEnd)
+      runPipelined(M, NumShards);
+    else
+      runInParallel(M, NumShards);
+  } else
+    for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
+      // Function bodies of a lazily loaded module are read as they come up.
+      MaterializeFunction(*I);
+      runOnFunction(*I);
+    }
 
   return doFinalization(M) || Changed;
 }
 
+unsigned FPPassManager::getNumShards(Module &M) {
+  // The passes may ask for threads themselves, or veto them for this module.
+  unsigned NumThreads = FunctionPassThreads;
+  unsigned Requester = getNumContainedPasses();
+  for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index) {
+    unsigned Threads = getContainedPass(Index)->getParallelThreads();
+    if (Threads == 1)
+      return 0;
+    if (Threads >= 2 && Requester == getNumContainedPasses())
+      Requester = Index;
+    NumThreads = std::max(NumThreads, Threads);
+  }
+  if (NumThreads < 2)
+    return 0;
+
+  // The pass debugging, timing and profiling output is not kept per thread.
+  if (PassDebugging >= Executions || TimePassesIsEnabled || ThePassProfiler)
+    return 0;
+
+  // The bodies of a lazily loaded module are not read yet.
+  unsigned NumFunctions = 0;
+  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
+    if (!I->isDeclaration() || I->isMaterializable())
+      ++NumFunctions;
+  unsigned NumShards = std::min<unsigned>(NumThreads, NumFunctions);
+  if (NumShards < 2)
+    return 0;
+
+  if (CanRunInParallel)
+    while (Shards.size() < NumShards)
+      if (!addShard(0, getNumContainedPasses())) {
+        CanRunInParallel = false;
+        break;
+      }
+
+  // Without a copy of every pass, a pass that asked for threads may still get
+  // them for the passes around it.
+  if (!CanRunInParallel) {
+    if (!PipelineChecked) {
+      PipelineChecked = true;
+      if (Requester == getNumContainedPasses() || !findPipeline(Requester))
+        PipelineBegin = PipelineEnd = 0;
+    }
+    if (Requester < PipelineBegin || Requester >= PipelineEnd)
+      return 0;
+    while (Shards.size() < NumShards)
+      if (!addShard(PipelineBegin, PipelineEnd))
+        return 0;
+  }
+
+  // Without this the locks of the context do nothing.
+  if (!llvm_is_multithreaded() && !llvm_start_multithreaded())
+    return 0;
+
+  return NumShards;
+}
+
+/// collectUnreleasedPasses - Add the passes of Passes that are not the last
+/// user of themselves or of each other to Unreleased.
+static void collectUnreleasedPasses(PMTopLevelManager *TPM,
+                                    const SmallVectorImpl<Pass *> &Passes,
+                                    SmallVectorImpl<Pass *> &Unreleased) {
+  SmallVector<Pass *, 12> LastUses;
+  for (unsigned i = 0, e = Passes.size(); i != e; ++i)
+    TPM->collectLastUses(LastUses, Passes[i]);
+  for (unsigned i = 0, e = Passes.size(); i != e; ++i)
+    if (std::find(LastUses.begin(), LastUses.end(), Passes[i]) ==
+        LastUses.end())
+      Unreleased.push_back(Passes[i]);
+}
+
+bool FPPassManager::addShard(unsigned Begin, unsigned End) {
+  FPPassManager *Shard = new FPPassManager(getDepth());
+  Shard->setTopLevelManager(TPM);
+
+  for (unsigned Index = Begin; Index < End; ++Index) {
+    FunctionPass *Clone = getContainedPass(Index)->createParallelClone();
+    if (!Clone) {
+      delete Shard;
+      return false;
+    }
+    Shard->add(Clone, false);
+
+    // The analysis usage is computed on demand, do it while there is only one
+    // thread.
+    TPM->findAnalysisUsage(Clone);
+  }
+
+  SmallVector<Pass *, 16> Originals(PassVector.begin() + Begin,
+                                    PassVector.begin() + End);
+  TPM->cloneLastUses(Originals, Shard->PassVector);
+
+  // The clones whose last user is not a clone are freed after each function.
+  collectUnreleasedPasses(TPM, Shard->PassVector, Shard->Unreleased);
+
+  Shards.push_back(Shard);
+  return true;
+}
+
+bool FPPassManager::findPipeline(unsigned Requester) {
+  unsigned NumPasses = getNumContainedPasses();
+
+  // Replay how the passes were scheduled to find the pass of this manager
+  // that provides each analysis a pass requires.
+  std::vector<SmallVector<unsigned, 4> > Providers(NumPasses);
+  std::map<AnalysisID, unsigned> Available;
+  for (unsigned Index = 0; Index != NumPasses; ++Index) {
+    Pass *P = getContainedPass(Index);
+    AnalysisUsage *AnUsage = TPM->findAnalysisUsage(P);
+
+    const AnalysisUsage::VectorType *Required[] = {
+      &AnUsage->getRequiredSet(), &AnUsage->getRequiredTransitiveSet()
+    };
+    for (unsigned i = 0; i != 2; ++i)
+      for (AnalysisUsage::VectorType::const_iterator I = Required[i]->begin(),
+             E = Required[i]->end(); I != E; ++I) {
+        std::map<AnalysisID, unsigned>::iterator Pos = Available.find(*I);
+        if (Pos != Available.end())
+          Providers[Index].push_back(Pos->second);
+      }
+
+    if (!AnUsage->getPreservesAll()) {
+      const AnalysisUsage::VectorType &PreservedSet =
+        AnUsage->getPreservedSet();
+      for (std::map<AnalysisID, unsigned>::iterator I = Available.begin(),
+             E = Available.end(); I != E; ) {
+        std::map<AnalysisID, unsigned>::iterator Info = I++;
+        if (std::find(PreservedSet.begin(), PreservedSet.end(), Info->first) ==
+            PreservedSet.end())
+          Available.erase(Info);
+      }
+    }
+
+    Available[P->getPassID()] = Index;
+    if (const PassInfo *PInf =
+          PassRegistry::getPassRegistry()->getPassInfo(P->getPassID())) {
+      const std::vector<const PassInfo*> &II = PInf->getInterfacesImplemented();
+      for (unsigned i = 0, e = II.size(); i != e; ++i)
+        Available[II[i]->getTypeInfo()] = Index;
+    }
+  }
+
+  // The pipeline runs from Requester up to the first pass without a clone.
+  unsigned Begin = Requester, End = Requester;
+  while (End != NumPasses) {
+    FunctionPass *Clone = getContainedPass(End)->createParallelClone();
+    if (!Clone)
+      break;
+    delete Clone;
+    ++End;
+  }
+  if (End == Begin)
+    return false;
+
+  // The pipeline runs on a batch of functions after the passes before it are
+  // done with the whole batch, so it cannot use their analysis, and neither
+  // can the passes after it.
+  for (unsigned Index = Begin; Index != NumPasses; ++Index)
+    for (unsigned i = 0, e = Providers[Index].size(); i != e; ++i)
+      if (Providers[Index][i] < Begin)
+        return false;
+
+  // The passes after the pipeline may only use analysis of the pipeline that
+  // its clones keep for them, or that only depends on the CFG and can be
+  // computed again, along with what that analysis uses in turn.
+  SmallVector<unsigned, 8> Worklist;
+  SmallVector<unsigned, 4> Reruns;
+  for (unsigned Index = End; Index != NumPasses; ++Index)
+    Worklist.append(Providers[Index].begin(), Providers[Index].end());
+  while (!Worklist.empty()) {
+    unsigned Index = Worklist.pop_back_val();
+    if (Index >= End ||
+        std::find(Reruns.begin(), Reruns.end(), Index) != Reruns.end())
+      continue;
+    Reruns.push_back(Index);
+    FunctionPass *P = getContainedPass(Index);
+    const PassInfo *PInf =
+      PassRegistry::getPassRegistry()->getPassInfo(P->getPassID());
+    if (!P->keepsParallelResults() &&
+        !(PInf && PInf->isAnalysis() && PInf->isCFGOnlyPass()))
+      return false;
+    Worklist.append(Providers[Index].begin(), Providers[Index].end());
+  }
+
+  PipelineBegin = Begin;
+  PipelineEnd = End;
+  std::sort(Reruns.begin(), Reruns.end());
+  PipelineReruns = Reruns;
+
+  // The passes of the pipeline this manager runs again may have their last
+  // user in the pipeline, free them after each function.
+  SmallVector<Pass *, 16> Passes;
+  for (unsigned i = 0, e = PipelineReruns.size(); i != e; ++i)
+    Passes.push_back(getContainedPass(PipelineReruns[i]));
+  for (unsigned Index = End; Index != NumPasses; ++Index)
+    Passes.push_back(getContainedPass(Index));
+  collectUnreleasedPasses(TPM, Passes, Unreleased);
+  return true;
+}
+
+bool FPPassManager::canRunInParallelOn(Function &F, unsigned Begin,
+                                      unsigned End) {
+  for (unsigned Index = Begin; Index < End; ++Index)
+    if (!getContainedPass(Index)->canRunInParallelOn(F))
+      return false;
+  return true;
+}
+
+namespace {
+
+/// ParallelRun - The functions the shards of an FPPassManager share out
+/// between them.
+struct ParallelRun {
+  std::vector<Function *> Functions;
+  volatile sys::cas_flag NextFunction;
+};
+
+/// ShardRun - What one shard runs on.
+struct ShardRun {
+  FPPassManager *Shard;
+  ParallelRun *Run;
+};
+
+}
+
+/// RunShard - Run the passes of a shard on the functions no other shard took
+/// yet.
+static void RunShard(void *Arg) {
+  ShardRun *SR = static_cast<ShardRun *>(Arg);
+  std::vector<Function *> &Functions = SR->Run->Functions;
+  for (;;) {
+    unsigned Index = sys::AtomicIncrement(&SR->Run->NextFunction) - 1;
+    if (Index >= Functions.size())
+      break;
+    SR->Shard->runPassesOn(*Functions[Index]);
+    SR->Shard->freeUnreleasedPasses(*Functions[Index]);
+  }
+}
+
+void FPPassManager::runInParallel(Module &M, unsigned NumShards) {
+  ParallelRun Run;
+  Run.NextFunction = 0;
+  std::vector<Function *> Serial;
+  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
+    MaterializeFunction(*I);
+    if (!I->isDeclaration()) {
+      if (canRunInParallelOn(*I, 0, getNumContainedPasses()))
+        Run.Functions.push_back(I);
+      else
+        Serial.push_back(I);
+    }
+  }
+
+  std::vector<ShardRun> ShardRuns(NumShards);
+  std::vector<void *> Args(NumShards);
+  for (unsigned i = 0; i != NumShards; ++i) {
+    FPPassManager *Shard = Shards[i];
+    Shard->initializeAnalysisInfo();
+    Shard->doInitialization(M);
+    ShardRuns[i].Shard = Shard;
+    ShardRuns[i].Run = &Run;
+    Args[i] = &ShardRuns[i];
+  }
+
+  llvm_execute_in_parallel(RunShard, &Args[0], NumShards);
+
+  for (unsigned i = 0, e = Serial.size(); i != e; ++i)
+    runOnFunction(*Serial[i]);
+
+  // The shards only look the analysis of the managers above this one up, now
+  // drop the analysis the passes did not preserve, as if this manager had run
+  // them.
+  populateInheritedAnalysis(TPM->activeStack);
+  for (unsigned Index = 0; Index < getNumContainedPasses(); ++Index)
+    removeNotPreservedAnalysis(getContainedPass(Index));
+}
+
+/// PipelineBatchSize - The number of functions per shard in a batch of a
+/// pipelined run.  All functions of a batch keep what the pipeline made for
+/// them until the passes after it are done with them.
+static const unsigned PipelineBatchSize = 16;
+
+void FPPassManager::runPipelined(Module &M, unsigned NumShards) {
+  ParallelRun Run;
+  std::vector<ShardRun> ShardRuns(NumShards);
+  std::vector<void *> Args(NumShards);
+  for (unsigned i = 0; i != NumShards; ++i) {
+    FPPassManager *Shard = Shards[i];
+    Shard->initializeAnalysisInfo();
+    Shard->doInitialization(M);
+    ShardRuns[i].Shard = Shard;
+    ShardRuns[i].Run = &Run;
+    Args[i] = &ShardRuns[i];
+  }
+
+  populateInheritedAnalysis(TPM->activeStack);
+
+  unsigned NumPasses = getNumContainedPasses();
+  std::vector<Function *> Batch;
+  Module::iterator I = M.begin(), E = M.end();
+  while (I != E) {
+    // The passes before the pipeline run on the whole batch first.
+    Batch.clear();
+    Run.Functions.clear();
+    Run.NextFunction = 0;
+    for (; I != E && Batch.size() < NumShards * PipelineBatchSize; ++I) {
+      MaterializeFunction(*I);
+      if (!I->isDeclaration()) {
+        runPassesOn(*I, 0, PipelineBegin);
+        Batch.push_back(I);
+        if (canRunInParallelOn(*I, PipelineBegin, PipelineEnd))
+          Run.Functions.push_back(I);
+      }
+    }
+
+    // The clones may look analysis of this manager up, drop what the
+    // pipeline does not preserve as if it ran here.
+    for (unsigned Index = PipelineBegin; Index != PipelineEnd; ++Index)
+      removeNotPreservedAnalysis(getContainedPass(Index));
+
+    llvm_execute_in_parallel(RunShard, &Args[0], NumShards);
+
+    // The passes after the pipeline run in module order, on what the clones
+    // kept.  The functions the shards did not take go through the pipeline
+    // here, in the same order.
+    for (unsigned i = 0, j = 0, e = Batch.size(); i != e; ++i) {
+      Function &F = *Batch[i];
+      if (j != Run.Functions.size() && Run.Functions[j] == &F) {
+        ++j;
+        for (unsigned k = 0, ke = PipelineReruns.size(); k != ke; ++k)
+          runPassesOn(F, PipelineReruns[k], PipelineReruns[k] + 1);
+        runPassesOn(F, PipelineEnd, NumPasses);
+      } else
+        runPassesOn(F, PipelineBegin, NumPasses);
+      freeUnreleasedPasses(F);
+    }
+  }
+
+  for (unsigned Index = 0; Index < NumPasses; ++Index)
+    removeNotPreservedAnalysis(getContainedPass(Index));
+}
+
 bool FPPassManager::doInitialization(Module &M) {
   bool Changed = false;
 
@@ -1550,9 +2088,19 @@ MPPassManager::runOnModule(Module &M) {
 
     initializeAnalysisImpl(MP);
 
+    // A module pass may look at any function, so read all of a lazily loaded
+    // module in first if asked to.  Function pass managers read one function
+    // at a time.
+    if (MaterializeForModulePasses && MP->getPassID() != &FPPassManager::ID) {
+      std::string ErrInfo;
+      if (M.MaterializeAll(&ErrInfo))
+        report_fatal_error("Error reading bitcode file: " + Twine(ErrInfo));
+    }
+
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      PassProfileRegion PassProfile(MP, M);
 
       LocalChanged |= MP->runOnModule(M);
     }
@@ -1629,13 +2177,17 @@ Pass* MPPassManager::getOnTheFlyPass(Pass *MP, AnalysisID PI, Function &F){
 bool PassManagerImpl::run(Module &M) {
   bool Changed = false;
   TimingInfo::createTheTimeInfo();
+  PassProfiler::createThePassProfiler();
 
   dumpArguments();
   dumpPasses();
 
   initializeAllAnalysisInfo();
-  for (unsigned Index = 0; Index < getNumContainedManagers(); ++Index)
-    Changed |= getContainedManager(Index)->runOnModule(M);
+  for (unsigned Index = 0; Index < getNumContainedManagers(); ++Index) {
+    MPPassManager *MP = getContainedManager(Index);
+    MP->MaterializeForModulePasses = MaterializeForModulePasses;
+    Changed |= MP->runOnModule(M);
+  }
   return Changed;
 }
 
@@ -1682,6 +2234,13 @@ bool PassManager::run(Module &M) {
   return PM->run(M);
 }
 
+/// setMaterializeForModulePasses - If Materialize is true, read all the
+/// function bodies of a lazily loaded module in before a module pass runs on
+/// it.
+void PassManager::setMaterializeForModulePasses(bool Materialize) {
+  PM->MaterializeForModulePasses = Materialize;
+}
+
 //===----------------------------------------------------------------------===//
 // TimingInfo Class - This class is used to calculate information about the
 // amount of time each pass takes to execute.  This only happens with
@@ -1712,6 +2271,246 @@ Timer *llvm::getPassTimer(Pass *P) {
   return 0;
 }
 
+//===----------------------------------------------------------------------===//
+// PassProfiler implementation
+//
+
+// createThePassProfiler - This method either initializes the ThePassProfiler
+// pointer to a non null value (if -profile-passes or -profile-passes-trace is
+// given) or it leaves it null.  It may be called multiple times.
+void PassProfiler::createThePassProfiler() {
+  if ((PassProfileFile.empty() && PassTraceFile.empty()) || ThePassProfiler)
+    return;
+
+  // Constructed the first time this is called, like TimingInfo, so that it is
+  // destroyed, writing its files, before the static globals it uses.
+  static ManagedStatic<PassProfiler> TPP;
+  ThePassProfiler = &*TPP;
+}
+
+/// writeJSONString - Print S as a quoted JSON string.
+static void writeJSONString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (StringRef::iterator I = S.begin(), E = S.end(); I != E; ++I) {
+    unsigned char C = *I;
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C < 0x20)
+      OS << format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void PassProfiler::writeTotals(raw_ostream &OS, const PassTotals &T) {
+  OS << "\"runs\": " << T.Runs
+     << ", \"wall\": " << format("%.6f", T.Wall)
+     << ", \"user\": " << format("%.6f", T.User)
+     << ", \"system\": " << format("%.6f", T.System)
+     << ", \"peak_rss_delta\": " << T.PeakRSS
+     << ", \"malloc_delta\": " << T.Malloc
+     << ", \"bump_bytes\": " << T.SlabBytes
+     << ", \"inst_delta\": " << T.Insts;
+}
+
+namespace {
+/// TotalsByWall - Sort name index and totals pairs, slowest first.
+struct TotalsByWall {
+  bool operator()(const std::pair<unsigned, PassTotals> &LHS,
+                  const std::pair<unsigned, PassTotals> &RHS) const {
+    return LHS.second.Wall > RHS.second.Wall;
+  }
+};
+}
+
+/// sortTotals - Return the entries of Map, slowest first.
+static std::vector<std::pair<unsigned, PassTotals> >
+sortTotals(const std::map<unsigned, PassTotals> &Map) {
+  std::vector<std::pair<unsigned, PassTotals> > Sorted(Map.begin(), Map.end());
+  std::stable_sort(Sorted.begin(), Sorted.end(), TotalsByWall());
+  return Sorted;
+}
+
+// writeReport - Print the totals of each pass, and of each function with the
+// totals of each pass that ran on it.  The times of passes that run other
+// passes, such as on-the-fly function passes, include those of the passes
+// they run.
+void PassProfiler::writeReport(raw_ostream &OS) {
+  std::map<unsigned, PassTotals> ByPass, ByFunction;
+  std::map<unsigned, std::map<unsigned, PassTotals> > ByFunctionAndPass;
+  for (unsigned i = 0, e = Events.size(); i != e; ++i) {
+    const PassEvent &E = Events[i];
+    ByPass[E.Pass].add(E);
+    if (strcmp(E.Kind, "module") == 0)
+      continue;
+    ByFunction[E.IRUnit].add(E);
+    ByFunctionAndPass[E.IRUnit][E.Pass].add(E);
+  }
+
+  std::vector<std::pair<unsigned, PassTotals> > Passes = sortTotals(ByPass);
+  OS << "{\n  \"passes\": [";
+  for (unsigned i = 0, e = Passes.size(); i != e; ++i) {
+    OS << (i ? ",\n" : "\n") << "    {\"name\": ";
+    writeJSONString(OS, Names[Passes[i].first]);
+    OS << ", ";
+    writeTotals(OS, Passes[i].second);
+    OS << "}";
+  }
+  OS << "\n  ],\n  \"functions\": [";
+
+  std::vector<std::pair<unsigned, PassTotals> > Functions =
+    sortTotals(ByFunction);
+  for (unsigned i = 0, e = Functions.size(); i != e; ++i) {
+    OS << (i ? ",\n" : "\n") << "    {\"name\": ";
+    writeJSONString(OS, Names[Functions[i].first]);
+    OS << ", ";
+    writeTotals(OS, Functions[i].second);
+    OS << ", \"passes\": [";
+    std::vector<std::pair<unsigned, PassTotals> > FunctionPasses =
+      sortTotals(ByFunctionAndPass[Functions[i].first]);
+    for (unsigned j = 0, je = FunctionPasses.size(); j != je; ++j) {
+      OS << (j ? ",\n" : "\n") << "      {\"name\": ";
+      writeJSONString(OS, Names[FunctionPasses[j].first]);
+      OS << ", ";
+      writeTotals(OS, FunctionPasses[j].second);
+      OS << "}";
+    }
+    OS << "\n    ]}";
+  }
+  OS << "\n  ]\n}\n";
+}
+
+// writeTrace - Print each run of a pass as a complete event of the Chrome
+// trace event format, which chrome://tracing and similar viewers load.
+void PassProfiler::writeTrace(raw_ostream &OS) {
+  OS << "{\"traceEvents\": [";
+  for (unsigned i = 0, e = Events.size(); i != e; ++i) {
+    const PassEvent &E = Events[i];
+    OS << (i ? ",\n" : "\n") << "  {\"name\": ";
+    writeJSONString(OS, Names[E.Pass]);
+    OS << ", \"cat\": \"" << E.Kind << "\", \"ph\": \"X\", \"pid\": 1, "
+       << "\"tid\": 1, \"ts\": " << format("%.3f", E.Start * 1000000.0)
+       << ", \"dur\": " << format("%.3f", E.Wall * 1000000.0)
+       << ", \"args\": {\"ir\": ";
+    writeJSONString(OS, Names[E.IRUnit]);
+    OS << ", \"peak_rss_delta\": " << E.PeakRSS
+       << ", \"malloc_delta\": " << E.Malloc
+       << ", \"bump_bytes\": " << E.SlabBytes
+       << ", \"inst_delta\": " << E.Insts << "}}";
+  }
+  OS << "\n], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+PassProfiler::~PassProfiler() {
+  const std::string *Files[] = { &PassProfileFile, &PassTraceFile };
+  for (unsigned i = 0; i != 2; ++i) {
+    if (Files[i]->empty())
+      continue;
+    std::string Error;
+    raw_fd_ostream OS(Files[i]->c_str(), Error);
+    if (!Error.empty()) {
+      errs() << "Error opening '" << *Files[i] << "': " << Error << "\n";
+      continue;
+    }
+    if (Files[i] == &PassProfileFile)
+      writeReport(OS);
+    else
+      writeTrace(OS);
+  }
+}
+
+/// PassProfileRun - What a PassProfileRegion needs to know when it ends.
+struct llvm::PassProfileRun {
+  const char *PassName;
+  const char *Kind;
+  std::string IRName;
+  Module *M;
+  Function *F;
+  BasicBlock *BB;
+  int64_t Insts;
+  ResourceUsage Start;
+
+  PassProfileRun(Pass *P, const char *kind, StringRef Name)
+    : PassName(P->getPassName()), Kind(kind), IRName(Name), M(0), F(0), BB(0),
+      Insts(0) {}
+
+  int64_t countInstructions() const {
+    int64_t Count = 0;
+    if (BB)
+      Count = BB->size();
+    if (F)
+      for (Function::iterator I = F->begin(), E = F->end(); I != E; ++I)
+        Count += I->size();
+    if (M)
+      for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI)
+        for (Function::iterator I = FI->begin(), E = FI->end(); I != E; ++I)
+          Count += I->size();
+    return Count;
+  }
+};
+
+/// shouldProfile - Return true if runs of P should be recorded.  The pass
+/// managers themselves are not, like with -time-passes.
+static bool shouldProfile(Pass *P) {
+  return ThePassProfiler && !P->getAsPMDataManager();
+}
+
+PassProfileRegion::PassProfileRegion(Pass *P, Module &M) : Run(0) {
+  if (!shouldProfile(P))
+    return;
+  Run = new PassProfileRun(P, "module", M.getModuleIdentifier());
+  Run->M = &M;
+  Run->Insts = Run->countInstructions();
+  Run->Start = ResourceUsage::getCurrent();
+}
+
+PassProfileRegion::PassProfileRegion(Pass *P, Function &F) : Run(0) {
+  if (!shouldProfile(P))
+    return;
+  Run = new PassProfileRun(P, "function", F.getName());
+  Run->F = &F;
+  Run->Insts = Run->countInstructions();
+  Run->Start = ResourceUsage::getCurrent();
+}
+
+PassProfileRegion::PassProfileRegion(Pass *P, BasicBlock &BB) : Run(0) {
+  if (!shouldProfile(P))
+    return;
+  // Basic block passes are added to the totals of their function.
+  Run = new PassProfileRun(P, "basicblock", BB.getParent()->getName());
+  Run->BB = &BB;
+  Run->Insts = Run->countInstructions();
+  Run->Start = ResourceUsage::getCurrent();
+}
+
+PassProfileRegion::PassProfileRegion(Pass *P, StringRef Name) : Run(0) {
+  if (!shouldProfile(P))
+    return;
+  Run = new PassProfileRun(P, "other", Name);
+  Run->Start = ResourceUsage::getCurrent();
+}
+
+PassProfileRegion::~PassProfileRegion() {
+  if (!Run)
+    return;
+  ResourceUsage End = ResourceUsage::getCurrent();
+
+  PassEvent E;
+  E.Kind = Run->Kind;
+  E.Start = Run->Start.Wall - ThePassProfiler->getOrigin();
+  E.Wall = End.Wall - Run->Start.Wall;
+  E.User = End.User - Run->Start.User;
+  E.System = End.System - Run->Start.System;
+  E.PeakRSS = int64_t(End.PeakRSS) - int64_t(Run->Start.PeakRSS);
+  E.Malloc = int64_t(End.Malloc) - int64_t(Run->Start.Malloc);
+  // The slab count wraps around at 32 bits.
+  E.SlabBytes = uint32_t(End.SlabBytes - Run->Start.SlabBytes);
+  E.Insts = Run->countInstructions() - Run->Insts;
+  ThePassProfiler->addEvent(E, Run->PassName, Run->IRName);
+  delete Run;
+}
+
 //===----------------------------------------------------------------------===//
 // PMStack implementation
 //
@@ -88,6 +88,7 @@ void Type::destroy() const {
     return;
   } else if (const OpaqueType *opaque_this = dyn_cast<OpaqueType>(this)) {
     LLVMContextImpl *pImpl = this->getContext().pImpl;
+    sys::SmartScopedLock<true> Lock(pImpl->Lock);
     pImpl->OpaqueTypes.erase(opaque_this);
   }
 
@@ -292,6 +293,7 @@ void Type::typeBecameConcrete(const DerivedType *AbsTy) {
 
 std::string Type::getDescription() const {
   LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   TypePrinting &Map =
     isAbstract() ?
       pImpl->AbstractTypeDescriptions :
@@ -798,12 +800,12 @@ const IntegerType *IntegerType::get(LLVMContext &C, unsigned NumBits) {
   }
 
   LLVMContextImpl *pImpl = C.pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   IntegerValType IVT(NumBits);
   IntegerType *ITy = 0;
   
-  // First, see if the type is already in the table, for which
-  // a reader lock suffices.
+  // First, see if the type is already in the table.
   ITy = pImpl->IntegerTypes.get(IVT);
     
   if (!ITy) {
@@ -844,6 +846,7 @@ FunctionType *FunctionType::get(const Type *ReturnType,
   FunctionType *FT = 0;
   
   LLVMContextImpl *pImpl = ReturnType->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   FT = pImpl->FunctionTypes.get(VT);
   
@@ -868,6 +871,7 @@ ArrayType *ArrayType::get(const Type *ElementType, uint64_t NumElements) {
   ArrayType *AT = 0;
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   AT = pImpl->ArrayTypes.get(AVT);
       
@@ -893,6 +897,7 @@ VectorType *VectorType::get(const Type *ElementType, unsigned NumElements) {
   VectorType *PT = 0;
   
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   PT = pImpl->VectorTypes.get(PVT);
     
@@ -921,6 +926,7 @@ StructType *StructType::get(LLVMContext &Context,
   StructType *ST = 0;
   
   LLVMContextImpl *pImpl = Context.pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   ST = pImpl->StructTypes.get(STV);
     
@@ -968,6 +974,7 @@ PointerType *PointerType::get(const Type *ValueType, unsigned AddressSpace) {
   PointerType *PT = 0;
   
   LLVMContextImpl *pImpl = ValueType->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   
   PT = pImpl->PointerTypes.get(PVT);
   
@@ -998,6 +1005,7 @@ bool PointerType::isValidElementType(const Type *ElemTy) {
 OpaqueType *OpaqueType::get(LLVMContext &C) {
   OpaqueType *OT = new OpaqueType(C);       // All opaque types are distinct.
   LLVMContextImpl *pImpl = C.pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   pImpl->OpaqueTypes.insert(OT);
   return OT;
 }
@@ -1012,6 +1020,7 @@ OpaqueType *OpaqueType::get(LLVMContext &C) {
 // it.  This function is called primarily by the PATypeHandle class.
 void Type::addAbstractTypeUser(AbstractTypeUser *U) const {
   assert(isAbstract() && "addAbstractTypeUser: Current type not abstract!");
+  sys::SmartScopedLock<true> Lock(getContext().pImpl->Lock);
   AbstractTypeUsers.push_back(U);
 }
 
@@ -1022,6 +1031,7 @@ void Type::addAbstractTypeUser(AbstractTypeUser *U) const {
 // is annihilated, because there is no way to get a reference to it ever again.
 //
 void Type::removeAbstractTypeUser(AbstractTypeUser *U) const {
+  sys::SmartScopedLock<true> Lock(getContext().pImpl->Lock);
   
   // Search from back to front because we will notify users from back to
   // front.  Also, it is likely that there will be a stack like behavior to
@@ -1063,6 +1073,7 @@ void DerivedType::refineAbstractTypeTo(const Type *NewType) {
   assert(ForwardType == 0 && "This type has already been refined!");
 
   LLVMContextImpl *pImpl = getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
 
   // The descriptions may be out of date.  Conservatively clear them all!
   pImpl->AbstractTypeDescriptions.clear();
@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Value.h"
+#include "LLVMContextImpl.h"
 
 namespace llvm {
 
@@ -23,25 +24,25 @@ void Use::swap(Use &RHS) {
   Value *V1(Val);
   Value *V2(RHS.Val);
   if (V1 != V2) {
-    if (V1) {
-      removeFromList();
-    }
+    set(V2);
+    RHS.set(V1);
+  }
+}
 
-    if (V2) {
-      RHS.removeFromList();
-      Val = V2;
-      V2->addUse(*this);
-    } else {
-      Val = 0;
-    }
+//===----------------------------------------------------------------------===//
+//                         Use set Implementation
+//===----------------------------------------------------------------------===//
 
-    if (V1) {
-      RHS.Val = V1;
-      V1->addUse(RHS);
-    } else {
-      RHS.Val = 0;
-    }
-  }
+Use::~Use() {
+  if (Val) set(0);
+}
+
+void Use::setShared(Value *V) {
+  LLVMContextImpl *pImpl = (Val ? Val : V)->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+  if (Val) removeFromList();
+  Val = V;
+  if (V) V->addUse(*this);
 }
 
 //===----------------------------------------------------------------------===//
@@ -452,6 +452,7 @@ void ValueHandleBase::AddToUseList() {
   assert(VP && "Null pointer doesn't have a use list!");
 
   LLVMContextImpl *pImpl = VP->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
 
   if (VP->HasValueHandle) {
     // If this value already has a ValueHandle, then it must be in the
@@ -490,10 +491,23 @@ void ValueHandleBase::AddToUseList() {
   }
 }
 
+/// AddToUseListBefore - Add this ValueHandle to the use list for VP, right
+/// before RHS.  The list is only read under the context lock, as the head of
+/// the list moves whenever another value gets its first handle.
+void ValueHandleBase::AddToUseListBefore(const ValueHandleBase &RHS) {
+  assert(VP && VP == RHS.VP && "RHS is not on the use list for VP!");
+
+  sys::SmartScopedLock<true> Lock(VP->getContext().pImpl->Lock);
+  AddToExistingUseList(RHS.getPrevPtr());
+}
+
 /// RemoveFromUseList - Remove this ValueHandle from its current use list.
 void ValueHandleBase::RemoveFromUseList() {
   assert(VP && VP->HasValueHandle && "Pointer doesn't have a use list!");
 
+  LLVMContextImpl *pImpl = VP->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
+
   // Unlink this from its use list.
   ValueHandleBase **PrevPtr = getPrevPtr();
   assert(*PrevPtr == this && "List invariant broken");
@@ -508,7 +522,6 @@ void ValueHandleBase::RemoveFromUseList() {
   // If the Next pointer was null, then it is possible that this was the last
   // ValueHandle watching VP.  If so, delete its entry from the ValueHandles
   // map.
-  LLVMContextImpl *pImpl = VP->getContext().pImpl;
   DenseMap<Value*, ValueHandleBase*> &Handles = pImpl->ValueHandles;
   if (Handles.isPointerIntoBucketsArray(PrevPtr)) {
     Handles.erase(VP);
@@ -523,6 +536,7 @@ void ValueHandleBase::ValueIsDeleted(Value *V) {
   // Get the linked list base, which is guaranteed to exist since the
   // HasValueHandle flag is set.
   LLVMContextImpl *pImpl = V->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   ValueHandleBase *Entry = pImpl->ValueHandles[V];
   assert(Entry && "Value bit set but no entries exist");
 
@@ -581,6 +595,7 @@ void ValueHandleBase::ValueIsRAUWd(Value *Old, Value *New) {
   // Get the linked list base, which is guaranteed to exist since the
   // HasValueHandle flag is set.
   LLVMContextImpl *pImpl = Old->getContext().pImpl;
+  sys::SmartScopedLock<true> Lock(pImpl->Lock);
   ValueHandleBase *Entry = pImpl->ValueHandles[Old];
 
   assert(Entry && "Value bit set but no entries exist");
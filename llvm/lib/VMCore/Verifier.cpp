@@ -76,6 +76,10 @@ namespace {  // Anonymous namespace for class
       initializePreVerifierPass(*PassRegistry::getPassRegistry());
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new PreVerifier();
+    }
+
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.setPreservesAll();
     }
@@ -228,6 +232,10 @@ namespace {
       return false;
     }
 
+    virtual FunctionPass *createParallelClone() const {
+      return new Verifier(action);
+    }
+
     bool doFinalization(Module &M) {
       // Scan through, checking all of the external function's linkage now...
       for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I) {
@@ -1697,6 +1705,19 @@ void Verifier::visitIntrinsicFunctionCall(Intrinsic::ID ID, CallInst &CI) {
     Assert1(isa<ConstantInt>(CI.getArgOperand(1)),
             "llvm.invariant.end parameter #2 must be a constant integer", &CI);
     break;
+  case Intrinsic::sadd_sat:
+  case Intrinsic::ssub_sat:
+  case Intrinsic::smul_fix_sat:
+    Assert1(CI.getType()->isIntegerTy(),
+            "saturation intrinsics do not support vector types", &CI);
+    if (ID == Intrinsic::smul_fix_sat) {
+      ConstantInt *Scale = dyn_cast<ConstantInt>(CI.getArgOperand(2));
+      Assert1(Scale &&
+              Scale->getValue().ult(CI.getType()->getPrimitiveSizeInBits()),
+              "llvm.smul.fix.sat parameter #3 must be a constant integer "
+              "smaller than the bit width", &CI);
+    }
+    break;
   }
 }
 
@@ -0,0 +1,32 @@
+; Test that llvm-ar writes a hashed symbol index and that llvm-ld uses it to
+; load only the members that define undefined symbols.
+; RUN: rm -f %t.a
+; RUN: llvm-as %s -o %t.main.bc
+; RUN: echo {define i32 @foo() \{ ret i32 1 \} @gv = global i32 3} \
+; RUN:   | llvm-as -o %t.foo.bc
+; RUN: echo {define i32 @bar() \{ %r = call i32 @foo() ret i32 %r \} \
+; RUN:   declare i32 @foo()} | llvm-as -o %t.bar.bc
+; RUN: echo {define i32 @unused() \{ ret i32 0 \}} | llvm-as -o %t.unused.bc
+; RUN: llvm-ar rcs %t.a %t.foo.bc %t.bar.bc %t.unused.bc
+; RUN: grep -c _LLVM_SYM_IDX_ %t.a | grep 1
+; RUN: llvm-ar tV %t.a | FileCheck %s -check-prefix=TOC
+; RUN: llvm-ld -disable-opt %t.main.bc %t.a -o %t
+; RUN: llvm-dis %t.bc -o - | FileCheck %s
+
+; TOC: Archive Symbol Table:
+; TOC-NEXT: bar
+; TOC-NEXT: foo
+; TOC-NEXT: gv
+; TOC-NEXT: unused
+
+; CHECK: define i32 @main()
+; CHECK: define i32 @bar()
+; CHECK: define i32 @foo()
+; CHECK-NOT: @unused
+
+declare i32 @bar()
+
+define i32 @main() {
+  %r = call i32 @bar()
+  ret i32 %r
+}
@@ -0,0 +1,142 @@
+; RUN: llvm-as < %s | llvm-dis -bitcode-reader-threads=4 | FileCheck %s
+; RUN: llvm-as < %s | llvm-dis | FileCheck %s
+; RUN: llvm-dis -bitcode-reader-threads=4 < %S/AutoUpgradeIntrinsics.ll.bc \
+; RUN:   | FileCheck %s -check-prefix=UPGRADE
+
+; Reading the function bodies on several threads gives the same module as
+; reading them one after the other.
+
+; Calls to old intrinsics are upgraded once all the bodies are read.
+; UPGRADE: define i32 @test_ct(i32 %A)
+; UPGRADE-NEXT: call i28 @llvm.ctpop.i28(i28 1234)
+; UPGRADE-NOT: call i32 @llvm.ct
+
+%struct.opaque = type opaque
+
+; CHECK: @targets = global [2 x i8*] [i8* blockaddress(@jump, %a), i8* blockaddress(@jump, %b)]
+@targets = global [2 x i8*] [i8* blockaddress(@jump, %a), i8* blockaddress(@jump, %b)]
+
+; The body of @first is read before the workers start, for this initializer.
+; The block address in @second is then left to the parallel reader, and no
+; placeholder for it is left behind.
+; CHECK: @early = global i8* blockaddress(@first, %one)
+; CHECK-NOT: internal global i8
+@early = global i8* blockaddress(@first, %one)
+
+; CHECK: define i32 @jump(i8* %p)
+; CHECK-NEXT: entry:
+; CHECK-NEXT: indirectbr i8* %p, [label %a, label %b]
+; CHECK: a:
+; CHECK-NEXT: ret i32 1
+; CHECK: b:
+; CHECK-NEXT: ret i32 2
+define i32 @jump(i8* %p) nounwind {
+entry:
+  indirectbr i8* %p, [label %a, label %b]
+
+a:
+  ret i32 1
+
+b:
+  ret i32 2
+}
+
+; CHECK: define i32 @self()
+; CHECK-NEXT: entry:
+; CHECK-NEXT: br label %loop
+; CHECK: loop:
+; CHECK-NEXT: %p = phi i8* [ blockaddress(@self, %loop), %entry ], [ blockaddress(@self, %done), %loop ]
+; CHECK-NEXT: indirectbr i8* %p, [label %loop, label %done]
+define i32 @self() nounwind {
+entry:
+  br label %loop
+
+loop:
+  %p = phi i8* [ blockaddress(@self, %loop), %entry ], [ blockaddress(@self, %done), %loop ]
+  indirectbr i8* %p, [label %loop, label %done]
+
+done:
+  ret i32 0
+}
+
+; CHECK: define i32 @other()
+; CHECK-NEXT: %r = call i32 @jump(i8* blockaddress(@jump, %b))
+; CHECK-NEXT: ret i32 %r
+define i32 @other() nounwind {
+  %r = call i32 @jump(i8* blockaddress(@jump, %b))
+  ret i32 %r
+}
+
+; CHECK: define i32 @first(i8* %p)
+; CHECK-NEXT: entry:
+; CHECK-NEXT: indirectbr i8* %p, [label %one, label %two]
+define i32 @first(i8* %p) nounwind {
+entry:
+  indirectbr i8* %p, [label %one, label %two]
+
+one:
+  ret i32 1
+
+two:
+  ret i32 2
+}
+
+; CHECK: define i8* @second()
+; CHECK-NEXT: ret i8* blockaddress(@first, %two)
+define i8* @second() nounwind {
+  ret i8* blockaddress(@first, %two)
+}
+
+; The body of @self is read before this one, if there is only one thread.
+; CHECK: define i8* @later()
+; CHECK-NEXT: ret i8* blockaddress(@self, %done)
+define i8* @later() nounwind {
+  ret i8* blockaddress(@self, %done)
+}
+
+; CHECK: define void @opaque(%struct.opaque* %p)
+; CHECK-NEXT: call void @take(%struct.opaque* %p)
+; CHECK-NEXT: call void @take(%struct.opaque* %p)
+define void @opaque(%struct.opaque* %p) nounwind {
+  call void @take(%struct.opaque* %p)
+  call void @take(%struct.opaque* %p)
+  ret void
+}
+
+; CHECK: define void @take(%struct.opaque* %p)
+; CHECK-NEXT: %q = bitcast %struct.opaque* %p to i32*
+; CHECK-NEXT: store i32 0, i32* %q, !note !0
+define void @take(%struct.opaque* %p) nounwind {
+  %q = bitcast %struct.opaque* %p to i32*
+  store i32 0, i32* %q, !note !0
+  ret void
+}
+
+; CHECK: define i32 @local(i32 %x)
+; CHECK-NEXT: %y = add i32 %x, 1, !note !{i32 %x}
+define i32 @local(i32 %x) nounwind {
+  %y = add i32 %x, 1, !note !{i32 %x}
+  ret i32 %y
+}
+
+; CHECK: define i32 @loop(i32 %n)
+; CHECK: %s1 = add i32 %s, %i
+; CHECK: ret i32 %s1
+define i32 @loop(i32 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  %s1 = add i32 %s, %i
+  %i1 = add i32 %i, 1
+  %c = icmp eq i32 %i1, %n
+  br i1 %c, label %exit, label %loop
+
+exit:
+  ret i32 %s1
+}
+
+; CHECK: !0 = metadata !{metadata !"stored"}
+!0 = metadata !{metadata !"stored"}
@@ -0,0 +1,49 @@
+; RUN: llvm-as < %s | llvm-bcanalyzer -dump |& FileCheck %s
+; RUN: llvm-as < %s | llvm-dis | FileCheck %s -check-prefix=DIS
+; RUN: llvm-as < %s > %t
+; RUN: llvm-nm %t | FileCheck %s -check-prefix=NM
+
+; Every function with a body gets a summary record:
+; [valueid, numblocks, numinsts, numcalls, callees..., refs...]
+
+@g = global i32 0
+@table = global [1 x void ()*] [void ()* @leaf]
+@ext = external global i32
+@alias = alias void ()* @leaf
+
+declare i32 @extfn(i32)
+
+; CHECK: <SUMMARY_BLOCK
+; leaf: one block, one instruction, nothing used.
+; CHECK: <FUNCTION op0=[[LEAF:[0-9]+]] op1=1 op2=1 op3=0/>
+define void @leaf() nounwind {
+  ret void
+}
+
+; caller: two calls (once through a bitcast), a load of @ext and a store to
+; @g through a constant expression.
+; CHECK: <FUNCTION op0={{[0-9]+}} op1=2 op2=6 op3=2 op4={{[0-9]+}} op5=[[LEAF]] op6={{[0-9]+}} op7={{[0-9]+}}/>
+define i32 @caller(i32 %x) nounwind {
+entry:
+  %r = call i32 @extfn(i32 %x)
+  call void bitcast (void ()* @leaf to void (i32)*)(i32 %r)
+  br label %exit
+
+exit:
+  %v = load i32* @ext
+  store i32 %v, i32* getelementptr (i32* @g, i32 0)
+  ret i32 %v
+}
+; CHECK: </SUMMARY_BLOCK>
+
+; The summary does not change the module that is read back.
+; DIS: define void @leaf()
+; DIS: define i32 @caller(i32 %x)
+
+; llvm-nm does not read the bodies, the functions are defined all the same.
+; NM: T alias
+; NM: T caller
+; NM: U ext
+; NM: U extfn
+; NM: D g
+; NM: T leaf
@@ -0,0 +1,136 @@
+; RUN: llc < %s -march=mdsp -filetype=obj -o %t.o
+; RUN: mdsp-sim %t.o | FileCheck %s
+
+; A 16 point radix-2 Q15 FFT that halves the data after every stage.
+; CHECK: return: -1401550912
+
+@cos = internal constant [8 x i32] [i32 32767, i32 30273, i32 23170,
+                                    i32 12539, i32 0, i32 -12539, i32 -23170,
+                                    i32 -30273]
+@sin = internal constant [8 x i32] [i32 0, i32 12539, i32 23170, i32 30273,
+                                    i32 32767, i32 30273, i32 23170,
+                                    i32 12539]
+@re = internal global [16 x i32] zeroinitializer
+@im = internal global [16 x i32] zeroinitializer
+
+define void @fft(i32* noalias %re, i32* noalias %im, i32 %n) nounwind {
+entry:
+  %step0 = lshr i32 %n, 1
+  %c = icmp ugt i32 %n, 1
+  br i1 %c, label %stage, label %exit
+
+stage:
+  %len = phi i32 [ 2, %entry ], [ %len1, %stage.end ]
+  %step = phi i32 [ %step0, %entry ], [ %step1, %stage.end ]
+  %half = lshr i32 %len, 1
+  br label %group
+
+group:
+  %i = phi i32 [ 0, %stage ], [ %i1, %group.end ]
+  br label %bfly
+
+bfly:
+  %j = phi i32 [ 0, %group ], [ %j1, %bfly ]
+  %w = mul i32 %j, %step
+  %pwr = getelementptr [8 x i32]* @cos, i32 0, i32 %w
+  %pwi = getelementptr [8 x i32]* @sin, i32 0, i32 %w
+  %wr = load i32* %pwr
+  %wi = load i32* %pwi
+  %a = add i32 %i, %j
+  %b = add i32 %a, %half
+  %pra = getelementptr i32* %re, i32 %a
+  %pia = getelementptr i32* %im, i32 %a
+  %prb = getelementptr i32* %re, i32 %b
+  %pib = getelementptr i32* %im, i32 %b
+  %ra = load i32* %pra
+  %ia = load i32* %pia
+  %rb = load i32* %prb
+  %ib = load i32* %pib
+  %t0 = mul i32 %rb, %wr
+  %t1 = mul i32 %ib, %wi
+  %t2 = add i32 %t0, %t1
+  %tr = ashr i32 %t2, 15
+  %t3 = mul i32 %ib, %wr
+  %t4 = mul i32 %rb, %wi
+  %t5 = sub i32 %t3, %t4
+  %ti = ashr i32 %t5, 15
+  %sr = add i32 %ra, %tr
+  %si = add i32 %ia, %ti
+  %dr = sub i32 %ra, %tr
+  %di = sub i32 %ia, %ti
+  %sr1 = ashr i32 %sr, 1
+  %si1 = ashr i32 %si, 1
+  %dr1 = ashr i32 %dr, 1
+  %di1 = ashr i32 %di, 1
+  store i32 %sr1, i32* %pra
+  store i32 %si1, i32* %pia
+  store i32 %dr1, i32* %prb
+  store i32 %di1, i32* %pib
+  %j1 = add i32 %j, 1
+  %jd = icmp eq i32 %j1, %half
+  br i1 %jd, label %group.end, label %bfly
+
+group.end:
+  %i1 = add i32 %i, %len
+  %id = icmp ult i32 %i1, %n
+  br i1 %id, label %group, label %stage.end
+
+stage.end:
+  %len1 = shl i32 %len, 1
+  %step1 = lshr i32 %step, 1
+  %ld = icmp ugt i32 %len1, %n
+  br i1 %ld, label %exit, label %stage
+
+exit:
+  ret void
+}
+
+define i32 @main() nounwind {
+entry:
+  br label %fill
+
+fill:
+  %i = phi i32 [ 0, %entry ], [ %i1, %fill ]
+  %s = phi i32 [ 7, %entry ], [ %s2, %fill ]
+  %m0 = mul i32 %s, 1103515245
+  %s1 = add i32 %m0, 12345
+  %r0 = lshr i32 %s1, 16
+  %v0 = and i32 %r0, 16383
+  %x0 = sub i32 %v0, 8192
+  %m1 = mul i32 %s1, 1103515245
+  %s2 = add i32 %m1, 12345
+  %r1 = lshr i32 %s2, 16
+  %v1 = and i32 %r1, 16383
+  %x1 = sub i32 %v1, 8192
+  %pr = getelementptr [16 x i32]* @re, i32 0, i32 %i
+  %pi = getelementptr [16 x i32]* @im, i32 0, i32 %i
+  store i32 %x0, i32* %pr
+  store i32 %x1, i32* %pi
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, 16
+  br i1 %d, label %run, label %fill
+
+run:
+  %pre = getelementptr [16 x i32]* @re, i32 0, i32 0
+  %pim = getelementptr [16 x i32]* @im, i32 0, i32 0
+  call void @fft(i32* %pre, i32* %pim, i32 16)
+  br label %sum
+
+sum:
+  %j = phi i32 [ 0, %run ], [ %j1, %sum ]
+  %a = phi i32 [ 0, %run ], [ %a3, %sum ]
+  %qr = getelementptr [16 x i32]* @re, i32 0, i32 %j
+  %qi = getelementptr [16 x i32]* @im, i32 0, i32 %j
+  %vr = load i32* %qr
+  %vi = load i32* %qi
+  %a0 = mul i32 %a, 31
+  %a1 = add i32 %a0, %vr
+  %a2 = mul i32 %a1, 31
+  %a3 = add i32 %a2, %vi
+  %j1 = add i32 %j, 1
+  %f = icmp eq i32 %j1, 16
+  br i1 %f, label %done, label %sum
+
+done:
+  ret i32 %a3
+}
@@ -0,0 +1,95 @@
+; RUN: llc < %s -march=mdsp -filetype=obj -o %t.o
+; RUN: mdsp-sim %t.o | FileCheck %s
+
+; A 16 tap Q15 low pass filter over 64 samples.
+; CHECK: return: 245504246
+
+@h = internal constant [16 x i16] [i16 -38, i16 -159, i16 -365, i16 -317,
+                                   i16 602, i16 2665, i16 5262, i16 7096,
+                                   i16 7096, i16 5262, i16 2665, i16 602,
+                                   i16 -317, i16 -365, i16 -159, i16 -38]
+@x = internal global [79 x i16] zeroinitializer
+@y = internal global [64 x i16] zeroinitializer
+
+define void @fir(i16* noalias %x, i16* noalias %h, i16* noalias %y, i32 %n,
+                 i32 %taps) nounwind {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %outer, label %exit
+
+outer:
+  %i = phi i32 [ 0, %entry ], [ %i1, %store ]
+  %xi = getelementptr i16* %x, i32 %i
+  %c1 = icmp sgt i32 %taps, 0
+  br i1 %c1, label %inner, label %store
+
+inner:
+  %k = phi i32 [ 0, %outer ], [ %k1, %inner ]
+  %acc = phi i32 [ 0, %outer ], [ %acc1, %inner ]
+  %px = getelementptr i16* %xi, i32 %k
+  %ph = getelementptr i16* %h, i32 %k
+  %vx = load i16* %px
+  %vh = load i16* %ph
+  %ex = sext i16 %vx to i32
+  %eh = sext i16 %vh to i32
+  %m = mul i32 %ex, %eh
+  %acc1 = add i32 %acc, %m
+  %k1 = add i32 %k, 1
+  %d = icmp eq i32 %k1, %taps
+  br i1 %d, label %store, label %inner
+
+store:
+  %sum = phi i32 [ 0, %outer ], [ %acc1, %inner ]
+  %q = ashr i32 %sum, 15
+  %t = trunc i32 %q to i16
+  %py = getelementptr i16* %y, i32 %i
+  store i16 %t, i16* %py
+  %i1 = add i32 %i, 1
+  %e = icmp eq i32 %i1, %n
+  br i1 %e, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+define i32 @main() nounwind {
+entry:
+  br label %fill
+
+fill:
+  %i = phi i32 [ 0, %entry ], [ %i1, %fill ]
+  %s = phi i32 [ 1, %entry ], [ %s1, %fill ]
+  %m = mul i32 %s, 1103515245
+  %s1 = add i32 %m, 12345
+  %r = lshr i32 %s1, 16
+  %v = and i32 %r, 32767
+  %v1 = sub i32 %v, 16384
+  %t = trunc i32 %v1 to i16
+  %p = getelementptr [79 x i16]* @x, i32 0, i32 %i
+  store i16 %t, i16* %p
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, 79
+  br i1 %d, label %run, label %fill
+
+run:
+  %px = getelementptr [79 x i16]* @x, i32 0, i32 0
+  %ph = getelementptr [16 x i16]* @h, i32 0, i32 0
+  %py = getelementptr [64 x i16]* @y, i32 0, i32 0
+  call void @fir(i16* %px, i16* %ph, i16* %py, i32 64, i32 16)
+  br label %sum
+
+sum:
+  %j = phi i32 [ 0, %run ], [ %j1, %sum ]
+  %a = phi i32 [ 0, %run ], [ %a1, %sum ]
+  %q = getelementptr [64 x i16]* @y, i32 0, i32 %j
+  %w = load i16* %q
+  %e = sext i16 %w to i32
+  %a31 = mul i32 %a, 31
+  %a1 = add i32 %a31, %e
+  %j1 = add i32 %j, 1
+  %f = icmp eq i32 %j1, 64
+  br i1 %f, label %done, label %sum
+
+done:
+  ret i32 %a1
+}
@@ -0,0 +1,166 @@
+; RUN: llc < %s -march=mdsp -filetype=obj -o %t.o
+; RUN: mdsp-sim %t.o | FileCheck %s
+
+; Hard decision Viterbi decoding of 32 soft symbol pairs for the rate 1/2,
+; constraint length 3 code with generators 7 and 5.
+; CHECK: return: -1739179570
+
+; The two code bits for shift register contents (input << 2) | state.
+@outbits = internal constant [8 x i32] [i32 0, i32 3, i32 2, i32 1, i32 3,
+                                        i32 0, i32 1, i32 2]
+@soft = internal global [64 x i32] zeroinitializer
+@pm = internal global [4 x i32] [i32 0, i32 64, i32 64, i32 64]
+@npm = internal global [4 x i32] zeroinitializer
+@dec = internal global [128 x i32] zeroinitializer
+
+define i32 @viterbi(i32* noalias %soft, i32* noalias %pm, i32* noalias %npm,
+                    i32* noalias %dec, i32 %steps) nounwind {
+entry:
+  %c = icmp sgt i32 %steps, 0
+  br i1 %c, label %step, label %best
+
+step:
+  %t = phi i32 [ 0, %entry ], [ %t1, %copy ]
+  %t2 = shl i32 %t, 1
+  %ps0 = getelementptr i32* %soft, i32 %t2
+  %ps1 = getelementptr i32* %ps0, i32 1
+  %s0 = load i32* %ps0
+  %s1 = load i32* %ps1
+  %n0 = sub i32 15, %s0
+  %n1 = sub i32 15, %s1
+  %row = shl i32 %t, 2
+  %drow = getelementptr i32* %dec, i32 %row
+  br label %acs
+
+; Add, compare and select for each of the four states.
+acs:
+  %ns = phi i32 [ 0, %step ], [ %ns1, %acs ]
+  %u = and i32 %ns, 1
+  %p0 = lshr i32 %ns, 1
+  %p1 = or i32 %p0, 2
+  %ub = shl i32 %u, 2
+  %r0 = or i32 %ub, %p0
+  %r1 = or i32 %ub, %p1
+  %po0 = getelementptr [8 x i32]* @outbits, i32 0, i32 %r0
+  %po1 = getelementptr [8 x i32]* @outbits, i32 0, i32 %r1
+  %o0 = load i32* %po0
+  %o1 = load i32* %po1
+  %h0 = and i32 %o0, 2
+  %hb0 = icmp ne i32 %h0, 0
+  %x0 = select i1 %hb0, i32 %n0, i32 %s0
+  %l0 = and i32 %o0, 1
+  %lb0 = icmp ne i32 %l0, 0
+  %y0 = select i1 %lb0, i32 %n1, i32 %s1
+  %bm0 = add i32 %x0, %y0
+  %h1 = and i32 %o1, 2
+  %hb1 = icmp ne i32 %h1, 0
+  %x1 = select i1 %hb1, i32 %n0, i32 %s0
+  %l1 = and i32 %o1, 1
+  %lb1 = icmp ne i32 %l1, 0
+  %y1 = select i1 %lb1, i32 %n1, i32 %s1
+  %bm1 = add i32 %x1, %y1
+  %pp0 = getelementptr i32* %pm, i32 %p0
+  %pp1 = getelementptr i32* %pm, i32 %p1
+  %q0 = load i32* %pp0
+  %q1 = load i32* %pp1
+  %m0 = add i32 %q0, %bm0
+  %m1 = add i32 %q1, %bm1
+  %sel = icmp slt i32 %m1, %m0
+  %m = select i1 %sel, i32 %m1, i32 %m0
+  %pn = getelementptr i32* %npm, i32 %ns
+  store i32 %m, i32* %pn
+  %dv = zext i1 %sel to i32
+  %pd = getelementptr i32* %drow, i32 %ns
+  store i32 %dv, i32* %pd
+  %ns1 = add i32 %ns, 1
+  %acsd = icmp eq i32 %ns1, 4
+  br i1 %acsd, label %copy, label %acs
+
+copy:
+  %pn0 = getelementptr i32* %npm, i32 0
+  %pn1 = getelementptr i32* %npm, i32 1
+  %pn2 = getelementptr i32* %npm, i32 2
+  %pn3 = getelementptr i32* %npm, i32 3
+  %v0 = load i32* %pn0
+  %v1 = load i32* %pn1
+  %v2 = load i32* %pn2
+  %v3 = load i32* %pn3
+  %pm1 = getelementptr i32* %pm, i32 1
+  %pm2 = getelementptr i32* %pm, i32 2
+  %pm3 = getelementptr i32* %pm, i32 3
+  store i32 %v0, i32* %pm
+  store i32 %v1, i32* %pm1
+  store i32 %v2, i32* %pm2
+  store i32 %v3, i32* %pm3
+  %t1 = add i32 %t, 1
+  %td = icmp eq i32 %t1, %steps
+  br i1 %td, label %best, label %step
+
+; Trace back from the state with the smallest path metric.
+best:
+  %k = phi i32 [ 0, %entry ], [ %k1, %best ], [ 0, %copy ]
+  %min = phi i32 [ 2147483647, %entry ], [ %min1, %best ],
+                 [ 2147483647, %copy ]
+  %bs = phi i32 [ 0, %entry ], [ %bs1, %best ], [ 0, %copy ]
+  %pk = getelementptr i32* %pm, i32 %k
+  %vk = load i32* %pk
+  %lt = icmp slt i32 %vk, %min
+  %min1 = select i1 %lt, i32 %vk, i32 %min
+  %bs1 = select i1 %lt, i32 %k, i32 %bs
+  %k1 = add i32 %k, 1
+  %kd = icmp eq i32 %k1, 4
+  br i1 %kd, label %trace.start, label %best
+
+trace.start:
+  br i1 %c, label %trace, label %done
+
+trace:
+  %tt = phi i32 [ %steps, %trace.start ], [ %tt1, %trace ]
+  %st = phi i32 [ %bs1, %trace.start ], [ %prev, %trace ]
+  %bits = phi i32 [ 0, %trace.start ], [ %bits1, %trace ]
+  %tt1 = add i32 %tt, -1
+  %bit = and i32 %st, 1
+  %bsh = shl i32 %bits, 1
+  %bits1 = or i32 %bsh, %bit
+  %trow = shl i32 %tt1, 2
+  %ti = add i32 %trow, %st
+  %ptd = getelementptr i32* %dec, i32 %ti
+  %d = load i32* %ptd
+  %hi = lshr i32 %st, 1
+  %dh = shl i32 %d, 1
+  %prev = or i32 %hi, %dh
+  %tdone = icmp eq i32 %tt1, 0
+  br i1 %tdone, label %done, label %trace
+
+done:
+  %out = phi i32 [ 0, %trace.start ], [ %bits1, %trace ]
+  %r = xor i32 %out, %min1
+  ret i32 %r
+}
+
+define i32 @main() nounwind {
+entry:
+  br label %fill
+
+fill:
+  %i = phi i32 [ 0, %entry ], [ %i1, %fill ]
+  %s = phi i32 [ 3, %entry ], [ %s1, %fill ]
+  %m = mul i32 %s, 1103515245
+  %s1 = add i32 %m, 12345
+  %r = lshr i32 %s1, 16
+  %v = and i32 %r, 15
+  %p = getelementptr [64 x i32]* @soft, i32 0, i32 %i
+  store i32 %v, i32* %p
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, 64
+  br i1 %d, label %run, label %fill
+
+run:
+  %ps = getelementptr [64 x i32]* @soft, i32 0, i32 0
+  %ppm = getelementptr [4 x i32]* @pm, i32 0, i32 0
+  %pnpm = getelementptr [4 x i32]* @npm, i32 0, i32 0
+  %pdec = getelementptr [128 x i32]* @dec, i32 0, i32 0
+  %res = call i32 @viterbi(i32* %ps, i32* %ppm, i32* %pnpm, i32* %pdec,
+                           i32 32)
+  ret i32 %res
+}
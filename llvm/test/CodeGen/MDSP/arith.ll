@@ -0,0 +1,86 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+
+define i32 @add(i32 %a, i32 %b) nounwind {
+; CHECK: add:
+; CHECK: add r1, r1, r2
+; CHECK-NEXT: ret
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+define i32 @addi(i32 %a) nounwind {
+; CHECK: addi:
+; CHECK: addi r1, r1, -42
+  %r = add i32 %a, -42
+  ret i32 %r
+}
+
+define i32 @andi(i32 %a) nounwind {
+; CHECK: andi:
+; CHECK: andi r1, r1, 65535
+  %r = and i32 %a, 65535
+  ret i32 %r
+}
+
+define i32 @shifts(i32 %a, i32 %b) nounwind {
+; CHECK: shifts:
+; CHECK: srai r1, r1, 3
+; CHECK: shl r1, r1, r2
+  %s = ashr i32 %a, 3
+  %r = shl i32 %s, %b
+  ret i32 %r
+}
+
+define i32 @big() nounwind {
+; CHECK: big:
+; CHECK: movhi r1, 4660
+; CHECK-NEXT: ori r1, r1, 22136
+  ret i32 305419896
+}
+
+define i32 @sext(i32 %a) nounwind {
+; CHECK: sext:
+; CHECK: sexth r1, r1
+  %t = trunc i32 %a to i16
+  %r = sext i16 %t to i32
+  ret i32 %r
+}
+
+define i32 @slt(i32 %a, i32 %b) nounwind {
+; CHECK: slt:
+; CHECK: slt r1, r1, r2
+  %c = icmp slt i32 %a, %b
+  %r = zext i1 %c to i32
+  ret i32 %r
+}
+
+define i32 @smax(i32 %a, i32 %b) nounwind {
+; CHECK: smax:
+; CHECK: max r1, r1, r2
+  %c = icmp sgt i32 %a, %b
+  %r = select i1 %c, i32 %a, i32 %b
+  ret i32 %r
+}
+
+define i32 @umin(i32 %a, i32 %b) nounwind {
+; CHECK: umin:
+; CHECK: minu r1, r1, r2
+  %c = icmp ult i32 %a, %b
+  %r = select i1 %c, i32 %a, i32 %b
+  ret i32 %r
+}
+
+define i32 @sel(i32 %c, i32 %a, i32 %b) nounwind {
+; CHECK: sel:
+; CHECK: sel r1, r1, r2, r3
+  %t = icmp ne i32 %c, 0
+  %r = select i1 %t, i32 %a, i32 %b
+  ret i32 %r
+}
+
+define i32 @div(i32 %a, i32 %b) nounwind {
+; CHECK: div:
+; CHECK: call __divsi3
+  %r = sdiv i32 %a, %b
+  ret i32 %r
+}
@@ -0,0 +1,66 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+
+declare void @foo()
+
+define void @beq(i32 %a, i32 %b) nounwind {
+; CHECK: beq:
+; CHECK: bne r1, r2, .LBB0_2
+entry:
+  %c = icmp eq i32 %a, %b
+  br i1 %c, label %then, label %exit
+then:
+  call void @foo()
+  br label %exit
+exit:
+  ret void
+}
+
+define void @bltz(i32 %a) nounwind {
+; CHECK: bltz:
+; CHECK: bge r1, r0, .LBB1_2
+entry:
+  %c = icmp slt i32 %a, 0
+  br i1 %c, label %then, label %exit
+then:
+  call void @foo()
+  br label %exit
+exit:
+  ret void
+}
+
+define void @bgtu(i32 %a, i32 %b) nounwind {
+; CHECK: bgtu:
+; CHECK: bgeu r2, r1, .LBB2_2
+entry:
+  %c = icmp ugt i32 %a, %b
+  br i1 %c, label %then, label %exit
+then:
+  call void @foo()
+  br label %exit
+exit:
+  ret void
+}
+
+define i32 @jumptable(i32 %a) nounwind {
+; CHECK: jumptable:
+; CHECK: movhi r{{[0-9]+}}, %hi(.LJTI3_0)
+; CHECK: jr r
+entry:
+  switch i32 %a, label %d [ i32 0, label %a0
+                            i32 1, label %a1
+                            i32 2, label %a2
+                            i32 3, label %a3
+                            i32 4, label %a4 ]
+a0:
+  ret i32 10
+a1:
+  ret i32 11
+a2:
+  ret i32 17
+a3:
+  ret i32 19
+a4:
+  ret i32 23
+d:
+  ret i32 0
+}
@@ -0,0 +1,56 @@
+; RUN: llc < %s -march=mdsp -disable-mdsp-packetizer | FileCheck %s
+
+declare i32 @callee(i32, i32)
+declare void @use(i32*)
+
+; Leaf functions neither touch the stack nor save the link register.
+define i32 @leaf(i32 %a) nounwind {
+; CHECK: leaf:
+; CHECK-NOT: r29
+; CHECK: ret
+  %r = add i32 %a, 1
+  ret i32 %r
+}
+
+define i32 @caller(i32 %a) nounwind {
+; CHECK: caller:
+; CHECK: addi r29, r29, -8
+; CHECK-NEXT: stw r31, 4(r29)
+; CHECK: addi r2, r0, 7
+; CHECK-NEXT: call callee
+; CHECK: ldw r31, 4(r29)
+; CHECK-NEXT: addi r29, r29, 8
+; CHECK-NEXT: ret
+  %r = call i32 @callee(i32 %a, i32 7)
+  ret i32 %r
+}
+
+; The fifth and sixth arguments are passed on the stack.
+define i32 @stackargs(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f) nounwind {
+; CHECK: stackargs:
+; CHECK: ldw r2, 4(r29)
+; CHECK-NEXT: add r1, r1, r2
+  %r = add i32 %a, %f
+  ret i32 %r
+}
+
+; Dynamic allocas need a frame pointer; the stack pointer is rebuilt from it
+; before the callee-saved registers are reloaded.
+define void @dynalloca(i32 %n) nounwind {
+; CHECK: dynalloca:
+; CHECK: stw r28,
+; CHECK: addi r28, r29, [[SIZE:[0-9]+]]
+; CHECK: call use
+; CHECK: addi r29, r28, -[[SIZE]]
+; CHECK: ldw r28,
+  %p = alloca i32, i32 %n
+  call void @use(i32* %p)
+  ret void
+}
+
+define i32 @indirect(i32 (i32, i32)* %f) nounwind {
+; CHECK: indirect:
+; CHECK: callr r
+  %r = call i32 %f(i32 1, i32 2)
+  ret i32 %r
+}
@@ -0,0 +1,139 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+; RUN: llc < %s -march=mdsp -mattr=-circ | FileCheck %s -check-prefix=NOCIRC
+
+; The read position walks the delay line without a division in the loop.
+define i32 @fir(i32* noalias %buf, i32* noalias %h, i32 %pos, i32 %n,
+                i32 %taps) nounwind {
+; CHECK: fir:
+; CHECK: Inner Loop Header
+; CHECK-NOT: __umodsi3
+; CHECK: endloop
+; NOCIRC: fir:
+; NOCIRC: Inner Loop Header
+; NOCIRC: __umodsi3
+entry:
+  %c = icmp sgt i32 %taps, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc1, %loop ]
+  %j = add i32 %pos, %i
+  %k = urem i32 %j, %n
+  %pb = getelementptr i32* %buf, i32 %k
+  %v = load i32* %pb
+  %ph = getelementptr i32* %h, i32 %i
+  %w = load i32* %ph
+  %m = mul i32 %v, %w
+  %acc1 = add i32 %acc, %m
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %taps
+  br i1 %d, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc1, %loop ]
+  ret i32 %r
+}
+
+; The tap five samples behind the write position wraps in the address unit.
+define void @delay(i16* noalias %buf, i16* noalias %x, i16* noalias %y,
+                   i32 %pos, i32 %len) nounwind {
+; CHECK: delay:
+; CHECK: Inner Loop Header
+; CHECK-NOT: __umodsi3
+; CHECK: addi [[LEN:r[0-9]+]], r0, 37
+; CHECK-NEXT: ldhuc {{r[0-9]+}}, (r1)[{{r[0-9]+}}%[[LEN]]]
+; CHECK: endloop
+; NOCIRC: delay:
+; NOCIRC-NOT: ldhuc
+; NOCIRC: ret
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %j = add i32 %pos, %i
+  %k = urem i32 %j, 37
+  %j5 = add i32 %j, 5
+  %k5 = urem i32 %j5, 37
+  %pr = getelementptr i16* %buf, i32 %k5
+  %old = load i16* %pr
+  %py = getelementptr i16* %y, i32 %i
+  store i16 %old, i16* %py
+  %px = getelementptr i16* %x, i32 %i
+  %in = load i16* %px
+  %pw = getelementptr i16* %buf, i32 %k
+  store i16 %in, i16* %pw
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %len
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; Buffer length in a register, with a store through the second tap.
+define void @push(i32* noalias %buf, i32* noalias %x, i32 %len,
+                  i32 %cnt) nounwind {
+; CHECK: push:
+; CHECK: Inner Loop Header
+; CHECK-NOT: __umodsi3
+; CHECK: stwc {{r[0-9]+}}, ({{r[0-9]+}})[{{r[0-9]+}}%{{r[0-9]+}}]
+; CHECK: endloop
+; NOCIRC: push:
+; NOCIRC-NOT: stwc
+; NOCIRC: ret
+entry:
+  %c = icmp sgt i32 %cnt, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %px = getelementptr i32* %x, i32 %i
+  %v = load i32* %px
+  %j = add i32 %i, 3
+  %k = urem i32 %j, %len
+  %j2 = add i32 %i, 7
+  %k2 = urem i32 %j2, %len
+  %pb = getelementptr i32* %buf, i32 %k
+  %pb2 = getelementptr i32* %buf, i32 %k2
+  %o = load i32* %pb
+  %s = add i32 %o, %v
+  store i32 %s, i32* %pb2
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %cnt
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; A count-down induction variable overflows as an unsigned addition in every
+; iteration, so the stride needs the carry correction.
+define i32 @down(i32* noalias %buf, i32 %len) nounwind {
+; CHECK: down:
+; CHECK: Inner Loop Header
+; CHECK-NOT: __umodsi3
+; CHECK: sel
+; CHECK: endloop
+; NOCIRC: down:
+; NOCIRC: Inner Loop Header
+; NOCIRC: __umodsi3
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 10, %entry ], [ %i1, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc1, %loop ]
+  %j = add i32 %i, 3
+  %k = urem i32 %j, %len
+  %pb = getelementptr i32* %buf, i32 %k
+  %v = load i32* %pb
+  %acc1 = add i32 %acc, %v
+  %i1 = add i32 %i, -1
+  %d = icmp eq i32 %i1, 0
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret i32 %acc1
+}
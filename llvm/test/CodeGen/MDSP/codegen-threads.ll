@@ -0,0 +1,35 @@
+; RUN: llc < %s -march=mdsp -o %t.s
+; RUN: llc < %s -march=mdsp -codegen-threads=4 -o %t.p.s
+; RUN: cmp %t.s %t.p.s
+
+; Parallel machine code generation gives the same output as a serial run.
+
+define i32 @sum(i32* %p, i32 %n) nounwind {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %a = getelementptr i32* %p, i32 %i
+  %v = load i32* %a
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, 1
+  %d = icmp slt i32 %i.next, %n
+  br i1 %d, label %body, label %exit
+
+exit:
+  ret i32 %s.next
+}
+
+define i32 @mac(i32 %a, i32 %b, i32 %c) nounwind {
+  %x = mul i32 %a, %b
+  %y = add i32 %x, %c
+  ret i32 %y
+}
+
+define i32 @caller(i32* %p) nounwind {
+  %a = call i32 @sum(i32* %p, i32 8)
+  %b = call i32 @mac(i32 %a, i32 %a, i32 3)
+  ret i32 %b
+}
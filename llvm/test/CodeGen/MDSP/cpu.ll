@@ -0,0 +1,51 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s -check-prefix=GENERIC
+; RUN: llc < %s -march=mdsp -mcpu=mdsp200 | FileCheck %s -check-prefix=GENERIC
+; RUN: llc < %s -march=mdsp -mcpu=mdsp100 | FileCheck %s -check-prefix=M100
+; RUN: llc < %s -march=mdsp -mcpu=mdsp300 | FileCheck %s -check-prefix=M300
+; RUN: llc < %s -march=mdsp -mcpu=mdsp1000 |& FileCheck %s -check-prefix=UNKNOWN
+
+; UNKNOWN: 'mdsp1000' is not a recognized processor
+; UNKNOWN: loads:
+; UNKNOWN-NOT: ||
+; UNKNOWN: ret
+
+; The MDSP300 has a load/store unit per memory bank and two multipliers.
+define i32 @loads(i32* %p, i32* %q) nounwind {
+; GENERIC: loads:
+; GENERIC: ldw
+; GENERIC-NOT: ||{{.}}ldw
+; GENERIC: ret
+; M300: loads:
+; M300: ldw
+; M300-NEXT: ||{{.}}ldw
+  %a = load i32* %p
+  %b = load i32* %q
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+define i32 @muls(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+; GENERIC: muls:
+; GENERIC: mul r
+; GENERIC-NOT: ||{{.}}mul
+; GENERIC: ret
+; M300: muls:
+; M300: mul r
+; M300-NEXT: ||{{.}}mul
+  %x = mul i32 %a, %b
+  %y = mul i32 %c, %d
+  %r = xor i32 %x, %y
+  ret i32 %r
+}
+
+; The MDSP100 has no MAC instructions.
+define i32 @mac(i32 %acc, i32 %a, i32 %b) nounwind {
+; GENERIC: mac:
+; GENERIC: mac r1, r2, r3
+; M100: mac:
+; M100: mul r
+; M100: add
+  %m = mul i32 %a, %b
+  %r = add i32 %acc, %m
+  ret i32 %r
+}
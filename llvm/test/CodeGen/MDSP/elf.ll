@@ -0,0 +1,59 @@
+; RUN: llc < %s -march=mdsp -filetype=obj -o - | \
+; RUN:   elf-dump --dump-section-data | FileCheck %s
+
+; Packets of more than one instruction are preceded by a header word, branch
+; offsets count words, and addresses are left to the linker.
+
+; CHECK: 'e_machine', 0x00004d44
+
+; CHECK: '.text'
+; CHECK: '_section_data', '020000fc 01206300 00102100 02182100 00001fa8 020000fc 00002028 01004010 00002118 020000fc 00004160 00001fa8 f8ffbd13 0400fd63 000000a4 020000fc 0400fd43 0800bd13 00001fa8 0200228c 00102104 00001fa8'
+
+; CHECK: '.rela.text'
+; movhi r1, %hi(g)
+; CHECK: 'r_offset', 0x00000018
+; CHECK-NEXT: 'r_sym'
+; CHECK-NEXT: 'r_type', 0x00000005
+; ori r1, r1, %lo(g)
+; CHECK: 'r_offset', 0x00000020
+; CHECK-NEXT: 'r_sym'
+; CHECK-NEXT: 'r_type', 0x00000006
+; call ext
+; CHECK: 'r_offset', 0x00000038
+; CHECK-NEXT: 'r_sym'
+; CHECK-NEXT: 'r_type', 0x00000004
+
+@g = global i32 0
+
+declare void @ext()
+
+define i32 @pair(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+  %x = add i32 %a, %b
+  %y = sub i32 %c, %d
+  %z = and i32 %x, %y
+  ret i32 %z
+}
+
+define void @addr() nounwind {
+  store i32 1, i32* @g
+  ret void
+}
+
+define void @tail() nounwind {
+  tail call void @ext() nounwind
+  ret void
+}
+
+define i32 @skip(i32 %a, i32 %b) nounwind {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %done
+
+then:
+  %m = mul i32 %a, %b
+  br label %done
+
+done:
+  %r = phi i32 [ %a, %entry ], [ %m, %then ]
+  ret i32 %r
+}
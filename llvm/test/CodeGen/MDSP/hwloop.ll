@@ -0,0 +1,128 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+; RUN: llc < %s -march=mdsp -disable-modulo-sched | FileCheck %s -check-prefix=FLAT
+; RUN: llc < %s -march=mdsp -disable-mdsp-hwloops | FileCheck %s -check-prefix=BRANCH
+
+; The counter is loaded before the guard, and endloop replaces both the
+; induction variable and the compare and branch. It does not need an issue
+; slot, so it joins the last packet of the body. The pipelined kernel gets
+; its count from the induction variable instead.
+define void @fill(i32* %x, i32 %v, i32 %n) nounwind {
+; FLAT: fill:
+; FLAT: loop r3
+; FLAT: Inner Loop Header
+; FLAT-NEXT: stw r2, 0(r1)
+; FLAT-NEXT: ||{{.}}addi r1, r1, 4
+; FLAT-NEXT: ||{{.}}endloop
+; CHECK: fill:
+; CHECK: loop
+; CHECK: Inner Loop Header
+; CHECK: stw
+; CHECK-NEXT: ||{{.}}endloop
+; BRANCH: fill:
+; BRANCH-NOT: endloop
+; BRANCH: bne
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %p = getelementptr i32* %x, i32 %i
+  store i32 %v, i32* %p
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; The count from ScalarEvolution covers exit tests other than equality. The
+; pipelined kernel exits on a signed compare, so it keeps its branch and the
+; count computed for it is deleted.
+define void @range(i32* %x, i32 %a, i32 %b) nounwind {
+; FLAT: range:
+; FLAT: max
+; FLAT-NEXT: sub [[R:r[0-9]+]]
+; FLAT-NEXT: loop [[R]]
+; FLAT: endloop
+; CHECK: range:
+; CHECK-NOT: max
+; CHECK-NOT: endloop
+; CHECK: blt
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ %a, %entry ], [ %i1, %loop ]
+  %p = getelementptr i32* %x, i32 %i
+  %v = load i32* %p
+  %w = shl i32 %v, 1
+  store i32 %w, i32* %p
+  %i1 = add nsw i32 %i, 1
+  %d = icmp slt i32 %i1, %b
+  br i1 %d, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+declare void @g(i32)
+
+; A call may use the loop counter itself.
+define void @call(i32 %n) nounwind {
+; CHECK: call:
+; CHECK-NOT: endloop
+; CHECK: bne
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  call void @g(i32 %i)
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; Only the inner loop of a nest gets the counter, and it is reloaded each
+; time the inner loop is entered.
+define void @nest(i32* %x, i32 %n, i32 %m) nounwind {
+; CHECK: nest:
+; CHECK: Loop Header: Depth=1
+; CHECK: loop r
+; CHECK: Inner Loop Header: Depth=2
+; CHECK: endloop
+; CHECK: bne
+entry:
+  %c = icmp sgt i32 %n, 0
+  %cm = icmp sgt i32 %m, 0
+  %cc = and i1 %c, %cm
+  br i1 %cc, label %outer, label %exit
+
+outer:
+  %j = phi i32 [ 0, %entry ], [ %j1, %latch ]
+  br label %inner
+
+inner:
+  %i = phi i32 [ 0, %outer ], [ %i1, %inner ]
+  %k = mul i32 %j, %m
+  %ki = add i32 %k, %i
+  %p = getelementptr i32* %x, i32 %ki
+  store i32 %j, i32* %p
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %m
+  br i1 %d, label %latch, label %inner
+
+latch:
+  %j1 = add i32 %j, 1
+  %e = icmp eq i32 %j1, %n
+  br i1 %e, label %exit, label %outer
+
+exit:
+  ret void
+}
@@ -0,0 +1,32 @@
+; RUN: llvm-as < %s | llc -march=mdsp -disable-mdsp-packetizer | FileCheck %s
+; RUN: llvm-as < %s | llc -march=mdsp -disable-mdsp-packetizer \
+; RUN:   -disable-lazy-materialize | FileCheck %s
+; RUN: llvm-as < %s | llc -march=mdsp -disable-mdsp-packetizer \
+; RUN:   -codegen-threads=2 | FileCheck %s
+
+; The functions of bitcode input are read one at a time as the code generator
+; gets to them, and freed once they are emitted.  Functions called before
+; they are compiled, and globals they use, come out the same either way.
+
+@g = global i32 5
+
+define i32 @first(i32 %a) nounwind {
+; CHECK: first:
+; CHECK: call second
+; CHECK: ret
+  %r = call i32 @second(i32 %a)
+  %s = add i32 %r, 1
+  ret i32 %s
+}
+
+define i32 @second(i32 %a) nounwind {
+; CHECK: second:
+; CHECK: %lo(g)
+; CHECK: ret
+  %v = load i32* @g
+  %r = mul i32 %v, %a
+  ret i32 %r
+}
+
+; CHECK: g:
+; CHECK: .long 5
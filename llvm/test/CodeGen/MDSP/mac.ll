@@ -0,0 +1,61 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+
+define i32 @mac(i32 %acc, i32 %a, i32 %b) nounwind {
+; CHECK: mac:
+; CHECK: mac r1, r2, r3
+; CHECK-NEXT: ret
+  %m = mul i32 %a, %b
+  %r = add i32 %acc, %m
+  ret i32 %r
+}
+
+define i32 @msu(i32 %acc, i32 %a, i32 %b) nounwind {
+; CHECK: msu:
+; CHECK: msu r1, r2, r3
+; CHECK-NEXT: ret
+  %m = mul i32 %a, %b
+  %r = sub i32 %acc, %m
+  ret i32 %r
+}
+
+define i32 @mulhs(i32 %a, i32 %b) nounwind {
+; CHECK: mulhs:
+; CHECK: mulhs r1, r1, r2
+  %x = sext i32 %a to i64
+  %y = sext i32 %b to i64
+  %m = mul i64 %x, %y
+  %h = lshr i64 %m, 32
+  %r = trunc i64 %h to i32
+  ret i32 %r
+}
+
+; A 16-bit dot product accumulates in a register with one MAC per element.
+define i32 @dot(i16* %x, i16* %y, i32 %n) nounwind {
+; CHECK: dot:
+; CHECK: ldh
+; CHECK: ldh
+; CHECK: mac
+; CHECK: endloop
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  %px = getelementptr i16* %x, i32 %i
+  %py = getelementptr i16* %y, i32 %i
+  %vx = load i16* %px
+  %vy = load i16* %py
+  %ex = sext i16 %vx to i32
+  %ey = sext i16 %vy to i32
+  %m = mul i32 %ex, %ey
+  %s1 = add i32 %s, %m
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %s1, %loop ]
+  ret i32 %r
+}
@@ -0,0 +1,47 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+
+@g = global i32 0
+
+define i32 @ldw(i32* %p) nounwind {
+; CHECK: ldw:
+; CHECK: ldw r1, 8(r1)
+  %q = getelementptr i32* %p, i32 2
+  %v = load i32* %q
+  ret i32 %v
+}
+
+define i32 @ldbu(i8* %p) nounwind {
+; CHECK: ldbu:
+; CHECK: ldbu r1, 0(r1)
+  %v = load i8* %p
+  %r = zext i8 %v to i32
+  ret i32 %r
+}
+
+define i32 @ldh(i16* %p) nounwind {
+; CHECK: ldh:
+; CHECK: ldh r1, -2(r1)
+  %q = getelementptr i16* %p, i32 -1
+  %v = load i16* %q
+  %r = sext i16 %v to i32
+  ret i32 %r
+}
+
+define void @st(i32 %v, i8* %p, i16* %q) nounwind {
+; CHECK: st:
+; CHECK-DAG: stb r1, 0(r2)
+; CHECK-DAG: sth r0, 0(r3)
+  %t = trunc i32 %v to i8
+  store i8 %t, i8* %p
+  store i16 0, i16* %q
+  ret void
+}
+
+define i32 @global() nounwind {
+; CHECK: global:
+; CHECK: movhi r1, %hi(g)
+; CHECK-NEXT: ori r1, r1, %lo(g)
+; CHECK-NEXT: ldw r1, 0(r1)
+  %v = load i32* @g
+  ret i32 %v
+}
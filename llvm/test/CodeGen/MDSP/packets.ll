@@ -0,0 +1,86 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+; RUN: llc < %s -march=mdsp -disable-mdsp-packetizer | FileCheck %s -check-prefix=SERIAL
+
+; Two independent ALU operations share one bundle, in either order.
+define i32 @alu2(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+; CHECK: alu2:
+; CHECK: {{add r1, r1, r2|sub r3, r3, r4}}
+; CHECK-NEXT: ||{{.}}{{add r1, r1, r2|sub r3, r3, r4}}
+; SERIAL: alu2:
+; SERIAL-NOT: ||
+; SERIAL: ret
+  %x = add i32 %a, %b
+  %y = sub i32 %c, %d
+  %r = xor i32 %x, %y
+  ret i32 %r
+}
+
+; There is a single load/store unit, so two loads never share a bundle.
+define i32 @loads(i32* %p, i32* %q) nounwind {
+; CHECK: loads:
+; CHECK: ldw
+; CHECK-NOT: ||{{.}}ldw
+; CHECK: ret
+  %a = load i32* %p
+  %b = load i32* %q
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+; A result is not visible inside the bundle that produces it.
+define i32 @chain(i32 %a, i32 %b) nounwind {
+; CHECK: chain:
+; CHECK: add r1, r1, r2
+; CHECK-NOT: ||{{.}}shl
+; CHECK: shl
+  %x = add i32 %a, %b
+  %r = shl i32 %x, %b
+  ret i32 %r
+}
+
+; Branches can only issue in slot 0, ALU operations in either slot, so a
+; branch still shares a bundle with an ALU operation that does not feed it.
+declare void @use(i32)
+
+define void @jump(i32 %a, i32 %b, i32 %c) nounwind {
+; CHECK: jump:
+; CHECK: sub r1, r3, r2
+; CHECK-NEXT: ||{{.}}br
+entry:
+  %t = icmp eq i32 %a, 0
+  br i1 %t, label %x, label %z
+
+z:
+  %q = sub i32 %c, %b
+  br label %y
+
+x:
+  %w = shl i32 %c, %b
+  br label %y
+
+y:
+  %r = phi i32 [ %w, %x ], [ %q, %z ]
+  call void @use(i32 %r)
+  ret void
+}
+
+define i32 @count(i32 %n, i32* %p) nounwind {
+; CHECK: count:
+; CHECK: add r3, r3, r5
+; CHECK-NEXT: ||{{.}}blt r5, r1
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %loop ]
+  %a = getelementptr i32* %p, i32 %i
+  %v = volatile load i32* %a
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, 1
+  %c = icmp slt i32 %v, %n
+  br i1 %c, label %loop, label %exit
+
+exit:
+  ret i32 %s.next
+}
@@ -0,0 +1,69 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+; RUN: llc < %s -march=mdsp -disable-modulo-sched | FileCheck %s -check-prefix=FLAT
+
+; The multiply of one element overlaps with the load of the next, so the
+; kernel stores the product of the previous iteration before it multiplies.
+define void @scale(i32* noalias %x, i32* noalias %y, i32 %k, i32 %n) nounwind {
+; CHECK: scale:
+; CHECK: ldw
+; CHECK: mul
+; CHECK-NEXT: loop
+; CHECK-NEXT: beq
+; CHECK: Inner Loop Header
+; CHECK: ldw
+; CHECK: stw
+; CHECK: mul
+; CHECK-NEXT: ||{{.}}endloop
+; CHECK: stw
+; FLAT: scale:
+; FLAT: Inner Loop Header
+; FLAT: ldw
+; FLAT: mul
+; FLAT: stw
+; FLAT: endloop
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %px = getelementptr i32* %x, i32 %i
+  %py = getelementptr i32* %y, i32 %i
+  %v = load i32* %px
+  %m = mul i32 %v, %k
+  store i32 %m, i32* %py
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; The buffers may overlap, so each store must complete before the next load
+; and there is nothing to gain from overlapping the iterations.
+define void @alias(i32* %x, i32* %y, i32 %k, i32 %n) nounwind {
+; CHECK: alias:
+; CHECK: Inner Loop Header
+; CHECK: ldw
+; CHECK: mul
+; CHECK: stw
+; CHECK: endloop
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %px = getelementptr i32* %x, i32 %i
+  %py = getelementptr i32* %y, i32 %i
+  %v = load i32* %px
+  %m = mul i32 %v, %k
+  store i32 %m, i32* %py
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,80 @@
+; RUN: llc < %s -march=mdsp | FileCheck %s
+
+define i32 @adds(i32 %a, i32 %b) nounwind {
+; CHECK: adds:
+; CHECK: adds r1, r1, r2
+  %r = call i32 @llvm.sadd.sat.i32(i32 %a, i32 %b)
+  ret i32 %r
+}
+
+define i32 @subs(i32 %a, i32 %b) nounwind {
+; CHECK: subs:
+; CHECK: subs r1, r1, r2
+  %r = call i32 @llvm.ssub.sat.i32(i32 %a, i32 %b)
+  ret i32 %r
+}
+
+define i32 @q31(i32 %a, i32 %b) nounwind {
+; CHECK: q31:
+; CHECK: mulq r1, r1, r2
+  %r = call i32 @llvm.smul.fix.sat.i32(i32 %a, i32 %b, i32 31)
+  ret i32 %r
+}
+
+; Q15 values are moved into the upper half, where they saturate in Q31.
+define i16 @q15(i16 %a, i16 %b) nounwind {
+; CHECK: q15:
+; CHECK: shli
+; CHECK: mulq
+; CHECK: srai r1, r1, 16
+  %r = call i16 @llvm.smul.fix.sat.i16(i16 %a, i16 %b, i32 15)
+  ret i16 %r
+}
+
+define i16 @adds16(i16 %a, i16 %b) nounwind {
+; CHECK: adds16:
+; CHECK: shli
+; CHECK: adds
+; CHECK: srai r1, r1, 16
+  %r = call i16 @llvm.sadd.sat.i16(i16 %a, i16 %b)
+  ret i16 %r
+}
+
+; Other scales are built from the two halves of the product.
+define i32 @fix16(i32 %a, i32 %b) nounwind {
+; CHECK: fix16:
+; CHECK-NOT: mulq
+; CHECK: mulhs
+; CHECK: sel
+  %r = call i32 @llvm.smul.fix.sat.i32(i32 %a, i32 %b, i32 16)
+  ret i32 %r
+}
+
+define i64 @adds64(i64 %a, i64 %b) nounwind {
+; CHECK: adds64:
+; CHECK-NOT: adds r
+; CHECK: sel
+; CHECK: ret
+  %r = call i64 @llvm.sadd.sat.i64(i64 %a, i64 %b)
+  ret i64 %r
+}
+
+; Without a 64-bit multiplier the product is put together from 32-bit halves,
+; without a libcall.
+define i64 @q63(i64 %a, i64 %b) nounwind {
+; CHECK: q63:
+; CHECK-NOT: call
+; CHECK: mulhu
+; CHECK-NOT: call
+; CHECK: ret
+  %r = call i64 @llvm.smul.fix.sat.i64(i64 %a, i64 %b, i32 63)
+  ret i64 %r
+}
+
+declare i32 @llvm.sadd.sat.i32(i32, i32)
+declare i16 @llvm.sadd.sat.i16(i16, i16)
+declare i64 @llvm.sadd.sat.i64(i64, i64)
+declare i32 @llvm.ssub.sat.i32(i32, i32)
+declare i32 @llvm.smul.fix.sat.i32(i32, i32, i32)
+declare i16 @llvm.smul.fix.sat.i16(i16, i16, i32)
+declare i64 @llvm.smul.fix.sat.i64(i64, i64, i32)
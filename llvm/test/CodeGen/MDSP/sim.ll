@@ -0,0 +1,117 @@
+; RUN: llc < %s -march=mdsp -filetype=obj -o %t.o
+; RUN: mdsp-sim -args=16 %t.o | FileCheck %s
+; RUN: mdsp-sim -entry=fir -args=0,0,5,16,0 %t.o | FileCheck %s -check-prefix=EMPTY
+; RUN: mdsp-sim -args=16 -profile %t.o | FileCheck %s -check-prefix=PROFILE
+; RUN: llc < %s -march=mdsp -filetype=obj -mattr=-circ -o %t.nocirc.o
+; RUN: mdsp-sim -args=16 -profile %t.nocirc.o | \
+; RUN:   FileCheck %s -check-prefix=NOCIRC
+; RUN: llc < %s -march=mdsp -filetype=obj -mcpu=mdsp300 -o %t.300.o
+; RUN: mdsp-sim -mcpu=mdsp300 -args=16 %t.300.o | FileCheck %s
+; RUN: mdsp-sim -entry=down -args=7 %t.o | FileCheck %s -check-prefix=DOWN
+; RUN: mdsp-sim -entry=down -args=7 %t.nocirc.o | FileCheck %s -check-prefix=DOWN
+; RUN: not mdsp-sim -mcpu=mdsp1000 %t.o |& FileCheck %s -check-prefix=BADCPU
+
+; The simulator links the object, runs main and reports what it returned.
+; CHECK: return: 3168
+; CHECK-NEXT: cycles: {{[0-9]+}}
+
+; EMPTY: return: 0
+
+; A count-down walk of a seven entry delay line reads the taps 6 5 4 3 2 1 0
+; 6 5 4.
+; DOWN: return: 2221111
+
+; BADCPU: unknown MDSP core 'mdsp1000'
+
+; Every function that ran gets a row, most cycles first, and a total.
+; PROFILE: Function Calls Cycles Stalls Packets Insts Slots
+; PROFILE: fir 1 {{[0-9]+}}
+; PROFILE: scale 1 {{[0-9]+}}
+; PROFILE: main 1 {{[0-9]+}}
+; PROFILE: Total {{[0-9]+ [0-9]+ [0-9]+ [0-9]+ [0-9.]+%}}
+
+; Without circular addressing the wrap goes through the runtime division,
+; which the simulator provides.
+; NOCIRC: return: 3168
+; NOCIRC: __umodsi3 16
+
+@x = global [16 x i32] [i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7, i32 8,
+                        i32 9, i32 10, i32 11, i32 12, i32 13, i32 14, i32 15,
+                        i32 16]
+@y = global [16 x i32] zeroinitializer
+@taps = global [7 x i32] [i32 1, i32 10, i32 100, i32 1000, i32 10000,
+                          i32 100000, i32 1000000]
+
+define void @scale(i32* noalias %x, i32* noalias %y, i32 %k, i32 %n) nounwind {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %px = getelementptr i32* %x, i32 %i
+  %v = load i32* %px
+  %m = mul i32 %v, %k
+  %py = getelementptr i32* %y, i32 %i
+  store i32 %m, i32* %py
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+define i32 @fir(i32* noalias %buf, i32* noalias %h, i32 %pos, i32 %n,
+                i32 %taps) nounwind {
+entry:
+  %c = icmp sgt i32 %taps, 0
+  br i1 %c, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i1, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc1, %loop ]
+  %j = add i32 %pos, %i
+  %k = urem i32 %j, %n
+  %pb = getelementptr i32* %buf, i32 %k
+  %v = load i32* %pb
+  %ph = getelementptr i32* %h, i32 %i
+  %w = load i32* %ph
+  %m = mul i32 %v, %w
+  %acc1 = add i32 %acc, %m
+  %i1 = add i32 %i, 1
+  %d = icmp eq i32 %i1, %taps
+  br i1 %d, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc1, %loop ]
+  ret i32 %r
+}
+
+define i32 @main(i32 %n) nounwind {
+  %px = getelementptr [16 x i32]* @x, i32 0, i32 0
+  %py = getelementptr [16 x i32]* @y, i32 0, i32 0
+  call void @scale(i32* %px, i32* %py, i32 3, i32 %n)
+  %f = call i32 @fir(i32* %py, i32* %px, i32 5, i32 16, i32 %n)
+  ret i32 %f
+}
+
+define i32 @down(i32 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 10, %entry ], [ %i1, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc1, %loop ]
+  %j = add i32 %i, 3
+  %k = urem i32 %j, %n
+  %pb = getelementptr [7 x i32]* @taps, i32 0, i32 %k
+  %v = load i32* %pb
+  %acc1 = add i32 %acc, %v
+  %i1 = add i32 %i, -1
+  %d = icmp eq i32 %i1, 0
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret i32 %acc1
+}
@@ -0,0 +1,22 @@
+; RUN: llc < %s -march=x86 -cgp-merge-straight-line | FileCheck %s
+; RUN: llc < %s -march=x86 | FileCheck %s -check-prefix=SPLIT
+
+; With the blocks merged, the load of %x from the stack in %next folds into
+; the add; selected block by block, %x is copied into a register first.
+; CHECK: f:
+; CHECK: movl (%eax), %eax
+; CHECK-NEXT: addl 8(%esp), %eax
+; CHECK-NEXT: ret
+; SPLIT: f:
+; SPLIT: movl 8(%esp), %ecx
+; SPLIT-NEXT: addl %ecx, %eax
+
+define i32 @f(i32* %p, i32 %x) nounwind {
+entry:
+  %v = load i32* %p
+  br label %next
+
+next:
+  %r = add i32 %v, %x
+  ret i32 %r
+}
@@ -0,0 +1,92 @@
+; RUN: llc < %s -march=x86-64 -o %t.s
+; RUN: llc < %s -march=x86-64 -codegen-threads=4 -o %t.p.s
+; RUN: cmp %t.s %t.p.s
+; RUN: llc < %s -march=x86 -O0 -o %t.s
+; RUN: llc < %s -march=x86 -O0 -codegen-threads=4 -o %t.p.s
+; RUN: cmp %t.s %t.p.s
+; RUN: llvm-as < %s > %t.bc
+; RUN: llc < %t.bc -march=x86-64 -o %t.s
+; RUN: llc < %t.bc -march=x86-64 -codegen-threads=4 -o %t.p.s
+; RUN: cmp %t.s %t.p.s
+; RUN: llc < %s -march=x86-64 -codegen-threads=4 | FileCheck %s
+
+; The machine passes of independent functions run on worker threads, but the
+; functions are still emitted in module order and the output is the same as
+; that of a serial run.  Functions that need unwind information, like @cleanup,
+; are compiled on the calling thread; the others still run in parallel.
+
+; CHECK: sum:
+; CHECK: loop:
+; CHECK: select:
+; CHECK: spill:
+; CHECK: cleanup:
+; CHECK: caller:
+
+define i32 @sum(i32* %p, i32 %n) nounwind {
+entry:
+  %c = icmp sgt i32 %n, 0
+  br i1 %c, label %body, label %exit
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %s = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  %a = getelementptr i32* %p, i32 %i
+  %v = load i32* %a
+  %s.next = add i32 %s, %v
+  %i.next = add i32 %i, 1
+  %d = icmp eq i32 %i.next, %n
+  br i1 %d, label %exit, label %body
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %s.next, %body ]
+  ret i32 %r
+}
+
+define void @loop(i32* %p, i32 %n) nounwind {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %a = getelementptr i32* %p, i32 %i
+  store i32 %i, i32* %a
+  %i.next = add i32 %i, 1
+  %d = icmp slt i32 %i.next, %n
+  br i1 %d, label %body, label %exit
+
+exit:
+  ret void
+}
+
+define i64 @select(i64 %a, i64 %b, i64 %c) nounwind {
+  %x = icmp ult i64 %a, %b
+  %y = select i1 %x, i64 %a, i64 %c
+  %z = mul i64 %y, %b
+  ret i64 %z
+}
+
+define double @spill(double %a, double %b, double %c, double %d) nounwind {
+  %x = fmul double %a, %b
+  %y = call double @select_fp(double %x)
+  %z = fadd double %y, %c
+  %w = fdiv double %z, %d
+  %r = fadd double %w, %x
+  ret double %r
+}
+
+declare double @select_fp(double) nounwind
+
+define i32 @cleanup(i32* %p) {
+entry:
+  %a = call i32 @sum(i32* %p, i32 4)
+  call void @loop(i32* %p, i32 %a)
+  store i32 0, i32* %p
+  ret i32 %a
+}
+
+define i32 @caller(i32* %p) nounwind {
+  %a = call i32 @sum(i32* %p, i32 16)
+  call void @loop(i32* %p, i32 %a)
+  %b = load i32* %p
+  ret i32 %b
+}
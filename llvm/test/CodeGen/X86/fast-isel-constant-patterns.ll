@@ -0,0 +1,41 @@
+; RUN: llc < %s -O0 -march=x86-64 -fast-isel-abort -verify-machineinstrs | FileCheck %s
+
+; FastISel uses the patterns that match specific constants, including the
+; ones that produce more than one instruction.
+
+; CHECK: xor8:
+; CHECK: notb
+define i8 @xor8(i8 %x) nounwind {
+  %r = xor i8 %x, -1
+  ret i8 %r
+}
+
+; CHECK: xor32:
+; CHECK: notl
+define i32 @xor32(i32 %x) nounwind {
+  %r = xor i32 %x, -1
+  ret i32 %r
+}
+
+; CHECK: xor64:
+; CHECK: notq
+define i64 @xor64(i64 %x) nounwind {
+  %r = xor i64 %x, -1
+  ret i64 %r
+}
+
+; A single AND is still preferred over a subregister copy and a movzx.
+; CHECK: and32:
+; CHECK: andl $255
+define i32 @and32(i32 %x) nounwind {
+  %r = and i32 %x, 255
+  ret i32 %r
+}
+
+; CHECK: and64:
+; CHECK-NOT: movabsq
+; CHECK: movzbl
+define i64 @and64(i64 %x) nounwind {
+  %r = and i64 %x, 255
+  ret i64 %r
+}
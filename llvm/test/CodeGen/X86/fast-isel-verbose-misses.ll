@@ -0,0 +1,31 @@
+; RUN: llc < %s -O0 -march=x86-64 -mattr=+sse2 -fast-isel-verbose -o /dev/null |& FileCheck %s
+
+; -fast-isel-verbose ends with a histogram of the instructions FastISel
+; missed, sorted by how many instructions each sent to SelectionDAG.
+
+; CHECK: FastISel missed call: {{.*}}@llvm.x86.sse2.sqrt.sd
+; CHECK: FastISel miss: {{.*}}sdiv <4 x i32>
+; CHECK: FastISel miss: {{.*}}sdiv <4 x i32>
+; CHECK: ... FastISel Misses ...
+; CHECK: Misses  DAG Insts  Instruction
+; CHECK-NEXT: 2          3  sdiv <4 x i32>
+; CHECK-NEXT: 1          1  call llvm.x86.sse2.sqrt.sd
+
+declare <2 x double> @llvm.x86.sse2.sqrt.sd(<2 x double>)
+
+define <2 x double> @sqrt(<2 x double> %x) nounwind {
+  %r = call <2 x double> @llvm.x86.sse2.sqrt.sd(<2 x double> %x)
+  ret <2 x double> %r
+}
+
+define <4 x i32> @div(<4 x i32> %x, <4 x i32> %y) nounwind {
+  %a = add <4 x i32> %x, %y
+  %b = sdiv <4 x i32> %a, %y
+  ret <4 x i32> %b
+}
+
+define <4 x i32> @div2(<4 x i32> %x, <4 x i32> %y) nounwind {
+  %a = sdiv <4 x i32> %x, %y
+  %b = add <4 x i32> %a, %y
+  ret <4 x i32> %b
+}
@@ -0,0 +1,14 @@
+; RUN: llc < %s -march=x86 -stats |& FileCheck %s
+; The second add and the second constant are CSE'd with the first ones.
+
+; CHECK: {{[0-9]+}} isel - Largest number of bytes allocated for one DAG
+; CHECK: {{[0-9]+}} isel - Number of SelectionDAG nodes created
+; CHECK: {{[0-9]+}} isel - Number of SelectionDAG nodes found in the CSE map
+; CHECK: {{[0-9]+}} isel - Number of bytes allocated for SelectionDAG nodes
+
+define i32 @f(i32 %x) nounwind {
+  %a = add i32 %x, 7
+  %b = add i32 %x, 7
+  %c = mul i32 %a, %b
+  ret i32 %c
+}
@@ -0,0 +1,37 @@
+; RUN: llvm-as < %s | llc -mtriple=i686-pc-linux-gnu -relocation-model=pic \
+; RUN:   | FileCheck %s
+; RUN: llvm-as < %s | llc -mtriple=i386-apple-darwin8 -relocation-model=pic \
+; RUN:   | FileCheck %s -check-prefix=DARWIN
+
+; Freeing the body of @callee once it is emitted keeps it internal, so the call
+; after it does not go through the PLT.  Neither call goes through a $stub:
+; both functions are still defined in this module.
+
+define internal i32 @callee(i32 %x) nounwind {
+  %y = mul i32 %x, %x
+  ret i32 %y
+}
+
+define i32 @defined(i32 %x) nounwind {
+  %y = add i32 %x, %x
+  ret i32 %y
+}
+
+define i32 @caller(i32 %x) nounwind {
+; CHECK: caller:
+; CHECK-NOT: callee@PLT
+; CHECK: calll callee
+; CHECK-NEXT: movl
+; CHECK-NEXT: calll defined@PLT
+
+; DARWIN: _caller:
+; DARWIN-NOT: $stub
+; DARWIN: calll _callee
+; DARWIN-NOT: $stub
+; DARWIN: calll _defined
+; DARWIN-NOT: $stub
+; DARWIN: ret
+  %r = call i32 @callee(i32 %x)
+  %s = call i32 @defined(i32 %r)
+  ret i32 %s
+}
@@ -0,0 +1,17 @@
+; RUN: llc < %s -march=x86-64 | FileCheck %s
+
+; On x86-64 the 64-bit halves are multiplied by mulq.
+define void @q64(i128* %p, i128* %q) nounwind {
+; CHECK: q64:
+; CHECK-NOT: call
+; CHECK: mulq
+; CHECK-NOT: call
+; CHECK: ret
+  %a = load i128* %p
+  %b = load i128* %q
+  %r = call i128 @llvm.smul.fix.sat.i128(i128 %a, i128 %b, i32 64)
+  store i128 %r, i128* %p
+  ret void
+}
+
+declare i128 @llvm.smul.fix.sat.i128(i128, i128, i32)
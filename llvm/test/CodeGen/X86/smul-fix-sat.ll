@@ -0,0 +1,23 @@
+; RUN: llc < %s -march=x86 | FileCheck %s -check-prefix=X32
+; RUN: llc < %s -march=x86-64 | FileCheck %s -check-prefix=X64
+
+; A fixed-point multiply wider than a register is built from the four products
+; of the halves, not from a libcall.
+
+define i64 @q31(i64 %a, i64 %b) nounwind {
+; X32: q31:
+; X32-NOT: call
+; X32: mull
+; X32: mull
+; X32: mull
+; X32: mull
+; X32-NOT: call
+; X32: ret
+; X64: q31:
+; X64: imulq
+; X64: cmov
+  %r = call i64 @llvm.smul.fix.sat.i64(i64 %a, i64 %b, i32 31)
+  ret i64 %r
+}
+
+declare i64 @llvm.smul.fix.sat.i64(i64, i64, i32)
@@ -0,0 +1,40 @@
+; RUN: llvm-as < %s | llc -O2 -asm-verbose | FileCheck %s
+; RUN: llvm-as < %s | llc -O2 -asm-verbose -disable-lazy-materialize \
+; RUN:   | FileCheck %s
+; llc reads bitcode input lazily, but these subprograms can only be found
+; through the function bodies.  Both still get their DIEs.
+
+; CHECK: .section .debug_info
+; CHECK: "square"{{ *}}# DW_AT_name
+; CHECK: "twice"{{ *}}# DW_AT_name
+
+define i32 @square(i32 %x) nounwind ssp {
+entry:
+  %x.addr = alloca i32, align 4
+  store i32 %x, i32* %x.addr, align 4
+  call void @llvm.dbg.declare(metadata !{i32* %x.addr}, metadata !6), !dbg !7
+  %0 = load i32* %x.addr, align 4, !dbg !8
+  %mul = mul nsw i32 %0, %0, !dbg !8
+  ret i32 %mul, !dbg !8
+}
+
+declare void @llvm.dbg.declare(metadata, metadata) nounwind readnone
+
+define i32 @twice(i32 %x) nounwind ssp {
+entry:
+  %add = add nsw i32 %x, %x, !dbg !10
+  ret i32 %add, !dbg !10
+}
+
+!0 = metadata !{i32 589870, i32 0, metadata !1, metadata !"square", metadata !"square", metadata !"", metadata !1, i32 1, metadata !3, i1 false, i1 true, i32 0, i32 0, null, i32 256, i1 false, i32 (i32)* @square} ; [ DW_TAG_subprogram ]
+!1 = metadata !{i32 589865, metadata !"lazy.c", metadata !"/tmp", metadata !2} ; [ DW_TAG_file_type ]
+!2 = metadata !{i32 589841, i32 0, i32 12, metadata !"lazy.c", metadata !"/tmp", metadata !"clang version 2.9", i1 true, i1 false, metadata !"", i32 0} ; [ DW_TAG_compile_unit ]
+!3 = metadata !{i32 589845, metadata !1, metadata !"", metadata !1, i32 0, i64 0, i64 0, i32 0, i32 0, i32 0, metadata !4, i32 0, i32 0} ; [ DW_TAG_subroutine_type ]
+!4 = metadata !{metadata !5}
+!5 = metadata !{i32 589860, metadata !2, metadata !"int", null, i32 0, i64 32, i64 32, i64 0, i32 0, i32 5} ; [ DW_TAG_base_type ]
+!6 = metadata !{i32 590081, metadata !0, metadata !"x", metadata !1, i32 16777217, metadata !5, i32 0} ; [ DW_TAG_arg_variable ]
+!7 = metadata !{i32 1, i32 15, metadata !0, null}
+!8 = metadata !{i32 2, i32 3, metadata !9, null}
+!9 = metadata !{i32 589835, metadata !0, i32 1, i32 18, metadata !1, i32 0} ; [ DW_TAG_lexical_block ]
+!10 = metadata !{i32 5, i32 3, metadata !11, null}
+!11 = metadata !{i32 589870, i32 0, metadata !1, metadata !"twice", metadata !"twice", metadata !"", metadata !1, i32 4, metadata !3, i1 false, i1 true, i32 0, i32 0, null, i32 256, i1 false, i32 (i32)* @twice} ; [ DW_TAG_subprogram ]
@@ -0,0 +1,35 @@
+; RUN: llvm-as < %p/lazy-b.ll > %t.bc
+; RUN: llvm-link %s %t.bc -S | FileCheck %s
+
+; The second module is read lazily: its bodies are only read when they are
+; linked in, and local functions nothing uses are left out.
+
+; CHECK: @table = internal global [2 x i8*] [i8* blockaddress(@jump, %a), i8* blockaddress(@jump, %b)]
+; CHECK: @handler = global void ()* @local_handler
+
+; CHECK: define i32 @main()
+define i32 @main() {
+  %x = call i32 @ext(i32 1)
+  %y = call i32 @dup()
+  %z = add i32 %x, %y
+  ret i32 %z
+}
+
+; The body this module has is kept, the one of the other module is not read.
+; CHECK: define linkonce_odr i32 @dup()
+; CHECK-NEXT: ret i32 1
+define linkonce_odr i32 @dup() {
+  ret i32 1
+}
+
+declare i32 @ext(i32)
+
+; CHECK: define i32 @ext(i32 %x)
+; CHECK: define internal i32 @helper(i32 %x)
+; CHECK: define internal i32 @helper2(i32 %x)
+; CHECK: define internal i32 @jump(i8* %p)
+; CHECK: define internal void @local_handler()
+; CHECK: define i8* @ext_addr()
+; CHECK-NEXT: ret i8* blockaddress(@target, %t)
+; CHECK: define internal void @target()
+; CHECK-NOT: @unused
@@ -0,0 +1,60 @@
+; This file is for use with lazy-a.ll
+; RUN: true
+
+@table = internal global [2 x i8*] [i8* blockaddress(@jump, %a), i8* blockaddress(@jump, %b)]
+@handler = global void ()* @local_handler
+
+define i32 @ext(i32 %x) {
+  %y = call i32 @helper(i32 %x)
+  %p = getelementptr [2 x i8*]* @table, i32 0, i32 1
+  %t = load i8** %p
+  %z = call i32 @jump(i8* %t)
+  %r = add i32 %y, %z
+  ret i32 %r
+}
+
+define linkonce_odr i32 @dup() {
+  ret i32 2
+}
+
+define internal i32 @unused(i32 %x) {
+  %y = call i32 @helper(i32 %x)
+  ret i32 %y
+}
+
+define internal i32 @helper(i32 %x) {
+  %y = call i32 @helper2(i32 %x)
+  ret i32 %y
+}
+
+define internal i32 @helper2(i32 %x) {
+  %y = mul i32 %x, 3
+  ret i32 %y
+}
+
+define internal i32 @jump(i8* %p) {
+entry:
+  indirectbr i8* %p, [label %a, label %b]
+
+a:
+  ret i32 1
+
+b:
+  ret i32 2
+}
+
+define internal void @local_handler() {
+  ret void
+}
+
+define i8* @ext_addr() {
+  ret i8* blockaddress(@target, %t)
+}
+
+define internal void @target() {
+entry:
+  br label %t
+
+t:
+  ret void
+}
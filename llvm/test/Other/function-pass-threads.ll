@@ -0,0 +1,100 @@
+; RUN: opt < %s -mem2reg -sccp -early-cse -adce -S | FileCheck %s
+; RUN: opt < %s -function-pass-threads=4 -mem2reg -sccp -early-cse -adce -S \
+; RUN:   | FileCheck %s
+; RUN: opt < %s -function-pass-threads=4 -mem2reg -instcombine -S \
+; RUN:   | FileCheck %s -check-prefix=SERIAL
+
+; Running the passes on several functions at once gives the same module as
+; running them on one function after the other.
+
+@g = global [4 x i32] zeroinitializer
+
+; CHECK: define i32 @f0(i32 %x)
+; CHECK-NEXT: entry:
+; CHECK-NEXT: %a = add i32 %x, 3
+; CHECK-NEXT: store i32 %a, i32* getelementptr inbounds ([4 x i32]* @g, i32 0, i32 0)
+; CHECK-NEXT: ret i32 %a
+define i32 @f0(i32 %x) nounwind {
+entry:
+  %p = alloca i32
+  store i32 %x, i32* %p
+  %v = load i32* %p
+  %c = icmp eq i32 1, 1
+  %k = select i1 %c, i32 3, i32 4
+  %a = add i32 %v, %k
+  %b = add i32 %v, %k
+  store i32 %b, i32* getelementptr inbounds ([4 x i32]* @g, i32 0, i32 0)
+  ret i32 %a
+}
+
+; CHECK: define i32 @f1(i32 %x)
+; CHECK-NEXT: entry:
+; CHECK-NEXT: %a = mul i32 %x, 5
+; CHECK-NEXT: store i32 %a, i32* getelementptr inbounds ([4 x i32]* @g, i32 0, i32 1)
+; CHECK-NEXT: ret i32 %a
+define i32 @f1(i32 %x) nounwind {
+entry:
+  %p = alloca i32
+  store i32 %x, i32* %p
+  %v = load i32* %p
+  %a = mul i32 %v, 5
+  %b = mul i32 %v, 5
+  store i32 %b, i32* getelementptr inbounds ([4 x i32]* @g, i32 0, i32 1)
+  ret i32 %a
+}
+
+; CHECK: define i32 @f2(i32 %n)
+; CHECK: loop:
+; CHECK-NEXT: %ip.0 = phi i32 [ 0, %entry ], [ %i1, %loop ]
+; CHECK-NEXT: %sp.0 = phi i32 [ 0, %entry ], [ %s1, %loop ]
+; CHECK-NEXT: %s1 = add i32 %sp.0, %ip.0
+; CHECK: exit:
+; CHECK-NEXT: ret i32 %s1
+define i32 @f2(i32 %n) nounwind {
+entry:
+  %sp = alloca i32
+  %ip = alloca i32
+  store i32 0, i32* %sp
+  store i32 0, i32* %ip
+  br label %loop
+
+loop:
+  %i = load i32* %ip
+  %s = load i32* %sp
+  %s1 = add i32 %s, %i
+  store i32 %s1, i32* %sp
+  %i1 = add i32 %i, 1
+  store i32 %i1, i32* %ip
+  %d = icmp eq i32 %i1, %n
+  br i1 %d, label %exit, label %loop
+
+exit:
+  ret i32 %s1
+}
+
+; CHECK: define i32 @f3()
+; CHECK: live:
+; CHECK-NEXT: %r = call i32 @f2(i32 7)
+; CHECK-NEXT: ret i32 %r
+define i32 @f3() nounwind {
+entry:
+  %p = alloca i32
+  store i32 7, i32* %p
+  %v = load i32* %p
+  br i1 false, label %dead, label %live
+
+dead:
+  ret i32 0
+
+live:
+  %r = call i32 @f2(i32 %v)
+  ret i32 %r
+}
+
+; CHECK: declare i32 @ext(i32)
+declare i32 @ext(i32)
+
+; Instcombine cannot run on several functions at once, the passes still run.
+; SERIAL: define i32 @f1(i32 %x)
+; SERIAL-NEXT: entry:
+; SERIAL-NEXT: %a = mul i32 %x, 5
@@ -0,0 +1,50 @@
+; RUN: opt < %s -mem2reg -instcombine -globaldce -disable-output \
+; RUN:   -profile-passes=%t.json -profile-passes-trace=%t.trace
+; RUN: FileCheck %s -check-prefix=MEM2REG < %t.json
+; RUN: FileCheck %s -check-prefix=INSTCOMBINE < %t.json
+; RUN: FileCheck %s -check-prefix=GLOBALDCE < %t.json
+; RUN: FileCheck %s -check-prefix=SPILL < %t.json
+; RUN: FileCheck %s -check-prefix=QUOTE < %t.json
+; RUN: FileCheck %s -check-prefix=TRACE < %t.trace
+; RUN: FileCheck %s -check-prefix=TRACEMODULE < %t.trace
+
+; Every pass that ran is in the report, with the instructions it added or
+; removed, and so is every function with the passes that ran on it.  The
+; entries are sorted by time, so each one is checked on its own.
+
+; MEM2REG: "passes": [
+; MEM2REG: {"name": "Promote Memory to Register", "runs": 3, {{.*}}, "inst_delta": -6}
+; MEM2REG: "functions": [
+; INSTCOMBINE: {"name": "Combine redundant instructions", "runs": 3, {{.*}}, "inst_delta": -1}
+; GLOBALDCE: {"name": "Dead Global Elimination", "runs": 1, {{.*}}, "inst_delta": -1}
+; GLOBALDCE: "functions": [
+; GLOBALDCE-NOT: Dead Global Elimination
+; SPILL: "functions": [
+; SPILL: {"name": "spill", {{.*}}, "inst_delta": -6, "passes": [
+; SPILL: {"name": "Promote Memory to Register", "runs": 1, {{.*}}, "inst_delta": -6}
+; QUOTE: {"name": "a\"b", {{.*}}, "inst_delta": -1, "passes": [
+
+; TRACE: {"traceEvents": [
+; TRACE: {"name": "Promote Memory to Register", "cat": "function", "ph": "X", {{.*}} "args": {"ir": "spill", {{.*}}, "inst_delta": -6}}
+; TRACE: ], "displayTimeUnit": "ms"}
+; TRACEMODULE: {"name": "Dead Global Elimination", "cat": "module", "ph": "X", {{.*}} "args": {"ir": "<stdin>", {{.*}}, "inst_delta": -1}}
+
+define i32 @spill(i32 %x) nounwind {
+  %p = alloca i32
+  %q = alloca i32
+  store i32 %x, i32* %p
+  store i32 %x, i32* %q
+  %a = load i32* %p
+  %b = load i32* %q
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+define i32 @"a\22b"(i32 %x) nounwind {
+  %y = add i32 %x, 0
+  ret i32 %y
+}
+
+define internal void @dead() nounwind {
+  ret void
+}
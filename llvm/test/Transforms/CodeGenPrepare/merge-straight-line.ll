@@ -0,0 +1,53 @@
+; RUN: opt < %s -codegenprepare -cgp-merge-straight-line -S | FileCheck %s
+
+; A chain of blocks linked by unconditional branches is merged into one block.
+; CHECK: define i32 @chain
+; CHECK: entry:
+; CHECK-NEXT: %v = load i32* %p
+; CHECK-NEXT: %r = add i32 %v, %x
+; CHECK-NEXT: %s = add i32 %r, 1
+; CHECK-NEXT: ret i32 %s
+define i32 @chain(i32* %p, i32 %x) nounwind {
+entry:
+  %v = load i32* %p
+  br label %next
+
+next:
+  %r = add i32 %v, %x
+  br label %last
+
+last:
+  %s = add i32 %r, 1
+  ret i32 %s
+}
+
+; Blocks with several predecessors, or whose predecessor branches
+; conditionally, are left alone.
+; CHECK: define i32 @diamond
+; CHECK: then:
+; CHECK: join:
+; CHECK-NEXT: %r = phi i32
+define i32 @diamond(i1 %c, i32 %x) nounwind {
+entry:
+  br i1 %c, label %then, label %join
+
+then:
+  %y = add i32 %x, 1
+  br label %join
+
+join:
+  %r = phi i32 [ %x, %entry ], [ %y, %then ]
+  ret i32 %r
+}
+
+; Blocks whose address is taken are not merged either.
+; CHECK: define i8* @taken
+; CHECK: target:
+@addr = global i8* blockaddress(@taken, %target)
+define i8* @taken() nounwind {
+entry:
+  br label %target
+
+target:
+  ret i8* blockaddress(@taken, %target)
+}
@@ -0,0 +1,102 @@
+; RUN: opt < %s -constprop -S | FileCheck %s
+
+;;-----------------------------
+;; sadd.sat
+;;-----------------------------
+
+define i8 @sadd_1() nounwind {
+entry:
+  %t = call i8 @llvm.sadd.sat.i8(i8 42, i8 50)
+  ret i8 %t
+
+; CHECK: @sadd_1
+; CHECK: ret i8 92
+}
+
+define i8 @sadd_2() nounwind {
+entry:
+  %t = call i8 @llvm.sadd.sat.i8(i8 100, i8 100)
+  ret i8 %t
+
+; CHECK: @sadd_2
+; CHECK: ret i8 127
+}
+
+define i8 @sadd_3() nounwind {
+entry:
+  %t = call i8 @llvm.sadd.sat.i8(i8 -100, i8 -100)
+  ret i8 %t
+
+; CHECK: @sadd_3
+; CHECK: ret i8 -128
+}
+
+;;-----------------------------
+;; ssub.sat
+;;-----------------------------
+
+define i8 @ssub_1() nounwind {
+entry:
+  %t = call i8 @llvm.ssub.sat.i8(i8 -100, i8 100)
+  ret i8 %t
+
+; CHECK: @ssub_1
+; CHECK: ret i8 -128
+}
+
+define i8 @ssub_2() nounwind {
+entry:
+  %t = call i8 @llvm.ssub.sat.i8(i8 100, i8 -100)
+  ret i8 %t
+
+; CHECK: @ssub_2
+; CHECK: ret i8 127
+}
+
+;;-----------------------------
+;; smul.fix.sat
+;;-----------------------------
+
+; 0.5 * 0.5 in Q15
+define i16 @smul_fix_1() nounwind {
+entry:
+  %t = call i16 @llvm.smul.fix.sat.i16(i16 16384, i16 16384, i32 15)
+  ret i16 %t
+
+; CHECK: @smul_fix_1
+; CHECK: ret i16 8192
+}
+
+; -1.0 * -1.0 is the only Q15 product that does not fit.
+define i16 @smul_fix_2() nounwind {
+entry:
+  %t = call i16 @llvm.smul.fix.sat.i16(i16 -32768, i16 -32768, i32 15)
+  ret i16 %t
+
+; CHECK: @smul_fix_2
+; CHECK: ret i16 32767
+}
+
+; The product is rounded towards minus infinity.
+define i16 @smul_fix_3() nounwind {
+entry:
+  %t = call i16 @llvm.smul.fix.sat.i16(i16 -3, i16 5, i32 2)
+  ret i16 %t
+
+; CHECK: @smul_fix_3
+; CHECK: ret i16 -4
+}
+
+define i8 @smul_fix_4() nounwind {
+entry:
+  %t = call i8 @llvm.smul.fix.sat.i8(i8 -100, i8 100, i32 0)
+  ret i8 %t
+
+; CHECK: @smul_fix_4
+; CHECK: ret i8 -128
+}
+
+declare i8 @llvm.sadd.sat.i8(i8, i8)
+declare i8 @llvm.ssub.sat.i8(i8, i8)
+declare i8 @llvm.smul.fix.sat.i8(i8, i8, i32)
+declare i16 @llvm.smul.fix.sat.i16(i16, i16, i32)
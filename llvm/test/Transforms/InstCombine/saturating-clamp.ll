@@ -0,0 +1,110 @@
+; RUN: opt < %s -instcombine -S | FileCheck %s
+
+; Q15 addition written as a clamp of the widened sum.
+define i16 @add16(i16 %a, i16 %b) nounwind {
+; CHECK: @add16
+; CHECK-NEXT: call i16 @llvm.sadd.sat.i16(i16 %a, i16 %b)
+; CHECK-NEXT: ret i16
+  %ea = sext i16 %a to i32
+  %eb = sext i16 %b to i32
+  %s = add nsw i32 %ea, %eb
+  %c1 = icmp sgt i32 %s, 32767
+  %m1 = select i1 %c1, i32 32767, i32 %s
+  %c2 = icmp slt i32 %m1, -32768
+  %m2 = select i1 %c2, i32 -32768, i32 %m1
+  %t = trunc i32 %m2 to i16
+  ret i16 %t
+}
+
+; Both compares test the sum itself, as in if/else-if clamping code.
+define i32 @sub32(i32 %a, i32 %b) nounwind {
+; CHECK: @sub32
+; CHECK-NEXT: call i32 @llvm.ssub.sat.i32(i32 %a, i32 %b)
+; CHECK-NEXT: ret i32
+  %ea = sext i32 %a to i64
+  %eb = sext i32 %b to i64
+  %s = sub nsw i64 %ea, %eb
+  %c1 = icmp sgt i64 %s, 2147483647
+  %c2 = icmp slt i64 %s, -2147483648
+  %m1 = select i1 %c2, i64 -2147483648, i64 %s
+  %m2 = select i1 %c1, i64 2147483647, i64 %m1
+  %t = trunc i64 %m2 to i32
+  ret i32 %t
+}
+
+; Q15 multiplication by a constant coefficient, kept in an int.
+define i32 @mul15(i16 %a) nounwind {
+; CHECK: @mul15
+; CHECK-NEXT: call i16 @llvm.smul.fix.sat.i16(i16 %a, i16 1234, i32 15)
+; CHECK-NEXT: sext i16
+; CHECK-NEXT: ret i32
+  %ea = sext i16 %a to i32
+  %p = mul nsw i32 %ea, 1234
+  %q = ashr i32 %p, 15
+  %c1 = icmp sge i32 %q, 32767
+  %m1 = select i1 %c1, i32 32767, i32 %q
+  %c2 = icmp sle i32 %m1, -32768
+  %m2 = select i1 %c2, i32 -32768, i32 %m1
+  ret i32 %m2
+}
+
+define i16 @mul15b(i16 %a, i16 %b) nounwind {
+; CHECK: @mul15b
+; CHECK-NEXT: call i16 @llvm.smul.fix.sat.i16(i16 %a, i16 %b, i32 15)
+; CHECK-NEXT: ret i16
+  %ea = sext i16 %a to i32
+  %eb = sext i16 %b to i32
+  %p = mul nsw i32 %ea, %eb
+  %q = ashr i32 %p, 15
+  %c1 = icmp slt i32 %q, -32768
+  %m1 = select i1 %c1, i32 -32768, i32 %q
+  %c2 = icmp sgt i32 %m1, 32767
+  %m2 = select i1 %c2, i32 32767, i32 %m1
+  %t = trunc i32 %m2 to i16
+  ret i16 %t
+}
+
+; An i8 operand is extended to the type of the clamp.
+define i16 @mixed(i16 %a, i8 %b) nounwind {
+; CHECK: @mixed
+; CHECK-NEXT: sext i8 %b to i16
+; CHECK-NEXT: call i16 @llvm.sadd.sat.i16
+  %ea = sext i16 %a to i32
+  %eb = sext i8 %b to i32
+  %s = add nsw i32 %ea, %eb
+  %c1 = icmp sgt i32 %s, 32767
+  %m1 = select i1 %c1, i32 32767, i32 %s
+  %c2 = icmp slt i32 %m1, -32768
+  %m2 = select i1 %c2, i32 -32768, i32 %m1
+  %t = trunc i32 %m2 to i16
+  ret i16 %t
+}
+
+; The bounds are not the range of a narrower type.
+define i32 @range(i16 %a, i16 %b) nounwind {
+; CHECK: @range
+; CHECK-NOT: sat
+; CHECK: ret i32
+  %ea = sext i16 %a to i32
+  %eb = sext i16 %b to i32
+  %s = add nsw i32 %ea, %eb
+  %c1 = icmp sgt i32 %s, 32000
+  %m1 = select i1 %c1, i32 32000, i32 %s
+  %c2 = icmp slt i32 %m1, -32768
+  %m2 = select i1 %c2, i32 -32768, i32 %m1
+  ret i32 %m2
+}
+
+; The sum of two i32 values does not fit in i32.
+define i16 @wide(i32 %a, i32 %b) nounwind {
+; CHECK: @wide
+; CHECK-NOT: sat
+; CHECK: ret i16
+  %s = add i32 %a, %b
+  %c1 = icmp sgt i32 %s, 32767
+  %m1 = select i1 %c1, i32 32767, i32 %s
+  %c2 = icmp slt i32 %m1, -32768
+  %m2 = select i1 %c2, i32 -32768, i32 %m1
+  %t = trunc i32 %m2 to i16
+  ret i16 %t
+}
@@ -0,0 +1,9 @@
+; RUN: not llvm-as %s -o /dev/null |& grep {llvm.smul.fix.sat parameter #3 must be a constant integer smaller than the bit width}
+
+define i16 @f(i16 %a, i16 %b) nounwind {
+entry:
+  %r = call i16 @llvm.smul.fix.sat.i16(i16 %a, i16 %b, i32 16)
+  ret i16 %r
+}
+
+declare i16 @llvm.smul.fix.sat.i16(i16, i16, i32)
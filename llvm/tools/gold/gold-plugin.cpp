@@ -17,6 +17,8 @@
 
 #include "llvm-c/lto.h"
 
+#include "llvm/ADT/StringExtras.h"
+
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/Errno.h"
 #include "llvm/Support/Path.h"
@@ -76,6 +78,10 @@ namespace options {
   static std::string extra_library_path;
   static std::string triple;
   static std::string mcpu;
+  // The number of object files to generate at once.
+  static unsigned partitions = 1;
+  // Where to keep the object files of partitions from one link to the next.
+  static std::string cache_dir;
   // Additional options to pass into the code generator.
   // Note: This array will contain all plugin options which are not claimed
   // as plugin exclusive to pass to the code generator.
@@ -99,6 +105,14 @@ namespace options {
       triple = opt.substr(strlen("mtriple="));
     } else if (opt.startswith("obj-path=")) {
       obj_path = opt.substr(strlen("obj-path="));
+    } else if (opt.startswith("partitions=")) {
+      if (opt.substr(strlen("partitions=")).getAsInteger(10, partitions) ||
+          partitions == 0) {
+        (*message)(LDPL_WARNING, "Invalid number of partitions %s", opt_);
+        partitions = 1;
+      }
+    } else if (opt.startswith("cache-dir=")) {
+      cache_dir = opt.substr(strlen("cache-dir="));
     } else if (opt == "emit-llvm") {
       generate_bc_file = BC_ONLY;
     } else if (opt == "also-emit-llvm") {
@@ -365,6 +379,44 @@ static ld_plugin_status claim_file_hook(const ld_plugin_input_file *file,
 /// At this point, we use get_symbols to see if any of our definitions have
 /// been overridden by a native object file. Then, perform optimization and
 /// codegen.
+/// write_object - Write an object file generated by libLTO to obj-path, with
+/// the index of the object appended to all but the first, or else to a
+/// temporary file.  objPath is set to the file written.
+static ld_plugin_status write_object(const char *buffer, size_t bufsize,
+                                     unsigned index, std::string &objPath) {
+  std::string ErrMsg;
+
+  sys::Path uniqueObjPath("/tmp/llvmgold.o");
+  if (!options::obj_path.empty()) {
+    objPath = options::obj_path;
+    if (index != 0)
+      objPath += "." + utostr(index);
+  } else {
+    if (uniqueObjPath.createTemporaryFileOnDisk(true, &ErrMsg)) {
+      (*message)(LDPL_ERROR, "%s", ErrMsg.c_str());
+      return LDPS_ERR;
+    }
+    objPath = uniqueObjPath.str();
+  }
+  tool_output_file objFile(objPath.c_str(), ErrMsg,
+                             raw_fd_ostream::F_Binary);
+    if (!ErrMsg.empty()) {
+      (*message)(LDPL_ERROR, "%s", ErrMsg.c_str());
+      return LDPS_ERR;
+    }
+
+  objFile.os().write(buffer, bufsize);
+  objFile.os().close();
+  if (objFile.os().has_error()) {
+    (*message)(LDPL_ERROR, "Error writing output file '%s'",
+               objPath.c_str());
+    objFile.os().clear_error();
+    return LDPS_ERR;
+  }
+  objFile.keep();
+  return LDPS_OK;
+}
+
 static ld_plugin_status all_symbols_read_hook(void) {
   std::ofstream api_file;
   assert(code_gen);
@@ -408,6 +460,9 @@ static ld_plugin_status all_symbols_read_hook(void) {
   if (!options::mcpu.empty())
     lto_codegen_set_cpu(code_gen, options::mcpu.c_str());
 
+  if (!options::cache_dir.empty())
+    lto_codegen_set_cache_dir(code_gen, options::cache_dir.c_str());
+
   // Pass through extra options to the code generator.
   if (!options::extra.empty()) {
     for (std::vector<std::string>::iterator it = options::extra.begin();
@@ -430,39 +485,30 @@ static ld_plugin_status all_symbols_read_hook(void) {
     if (options::generate_bc_file == options::BC_ONLY)
       exit(0);
   }
-  size_t bufsize = 0;
-  const char *buffer = static_cast<const char *>(lto_codegen_compile(code_gen,
-                                                                     &bufsize));
-
-  std::string ErrMsg;
-
-  const char *objPath;
-  sys::Path uniqueObjPath("/tmp/llvmgold.o");
-  if (!options::obj_path.empty()) {
-    objPath = options::obj_path.c_str();
-  } else {
-    if (uniqueObjPath.createTemporaryFileOnDisk(true, &ErrMsg)) {
-      (*message)(LDPL_ERROR, "%s", ErrMsg.c_str());
+  std::vector<std::string> objPaths;
+  if (options::partitions > 1 || !options::cache_dir.empty()) {
+    unsigned count = lto_codegen_compile_partitions(code_gen,
+                                                    options::partitions);
+    if (count == 0) {
+      (*message)(LDPL_ERROR, "%s", lto_get_error_message());
       return LDPS_ERR;
     }
-    objPath = uniqueObjPath.c_str();
-  }
-  tool_output_file objFile(objPath, ErrMsg,
-                             raw_fd_ostream::F_Binary);
-    if (!ErrMsg.empty()) {
-      (*message)(LDPL_ERROR, "%s", ErrMsg.c_str());
-      return LDPS_ERR;
+    for (unsigned i = 0; i != count; ++i) {
+      size_t bufsize = 0;
+      const char *buffer = static_cast<const char *>(
+        lto_codegen_get_partition(code_gen, i, &bufsize));
+      objPaths.push_back(std::string());
+      if (write_object(buffer, bufsize, i, objPaths.back()) != LDPS_OK)
+        return LDPS_ERR;
     }
-
-  objFile.os().write(buffer, bufsize);
-  objFile.os().close();
-  if (objFile.os().has_error()) {
-    (*message)(LDPL_ERROR, "Error writing output file '%s'",
-               objPath);
-    objFile.os().clear_error();
-    return LDPS_ERR;
+  } else {
+    size_t bufsize = 0;
+    const char *buffer = static_cast<const char *>(
+      lto_codegen_compile(code_gen, &bufsize));
+    objPaths.push_back(std::string());
+    if (write_object(buffer, bufsize, 0, objPaths.back()) != LDPS_OK)
+      return LDPS_ERR;
   }
-  objFile.keep();
 
   lto_codegen_dispose(code_gen);
   for (std::list<claimed_file>::iterator I = Modules.begin(),
@@ -473,10 +519,13 @@ static ld_plugin_status all_symbols_read_hook(void) {
     }
   }
 
-  if ((*add_input_file)(objPath) != LDPS_OK) {
-    (*message)(LDPL_ERROR, "Unable to add .o file to the link.");
-    (*message)(LDPL_ERROR, "File left behind in: %s", objPath);
-    return LDPS_ERR;
+  for (unsigned i = 0, e = objPaths.size(); i != e; ++i) {
+    const char *objPath = objPaths[i].c_str();
+    if ((*add_input_file)(objPath) != LDPS_OK) {
+      (*message)(LDPL_ERROR, "Unable to add .o file to the link.");
+      (*message)(LDPL_ERROR, "File left behind in: %s", objPath);
+      return LDPS_ERR;
+    }
   }
 
   if (!options::extra_library_path.empty() &&
@@ -486,7 +535,8 @@ static ld_plugin_status all_symbols_read_hook(void) {
   }
 
   if (options::obj_path.empty())
-    Cleanup.push_back(sys::Path(objPath));
+    for (unsigned i = 0, e = objPaths.size(); i != e; ++i)
+      Cleanup.push_back(sys::Path(objPaths[i]));
 
   return LDPS_OK;
 }
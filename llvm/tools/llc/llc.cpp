@@ -109,6 +109,53 @@ NoImplicitFloats("no-implicit-float",
   cl::desc("Don't generate implicit floating point instructions (x86-only)"),
   cl::init(false));
 
+static cl::opt<bool>
+DisableLazyMaterialize("disable-lazy-materialize", cl::Hidden,
+  cl::desc("Read all functions of the input bitcode before generating code"),
+  cl::init(false));
+
+namespace {
+  /// FunctionDematerializer - Frees the body of each function once the code
+  /// generator is done with it, so that only the functions being compiled
+  /// are in memory when the input is a lazily read bitcode file.
+  struct FunctionDematerializer : public FunctionPass {
+    static char ID;
+    FunctionDematerializer() : FunctionPass(ID) {}
+
+    virtual bool runOnFunction(Function &F) {
+      // The blockaddress constants of a block would not survive reading its
+      // function again.
+      for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+        if (BB->hasAddressTaken())
+          return false;
+      F.Dematerialize();
+      return false;
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesAll();
+    }
+
+    virtual const char *getPassName() const {
+      return "Function Dematerializer";
+    }
+  };
+}
+
+char FunctionDematerializer::ID = 0;
+
+/// HasDebugInfo - Return true if M has debug info.  The debug info printer
+/// looks for it in every function body before the first function is compiled,
+/// so a module with debug info has to be read in whole.  Front ends list the
+/// subprograms in llvm.dbg.sp, and variables are declared with intrinsics.
+static bool HasDebugInfo(const Module &M) {
+  for (Module::const_named_metadata_iterator I = M.named_metadata_begin(),
+         E = M.named_metadata_end(); I != E; ++I)
+    if (I->getName().startswith("llvm.dbg."))
+      return true;
+  return M.getFunction("llvm.dbg.declare") || M.getFunction("llvm.dbg.value");
+}
+
 // GetFileNameRoot - Helper function to get the basename of a filename.
 static inline std::string
 GetFileNameRoot(const std::string &InputFilename) {
@@ -212,13 +259,28 @@ int main(int argc, char **argv) {
   SMDiagnostic Err;
   std::auto_ptr<Module> M;
 
-  M.reset(ParseIRFile(InputFilename, Err, Context));
+  // Read the functions of bitcode input one at a time as the code generator
+  // gets to them, rather than all of them up front.
+  bool LazyMaterialize = !DisableLazyMaterialize;
+  if (LazyMaterialize)
+    M.reset(getLazyIRFileModule(InputFilename, Err, Context));
+  else
+    M.reset(ParseIRFile(InputFilename, Err, Context));
   if (M.get() == 0) {
     Err.Print(argv[0], errs());
     return 1;
   }
   Module &mod = *M.get();
 
+  if (LazyMaterialize && HasDebugInfo(mod)) {
+    LazyMaterialize = false;
+    std::string ErrInfo;
+    if (mod.MaterializeAllPermanently(&ErrInfo)) {
+      errs() << argv[0] << ": " << InputFilename << ": " << ErrInfo << "\n";
+      return 1;
+    }
+  }
+
   // If we are supposed to override the target triple, do so now.
   if (!TargetTriple.empty())
     mod.setTargetTriple(Triple::normalize(TargetTriple));
@@ -338,6 +400,12 @@ int main(int argc, char **argv) {
       return 1;
     }
 
+    // Module passes, such as those of the C backend, still see every body.
+    if (LazyMaterialize) {
+      PM.setMaterializeForModulePasses(true);
+      PM.add(new FunctionDematerializer());
+    }
+
     PM.run(mod);
   }
 
@@ -109,6 +109,7 @@ static const char *GetBlockName(unsigned BlockID,
   case bitc::VALUE_SYMTAB_BLOCK_ID:  return "VALUE_SYMTAB";
   case bitc::METADATA_BLOCK_ID:      return "METADATA_BLOCK";
   case bitc::METADATA_ATTACHMENT_ID: return "METADATA_ATTACHMENT_BLOCK";
+  case bitc::SUMMARY_BLOCK_ID:       return "SUMMARY_BLOCK";
   }
 }
 
@@ -279,6 +280,11 @@ static const char *GetCodeName(unsigned CodeID, unsigned BlockID,
     case bitc::METADATA_FN_NODE2:    return "METADATA_FN_NODE2";
     case bitc::METADATA_NAMED_NODE2: return "METADATA_NAMED_NODE2";
     }
+  case bitc::SUMMARY_BLOCK_ID:
+    switch(CodeID) {
+    default:return 0;
+    case bitc::SUMMARY_CODE_FUNCTION: return "FUNCTION";
+    }
   }
 }
 
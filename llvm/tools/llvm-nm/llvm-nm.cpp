@@ -212,8 +212,18 @@ static void SortAndPrintSymbolList() {
   SymbolList.clear();
 }
 
+/// isUndefined - The function bodies are not read, a function whose body is
+/// still in the file is a definition all the same.
+static bool isUndefined(const GlobalValue &GV) {
+  const GlobalValue *Def = &GV;
+  if (const GlobalAlias *GA = dyn_cast<GlobalAlias>(&GV))
+    if (const GlobalValue *AliasedGV = GA->getAliasedGlobal())
+      Def = AliasedGV;
+  return GV.isDeclaration() && !Def->isMaterializable();
+}
+
 static char TypeCharForSymbol(GlobalValue &GV) {
-  if (GV.isDeclaration())                                  return 'U';
+  if (isUndefined(GV))                                     return 'U';
   if (GV.hasLinkOnceLinkage())                             return 'C';
   if (GV.hasCommonLinkage())                               return 'C';
   if (GV.hasWeakLinkage())                                 return 'W';
@@ -294,8 +304,13 @@ static void DumpSymbolNamesFromFile(std::string &Filename) {
     if (error_code ec = MemoryBuffer::getFileOrSTDIN(Filename, Buffer))
       ErrorMessage = ec.message();
     Module *Result = 0;
-    if (Buffer.get())
-      Result = ParseBitcodeFile(Buffer.get(), Context, &ErrorMessage);
+    if (Buffer.get()) {
+      // The symbols are all in the header of the module, there is no need to
+      // read the function bodies.
+      Result = getLazyBitcodeModule(Buffer.get(), Context, &ErrorMessage);
+      if (Result)
+        Buffer.take();
+    }
 
     if (Result) {
       DumpSymbolNamesFromModule(Result);
@@ -21,6 +21,8 @@
 #include "llvm/LLVMContext.h"
 #include "llvm/Module.h"
 #include "llvm/PassManager.h"
+#include "llvm/TypeSymbolTable.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Analysis/Passes.h"
@@ -43,7 +45,9 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/system_error.h"
+#include "llvm/Transforms/Utils/PartitionModule.h"
 #include "llvm/Config/config.h"
 #include <cstdlib>
 #include <unistd.h>
@@ -81,12 +85,15 @@ LTOCodeGenerator::~LTOCodeGenerator()
 {
     delete _target;
     delete _nativeObjectFile;
+    for (unsigned i = 0, e = _partitionObjectFiles.size(); i != e; ++i)
+      delete _partitionObjectFiles[i];
 }
 
 
 
 bool LTOCodeGenerator::addModule(LTOModule* mod, std::string& errMsg)
 {
+  // the linker reads the function bodies LTOModule left in the file
   bool ret = _linker.LinkInModule(mod->getLLVVMModule(), &errMsg);
 
   const std::vector<const char*> &undefs = mod->getAsmUndefinedRefs();
@@ -132,6 +139,11 @@ void LTOCodeGenerator::setCpu(const char* mCpu)
   _mCpu = mCpu;
 }
 
+void LTOCodeGenerator::setCacheDir(const char* path)
+{
+  _cacheDir = path;
+}
+
 void LTOCodeGenerator::addMustPreserveSymbol(const char* sym)
 {
     _mustPreserveSymbols[sym] = 1;
@@ -250,6 +262,10 @@ bool LTOCodeGenerator::determineTarget(std::string& errMsg)
         Features.getDefaultSubtargetFeatures(_mCpu, llvm::Triple(Triple));
         std::string FeatureStr = Features.getString();
         _target = march->createTargetMachine(Triple, FeatureStr);
+
+        // remembered to make more target machines like it
+        _targetTriple = Triple;
+        _targetFeatures = FeatureStr;
     }
     return false;
 }
@@ -339,8 +355,7 @@ void LTOCodeGenerator::applyScopeRestrictions() {
 }
 
 /// Optimize merged modules using various IPO passes
-bool LTOCodeGenerator::generateObjectFile(raw_ostream& out,
-                                          std::string& errMsg)
+bool LTOCodeGenerator::optimize(std::string& errMsg)
 {
     if ( this->determineTarget(errMsg) ) 
         return true;
@@ -370,27 +385,35 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream& out,
     // Make sure everything is still good.
     passes.add(createVerifierPass());
 
-    FunctionPassManager* codeGenPasses = new FunctionPassManager(mergedModule);
+    // Run our queue of passes all at once now, efficiently.
+    passes.run(*mergedModule);
+
+    return false;
+}
+
+/// Generate code for the function bodies of a module into an object file
+static bool emitObjectFile(TargetMachine &target, Module *module,
+                           raw_ostream &out, std::string &errMsg)
+{
+    FunctionPassManager* codeGenPasses = new FunctionPassManager(module);
 
-    codeGenPasses->add(new TargetData(*_target->getTargetData()));
+    codeGenPasses->add(new TargetData(*target.getTargetData()));
 
     formatted_raw_ostream Out(out);
 
-    if (_target->addPassesToEmitFile(*codeGenPasses, Out,
-                                     TargetMachine::CGFT_ObjectFile,
-                                     CodeGenOpt::Aggressive)) {
+    if (target.addPassesToEmitFile(*codeGenPasses, Out,
+                                   TargetMachine::CGFT_ObjectFile,
+                                   CodeGenOpt::Aggressive)) {
       errMsg = "target file type not supported";
+      delete codeGenPasses;
       return true;
     }
 
-    // Run our queue of passes all at once now, efficiently.
-    passes.run(*mergedModule);
-
     // Run the code generator, and write assembly file
     codeGenPasses->doInitialization();
 
     for (Module::iterator
-           it = mergedModule->begin(), e = mergedModule->end(); it != e; ++it)
+           it = module->begin(), e = module->end(); it != e; ++it)
       if (!it->isDeclaration())
         codeGenPasses->run(*it);
 
@@ -400,6 +423,197 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream& out,
     return false; // success
 }
 
+bool LTOCodeGenerator::generateObjectFile(raw_ostream& out,
+                                          std::string& errMsg)
+{
+    if ( this->optimize(errMsg) )
+        return true;
+
+    return emitObjectFile(*_target, _linker.getModule(), out, errMsg);
+}
+
+
+namespace {
+  /// PartitionJob - The code generation of one partition of the merged module,
+  /// on a thread of its own.
+  struct PartitionJob {
+    TargetMachine *Target;
+    Module        *M;
+    std::string    Object;
+    std::string    ErrMsg;
+    bool           Failed;
+  };
+}
+
+static void generatePartition(void *arg)
+{
+    PartitionJob &job = *static_cast<PartitionJob*>(arg);
+    raw_string_ostream out(job.Object);
+    job.Failed = emitObjectFile(*job.Target, job.M, out, job.ErrMsg);
+}
+
+/// Optimize merged modules, then split them up and generate code for each
+/// part at the same time.  Returns the number of object files, 0 on error.
+unsigned LTOCodeGenerator::compilePartitions(unsigned numPartitions,
+                                             std::string& errMsg)
+{
+    // remove old objects if compilePartitions() called twice
+    for (unsigned i = 0, e = _partitionObjectFiles.size(); i != e; ++i)
+      delete _partitionObjectFiles[i];
+    _partitionObjectFiles.clear();
+
+    if ( this->optimize(errMsg) )
+        return 0;
+
+    // with a cache, a group of definitions stays in the same partition from
+    // one link to the next, so that an edit only changes the partitions it
+    // touches
+    std::vector<Module*> partitions;
+    PartitionModule(_linker.getModule(), numPartitions, !_cacheDir.empty(),
+                    partitions);
+
+    // each partition that is not in the cache gets a target machine of its
+    // own
+    std::vector<PartitionJob> jobs(partitions.size());
+    std::vector<std::string> keys(partitions.size());
+    std::vector<void*> args;
+    for (unsigned i = 0, e = partitions.size(); i != e; ++i) {
+      jobs[i].Target = NULL;
+      jobs[i].M = partitions[i];
+      jobs[i].Failed = false;
+      if (!_cacheDir.empty()) {
+        keys[i] = this->getCacheKey(partitions[i]);
+        if (this->readCachedObject(keys[i], jobs[i].Object))
+          continue;
+      }
+      jobs[i].Target = _target->getTarget().createTargetMachine(_targetTriple,
+                                                               _targetFeatures);
+      args.push_back(&jobs[i]);
+    }
+
+    // the context is only locked once LLVM is multithreaded
+    if (args.size() > 1 &&
+        (llvm_is_multithreaded() || llvm_start_multithreaded()))
+      llvm_execute_in_parallel(generatePartition, &args[0], args.size());
+    else
+      for (unsigned i = 0, e = args.size(); i != e; ++i)
+        generatePartition(args[i]);
+
+    bool failed = false;
+    for (unsigned i = 0, e = jobs.size(); i != e; ++i) {
+      if (jobs[i].Failed && !failed) {
+        errMsg = jobs[i].ErrMsg;
+        failed = true;
+      }
+      if (!failed) {
+        if (jobs[i].Target && !_cacheDir.empty())
+          this->writeCachedObject(keys[i], jobs[i].Object);
+        _partitionObjectFiles.push_back(
+          MemoryBuffer::getMemBufferCopy(jobs[i].Object, "lto-llvm.o"));
+      }
+      delete jobs[i].M;
+      delete jobs[i].Target;
+    }
+
+    if (failed) {
+      for (unsigned i = 0, e = _partitionObjectFiles.size(); i != e; ++i)
+        delete _partitionObjectFiles[i];
+      _partitionObjectFiles.clear();
+      return 0;
+    }
+    return _partitionObjectFiles.size();
+}
+
+/// 64-bit FNV-1a hash, which names the files of a cache entry
+static uint64_t hashCacheKey(StringRef key)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned i = 0, e = key.size(); i != e; ++i) {
+      hash ^= (unsigned char)key[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Everything the object file of a partition depends on: the version of
+/// LLVM, the target and code generator options, and the bitcode of the
+/// partition, which holds the declarations it references.
+std::string LTOCodeGenerator::getCacheKey(Module *partition)
+{
+    std::string key;
+    raw_string_ostream out(key);
+    out << getVersionString() << '\0' << _targetTriple << '\0'
+        << _targetFeatures << '\0' << _codeModel << '\0'
+        << _emitDwarfDebugInfo << '\0';
+    for (unsigned i = 0, e = _codegenOptions.size(); i != e; ++i)
+      out << _codegenOptions[i] << '\0';
+    WriteBitcodeToFile(partition, out);
+    out.flush();
+    return key;
+}
+
+/// Look for the object file of key in the cache.  An entry is the key itself
+/// and the object file, in files named after the hash of the key.
+bool LTOCodeGenerator::readCachedObject(const std::string &key,
+                                        std::string &object)
+{
+    std::string base = _cacheDir + "/" + utohexstr(hashCacheKey(key));
+
+    OwningPtr<MemoryBuffer> keyFile;
+    if (MemoryBuffer::getFile(base + ".key", keyFile) ||
+        keyFile->getBuffer() != key)
+      return false;
+
+    OwningPtr<MemoryBuffer> objFile;
+    if (MemoryBuffer::getFile(base + ".o", objFile))
+      return false;
+    object = objFile->getBuffer();
+    return true;
+}
+
+/// Write a file of the cache under a temporary name first, so that a link
+/// running at the same time never sees half of it
+static bool writeCacheFile(const std::string &path, const std::string &data)
+{
+    sys::Path tmpPath(path);
+    if (tmpPath.createTemporaryFileOnDisk(false, NULL))
+      return false;
+
+    std::string errInfo;
+    raw_fd_ostream out(tmpPath.c_str(), errInfo, raw_fd_ostream::F_Binary);
+    if (errInfo.empty()) {
+      out << data;
+      out.close();
+      if (!out.has_error() && !tmpPath.renamePathOnDisk(sys::Path(path), NULL))
+        return true;
+      out.clear_error();
+    }
+    tmpPath.eraseFromDisk();
+    return false;
+}
+
+/// Add an object file to the cache.  The object file goes first, so that
+/// the key is only there once the entry is complete.  The cache is only an
+/// optimization: when it can not be written, the link goes on all the same.
+void LTOCodeGenerator::writeCachedObject(const std::string &key,
+                                         const std::string &object)
+{
+    if (sys::Path(_cacheDir).createDirectoryOnDisk(true, NULL))
+      return;
+
+    std::string base = _cacheDir + "/" + utohexstr(hashCacheKey(key));
+    if (writeCacheFile(base + ".o", object))
+      writeCacheFile(base + ".key", key);
+}
+
+const void* LTOCodeGenerator::getPartition(unsigned index, size_t* length)
+{
+    if (index >= _partitionObjectFiles.size())
+      return NULL;
+    *length = _partitionObjectFiles[index]->getBufferSize();
+    return _partitionObjectFiles[index]->getBufferStart();
+}
+
 
 /// Optimize merged modules using various IPO passes
 void LTOCodeGenerator::setCodeGenDebugOptions(const char* options)
@@ -22,6 +22,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 
 #include <string>
+#include <vector>
 
 
 //
@@ -38,14 +39,24 @@ struct LTOCodeGenerator {
     bool                setDebugInfo(lto_debug_model, std::string& errMsg);
     bool                setCodePICModel(lto_codegen_model, std::string& errMsg);
     void                setCpu(const char *cpu);
+    void                setCacheDir(const char *path);
     void                addMustPreserveSymbol(const char* sym);
     bool                writeMergedModules(const char* path, 
                                                            std::string& errMsg);
     const void*         compile(size_t* length, std::string& errMsg);
+    unsigned            compilePartitions(unsigned numPartitions,
+                                          std::string& errMsg);
+    const void*         getPartition(unsigned index, size_t* length);
     void                setCodeGenDebugOptions(const char *opts); 
 private:
+    bool                optimize(std::string& errMsg);
     bool                generateObjectFile(llvm::raw_ostream& out, 
                                            std::string& errMsg);
+    std::string         getCacheKey(llvm::Module *partition);
+    bool                readCachedObject(const std::string &key,
+                                         std::string &object);
+    void                writeCachedObject(const std::string &key,
+                                          const std::string &object);
     void                applyScopeRestrictions();
     void                applyRestriction(llvm::GlobalValue &GV,
                                      std::vector<const char*> &mustPreserveList,
@@ -64,8 +75,12 @@ private:
     StringSet                   _mustPreserveSymbols;
     StringSet                   _asmUndefinedRefs;
     llvm::MemoryBuffer*         _nativeObjectFile;
+    std::vector<llvm::MemoryBuffer*> _partitionObjectFiles;
     std::vector<const char*>    _codegenOptions;
     std::string                 _mCpu;
+    std::string                 _targetTriple;
+    std::string                 _targetFeatures;
+    std::string                 _cacheDir;
 };
 
 #endif // LTO_CODE_GENERATOR_H
@@ -91,7 +91,7 @@ LTOModule *LTOModule::makeLTOModule(const char *path,
     errMsg = ec.message();
     return NULL;
   }
-  return makeLTOModule(buffer.get(), errMsg);
+  return makeLTOModule(buffer.take(), errMsg);
 }
 
 LTOModule *LTOModule::makeLTOModule(int fd, const char *path,
@@ -102,7 +102,7 @@ LTOModule *LTOModule::makeLTOModule(int fd, const char *path,
     errMsg = ec.message();
     return NULL;
   }
-  return makeLTOModule(buffer.get(), errMsg);
+  return makeLTOModule(buffer.take(), errMsg);
 }
 
 /// makeBuffer - Create a MemoryBuffer from a memory range.  MemoryBuffer
@@ -125,9 +125,10 @@ LTOModule *LTOModule::makeLTOModule(const void *mem, size_t length,
   OwningPtr<MemoryBuffer> buffer(makeBuffer(mem, length));
   if (!buffer)
     return NULL;
-  return makeLTOModule(buffer.get(), errMsg);
+  return makeLTOModule(buffer.take(), errMsg);
 }
 
+// Takes ownership of buffer.
 LTOModule *LTOModule::makeLTOModule(MemoryBuffer *buffer,
                                     std::string &errMsg) {
   static bool Initialized = false;
@@ -137,10 +138,20 @@ LTOModule *LTOModule::makeLTOModule(MemoryBuffer *buffer,
     Initialized = true;
   }
 
-  // parse bitcode buffer
-  OwningPtr<Module> m(ParseBitcodeFile(buffer, getGlobalContext(), &errMsg));
-  if (!m)
+  // parse the module header, the function bodies are read when the module is
+  // linked in.  The summary tells which globals each body refers to.
+  BitcodeModuleSummary Summary;
+  OwningPtr<Module> m(getLazyBitcodeModule(buffer, getGlobalContext(), Summary,
+                                           &errMsg));
+  if (!m) {
+    delete buffer;
     return NULL;
+  }
+
+  // bitcode written without a summary block has to have its bodies read
+  for (Module::iterator f = m->begin(); f != m->end(); ++f)
+    if (f->isMaterializable() && !Summary.count(f) && f->Materialize(&errMsg))
+      return NULL;
 
   std::string Triple = m->getTargetTriple();
   if (Triple.empty())
@@ -157,7 +168,7 @@ LTOModule *LTOModule::makeLTOModule(MemoryBuffer *buffer,
   std::string FeatureStr = Features.getString();
   TargetMachine *target = march->createTargetMachine(Triple, FeatureStr);
   LTOModule *Ret = new LTOModule(m.take(), target);
-  bool Err = Ret->ParseSymbols();
+  bool Err = Ret->ParseSymbols(Summary);
   if (Err) {
     delete Ret;
     return NULL;
@@ -174,11 +185,21 @@ void LTOModule::setTargetTriple(const char *triple) {
   _module->setTargetTriple(triple);
 }
 
-void LTOModule::addDefinedFunctionSymbol(Function *f, Mangler &mangler) {
+void LTOModule::addDefinedFunctionSymbol(Function *f, Mangler &mangler,
+                                         const BitcodeModuleSummary &Summary) {
   // add to list of defined symbols
   addDefinedSymbol(f, mangler, true);
 
-  // add external symbols referenced by this function.
+  // add external symbols referenced by this function.  If the body has not
+  // been read, they are in its summary.
+  BitcodeModuleSummary::const_iterator s = Summary.find(f);
+  if (f->isMaterializable() && s != Summary.end()) {
+    for (unsigned i = 0, e = s->second.Calls.size(); i != e; ++i)
+      findExternalRefs(s->second.Calls[i], mangler);
+    for (unsigned i = 0, e = s->second.Refs.size(); i != e; ++i)
+      findExternalRefs(s->second.Refs[i], mangler);
+    return;
+  }
   for (Function::iterator b = f->begin(); b != f->end(); ++b) {
     for (BasicBlock::iterator i = b->begin(); i != b->end(); ++i) {
       for (unsigned count = 0, total = i->getNumOperands();
@@ -679,17 +700,17 @@ bool LTOModule::addAsmGlobalSymbols(MCContext &Context) {
   return false;
 }
 
-bool LTOModule::ParseSymbols() {
+bool LTOModule::ParseSymbols(const BitcodeModuleSummary &Summary) {
   // Use mangler to add GlobalPrefix to names to match linker names.
   MCContext Context(*_target->getMCAsmInfo(), NULL);
   Mangler mangler(Context, *_target->getTargetData());
 
-  // add functions
+  // add functions, the ones whose bodies are not read yet are defined
   for (Module::iterator f = _module->begin(); f != _module->end(); ++f) {
-    if (f->isDeclaration())
+    if (f->isDeclaration() && !f->isMaterializable())
       addPotentialUndefinedSymbol(f, mangler);
     else
-      addDefinedFunctionSymbol(f, mangler);
+      addDefinedFunctionSymbol(f, mangler, Summary);
   }
 
   // add data
@@ -708,7 +729,8 @@ bool LTOModule::ParseSymbols() {
   // add aliases
   for (Module::alias_iterator i = _module->alias_begin(),
          e = _module->alias_end(); i != e; ++i) {
-    if (i->isDeclaration())
+    const GlobalValue *aliasee = i->getAliasedGlobal();
+    if (i->isDeclaration() && !(aliasee && aliasee->isMaterializable()))
       addPotentialUndefinedSymbol(i, mangler);
     else
       addDefinedDataSymbol(i, mangler);
@@ -15,6 +15,7 @@
 #define LTO_MODULE_H
 
 #include "llvm/Module.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/ADT/StringMap.h"
@@ -71,7 +72,8 @@ struct LTOModule {
 private:
                             LTOModule(llvm::Module* m, llvm::TargetMachine* t);
 
-    bool                    ParseSymbols();
+    bool                    ParseSymbols(
+                                const llvm::BitcodeModuleSummary &Summary);
     void                    addDefinedSymbol(llvm::GlobalValue* def, 
                                                     llvm::Mangler& mangler, 
                                                     bool isFunction);
@@ -80,7 +82,8 @@ private:
     void                    findExternalRefs(llvm::Value* value, 
                                                 llvm::Mangler& mangler);
     void                    addDefinedFunctionSymbol(llvm::Function* f, 
-                                                        llvm::Mangler &mangler);
+                                                        llvm::Mangler &mangler,
+                                    const llvm::BitcodeModuleSummary &Summary);
     void                    addDefinedDataSymbol(llvm::GlobalValue* v, 
                                                         llvm::Mangler &mangler);
     bool                    addAsmGlobalSymbols(llvm::MCContext &Context);
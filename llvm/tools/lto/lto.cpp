@@ -281,6 +281,38 @@ lto_codegen_compile(lto_code_gen_t cg, size_t* length)
 }
 
 
+//
+// Generates code for all added modules into up to the given number of
+// native object files at once.  Returns the number of object files, or
+// zero on failure (check lto_get_error_message() for details).
+//
+extern unsigned
+lto_codegen_compile_partitions(lto_code_gen_t cg, unsigned partitions)
+{
+  return cg->compilePartitions(partitions, sLastErrorString);
+}
+
+
+//
+// sets the directory that keeps the object files of partitions
+//
+extern void
+lto_codegen_set_cache_dir(lto_code_gen_t cg, const char* path)
+{
+  cg->setCacheDir(path);
+}
+
+
+//
+// Returns the object file of the given partition, or NULL.
+//
+extern const void*
+lto_codegen_get_partition(lto_code_gen_t cg, unsigned index, size_t* length)
+{
+  return cg->getPartition(index, length);
+}
+
+
 //
 // Used to pass extra options to the code generator
 //
@@ -0,0 +1,113 @@
+//===-- mdsp-sim.cpp - MDSP instruction set simulator ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This tool links MDSP ELF objects produced by llc, runs one function on the
+// MDSP simulator and reports its return value and cycle count, optionally
+// with a per function profile of cycles, stalls and issue slot use.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MDSPSimulator.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/system_error.h"
+using namespace llvm;
+
+static cl::list<std::string>
+InputFiles(cl::Positional, cl::desc("<input objects>"), cl::OneOrMore);
+
+static cl::opt<std::string>
+EntryPoint("entry", cl::desc("Function to run (default: main)"),
+           cl::value_desc("function"), cl::init("main"));
+
+static cl::list<std::string>
+Arguments("args", cl::desc("Integer arguments passed to the entry function"),
+          cl::value_desc("arg,..."), cl::CommaSeparated);
+
+static cl::opt<std::string>
+MCPU("mcpu", cl::desc("MDSP core whose timing to simulate (default: generic)"),
+     cl::value_desc("cpu-name"), cl::init("generic"));
+
+static cl::opt<bool>
+PrintProfile("profile", cl::desc("Print cycles, stalls and bundle use per "
+                                 "function"));
+
+static cl::opt<unsigned>
+MaxCycles("max-cycles", cl::desc("Give up after this many cycles (0 to run "
+                                 "until the entry function returns)"),
+          cl::init(100000000));
+
+static cl::opt<unsigned>
+MemorySize("memory-size", cl::desc("Size of the simulated memory in bytes"),
+           cl::init(1 << 24));
+
+static const char *ProgramName;
+
+static int Error(const Twine &Msg) {
+  errs() << ProgramName << ": error: " << Msg << "\n";
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  ProgramName = argv[0];
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  cl::ParseCommandLineOptions(argc, argv, "MDSP instruction set simulator\n");
+
+  MDSPSimulator Sim(MemorySize);
+  std::string ErrMsg;
+
+  if (!Sim.setCPU(MCPU))
+    return Error("unknown MDSP core '" + MCPU + "'");
+
+  // Load and link the objects.
+  for (unsigned i = 0, e = InputFiles.size(); i != e; ++i) {
+    OwningPtr<MemoryBuffer> Buffer;
+    if (error_code ec = MemoryBuffer::getFileOrSTDIN(InputFiles[i], Buffer))
+      return Error("unable to read '" + InputFiles[i] + "': " + ec.message());
+    if (Sim.addObject(Buffer.take(), &ErrMsg))
+      return Error(ErrMsg);
+  }
+  if (Sim.link(&ErrMsg))
+    return Error(ErrMsg);
+
+  uint32_t Entry;
+  if (!Sim.lookupSymbol(EntryPoint, Entry))
+    return Error("entry function '" + EntryPoint + "' not found");
+
+  SmallVector<uint32_t, 8> Args;
+  for (unsigned i = 0, e = Arguments.size(); i != e; ++i) {
+    long long Value;
+    if (StringRef(Arguments[i]).getAsInteger(0, Value))
+      return Error("invalid argument '" + Arguments[i] + "'");
+    Args.push_back((uint32_t)Value);
+  }
+
+  Sim.setOutput(outs());
+  if (Sim.run(Entry, Args, MaxCycles, &ErrMsg))
+    return Error(ErrMsg);
+
+  outs() << "return: " << (int32_t)Sim.getReturnValue() << "\n";
+  outs() << "cycles: " << Sim.getCycles() << "\n";
+  if (PrintProfile) {
+    outs() << "\n";
+    Sim.printProfile(outs());
+  }
+  return 0;
+}
@@ -59,6 +59,30 @@ TEST(AllocatorTest, TestReset) {
   EXPECT_EQ(2U, Alloc.GetNumSlabs());
 }
 
+// Allocate enough bytes to create three slabs, one of them for a big
+// allocation, recycle the allocator, and do it again.  The second round reuses
+// the slabs of the first instead of allocating new ones.
+TEST(AllocatorTest, TestRecycle) {
+  BumpPtrAllocator Alloc(4096, 4096);
+  Alloc.Allocate(3000, 0);
+  void *Second = Alloc.Allocate(3000, 0);
+  Alloc.Allocate(10000, 0);
+  EXPECT_EQ(3U, Alloc.GetNumSlabs());
+
+  size_t SlabBytes = MallocSlabAllocator::getTotalSlabBytes();
+  Alloc.Recycle();
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+  EXPECT_EQ(Second, Alloc.Allocate(3000, 0));
+  Alloc.Allocate(3000, 0);
+  Alloc.Allocate(10000, 0);
+  EXPECT_EQ(3U, Alloc.GetNumSlabs());
+  EXPECT_EQ(SlabBytes, MallocSlabAllocator::getTotalSlabBytes());
+
+  // A reset after a recycle still frees everything but the current slab.
+  Alloc.Reset();
+  EXPECT_EQ(1U, Alloc.GetNumSlabs());
+}
+
 // Test some allocations at varying alignments.
 TEST(AllocatorTest, TestAlignment) {
   BumpPtrAllocator Alloc;
@@ -9,10 +9,15 @@
 
 #include "gtest/gtest.h"
 #include "llvm/Argument.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
 #include "llvm/Instructions.h"
 #include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 using namespace llvm;
 
@@ -139,3 +144,45 @@ TEST_F(CloneInstruction, Exact) {
   SDiv->setIsExact(true);
   EXPECT_TRUE(this->clone(SDiv)->isExact());
 }
+
+TEST(CloneModule, BlockAddress) {
+  LLVMContext context;
+  OwningPtr<Module> M(new Module("test", context));
+  const Type *I8PtrTy = Type::getInt8PtrTy(context);
+
+  // @g comes first, so its body is cloned before the one of @f.
+  Function *G = Function::Create(FunctionType::get(I8PtrTy, false),
+                                 GlobalValue::ExternalLinkage, "g", M.get());
+  Function *F = Function::Create(FunctionType::get(Type::getVoidTy(context),
+                                                   false),
+                                 GlobalValue::ExternalLinkage, "f", M.get());
+  BasicBlock *Entry = BasicBlock::Create(context, "entry", F);
+  BasicBlock *Target = BasicBlock::Create(context, "target", F);
+  BranchInst::Create(Target, Entry);
+  ReturnInst::Create(context, Target);
+  ReturnInst::Create(context, BlockAddress::get(F, Target),
+                     BasicBlock::Create(context, "entry", G));
+
+  GlobalVariable *GV = new GlobalVariable(*M, I8PtrTy, true,
+                                          GlobalValue::ExternalLinkage,
+                                          BlockAddress::get(F, Target), "ga");
+  GV->setSection("addresses");
+  GV->setVisibility(GlobalValue::HiddenVisibility);
+
+  OwningPtr<Module> Clone(CloneModule(M.get()));
+  Function *CloneF = Clone->getFunction("f");
+  Function *CloneG = Clone->getFunction("g");
+  GlobalVariable *CloneGV = Clone->getGlobalVariable("ga");
+
+  BlockAddress *FromGV = cast<BlockAddress>(CloneGV->getInitializer());
+  EXPECT_EQ(CloneF, FromGV->getFunction());
+  EXPECT_EQ(CloneF, FromGV->getBasicBlock()->getParent());
+
+  ReturnInst *Ret = cast<ReturnInst>(CloneG->getEntryBlock().getTerminator());
+  BlockAddress *FromG = cast<BlockAddress>(Ret->getReturnValue());
+  EXPECT_EQ(CloneF, FromG->getFunction());
+  EXPECT_EQ(CloneF, FromG->getBasicBlock()->getParent());
+
+  EXPECT_EQ(std::string("addresses"), CloneGV->getSection());
+  EXPECT_TRUE(CloneGV->hasHiddenVisibility());
+}
@@ -0,0 +1,194 @@
+//===- PartitionModule.cpp - Unit tests for PartitionModule ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "llvm/GlobalAlias.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Analysis/Verifier.h"
+#include "llvm/Assembly/Parser.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/PartitionModule.h"
+
+using namespace llvm;
+
+namespace {
+
+// @big is the heaviest definition and goes to the first partition.  The
+// blockaddresses in @table keep it with @dispatch, the alias of @dispatch
+// stays with it, and @counter is kept with @init, which @big is too heavy to
+// join.  @counter is then used from both partitions, and @init from the
+// llvm.global_ctors of the first one.
+const char *ModuleText =
+  "@llvm.global_ctors = appending global [1 x { i32, void ()* }] "
+  "[{ i32, void ()* } { i32 65535, void ()* @init }]\n"
+  "@counter = internal global i32 0\n"
+  "@table = internal constant [2 x i8*] "
+  "[i8* blockaddress(@dispatch, %a), i8* blockaddress(@dispatch, %b)]\n"
+  "@dispatch_alias = alias i32 (i32)* @dispatch\n"
+  "\n"
+  "define internal void @init() {\n"
+  "  store i32 1, i32* @counter\n"
+  "  ret void\n"
+  "}\n"
+  "\n"
+  "define i32 @dispatch(i32 %i) {\n"
+  "entry:\n"
+  "  %p = getelementptr [2 x i8*]* @table, i32 0, i32 %i\n"
+  "  %t = load i8** %p\n"
+  "  indirectbr i8* %t, [label %a, label %b]\n"
+  "a:\n"
+  "  ret i32 1\n"
+  "b:\n"
+  "  ret i32 2\n"
+  "}\n"
+  "\n"
+  "define i32 @big(i32 %x) {\n"
+  "  %c = load i32* @counter\n"
+  "  %x1 = add i32 %x, %c\n"
+  "  %x2 = mul i32 %x1, %x1\n"
+  "  %x3 = xor i32 %x2, %x\n"
+  "  %x4 = add i32 %x3, 7\n"
+  "  %x5 = mul i32 %x4, %x2\n"
+  "  %x6 = sub i32 %x5, %x1\n"
+  "  %x7 = shl i32 %x6, 3\n"
+  "  %x8 = or i32 %x7, %x4\n"
+  "  %x9 = add i32 %x8, %x3\n"
+  "  %x10 = mul i32 %x9, %x5\n"
+  "  %x11 = xor i32 %x10, %x6\n"
+  "  %x12 = add i32 %x11, %x7\n"
+  "  %x13 = and i32 %x12, 255\n"
+  "  %x14 = urem i32 %x13, 2\n"
+  "  %r = call i32 @dispatch_alias(i32 %x14)\n"
+  "  %s = add i32 %r, %x12\n"
+  "  ret i32 %s\n"
+  "}\n";
+
+class PartitionModuleTest : public testing::Test {
+protected:
+  virtual void SetUp() {
+    SMDiagnostic Error;
+    M.reset(ParseAssemblyString(ModuleText, 0, Error, Context));
+    std::string ErrMsg;
+    raw_string_ostream OS(ErrMsg);
+    Error.Print("", OS);
+    ASSERT_TRUE(M.get() != 0) << OS.str();
+  }
+
+  virtual void TearDown() {
+    DeleteContainerPointers(Partitions);
+  }
+
+  LLVMContext Context;
+  OwningPtr<Module> M;
+  std::vector<Module*> Partitions;
+};
+
+TEST_F(PartitionModuleTest, Groups) {
+  PartitionModule(M.get(), 2, false, Partitions);
+  ASSERT_EQ(2U, Partitions.size());
+  Module *P0 = Partitions[0], *P1 = Partitions[1];
+  std::string ErrMsg;
+  EXPECT_FALSE(verifyModule(*P0, ReturnStatusAction, &ErrMsg)) << ErrMsg;
+  EXPECT_FALSE(verifyModule(*P1, ReturnStatusAction, &ErrMsg)) << ErrMsg;
+
+  // The first partition defines @big and gets the constructors.
+  Function *Big = P0->getFunction("big");
+  ASSERT_TRUE(Big != 0);
+  EXPECT_FALSE(Big->isDeclaration());
+  EXPECT_TRUE(P0->getNamedGlobal("llvm.global_ctors") != 0);
+  EXPECT_TRUE(P1->getNamedGlobal("llvm.global_ctors") == 0);
+  EXPECT_TRUE(P1->getFunction("big") == 0);
+
+  // @dispatch, its alias and the blockaddresses of its blocks stay together.
+  Function *Dispatch = P1->getFunction("dispatch");
+  ASSERT_TRUE(Dispatch != 0);
+  EXPECT_FALSE(Dispatch->isDeclaration());
+  EXPECT_TRUE(P1->getNamedAlias("dispatch_alias") != 0);
+  GlobalVariable *Table = P1->getNamedGlobal("table");
+  ASSERT_TRUE(Table != 0);
+  EXPECT_TRUE(Table->hasInternalLinkage());
+  EXPECT_TRUE(Table->hasInitializer());
+
+  // The other partition declares the alias as a function, and keeps no
+  // declaration of what it does not use.
+  EXPECT_TRUE(P0->getNamedAlias("dispatch_alias") == 0);
+  Function *AliasDecl = P0->getFunction("dispatch_alias");
+  ASSERT_TRUE(AliasDecl != 0);
+  EXPECT_TRUE(AliasDecl->isDeclaration());
+  EXPECT_FALSE(AliasDecl->use_empty());
+  EXPECT_TRUE(P0->getFunction("dispatch") == 0);
+  EXPECT_TRUE(P0->getNamedGlobal("table") == 0);
+
+  // Locals used from both partitions become hidden globals, defined in one
+  // and declared in the other.
+  EXPECT_TRUE(P0->getNamedGlobal("counter") == 0);
+  EXPECT_TRUE(P1->getNamedGlobal("counter") == 0);
+  GlobalVariable *Counter0 = P0->getNamedGlobal("counter.lto_part");
+  GlobalVariable *Counter1 = P1->getNamedGlobal("counter.lto_part");
+  ASSERT_TRUE(Counter0 != 0 && Counter1 != 0);
+  EXPECT_TRUE(Counter0->isDeclaration());
+  EXPECT_FALSE(Counter1->isDeclaration());
+  EXPECT_TRUE(Counter1->hasExternalLinkage());
+  EXPECT_TRUE(Counter0->hasHiddenVisibility());
+  EXPECT_TRUE(Counter1->hasHiddenVisibility());
+
+  EXPECT_TRUE(P0->getFunction("init") == 0);
+  Function *Init0 = P0->getFunction("init.lto_part");
+  Function *Init1 = P1->getFunction("init.lto_part");
+  ASSERT_TRUE(Init0 != 0 && Init1 != 0);
+  EXPECT_TRUE(Init0->isDeclaration());
+  EXPECT_FALSE(Init1->isDeclaration());
+  EXPECT_TRUE(Init1->hasHiddenVisibility());
+
+  // The module itself is left as it is.
+  EXPECT_TRUE(M->getFunction("init")->hasInternalLinkage());
+  EXPECT_TRUE(M->getNamedGlobal("counter") != 0);
+  EXPECT_TRUE(M->getNamedAlias("dispatch_alias") != 0);
+}
+
+TEST_F(PartitionModuleTest, OnePartition) {
+  PartitionModule(M.get(), 1, false, Partitions);
+  ASSERT_EQ(1U, Partitions.size());
+  Module *P0 = Partitions[0];
+  EXPECT_FALSE(P0->getFunction("big")->isDeclaration());
+  EXPECT_FALSE(P0->getFunction("dispatch")->isDeclaration());
+  EXPECT_TRUE(P0->getFunction("init")->hasInternalLinkage());
+  EXPECT_TRUE(P0->getNamedGlobal("counter")->hasInternalLinkage());
+  EXPECT_TRUE(P0->getNamedGlobal("llvm.global_ctors") != 0);
+}
+
+TEST_F(PartitionModuleTest, Stable) {
+  // With Stable set, a group keeps its partition when other code is added.
+  PartitionModule(M.get(), 2, true, Partitions);
+  ASSERT_EQ(2U, Partitions.size());
+  unsigned BigPart = Partitions[0]->getFunction("big") &&
+                     !Partitions[0]->getFunction("big")->isDeclaration()
+                     ? 0 : 1;
+  DeleteContainerPointers(Partitions);
+
+  SMDiagnostic Error;
+  ASSERT_TRUE(ParseAssemblyString("define i32 @extra(i32 %x) {\n"
+                                  "  %y = mul i32 %x, %x\n"
+                                  "  %z = mul i32 %y, %y\n"
+                                  "  %w = mul i32 %z, %z\n"
+                                  "  ret i32 %w\n"
+                                  "}\n", M.get(), Error, Context) != 0);
+  PartitionModule(M.get(), 2, true, Partitions);
+  ASSERT_EQ(2U, Partitions.size());
+  Function *Big = Partitions[BigPart]->getFunction("big");
+  ASSERT_TRUE(Big != 0);
+  EXPECT_FALSE(Big->isDeclaration());
+}
+
+}
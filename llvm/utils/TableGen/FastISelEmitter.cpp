@@ -13,7 +13,9 @@
 //
 // This file scans through the target's tablegen instruction-info files
 // and extracts instructions with obvious-looking patterns, and it emits
-// code to look up these instructions by type and operator.
+// code to look up these instructions by type and operator.  A pattern may
+// also match specific constants, or produce a small tree of instructions
+// and subregister copies.
 //
 //===----------------------------------------------------------------------===//
 
@@ -21,6 +23,7 @@
 #include "Record.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/VectorExtras.h"
 using namespace llvm;
 
@@ -34,6 +37,9 @@ struct InstructionMemo {
   const CodeGenRegisterClass *RC;
   std::string SubRegNo;
   std::vector<std::string>* PhysRegs;
+  /// DstCode - For a pattern that is not a single instruction taking the
+  /// source operands in order, the statements that emit its instructions.
+  std::vector<std::string> DstCode;
 };
 
 /// OperandsSignature - This class holds a description of a list of operand
@@ -95,6 +101,12 @@ struct OperandsSignature {
         // For now, ignore other non-leaf nodes.
         return false;
       }
+      // A specific constant is passed in like any immediate; the pattern
+      // checks its value before it is used.
+      if (dynamic_cast<IntInit*>(Op->getLeafValue())) {
+        Operands.push_back("i");
+        continue;
+      }
       DefInit *OpDI = dynamic_cast<DefInit*>(Op->getLeafValue());
       if (!OpDI)
         return false;
@@ -208,6 +220,167 @@ struct OperandsSignature {
   }
 };
 
+/// DstTreeBuilder - This class builds the code for a destination pattern
+/// that is a tree of instructions.  The instructions are emitted innermost
+/// first, each into a new virtual register that is killed by its user.
+/// Source operands are found by name, so the destination may use them in
+/// any order, more than once, or not at all.
+///
+class DstTreeBuilder {
+  const CodeGenTarget &Target;
+  std::string InstNS;
+
+  /// SrcOperands - The index of each named operand of the source pattern,
+  /// which is also the index of its FastEmit parameter.
+  std::map<std::string, unsigned> SrcOperands;
+  const OperandsSignature &Operands;
+
+  /// NumUses - How many times the destination uses each source operand.
+  /// An operand that is used more than once is never killed.
+  std::map<std::string, unsigned> NumUses;
+
+  unsigned NumTemps;
+
+  std::string newTemp() { return "Tmp" + utostr(NumTemps++); }
+
+  void countUses(TreePatternNode *N) {
+    if (N->isLeaf()) {
+      if (!N->getName().empty())
+        ++NumUses[N->getName()];
+      return;
+    }
+    for (unsigned i = 0, e = N->getNumChildren(); i != e; ++i)
+      countUses(N->getChild(i));
+  }
+
+  /// emitOperand - Compute the kind ("r" or "i") and the FastEmitInst_
+  /// arguments for an operand of a destination instruction.
+  bool emitOperand(TreePatternNode *Op, std::string &Kind, std::string &Args) {
+    if (!Op->isLeaf()) {
+      Kind = "r";
+      Args = emitNode(Op);
+      if (Args.empty())
+        return false;
+      Args += ", true";
+      return true;
+    }
+
+    if (IntInit *II = dynamic_cast<IntInit*>(Op->getLeafValue())) {
+      Kind = "i";
+      Args = utostr((uint64_t)II->getValue()) + "ULL";
+      return true;
+    }
+
+    std::map<std::string, unsigned>::const_iterator I =
+      SrcOperands.find(Op->getName());
+    if (Op->getName().empty() || I == SrcOperands.end())
+      return false;
+    std::string Idx = utostr(I->second);
+    Kind = Operands.Operands[I->second];
+    if (Kind == "r") {
+      Args = "Op" + Idx + ", ";
+      Args += NumUses[Op->getName()] == 1 ? "Op" + Idx + "IsKill" : "false";
+    } else if (Kind == "i") {
+      Args = "imm" + Idx;
+    } else
+      return false;
+    return true;
+  }
+
+  /// emitNode - Append the code for the instruction at N and its operands,
+  /// and return the name of the register holding its result.  Return an
+  /// empty string if N can't be emitted.
+  std::string emitNode(TreePatternNode *N) {
+    Record *Op = N->getOperator();
+    if (!Op->isSubClassOf("Instruction") || N->getNumTypes() != 1)
+      return "";
+
+    std::string Kind, Args;
+
+    if (Op->getName() == "EXTRACT_SUBREG" ||
+        Op->getName() == "COPY_TO_REGCLASS") {
+      if (N->getNumChildren() != 2 || !N->getChild(1)->isLeaf() ||
+          !emitOperand(N->getChild(0), Kind, Args) || Kind != "r")
+        return "";
+      DefInit *DI = dynamic_cast<DefInit*>(N->getChild(1)->getLeafValue());
+      if (!DI)
+        return "";
+      std::string Temp = newTemp();
+      if (Op->getName() == "EXTRACT_SUBREG") {
+        if (!DI->getDef()->isSubClassOf("SubRegIndex"))
+          return "";
+        Code.push_back("unsigned " + Temp + " = FastEmitInst_extractsubreg(" +
+                       getName(N->getType(0)) + ", " + Args + ", " +
+                       getQualifiedName(DI->getDef()) + ");");
+      } else {
+        if (!DI->getDef()->isSubClassOf("RegisterClass"))
+          return "";
+        const CodeGenRegisterClass &RC = Target.getRegisterClass(DI->getDef());
+        Code.push_back("unsigned " + Temp + " = FastEmitInst_copytoregclass(" +
+                       InstNS + RC.getName() + "RegisterClass, " + Args +
+                       ");");
+      }
+      return Temp;
+    }
+
+    // Otherwise this must be a target instruction with one register result
+    // whose operands each map to a single machine operand.
+    CodeGenInstruction &II = Target.getInstruction(Op);
+    if (II.Namespace == "TargetOpcode" || II.Operands.NumDefs != 1 ||
+        !II.Operands[0].Rec->isSubClassOf("RegisterClass") ||
+        II.Operands.size() != N->getNumChildren() + 1)
+      return "";
+
+    std::string Suffix, AllArgs;
+    for (unsigned i = 0, e = N->getNumChildren(); i != e; ++i) {
+      if (II.Operands[i + 1].MINumOperands != 1 ||
+          !emitOperand(N->getChild(i), Kind, Args))
+        return "";
+      Suffix += Kind;
+      AllArgs += ", " + Args;
+    }
+
+    // Only the operand lists that FastISel has FastEmitInst_ methods for;
+    // registers always come before the immediate.
+    if (Suffix != "" && Suffix != "r" && Suffix != "rr" && Suffix != "ri" &&
+        Suffix != "rri" && Suffix != "i")
+      return "";
+
+    const CodeGenRegisterClass &RC =
+      Target.getRegisterClass(II.Operands[0].Rec);
+    std::string Temp = newTemp();
+    Code.push_back("unsigned " + Temp + " = FastEmitInst_" + Suffix + "(" +
+                   InstNS + Op->getName() + ", " + InstNS + RC.getName() +
+                   "RegisterClass" + AllArgs + ");");
+    return Temp;
+  }
+
+public:
+  /// Code - The statements built for the destination, one per line.
+  std::vector<std::string> Code;
+
+  DstTreeBuilder(const CodeGenTarget &T, const std::string &NS,
+                 TreePatternNode *Src, const OperandsSignature &Ops)
+    : Target(T), InstNS(NS), Operands(Ops), NumTemps(0) {
+    for (unsigned i = 0, e = Src->getNumChildren(); i != e; ++i)
+      if (!Src->getChild(i)->getName().empty())
+        SrcOperands[Src->getChild(i)->getName()] = i;
+  }
+
+  /// build - Build the code for the destination pattern Dst.  Return false
+  /// if some part of it is beyond what the generated selector can emit.
+  bool build(TreePatternNode *Dst) {
+    if (Dst->isLeaf())
+      return false;
+    countUses(Dst);
+    std::string Result = emitNode(Dst);
+    if (Result.empty())
+      return false;
+    Code.push_back("return " + Result + ";");
+    return true;
+  }
+};
+
 class FastISelMap {
   typedef std::map<std::string, InstructionMemo> PredMap;
   typedef std::map<MVT::SimpleValueType, PredMap> RetPredMap;
@@ -225,6 +398,14 @@ public:
 
   void CollectPatterns(CodeGenDAGPatterns &CGP);
   void PrintFunctionDefinitions(raw_ostream &OS);
+
+private:
+  void EmitInstruction(raw_ostream &OS, const OperandsSignature &Operands,
+                       const InstructionMemo &Memo,
+                       const std::string &RetVTName,
+                       const std::string &Indent);
+  void EmitInstructions(raw_ostream &OS, const OperandsSignature &Operands,
+                        const PredMap &PM, const std::string &RetVTName);
 };
 
 }
@@ -240,6 +421,50 @@ static std::string getLegalCName(std::string OpName) {
   return OpName;
 }
 
+/// getConstantChecks - Set Checks to the C++ condition that the immediate
+/// parameters of a pattern hold the specific constants its source operands
+/// require, or to an empty string if it has no such operands.  The caller
+/// may pass an immediate zero- or sign-extended, so only the bits of the
+/// operand's type are compared.  Return false if a constant has a type
+/// that can't be checked.
+static bool getConstantChecks(TreePatternNode *InstPatNode,
+                              std::string &Checks) {
+  for (unsigned i = 0, e = InstPatNode->getNumChildren(); i != e; ++i) {
+    TreePatternNode *Op = InstPatNode->getChild(i);
+    if (!Op->isLeaf())
+      continue;
+    IntInit *II = dynamic_cast<IntInit*>(Op->getLeafValue());
+    if (!II)
+      continue;
+
+    std::string Check;
+    switch (Op->getType(0)) {
+    case MVT::i8:
+      Check = "(uint8_t)imm" + utostr(i) + " == " +
+              utostr((uint8_t)II->getValue()) + "U";
+      break;
+    case MVT::i16:
+      Check = "(uint16_t)imm" + utostr(i) + " == " +
+              utostr((uint16_t)II->getValue()) + "U";
+      break;
+    case MVT::i32:
+      Check = "(uint32_t)imm" + utostr(i) + " == " +
+              utostr((uint32_t)II->getValue()) + "U";
+      break;
+    case MVT::i64:
+      Check = "imm" + utostr(i) + " == " +
+              utostr((uint64_t)II->getValue()) + "ULL";
+      break;
+    default:
+      return false;
+    }
+    if (!Checks.empty())
+      Checks += " && ";
+    Checks += "(" + Check + ")";
+  }
+  return true;
+}
+
 FastISelMap::FastISelMap(std::string instns)
   : InstNS(instns) {
 }
@@ -256,8 +481,7 @@ void FastISelMap::CollectPatterns(CodeGenDAGPatterns &CGP) {
        E = CGP.ptm_end(); I != E; ++I) {
     const PatternToMatch &Pattern = *I;
 
-    // For now, just look at Instructions, so that we don't have to worry
-    // about emitting multiple instructions for a pattern.
+    // For now, just look at patterns that produce Instructions.
     TreePatternNode *Dst = Pattern.getDstPattern();
     if (Dst->isLeaf()) continue;
     Record *Op = Dst->getOperator();
@@ -267,7 +491,8 @@ void FastISelMap::CollectPatterns(CodeGenDAGPatterns &CGP) {
     if (II.Operands.size() == 0)
       continue;
 
-    // For now, ignore multi-instruction patterns.
+    // Multi-instruction patterns are emitted from the destination tree
+    // below, which checks each of their instructions.
     bool MultiInsts = false;
     for (unsigned i = 0, e = Dst->getNumChildren(); i != e; ++i) {
       TreePatternNode *ChildOp = Dst->getChild(i);
@@ -278,14 +503,14 @@ void FastISelMap::CollectPatterns(CodeGenDAGPatterns &CGP) {
         break;
       }
     }
-    if (MultiInsts)
-      continue;
 
     // For now, ignore instructions where the first operand is not an
     // output register.
     const CodeGenRegisterClass *DstRC = 0;
     std::string SubRegNo;
-    if (Op->getName() != "EXTRACT_SUBREG") {
+    if (MultiInsts) {
+      // Checked by DstTreeBuilder.
+    } else if (Op->getName() != "EXTRACT_SUBREG") {
       Record *Op0Rec = II.Operands[0].Rec;
       if (!Op0Rec->isSubClassOf("RegisterClass"))
         continue;
@@ -350,9 +575,9 @@ void FastISelMap::CollectPatterns(CodeGenDAGPatterns &CGP) {
         }
 
         DefInit *OpDI = dynamic_cast<DefInit*>(Op->getLeafValue());
-        Record *OpLeafRec = OpDI->getDef();
         std::string PhysReg;
-        if (OpLeafRec->isSubClassOf("Register")) {
+        if (OpDI && OpDI->getDef()->isSubClassOf("Register")) {
+          Record *OpLeafRec = OpDI->getDef();
           PhysReg += static_cast<StringInit*>(OpLeafRec->getValue( \
                      "Namespace")->getValue())->getValue();
           PhysReg += "::";
@@ -371,15 +596,42 @@ void FastISelMap::CollectPatterns(CodeGenDAGPatterns &CGP) {
     } else
       PhysRegInputs->push_back("");
 
-    // Get the predicate that guards this pattern.
+    // Get the predicate that guards this pattern, and add the checks for
+    // any specific constants it matches.
     std::string PredicateCheck = Pattern.getPredicateCheck();
+    std::string ConstantChecks;
+    if (!getConstantChecks(InstPatNode, ConstantChecks))
+      continue;
+    if (!ConstantChecks.empty()) {
+      if (!PredicateCheck.empty())
+        PredicateCheck += " && ";
+      PredicateCheck += ConstantChecks;
+    }
+
+    // The operands of a multi-instruction pattern, or of one that matches
+    // a constant, don't line up with the source operands, so build the
+    // code for its destination from the tree.
+    std::vector<std::string> DstCode;
+    if (MultiInsts || !ConstantChecks.empty()) {
+      bool HasPhysRegInputs = false;
+      for (unsigned i = 0, e = PhysRegInputs->size(); i != e; ++i)
+        if (!(*PhysRegInputs)[i].empty())
+          HasPhysRegInputs = true;
+      if (HasPhysRegInputs)
+        continue;
+      DstTreeBuilder Builder(Target, InstNS, InstPatNode, Operands);
+      if (!Builder.build(Dst))
+        continue;
+      DstCode = Builder.Code;
+    }
 
     // Ok, we found a pattern that we can handle. Remember it.
     InstructionMemo Memo = {
       Pattern.getDstPattern()->getOperator()->getName(),
       DstRC,
       SubRegNo,
-      PhysRegInputs
+      PhysRegInputs,
+      DstCode
     };
     if (SimplePatterns[Operands][OpcodeName][VT][RetVT]
             .count(PredicateCheck))
@@ -389,6 +641,73 @@ void FastISelMap::CollectPatterns(CodeGenDAGPatterns &CGP) {
   }
 }
 
+/// EmitInstruction - Emit the code that builds the instruction or
+/// instructions for Memo and returns the result register.
+void FastISelMap::EmitInstruction(raw_ostream &OS,
+                                  const OperandsSignature &Operands,
+                                  const InstructionMemo &Memo,
+                                  const std::string &RetVTName,
+                                  const std::string &Indent) {
+  if (!Memo.DstCode.empty()) {
+    for (unsigned i = 0, e = Memo.DstCode.size(); i != e; ++i)
+      OS << Indent << Memo.DstCode[i] << "\n";
+    return;
+  }
+
+  for (unsigned i = 0; i < Memo.PhysRegs->size(); ++i) {
+    if ((*Memo.PhysRegs)[i] != "")
+      OS << Indent << "BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, "
+         << "TII.get(TargetOpcode::COPY), "
+         << (*Memo.PhysRegs)[i] << ").addReg(Op" << i << ");\n";
+  }
+
+  OS << Indent << "return FastEmitInst_";
+  if (Memo.SubRegNo.empty()) {
+    Operands.PrintManglingSuffix(OS, *Memo.PhysRegs);
+    OS << "(" << InstNS << Memo.Name << ", ";
+    OS << InstNS << Memo.RC->getName() << "RegisterClass";
+    if (!Operands.empty())
+      OS << ", ";
+    Operands.PrintArguments(OS, *Memo.PhysRegs);
+    OS << ");\n";
+  } else {
+    OS << "extractsubreg(" << RetVTName;
+    OS << ", Op0, Op0IsKill, ";
+    OS << Memo.SubRegNo;
+    OS << ");\n";
+  }
+}
+
+/// EmitInstructions - Emit the body of a FastEmit function that tries each
+/// of the instructions in PM.  Instructions guarded by a predicate are
+/// tried first, in order; one without a predicate is the fallback.  The
+/// subregister copies of a multi-instruction pattern are not coalesced at
+/// -O0, so such a pattern is only used when there is no fallback.
+void FastISelMap::EmitInstructions(raw_ostream &OS,
+                                   const OperandsSignature &Operands,
+                                   const PredMap &PM,
+                                   const std::string &RetVTName) {
+  PredMap::const_iterator FallbackI = PM.find("");
+  const InstructionMemo *Fallback =
+    FallbackI != PM.end() ? &FallbackI->second : 0;
+  for (PredMap::const_iterator PI = PM.begin(), PE = PM.end(); PI != PE; ++PI) {
+    const std::string &PredicateCheck = PI->first;
+    const InstructionMemo &Memo = PI->second;
+    if (PredicateCheck.empty() ||
+        (Fallback && Memo.DstCode.size() > 2))
+      continue;
+    OS << "  if (" + PredicateCheck + ") {\n";
+    EmitInstruction(OS, Operands, Memo, RetVTName, "    ");
+    OS << "  }\n";
+  }
+
+  // Return 0 if none of the predicates were satisfied.
+  if (Fallback)
+    EmitInstruction(OS, Operands, *Fallback, RetVTName, "  ");
+  else
+    OS << "  return 0;\n";
+}
+
 void FastISelMap::PrintFunctionDefinitions(raw_ostream &OS) {
   // Now emit code for all the patterns that we collected.
   for (OperandsOpcodeTypeRetPredMap::const_iterator OI = SimplePatterns.begin(),
@@ -414,7 +733,6 @@ void FastISelMap::PrintFunctionDefinitions(raw_ostream &OS) {
                RI != RE; ++RI) {
             MVT::SimpleValueType RetVT = RI->first;
             const PredMap &PM = RI->second;
-            bool HasPred = false;
 
             OS << "unsigned FastEmit_"
                << getLegalCName(Opcode)
@@ -425,53 +743,7 @@ void FastISelMap::PrintFunctionDefinitions(raw_ostream &OS) {
             Operands.PrintParameters(OS);
             OS << ") {\n";
 
-            // Emit code for each possible instruction. There may be
-            // multiple if there are subtarget concerns.
-            for (PredMap::const_iterator PI = PM.begin(), PE = PM.end();
-                 PI != PE; ++PI) {
-              std::string PredicateCheck = PI->first;
-              const InstructionMemo &Memo = PI->second;
-
-              if (PredicateCheck.empty()) {
-                assert(!HasPred &&
-                       "Multiple instructions match, at least one has "
-                       "a predicate and at least one doesn't!");
-              } else {
-                OS << "  if (" + PredicateCheck + ") {\n";
-                OS << "  ";
-                HasPred = true;
-              }
-
-              for (unsigned i = 0; i < Memo.PhysRegs->size(); ++i) {
-                if ((*Memo.PhysRegs)[i] != "")
-                  OS << "  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, "
-                     << "TII.get(TargetOpcode::COPY), "
-                     << (*Memo.PhysRegs)[i] << ").addReg(Op" << i << ");\n";
-              }
-
-              OS << "  return FastEmitInst_";
-              if (Memo.SubRegNo.empty()) {
-                Operands.PrintManglingSuffix(OS, *Memo.PhysRegs);
-                OS << "(" << InstNS << Memo.Name << ", ";
-                OS << InstNS << Memo.RC->getName() << "RegisterClass";
-                if (!Operands.empty())
-                  OS << ", ";
-                Operands.PrintArguments(OS, *Memo.PhysRegs);
-                OS << ");\n";
-              } else {
-                OS << "extractsubreg(" << getName(RetVT);
-                OS << ", Op0, Op0IsKill, ";
-                OS << Memo.SubRegNo;
-                OS << ");\n";
-              }
-
-              if (HasPred)
-                OS << "  }\n";
-
-            }
-            // Return 0 if none of the predicates were satisfied.
-            if (HasPred)
-              OS << "  return 0;\n";
+            EmitInstructions(OS, Operands, PM, getName(RetVT));
             OS << "}\n";
             OS << "\n";
           }
@@ -515,55 +787,7 @@ void FastISelMap::PrintFunctionDefinitions(raw_ostream &OS) {
              << ")\n    return 0;\n";
 
           const PredMap &PM = RM.begin()->second;
-          bool HasPred = false;
-
-          // Emit code for each possible instruction. There may be
-          // multiple if there are subtarget concerns.
-          for (PredMap::const_iterator PI = PM.begin(), PE = PM.end(); PI != PE;
-               ++PI) {
-            std::string PredicateCheck = PI->first;
-            const InstructionMemo &Memo = PI->second;
-
-            if (PredicateCheck.empty()) {
-              assert(!HasPred &&
-                     "Multiple instructions match, at least one has "
-                     "a predicate and at least one doesn't!");
-            } else {
-              OS << "  if (" + PredicateCheck + ") {\n";
-              OS << "  ";
-              HasPred = true;
-            }
-
-            for (unsigned i = 0; i < Memo.PhysRegs->size(); ++i) {
-              if ((*Memo.PhysRegs)[i] != "")
-                OS << "  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, "
-                   << "TII.get(TargetOpcode::COPY), "
-                   << (*Memo.PhysRegs)[i] << ").addReg(Op" << i << ");\n";
-            }
-
-            OS << "  return FastEmitInst_";
-
-            if (Memo.SubRegNo.empty()) {
-              Operands.PrintManglingSuffix(OS, *Memo.PhysRegs);
-              OS << "(" << InstNS << Memo.Name << ", ";
-              OS << InstNS << Memo.RC->getName() << "RegisterClass";
-              if (!Operands.empty())
-                OS << ", ";
-              Operands.PrintArguments(OS, *Memo.PhysRegs);
-              OS << ");\n";
-            } else {
-              OS << "extractsubreg(RetVT, Op0, Op0IsKill, ";
-              OS << Memo.SubRegNo;
-              OS << ");\n";
-            }
-
-             if (HasPred)
-               OS << "  }\n";
-          }
-
-          // Return 0 if none of the predicates were satisfied.
-          if (HasPred)
-            OS << "  return 0;\n";
+          EmitInstructions(OS, Operands, PM, "RetVT");
           OS << "}\n";
           OS << "\n";
         }
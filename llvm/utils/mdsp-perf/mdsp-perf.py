@@ -0,0 +1,246 @@
+#!/usr/bin/env python
+
+"""
+mdsp-perf - MDSP code size and cycle count regression checker.
+
+Compiles a corpus of DSP kernels with llc, runs each one on the MDSP
+simulator and compares the size of its code and the number of cycles it took
+with a stored baseline. A kernel that got bigger or slower than the baseline
+allows is reported as a regression, and so is a kernel whose result no longer
+matches the 'CHECK: return:' line of its test. Every kernel is measured on
+each of the MDSP cores named with --mcpu, since each core has its own
+schedule.
+
+The kernels are the lit tests in test/CodeGen/MDSP/Kernels, so the corpus is
+also covered by 'make check'. To accept the current numbers, for example
+after a change that is known to be a win, rerun with --update and commit the
+new baseline along with the change.
+"""
+
+import os, re, struct, subprocess, sys, tempfile
+
+kSrcRoot = os.path.dirname(os.path.dirname(os.path.dirname(
+    os.path.abspath(__file__))))
+kDefaultKernels = os.path.join(kSrcRoot, 'test', 'CodeGen', 'MDSP', 'Kernels')
+kDefaultBaseline = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                'baseline.txt')
+
+kExpectedRE = re.compile(r'^;\s*CHECK:\s*return:\s*(-?\d+)\s*$', re.MULTILINE)
+
+class PerfError(Exception):
+    pass
+
+class Measurement:
+    def __init__(self, size, cycles):
+        self.size = size
+        self.cycles = cycles
+
+def note(msg):
+    sys.stderr.write('mdsp-perf: %s\n' % msg)
+
+def findTool(name, toolsDir):
+    if toolsDir:
+        path = os.path.join(toolsDir, name)
+        if not os.path.exists(path):
+            raise PerfError("unable to find '%s' in '%s'" % (name, toolsDir))
+        return path
+    return name
+
+def runTool(args):
+    try:
+        p = subprocess.Popen(args, stdout=subprocess.PIPE,
+                             stderr=subprocess.PIPE)
+    except OSError:
+        raise PerfError("unable to run '%s'" % args[0])
+    out,err = p.communicate()
+    if p.returncode != 0:
+        raise PerfError('%s failed:\n%s' % (' '.join(args),
+                                             err.decode().strip()))
+    return out.decode()
+
+def getCodeSize(path):
+    """getCodeSize(path) - Return the total size of the executable sections of
+    an ELF32 little endian object."""
+    f = open(path, 'rb')
+    data = f.read()
+    f.close()
+    if data[:4] != b'\x7fELF':
+        raise PerfError("'%s' is not an ELF file" % path)
+    shoff, = struct.unpack_from('<I', data, 32)
+    shentsize, shnum = struct.unpack_from('<HH', data, 46)
+    size = 0
+    for i in range(shnum):
+        base = shoff + i * shentsize
+        flags, = struct.unpack_from('<I', data, base + 8)
+        secSize, = struct.unpack_from('<I', data, base + 20)
+        if flags & 0x4:  # SHF_EXECINSTR
+            size += secSize
+    return size
+
+def measureKernel(path, cpu, opts, llc, sim):
+    f = open(path)
+    m = kExpectedRE.search(f.read())
+    f.close()
+    if not m:
+        raise PerfError("'%s' has no 'CHECK: return:' line" % path)
+    expected = int(m.group(1))
+
+    fd,obj = tempfile.mkstemp(suffix='.o')
+    os.close(fd)
+    try:
+        runTool([llc, '-march=mdsp', '-mcpu=' + cpu, '-filetype=obj',
+                 path, '-o', obj] + opts.llcArgs)
+        size = getCodeSize(obj)
+        out = runTool([sim, '-mcpu=' + cpu,
+                       '-max-cycles=%d' % opts.maxCycles, obj])
+    finally:
+        os.remove(obj)
+
+    result = re.search(r'^return: (-?\d+)$', out, re.MULTILINE)
+    cycles = re.search(r'^cycles: (\d+)$', out, re.MULTILINE)
+    if not result or not cycles:
+        raise PerfError('unexpected simulator output:\n%s' % out)
+    if int(result.group(1)) != expected:
+        raise PerfError('returned %s, expected %d' % (result.group(1),
+                                                      expected))
+    return Measurement(size, int(cycles.group(1)))
+
+def readBaseline(path):
+    baseline = {}
+    if not os.path.exists(path):
+        return baseline
+    f = open(path)
+    for ln in f:
+        ln = ln.split('#', 1)[0].strip()
+        if not ln:
+            continue
+        fields = ln.split()
+        if len(fields) != 3:
+            raise PerfError("invalid baseline line: '%s'" % ln)
+        baseline[fields[0]] = Measurement(int(fields[1]), int(fields[2]))
+    f.close()
+    return baseline
+
+def writeBaseline(path, results):
+    f = open(path, 'w')
+    f.write('# MDSP kernel baseline, written by mdsp-perf.py --update.\n')
+    f.write('# kernel  code-size  cycles\n')
+    for name in sorted(results):
+        f.write('%s %d %d\n' % (name, results[name].size,
+                                results[name].cycles))
+    f.close()
+
+def getCPU(name):
+    """getCPU(name) - Return the core a baseline entry was measured on."""
+    if '@' in name:
+        return name.split('@', 1)[1]
+    return 'generic'
+
+def compare(current, base, threshold):
+    """compare(current, base, threshold) - Return the change from base to
+    current in percent and whether it is beyond the threshold."""
+    if base == 0:
+        return (0.0, current != 0)
+    delta = 100.0 * (current - base) / base
+    return (delta, delta > threshold)
+
+def main():
+    from optparse import OptionParser
+    parser = OptionParser("usage: %prog [options] {kernel.ll}*")
+    parser.add_option("", "--tools", dest="toolsDir", metavar="DIR",
+                      help="Directory with llc and mdsp-sim (default: PATH)",
+                      action="store", default=None)
+    parser.add_option("", "--baseline", dest="baseline", metavar="FILE",
+                      help="Baseline to compare with (default: %default)",
+                      action="store", default=kDefaultBaseline)
+    parser.add_option("", "--update", dest="update",
+                      help="Write the current numbers to the baseline",
+                      action="store_true", default=False)
+    parser.add_option("", "--threshold", dest="threshold", metavar="PCT",
+                      help="Growth in percent that is tolerated "
+                           "(default: %default)",
+                      type=float, action="store", default=0.0)
+    parser.add_option("", "--mcpu", dest="cpus", metavar="CPU,...",
+                      help="MDSP cores to compile for and simulate "
+                           "(default: %default)",
+                      action="store", default="generic,mdsp100,mdsp300")
+    parser.add_option("", "--llc-arg", dest="llcArgs", metavar="ARG",
+                      help="Extra option for llc",
+                      action="append", default=[])
+    parser.add_option("", "--max-cycles", dest="maxCycles", metavar="N",
+                      help="Cycle limit per kernel (default: %default)",
+                      type=int, action="store", default=10000000)
+    (opts, args) = parser.parse_args()
+    cpus = opts.cpus.split(',')
+
+    # Updating the baseline for a few kernels keeps the numbers of the rest,
+    # and updating it for one core keeps those of the other cores.
+    keepOthers = bool(args)
+    if not args:
+        args = [os.path.join(kDefaultKernels, f)
+                for f in sorted(os.listdir(kDefaultKernels))
+                if f.endswith('.ll')]
+
+    try:
+        llc = findTool('llc', opts.toolsDir)
+        sim = findTool('mdsp-sim', opts.toolsDir)
+        baseline = readBaseline(opts.baseline)
+    except PerfError:
+        note(sys.exc_info()[1])
+        return 2
+
+    results = {}
+    failures = 0
+    regressions = 0
+    sys.stdout.write('%-16s %8s %8s %8s %10s %10s %8s\n' %
+                     ('Kernel', 'Size', 'Base', 'Delta', 'Cycles', 'Base',
+                      'Delta'))
+    for cpu,path in [(c,p) for c in cpus for p in args]:
+        # Each core has its own numbers, the generic one goes by the kernel
+        # name alone.
+        name = os.path.splitext(os.path.basename(path))[0]
+        if cpu != 'generic':
+            name += '@' + cpu
+        try:
+            cur = measureKernel(path, cpu, opts, llc, sim)
+        except PerfError:
+            note('%s: %s' % (name, sys.exc_info()[1]))
+            failures += 1
+            continue
+        results[name] = cur
+
+        base = baseline.get(name)
+        if base is None:
+            sys.stdout.write('%-16s %8d %8s %8s %10d %10s %8s  new\n' %
+                             (name, cur.size, '-', '-', cur.cycles, '-', '-'))
+            continue
+
+        sizeDelta,sizeWorse = compare(cur.size, base.size, opts.threshold)
+        cyclesDelta,cyclesWorse = compare(cur.cycles, base.cycles,
+                                          opts.threshold)
+        status = ''
+        if sizeWorse or cyclesWorse:
+            status = '  REGRESSED'
+            regressions += 1
+        sys.stdout.write('%-16s %8d %8d %+7.1f%% %10d %10d %+7.1f%%%s\n' %
+                         (name, cur.size, base.size, sizeDelta, cur.cycles,
+                          base.cycles, cyclesDelta, status))
+
+    if opts.update:
+        if failures:
+            note('not updating the baseline, %d kernel(s) failed' % failures)
+            return 1
+        for name,m in baseline.items():
+            if keepOthers or getCPU(name) not in cpus:
+                results.setdefault(name, m)
+        writeBaseline(opts.baseline, results)
+        note("wrote '%s'" % opts.baseline)
+        return 0
+
+    if failures or regressions:
+        note('%d kernel(s) failed, %d regressed' % (failures, regressions))
+        return 1
+    return 0
+
+if __name__=='__main__':
+    sys.exit(main())